@@ -30,10 +30,21 @@ public:
 	const static int CSV = 0;
 	const static int IMAGE = 1;
 	const static int TEXT = 2;
+	const static int STREAM = 3;
+
+	// feature storage flags
+	const static int STORE_FULL = 0;
+	const static int STORE_UINT8 = 1;
+	const static int STORE_FP16 = 2;
 
 	std::vector<OHE*> OHEMaps;
 	std::vector<bool> featureIsCategorical;
 
+	virtual ~DataInput()
+	{
+		//
+	}
+
 	virtual void import(shmea::GString) = 0;
 
 	virtual shmea::GList getTrainRow(unsigned int) const = 0;
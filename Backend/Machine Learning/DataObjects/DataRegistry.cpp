@@ -0,0 +1,291 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "DataRegistry.h"
+#include "ImageInput.h"
+#include "NumberInput.h"
+#include "TextInput.h"
+
+using namespace glades;
+
+pthread_mutex_t glades::DataRegistry::registryMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t glades::DataRegistry::loadedCond = PTHREAD_COND_INITIALIZER;
+std::map<std::string, glades::DataRegistry::Entry*> glades::DataRegistry::entries;
+unsigned int glades::DataRegistry::imports = 0;
+
+glades::DataHandle::DataHandle()
+{
+	key = "";
+	data = NULL;
+}
+
+glades::DataHandle::DataHandle(const std::string& newKey, DataInput* newData)
+{
+	key = newKey;
+	data = newData;
+}
+
+glades::DataHandle::DataHandle(const DataHandle& handle)
+{
+	key = handle.key;
+	data = handle.data;
+	if (data)
+		DataRegistry::addRef(key);
+}
+
+glades::DataHandle::~DataHandle()
+{
+	reset();
+}
+
+/*!
+ * @brief get dataset
+ * @details the shared dataset, for passing to train/test; do not import or modify it
+ * @return the DataInput or NULL for an empty handle
+ */
+DataInput* glades::DataHandle::get() const
+{
+	return data;
+}
+
+bool glades::DataHandle::empty() const
+{
+	return data == NULL;
+}
+
+void glades::DataHandle::reset()
+{
+	if (data)
+		DataRegistry::release(key);
+
+	key = "";
+	data = NULL;
+}
+
+void glades::DataHandle::operator=(const DataHandle& handle)
+{
+	if (this == &handle)
+		return;
+
+	if (handle.data)
+		DataRegistry::addRef(handle.key);
+	reset();
+
+	key = handle.key;
+	data = handle.data;
+}
+
+const DataInput* glades::DataHandle::operator->() const
+{
+	return data;
+}
+
+std::string glades::DataRegistry::makeKey(const shmea::GString& path, int inputType,
+										  int standardizeFlag, int storageType)
+{
+	char buffer[64];
+	sprintf(buffer, "|%d|%d|%d", inputType, standardizeFlag, storageType);
+	return std::string(path.c_str()) + buffer;
+}
+
+DataInput* glades::DataRegistry::create(int inputType, int storageType)
+{
+	if (inputType == DataInput::CSV)
+	{
+		NumberInput* ni = new NumberInput();
+		ni->setStorageType(storageType);
+		return ni;
+	}
+	else if (inputType == DataInput::IMAGE)
+	{
+		ImageInput* ii = new ImageInput();
+		ii->setStorageType(storageType);
+		return ii;
+	}
+	else if (inputType == DataInput::TEXT)
+		return new TextInput();
+
+	return NULL;
+}
+
+/*!
+ * @brief acquire dataset
+ * @details returns a handle to the dataset, importing it on first use. Later acquires with the
+ * same options share the same DataInput until every handle has been released.
+ * @param path the path as passed to DataInput::import
+ * @param inputType DataInput::CSV, IMAGE or TEXT
+ * @param standardizeFlag GMath::MINMAX or GMath::ZSCORE (CSV only)
+ * @param storageType DataInput::STORE_FULL, STORE_UINT8 or STORE_FP16 (CSV and IMAGE only)
+ * @return the handle; empty if the input type is unknown or the import found no rows
+ */
+DataHandle glades::DataRegistry::acquire(const shmea::GString& path, int inputType,
+										 int standardizeFlag, int storageType)
+{
+	std::string key = makeKey(path, inputType, standardizeFlag, storageType);
+
+	pthread_mutex_lock(&registryMutex);
+	std::map<std::string, Entry*>::iterator itr = entries.find(key);
+	if (itr != entries.end())
+	{
+		// Someone else imported (or is importing) it
+		Entry* cEntry = itr->second;
+		++cEntry->refCount;
+		while (cEntry->loading)
+			pthread_cond_wait(&loadedCond, &registryMutex);
+
+		DataInput* cData = cEntry->data;
+		if (!cData)
+		{
+			// The import failed and the entry is already out of the map
+			--cEntry->refCount;
+			if (cEntry->refCount == 0)
+				delete cEntry;
+			pthread_mutex_unlock(&registryMutex);
+			return DataHandle();
+		}
+
+		pthread_mutex_unlock(&registryMutex);
+		return DataHandle(key, cData);
+	}
+
+	DataInput* newData = create(inputType, storageType);
+	if (!newData)
+	{
+		pthread_mutex_unlock(&registryMutex);
+		return DataHandle();
+	}
+
+	Entry* newEntry = new Entry();
+	newEntry->data = newData;
+	newEntry->refCount = 1;
+	newEntry->loading = true;
+	entries[key] = newEntry;
+	pthread_mutex_unlock(&registryMutex);
+
+	// Import outside the lock so other datasets can load in parallel
+	printf("[NNDATA] Importing shared dataset %s\n", key.c_str());
+	if (inputType == DataInput::CSV)
+		((NumberInput*)newData)->import(path, standardizeFlag);
+	else
+		newData->import(path);
+
+	// Missing or empty file: forget the key so a later acquire imports it again
+	bool imported = (newData->getTrainSize() > 0);
+	Entry* deadEntry = NULL;
+
+	pthread_mutex_lock(&registryMutex);
+	++imports;
+	newEntry->loading = false;
+	if (!imported)
+	{
+		entries.erase(key);
+		newEntry->data = NULL;
+		--newEntry->refCount;
+		if (newEntry->refCount == 0)
+			deadEntry = newEntry;
+	}
+	pthread_cond_broadcast(&loadedCond);
+	pthread_mutex_unlock(&registryMutex);
+
+	if (!imported)
+	{
+		printf("[NNDATA] Shared dataset %s has no rows\n", key.c_str());
+		delete newData;
+		delete deadEntry;
+		return DataHandle();
+	}
+
+	return DataHandle(key, newData);
+}
+
+void glades::DataRegistry::addRef(const std::string& key)
+{
+	pthread_mutex_lock(&registryMutex);
+	std::map<std::string, Entry*>::iterator itr = entries.find(key);
+	if (itr != entries.end())
+		++itr->second->refCount;
+	pthread_mutex_unlock(&registryMutex);
+}
+
+void glades::DataRegistry::release(const std::string& key)
+{
+	Entry* deadEntry = NULL;
+
+	pthread_mutex_lock(&registryMutex);
+	std::map<std::string, Entry*>::iterator itr = entries.find(key);
+	if (itr != entries.end())
+	{
+		--itr->second->refCount;
+		if (itr->second->refCount == 0)
+		{
+			deadEntry = itr->second;
+			entries.erase(itr);
+		}
+	}
+	pthread_mutex_unlock(&registryMutex);
+
+	// Free the dataset outside the lock
+	if (deadEntry)
+	{
+		delete deadEntry->data;
+		delete deadEntry;
+	}
+}
+
+unsigned int glades::DataRegistry::size()
+{
+	pthread_mutex_lock(&registryMutex);
+	unsigned int retVal = entries.size();
+	pthread_mutex_unlock(&registryMutex);
+	return retVal;
+}
+
+unsigned int glades::DataRegistry::useCount(const DataHandle& handle)
+{
+	if (handle.empty())
+		return 0;
+
+	unsigned int retVal = 0;
+	pthread_mutex_lock(&registryMutex);
+	std::map<std::string, Entry*>::const_iterator itr = entries.find(handle.key);
+	if (itr != entries.end())
+		retVal = itr->second->refCount;
+	pthread_mutex_unlock(&registryMutex);
+	return retVal;
+}
+
+/*!
+ * @brief get imports
+ * @details how many imports the registry has run, failed ones included
+ * @return the import count
+ */
+unsigned int glades::DataRegistry::getImports()
+{
+	pthread_mutex_lock(&registryMutex);
+	unsigned int retVal = imports;
+	pthread_mutex_unlock(&registryMutex);
+	return retVal;
+}
+
+void glades::DataRegistry::print()
+{
+	pthread_mutex_lock(&registryMutex);
+	printf("[NNDATA] %lu shared datasets, %u imports\n", (unsigned long)entries.size(), imports);
+	std::map<std::string, Entry*>::const_iterator itr = entries.begin();
+	for (; itr != entries.end(); ++itr)
+		printf("[NNDATA] %s (%u handles)\n", itr->first.c_str(), itr->second->refCount);
+	pthread_mutex_unlock(&registryMutex);
+}
@@ -0,0 +1,103 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GDATAREGISTRY
+#define _GDATAREGISTRY
+
+#include "DataInput.h"
+#include "Backend/Database/GString.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <map>
+#include <string>
+
+namespace glades {
+
+class DataRegistry;
+
+/*!
+ * @brief shared dataset handle
+ * @details reference counted handle to a DataInput owned by the DataRegistry. The dataset is
+ * shared by every handle with the same key and must be treated as read only; the last handle to
+ * go away frees it.
+ */
+class DataHandle
+{
+private:
+
+	friend class DataRegistry;
+
+	std::string key;
+	DataInput* data;
+
+	DataHandle(const std::string&, DataInput*);
+
+public:
+
+	DataHandle();
+	DataHandle(const DataHandle&);
+	virtual ~DataHandle();
+
+	DataInput* get() const;
+	bool empty() const;
+	void reset();
+
+	void operator=(const DataHandle&);
+	const DataInput* operator->() const;
+};
+
+/*!
+ * @brief dataset registry
+ * @details process-wide cache of imported datasets keyed by path, input type, standardization
+ * and storage type. Concurrent acquires of the same key share one import; the importing thread
+ * loads outside the registry lock while the others wait for it. An import that yields no rows is
+ * not cached: everyone waiting on it gets an empty handle and the next acquire tries again.
+ */
+class DataRegistry
+{
+private:
+
+	friend class DataHandle;
+
+	class Entry
+	{
+	public:
+		DataInput* data;
+		unsigned int refCount;
+		bool loading;
+	};
+
+	static pthread_mutex_t registryMutex;
+	static pthread_cond_t loadedCond;
+	static std::map<std::string, Entry*> entries;
+	static unsigned int imports;
+
+	static std::string makeKey(const shmea::GString&, int, int, int);
+	static DataInput* create(int, int);
+	static void addRef(const std::string&);
+	static void release(const std::string&);
+
+public:
+
+	static DataHandle acquire(const shmea::GString&, int, int = 0, int = DataInput::STORE_FULL);
+	static unsigned int size();
+	static unsigned int useCount(const DataHandle&);
+	static unsigned int getImports();
+	static void print();
+};
+};
+
+#endif
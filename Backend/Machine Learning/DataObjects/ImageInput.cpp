@@ -56,6 +56,18 @@ void ImageInput::import(shmea::GString newName)
     // Convert the label to a string for classification
     trainingLegend.setCell(i, 1, label);
 
+	// Keep only the compact pixels
+	if (storageType != STORE_FULL)
+	{
+	    if (i == 0)
+		pixelCount = img->getPixelCount();
+
+	    shmea::GList pixels = img->flatten();
+	    pixels.standardize(glades::DataInput::IMAGE);
+	    trainStore.addRow(pixels);
+	    continue;
+	}
+
 	// Add a label if it doesn't exist
 	if(trainImages.find(label) == trainImages.end())
 	{
@@ -84,6 +96,16 @@ void ImageInput::import(shmea::GString newName)
 
     // Convert the label to a string for classification
     testingLegend.setCell(i, 1, label);
+
+	// Keep only the compact pixels
+	if (storageType != STORE_FULL)
+	{
+	    shmea::GList pixels = img->flatten();
+	    pixels.standardize(glades::DataInput::IMAGE);
+	    testStore.addRow(pixels);
+	    continue;
+	}
+
 	// Add a label if it doesn't exist
 	if(testImages.find(label) == testImages.end())
 	{
@@ -126,11 +148,31 @@ void ImageInput::import(shmea::GString newName)
     }
 
     //printf("OHEMaps.size() = %lu\n", OHEMaps.size());
+    if (storageType != STORE_FULL)
+	trainStore.print();
 
     // Set the loaded flag
     loaded = true;
 }
 
+/*!
+ * @brief set storage type
+ * @details images are flattened and standardized once at import and kept as uint8 codes (per row
+ * scale/offset) or fp16 halves; the decoded Images are not kept, so getTrainImage and
+ * getTestImage return empty images. Must be called before import.
+ * @param newStorageType DataInput::STORE_FULL, STORE_UINT8 or STORE_FP16
+ */
+void ImageInput::setStorageType(int newStorageType)
+{
+    if(loaded)
+    {
+	printf("[NNDATA] Storage type must be set before import\n");
+	return;
+    }
+
+    storageType = newStorageType;
+}
+
 const shmea::GPointer<shmea::Image> ImageInput::getTrainImage(unsigned int row) const
 {
     if(row >= trainingLegend.numberOfRows())
@@ -178,6 +220,9 @@ const shmea::GPointer<shmea::Image> ImageInput::getTestImage(unsigned int row) c
 shmea::GList ImageInput::getTrainRow(unsigned int index) const
 {
     int inputType = glades::DataInput::IMAGE;
+    if(!trainStore.empty())
+	return trainStore.getRow(index);
+
     static const unsigned int numRows = trainingLegend.numberOfRows(); // Cache number of rows
     if (index >= numRows)
         return emptyRow;
@@ -263,6 +308,9 @@ shmea::GList ImageInput::getTestExpectedRow(unsigned int index) const
 shmea::GList ImageInput::getTestRow(unsigned int index) const
 {
     int inputType = glades::DataInput::IMAGE;
+    if(!testStore.empty())
+	return testStore.getRow(index);
+
     if(index >= testingLegend.numberOfRows())
 	return shmea::GList();
 
@@ -298,6 +346,9 @@ unsigned int ImageInput::getTestSize() const
 
 unsigned int ImageInput::getFeatureCount() const
 {
+	if(!trainStore.empty())
+		return pixelCount;
+
 	if(trainImages.size() == 0)
 		return 0;
 
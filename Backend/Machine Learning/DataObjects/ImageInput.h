@@ -18,6 +18,7 @@
 #define _GIMAGEINPUT
 
 #include "DataInput.h"
+#include "QuantizedTable.h"
 #include "Backend/Database/GString.h"
 #include "Backend/Database/GTable.h"
 #include "Backend/Database/image.h"
@@ -39,6 +40,12 @@ public:
 	std::map<shmea::GString, std::map<shmea::GString, shmea::GPointer<shmea::Image> > > trainImages;
 	std::map<shmea::GString, std::map<shmea::GString, shmea::GPointer<shmea::Image> > > testImages;
 
+	// Flattened, standardized pixels when storageType != STORE_FULL (one row per legend row)
+	int storageType;
+	unsigned int pixelCount;
+	QuantizedTable trainStore;
+	QuantizedTable testStore;
+
 	shmea::GList emptyRow;
 	shmea::GString name;
 	bool loaded;
@@ -48,6 +55,8 @@ public:
 		//
 	    name = "";
 	    loaded = false;
+	    storageType = STORE_FULL;
+	    pixelCount = 0;
 	    trainingLegend.clear();
 	    testingLegend.clear();
 	    trainImages.clear();
@@ -62,9 +71,12 @@ public:
 	    testingLegend.clear();
 	    trainImages.clear();
 	    testImages.clear();
+	    trainStore.clear();
+	    testStore.clear();
 	}
 
 	virtual void import(shmea::GString);
+	void setStorageType(int);
 	const shmea::GPointer<shmea::Image> getTrainImage(unsigned int) const;
 	const shmea::GPointer<shmea::Image> getTestImage(unsigned int) const;
 
@@ -20,11 +20,17 @@
 #include "Backend/Database/SaveTable.h"
 #include "../GMath/OHE.h"
 #include "../GMath/gmath.h"
+#include "../GMath/runningstat.h"
 #include "../Structure/nninfo.h"
 
 using namespace glades;
 
 void NumberInput::import(shmea::GString fname)
+{
+    import(fname, GMath::MINMAX);
+}
+
+void NumberInput::import(shmea::GString fname, int newStandardizeFlag)
 {
     if(loaded)
 	return;
@@ -32,15 +38,67 @@ void NumberInput::import(shmea::GString fname)
     name = fname;
 
     // Load and Normalize/Standardize the data
-    standardizeInputTable(fname);
+    standardizeInputTable(fname, newStandardizeFlag);
 
     // TODO: test table stuff
 
+    // Move the standardized features into compact storage
+    if (storageType != STORE_FULL)
+    {
+	trainStore.setStorageType(storageType);
+	trainStore.fromTable(trainTable);
+	trainTable.clear();
+	trainStore.print();
+
+	testStore.setStorageType(storageType);
+	testStore.fromTable(testTable);
+	testTable.clear();
+    }
+
     // Set the loaded flag
     loaded = true;
 }
 
-void glades::NumberInput::standardizeInputTable(const shmea::GString& inputFName, int standardizeFlag)
+/*!
+ * @brief enable feature hashing
+ * @details categorical input cols get hashed into a fixed number of buckets instead of having an
+ * OHE dictionary built for them. Output cols keep using OHE so predictions can be decoded. Must be
+ * called before import.
+ * @param buckets the number of cols each categorical input col expands to; 0 disables hashing
+ * @param signedHashing whether to use a +1/-1 sign hash to reduce collision bias
+ */
+void glades::NumberInput::setFeatureHashing(unsigned int buckets, bool signedHashing)
+{
+	if (loaded)
+	{
+		printf("[NNDATA] Feature hashing must be set before import\n");
+		return;
+	}
+
+	useFeatureHashing = (buckets > 0);
+	if (useFeatureHashing)
+		featureHasher = FeatureHasher(buckets, signedHashing);
+}
+
+/*!
+ * @brief set storage type
+ * @details input features are kept as uint8 codes (per col scale/offset) or fp16 halves after
+ * standardization and dequantized to floats as rows are read. Expected (output) cols stay full
+ * precision. Must be called before import.
+ * @param newStorageType DataInput::STORE_FULL, STORE_UINT8 or STORE_FP16
+ */
+void glades::NumberInput::setStorageType(int newStorageType)
+{
+	if (loaded)
+	{
+		printf("[NNDATA] Storage type must be set before import\n");
+		return;
+	}
+
+	storageType = newStorageType;
+}
+
+void glades::NumberInput::standardizeInputTable(const shmea::GString& inputFName, int newStandardizeFlag)
 {
 	trainTable = shmea::GTable(',');
 	shmea::GTable rawTable = shmea::GTable(inputFName, ',', shmea::GTable::TYPE_FILE);
@@ -49,20 +107,38 @@ void glades::NumberInput::standardizeInputTable(const shmea::GString& inputFName
 	if ((rawTable.numberOfRows() <= 0) || (rawTable.numberOfCols() <= 0))
 		return;
 
+	standardizeFlag = newStandardizeFlag;
+	isClassification = false;
+	colIsOutput.clear();
+	colHeaders.clear();
+	colOffset.clear();
+	colStats.clear();
+	storedScale.clear();
+	storedShift.clear();
+	readScale.clear();
+	readShift.clear();
+	rescaleCols.clear();
+
 	// default cols to non-categorical
-	bool isClassification = false;
 	for (unsigned int c = 0; c < rawTable.numberOfCols(); ++c)
 	{
 		OHE* cOHE = new OHE();
 		featureIsCategorical.push_back(false);
+		colIsOutput.push_back(rawTable.isOutput(c));
+		colHeaders.push_back(rawTable.getHeader(c));
 
 		shmea::GType cCell = rawTable.getCell(0, c); // get the first cell of the col
 		if (cCell.getType() == shmea::GType::STRING_TYPE)
 		{
-			cOHE->mapFeatureSpace(rawTable, c);
 			featureIsCategorical[c] = true;
 			isClassification = true;
-			cOHE->print();
+
+			// Hashed cols need no dictionary (or pass over the data)
+			if ((!useFeatureHashing) || (rawTable.isOutput(c)))
+			{
+				cOHE->mapFeatureSpace(rawTable, c);
+				cOHE->print();
+			}
 		}
 
 		OHEMaps.push_back(cOHE);
@@ -71,58 +147,66 @@ void glades::NumberInput::standardizeInputTable(const shmea::GString& inputFName
 	// iterate through the cols
 	for (unsigned int c = 0; c < rawTable.numberOfCols(); ++c)
 	{
-		// Set the min and max for this feature (col)
-		float fMin = 0.0f;
-		float fMax = 0.0f;
-		float fMean = 0.0f;
-
-		// iterate through the rows
+		// Set the min, max, mean and variance for this feature (col)
+		RunningStat cStats;
 		for (unsigned int r = 0; r < rawTable.numberOfRows(); ++r)
 		{
 			// check if already marked categorical
 			if (featureIsCategorical[c])
-				continue;
+				break;
 
 			float cell = 0.0f;
-			shmea::GType cCell = rawTable.getCell(r, c);
-
-			if (cCell.getType() == shmea::GType::STRING_TYPE)
-				continue; // mapped strings in a previous loop
-			else if (cCell.getType() == shmea::GType::CHAR_TYPE)
-				cell = cCell.getChar();
-			else if (cCell.getType() == shmea::GType::SHORT_TYPE)
-				cell = cCell.getShort();
-			else if (cCell.getType() == shmea::GType::INT_TYPE)
-				cell = cCell.getInt();
-			else if (cCell.getType() == shmea::GType::LONG_TYPE)
-				cell = cCell.getLong();
-			else if (cCell.getType() == shmea::GType::FLOAT_TYPE)
-				cell = cCell.getFloat();
-			else if (cCell.getType() == shmea::GType::DOUBLE_TYPE)
-				cell = cCell.getDouble();
-			else if (cCell.getType() == shmea::GType::BOOLEAN_TYPE)
-				cell = cCell.getBoolean() ? 1.0f : 0.0f;
-
-			if ((r == 0) && (c == 0))
+			if (!cellToFloat(rawTable.getCell(r, c), cell))
 			{
-				fMin = cell;
-				fMax = cell;
+				// for errors - strings MUST be categorical
+				printf("ERROR: String found in non-categorical column.\n");
+				trainTable.clear();
+				return;
 			}
 
-			// Check the mins and maxes
-			if (cell < fMin)
-				fMin = cell;
-			if (cell > fMax)
-				fMax = cell;
-
-			// update mean
-			fMean += cell;
-			if (r == (rawTable.numberOfRows() - 1))
-				fMean /= rawTable.numberOfRows();
+			cStats.add(cell);
 		}
-		printf("c: %d:%u, fMin: %f, fMax: %f, fMean: %f\n", c, rawTable.numberOfCols(), fMin, fMax, fMean);
+		printf("c: %d:%u, fMin: %f, fMax: %f, fMean: %f\n", c, rawTable.numberOfCols(),
+			   cStats.getMin(), cStats.getMax(), (float)cStats.getMean());
 
-		if (featureIsCategorical[c])
+		// Remember how this col was encoded so rows can be appended later
+		float cScale = 1.0f;
+		float cShift = 0.0f;
+		if (!featureIsCategorical[c])
+			encodeParams(cStats, cScale, cShift);
+
+		colStats.push_back(cStats);
+		storedScale.push_back(cScale);
+		storedShift.push_back(cShift);
+		readScale.push_back(1.0f);
+		readShift.push_back(0.0f);
+
+		shmea::GTable& cTable = colIsOutput[c] ? trainExpectedTable : trainTable;
+		colOffset.push_back(cTable.numberOfCols());
+
+		if ((featureIsCategorical[c]) && (useFeatureHashing) && (!colIsOutput[c]))
+		{
+			// hash each row straight into its bucket
+			std::vector<shmea::GList> newCols(featureHasher.size());
+			for (unsigned int r = 0; r < rawTable.numberOfRows(); ++r)
+			{
+				std::string cString = rawTable.getCell(r, c).c_str();
+				unsigned int cBucket = featureHasher.indexAt(cString);
+				float cSign = featureHasher.signAt(cString);
+
+				for (unsigned int cInt = 0; cInt < newCols.size(); ++cInt)
+					newCols[cInt].addFloat((cInt == cBucket) ? cSign : 0.0f);
+			}
+
+			// generic new header since hashing turns 1 col to many
+			for (unsigned int cInt = 0; cInt < newCols.size(); ++cInt)
+			{
+				shmea::GString newHeader = rawTable.getHeader(c).c_str();
+				newHeader += shmea::GString::intTOstring(cInt);
+				trainTable.addCol(newHeader, newCols[cInt]);
+			}
+		}
+		else if (featureIsCategorical[c])
 		{
 			OHE* OHEVector = OHEMaps[c];
 			printf("OHEVector size: %d\n", OHEVector->size());
@@ -151,144 +235,387 @@ void glades::NumberInput::standardizeInputTable(const shmea::GString& inputFName
 				newHeader += shmea::GString::intTOstring(cInt);
 
 				// add the standardized newCol to the trainTable
-				if (rawTable.isOutput(c))
-				{
-				    trainExpectedTable.addCol(newHeader, newCol);
-				    trainExpectedTable.toggleOutput(trainExpectedTable.numberOfCols() - 1);
-				}
-				else
-				    trainTable.addCol(newHeader, newCol);
+				cTable.addCol(newHeader, newCol);
+				if (colIsOutput[c])
+				    cTable.toggleOutput(cTable.numberOfCols() - 1);
 			}
 		}
 		else
 		{
-			if (standardizeFlag == GMath::MINMAX)
+			// iterate through the rows
+			shmea::GList newCol;
+			for (unsigned int r = 0; r < rawTable.numberOfRows(); ++r)
 			{
-				// find the range of this feature
-				float xRange = fMax - fMin;
-				if (xRange == 0.0f)
-				{
-					// This column is just a constant, add and skip standardization
-					trainTable.addCol(rawTable.getHeader(c), rawTable.getCol(c));
-					continue;
-				}
+				float cell = 0.0f;
+				cellToFloat(rawTable.getCell(r, c), cell);
 
-				// iterate through the rows
-				shmea::GList newCol;
-				for (unsigned int r = 0; r < rawTable.numberOfRows(); ++r)
-				{
-					// acquire original cell value
-					shmea::GType cCell = rawTable.getCell(r, c);
-					float cell = 0.0f;
-					if (cCell.getType() == shmea::GType::STRING_TYPE)
-					{
-						// for errors - strings MUST be categorical
-						printf("ERROR: String found in non-categorical column.\n");
-						trainTable.clear();
-						return;
-					}
-					else
-						cell = cCell.getFloat();
-
-					// standardize cell value based on network vars
-					if (isClassification) // CLASSIFICATION
-					{
-						// [0.01, 0.99] bounds
-						cell = ((((cell - fMin) / (xRange)) * 0.98f) + 0.01f);
-					}
-					else // REGRESSION
-					{
-						/*int activationType = skeleton->getActivationType(0); // 0 because first layer
-						if ((activationType == GMath::SIGMOID) || (activationType ==
-						GMath::SIGMOIDP)
-						||
-							(activationType == GMath::RELU) || (activationType == GMath::LEAKY))
-							cell = ((cell - fMin) / (xRange)); // [0.0, 1.0] bounds
-						else
-							cell = ((((cell - fMin) / (xRange)) * 2.0f) - 1.0f); // [-1.0, 1.0]
-						bounds*/
-
-						// [0.0, 1.0] bounds
-						cell = ((cell - fMin) / (xRange));
-					}
+				// standardize cell value based on network vars
+				newCol.addFloat((cell * cScale) + cShift);
+			}
 
-					// add cell to newCol
-					newCol.addFloat(cell);
-				}
+			// add the standardized newCol to the trainTable
+			cTable.addCol(rawTable.getHeader(c), newCol);
+			if (colIsOutput[c])
+				cTable.toggleOutput(cTable.numberOfCols() - 1);
+		}
+	}
+}
 
-				// add the standardized newCol to the trainTable
-				if (rawTable.isOutput(c))
-				{
-					trainExpectedTable.addCol(rawTable.getHeader(c), newCol);
-					trainExpectedTable.toggleOutput(trainTable.numberOfCols() - 1);
-				}
-				else
-				    trainTable.addCol(rawTable.getHeader(c), newCol);
-			}
-			else if (standardizeFlag == GMath::ZSCORE)
-			{
-				// second pass for stdev
-				float fStDev = 0.0f;
-				shmea::GList newCol;
-				for (unsigned int r = 0; r < rawTable.numberOfRows(); ++r)
-				{
-					// acquire original cell value
-					shmea::GType cCell = rawTable.getCell(r, c);
-					float cell = 0.0f;
-					if (cCell.getType() == shmea::GType::STRING_TYPE)
-					{
-						// for errors - strings MUST be categorical
-						trainTable.clear();
-						return;
-					}
-					else
-						cell = cCell.getFloat();
-
-					fStDev += ((cell - fMean) * (cell - fMean));
-				}
+/*!
+ * @brief encode params
+ * @details the affine map (cell * scale + shift) the current standardization applies to a numeric
+ * col. MINMAX maps to [0.01, 0.99] for classification and [0.0, 1.0] for regression, ZSCORE to
+ * zero mean and unit variance. Constant cols are left as is.
+ * @param stats the col statistics
+ * @param scale set to the multiplier
+ * @param shift set to the offset
+ */
+void glades::NumberInput::encodeParams(const RunningStat& stats, float& scale, float& shift) const
+{
+	scale = 1.0f;
+	shift = 0.0f;
 
-				// calculate stdev
-				fStDev = sqrt(fStDev / (rawTable.numberOfRows() - 1));
+	if (standardizeFlag == GMath::ZSCORE)
+	{
+		float fStDev = stats.getStDev();
+		if (fStDev == 0.0f)
+			return;
 
-				for (unsigned int r = 0; r < rawTable.numberOfRows(); ++r)
-				{
-					// acquire original cell value
-					shmea::GType cCell = rawTable.getCell(r, c);
-					float cell = 0.0f;
-					if (cCell.getType() == shmea::GType::STRING_TYPE)
-					{
-						// for errors - strings MUST be categorical
-						printf("ERROR: String found in non-categorical column.\n");
-						trainTable.clear();
-						return;
-					}
-					else
-						cell = cCell.getFloat();
-
-					cell = ((cell - fMean) / fStDev);
+		scale = 1.0f / fStDev;
+		shift = -((float)stats.getMean()) * scale;
+	}
+	else
+	{
+		// find the range of this feature
+		float xRange = stats.getRange();
+		if (xRange == 0.0f)
+			return;
 
-					// add cell to newCol
-					newCol.addFloat(cell);
-				}
+		if (isClassification)
+		{
+			// [0.01, 0.99] bounds
+			scale = 0.98f / xRange;
+			shift = 0.01f - (stats.getMin() * scale);
+		}
+		else
+		{
+			// [0.0, 1.0] bounds
+			scale = 1.0f / xRange;
+			shift = -(stats.getMin() * scale);
+		}
+	}
+}
 
-				// add the standardized newCol to the trainTable
-				if (rawTable.isOutput(c))
-				{
-					trainExpectedTable.addCol(rawTable.getHeader(c), newCol);
-					trainExpectedTable.toggleOutput(trainTable.numberOfCols() - 1);
-				}
-				else
-				    trainTable.addCol(rawTable.getHeader(c), newCol);
-			}
+/*!
+ * @brief cell to float
+ * @param cCell the cell to convert
+ * @param cell set to the numeric value of the cell
+ * @return false if the cell is a string
+ */
+bool glades::NumberInput::cellToFloat(const shmea::GType& cCell, float& cell)
+{
+	cell = 0.0f;
+	if (cCell.getType() == shmea::GType::STRING_TYPE)
+		return false;
+	else if (cCell.getType() == shmea::GType::CHAR_TYPE)
+		cell = cCell.getChar();
+	else if (cCell.getType() == shmea::GType::SHORT_TYPE)
+		cell = cCell.getShort();
+	else if (cCell.getType() == shmea::GType::INT_TYPE)
+		cell = cCell.getInt();
+	else if (cCell.getType() == shmea::GType::LONG_TYPE)
+		cell = cCell.getLong();
+	else if (cCell.getType() == shmea::GType::FLOAT_TYPE)
+		cell = cCell.getFloat();
+	else if (cCell.getType() == shmea::GType::DOUBLE_TYPE)
+		cell = cCell.getDouble();
+	else if (cCell.getType() == shmea::GType::BOOLEAN_TYPE)
+		cell = cCell.getBoolean() ? 1.0f : 0.0f;
+
+	return true;
+}
+
+/*!
+ * @brief append rows
+ * @details adds raw rows (same cols as the imported file) without re-reading the history. Numeric
+ * cols update their running statistics and are stored with the encoding already in the table;
+ * if that encoding no longer matches the statistics, rows are corrected as they are read until
+ * rescale() folds the change into the table. Unseen categories grow the OHE and add a col that
+ * older rows read as cold (0.01). Networks built before an OHE grows must be rebuilt.
+ * @param rows the raw rows to append
+ * @return whether every row was appended; rows up to the first bad one are kept
+ */
+bool glades::NumberInput::append(const shmea::GTable& rows)
+{
+	for (unsigned int r = 0; r < rows.numberOfRows(); ++r)
+	{
+		if (!appendRow(rows.getRow(r)))
+		{
+			// the rows already kept moved the stats
+			updateRescale();
+			return false;
+		}
+	}
+
+	updateRescale();
+	return true;
+}
+
+bool glades::NumberInput::append(const shmea::GList& row)
+{
+	if (!appendRow(row))
+		return false;
+
+	updateRescale();
+	return true;
+}
+
+bool glades::NumberInput::appendRow(const shmea::GList& row)
+{
+	if ((!loaded) || (colStats.empty()))
+	{
+		printf("[NNDATA] Import before appending\n");
+		return false;
+	}
+
+	if (!trainStore.empty())
+	{
+		printf("[NNDATA] Appending needs STORE_FULL storage\n");
+		return false;
+	}
+
+	if (row.size() != colStats.size())
+	{
+		printf("[NNDATA] Appended row has %u cols, expected %u\n", row.size(),
+			   (unsigned int)colStats.size());
+		return false;
+	}
+
+	// Check the row before touching any state
+	for (unsigned int c = 0; c < row.size(); ++c)
+	{
+		float cell = 0.0f;
+		if ((!featureIsCategorical[c]) && (!cellToFloat(row[c], cell)))
+		{
+			printf("ERROR: String found in non-categorical column.\n");
+			return false;
 		}
 	}
+
+	shmea::GList inputRow;
+	shmea::GList expectedRow;
+	for (unsigned int c = 0; c < row.size(); ++c)
+	{
+		shmea::GType cCell = row[c];
+		shmea::GList& cRow = colIsOutput[c] ? expectedRow : inputRow;
+
+		if ((featureIsCategorical[c]) && (useFeatureHashing) && (!colIsOutput[c]))
+		{
+			std::string cString = cCell.c_str();
+			unsigned int cBucket = featureHasher.indexAt(cString);
+			float cSign = featureHasher.signAt(cString);
+			for (unsigned int cInt = 0; cInt < featureHasher.size(); ++cInt)
+				cRow.addFloat((cInt == cBucket) ? cSign : 0.0f);
+		}
+		else if (featureIsCategorical[c])
+		{
+			std::string cString = cCell.c_str();
+			OHE* OHEVector = OHEMaps[c];
+			if (!OHEVector->contains(cString))
+				growCategory(c, cString);
+			else
+				OHEVector->addString(cString);
+
+			std::vector<float> featureVector = (*OHEVector)[cString];
+			for (unsigned int cInt = 0; cInt < featureVector.size(); ++cInt)
+				cRow.addFloat(featureVector[cInt]);
+		}
+		else
+		{
+			float cell = 0.0f;
+			cellToFloat(cCell, cell);
+			colStats[c].add(cell);
+			cRow.addFloat((cell * storedScale[c]) + storedShift[c]);
+		}
+	}
+
+	trainTable.addRow(inputRow);
+	if (expectedRow.size() > 0)
+		trainExpectedTable.addRow(expectedRow);
+
+	return true;
+}
+
+/*!
+ * @brief encode row
+ * @details standardizes a raw row (same cols as the imported file) with the current encoding
+ * without storing it or touching any statistics. Unseen categories encode as all cold.
+ * @param row the raw row
+ * @param inputRow set to the standardized input cols
+ * @param expectedRow set to the standardized output cols
+ * @return false if the row does not fit the imported cols
+ */
+bool glades::NumberInput::encodeRow(const shmea::GList& row, shmea::GList& inputRow,
+									shmea::GList& expectedRow) const
+{
+	inputRow.clear();
+	expectedRow.clear();
+	if ((colStats.empty()) || (row.size() != colStats.size()))
+		return false;
+
+	for (unsigned int c = 0; c < row.size(); ++c)
+	{
+		shmea::GType cCell = row[c];
+		shmea::GList& cRow = colIsOutput[c] ? expectedRow : inputRow;
+
+		if ((featureIsCategorical[c]) && (useFeatureHashing) && (!colIsOutput[c]))
+		{
+			std::string cString = cCell.c_str();
+			unsigned int cBucket = featureHasher.indexAt(cString);
+			float cSign = featureHasher.signAt(cString);
+			for (unsigned int cInt = 0; cInt < featureHasher.size(); ++cInt)
+				cRow.addFloat((cInt == cBucket) ? cSign : 0.0f);
+		}
+		else if (featureIsCategorical[c])
+		{
+			std::string cString = cCell.c_str();
+			std::vector<float> featureVector = (*OHEMaps[c])[cString];
+			for (unsigned int cInt = 0; cInt < featureVector.size(); ++cInt)
+				cRow.addFloat(featureVector[cInt]);
+		}
+		else
+		{
+			float cell = 0.0f;
+			if (!cellToFloat(cCell, cell))
+				return false;
+
+			float cScale = 1.0f;
+			float cShift = 0.0f;
+			encodeParams(colStats[c], cScale, cShift);
+			cRow.addFloat((cell * cScale) + cShift);
+		}
+	}
+
+	return true;
+}
+
+/*!
+ * @brief grow category
+ * @details adds a new category to a dictionary OHE col and inserts its col after the existing
+ * ones, cold (0.01) for every stored row
+ * @param c the raw col
+ * @param newClass the new category
+ */
+void glades::NumberInput::growCategory(unsigned int c, const std::string& newClass)
+{
+	OHE* OHEVector = OHEMaps[c];
+	unsigned int newIndex = colOffset[c] + OHEVector->size();
+	OHEVector->addString(newClass);
+
+	shmea::GTable& cTable = colIsOutput[c] ? trainExpectedTable : trainTable;
+	shmea::GList newCol(cTable.numberOfRows(), shmea::GType(0.01f));
+	shmea::GString newHeader = colHeaders[c];
+	newHeader += shmea::GString::intTOstring(OHEVector->size() - 1);
+	cTable.addCol(newHeader, newCol, newIndex);
+	if (colIsOutput[c])
+		cTable.toggleOutput(newIndex);
+
+	// later cols in the same table moved over by one
+	for (unsigned int c2 = c + 1; c2 < colOffset.size(); ++c2)
+	{
+		if (colIsOutput[c2] == colIsOutput[c])
+			++colOffset[c2];
+	}
+
+	printf("[NNDATA] New category \"%s\" in col %u\n", newClass.c_str(), c);
+}
+
+/*!
+ * @brief update rescale
+ * @details recomputes which numeric cols need correcting when read. A stored cell s was encoded
+ * as x * a + b; the current encoding is x * a' + b', so s reads as s * (a' / a) + (b' - b * a' / a).
+ */
+void glades::NumberInput::updateRescale()
+{
+	rescaleCols.clear();
+	for (unsigned int c = 0; c < colStats.size(); ++c)
+	{
+		readScale[c] = 1.0f;
+		readShift[c] = 0.0f;
+		if (featureIsCategorical[c])
+			continue;
+
+		float cScale = 1.0f;
+		float cShift = 0.0f;
+		encodeParams(colStats[c], cScale, cShift);
+		if ((cScale == storedScale[c]) && (cShift == storedShift[c]))
+			continue;
+
+		readScale[c] = cScale / storedScale[c];
+		readShift[c] = cShift - (storedShift[c] * readScale[c]);
+		rescaleCols.push_back(c);
+	}
+}
+
+/*!
+ * @brief rescale
+ * @details folds pending read corrections into the stored tables. Only cols whose standardization
+ * changed since the last rescale are touched.
+ */
+void glades::NumberInput::rescale()
+{
+	for (unsigned int i = 0; i < rescaleCols.size(); ++i)
+	{
+		unsigned int c = rescaleCols[i];
+		shmea::GTable& cTable = colIsOutput[c] ? trainExpectedTable : trainTable;
+		for (unsigned int r = 0; r < cTable.numberOfRows(); ++r)
+		{
+			float cell = (cTable.getCell(r, colOffset[c]).getFloat() * readScale[c]) + readShift[c];
+			cTable.setCell(r, colOffset[c], shmea::GType(cell));
+		}
+
+		encodeParams(colStats[c], storedScale[c], storedShift[c]);
+		readScale[c] = 1.0f;
+		readShift[c] = 0.0f;
+	}
+
+	rescaleCols.clear();
+}
+
+/*!
+ * @brief apply rescale
+ * @details applies pending read corrections to a row read from one of the tables
+ * @param row the row to correct in place
+ * @param isOutput whether row came from the expected table
+ */
+void glades::NumberInput::applyRescale(shmea::GList& row, bool isOutput) const
+{
+	for (unsigned int i = 0; i < rescaleCols.size(); ++i)
+	{
+		unsigned int c = rescaleCols[i];
+		if ((colIsOutput[c] != isOutput) || (colOffset[c] >= row.size()))
+			continue;
+
+		float cell = (row.getFloat(colOffset[c]) * readScale[c]) + readShift[c];
+		row.setGType(colOffset[c], shmea::GType(cell));
+	}
 }
 
 shmea::GList NumberInput::getTrainRow(unsigned int index) const
 {
+    if(!trainStore.empty())
+	return trainStore.getRow(index);
+
     if(index >= trainTable.numberOfRows())
 	return emptyRow;
 
+    if(!rescaleCols.empty())
+    {
+	shmea::GList retList = trainTable.getRow(index);
+	applyRescale(retList, false);
+	return retList;
+    }
+
     return trainTable.getRow(index);
 }
 
@@ -297,11 +624,21 @@ shmea::GList NumberInput::getTrainExpectedRow(unsigned int index) const
     if(index >= trainExpectedTable.numberOfRows())
 	return emptyRow;
 
+    if(!rescaleCols.empty())
+    {
+	shmea::GList retList = trainExpectedTable.getRow(index);
+	applyRescale(retList, true);
+	return retList;
+    }
+
     return trainExpectedTable.getRow(index);
 }
 
 shmea::GList NumberInput::getTestRow(unsigned int index) const
 {
+    if(!testStore.empty())
+	return testStore.getRow(index);
+
     if(index >= testTable.numberOfRows())
 	return shmea::GList();
 
@@ -318,16 +655,25 @@ shmea::GList NumberInput::getTestExpectedRow(unsigned int index) const
 
 unsigned int NumberInput::getTrainSize() const
 {
+    if(!trainStore.empty())
+	return trainStore.numberOfRows();
+
     return trainTable.numberOfRows();
 }
 
 unsigned int NumberInput::getTestSize() const
 {
+    if(!testStore.empty())
+	return testStore.numberOfRows();
+
     return testTable.numberOfRows();
 }
 
 unsigned int NumberInput::getFeatureCount() const
 {
+    if(!trainStore.empty())
+	return trainStore.numberOfCols();
+
     return trainTable[0].size();
 }
 
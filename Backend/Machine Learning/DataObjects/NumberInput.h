@@ -18,6 +18,9 @@
 #define _GNUMBERINPUT
 
 #include "DataInput.h"
+#include "QuantizedTable.h"
+#include "../GMath/featurehasher.h"
+#include "../GMath/runningstat.h"
 #include "Backend/Database/GString.h"
 #include "Backend/Database/GTable.h"
 #include "Backend/Database/image.h"
@@ -41,11 +44,37 @@ public:
 	shmea::GString name;
 	bool loaded;
 
+	// Hashed categorical input cols when set, dictionary OHE otherwise
+	bool useFeatureHashing;
+	FeatureHasher featureHasher;
+
+	// Compact copies of the feature tables when storageType != STORE_FULL
+	int storageType;
+	QuantizedTable trainStore;
+	QuantizedTable testStore;
+
+	// Per raw col encoding kept from import so rows can be appended
+	int standardizeFlag;
+	bool isClassification;
+	std::vector<bool> colIsOutput;
+	std::vector<shmea::GString> colHeaders;
+	std::vector<unsigned int> colOffset; // first standardized col in its table
+	std::vector<RunningStat> colStats;
+	std::vector<float> storedScale; // stored cell = x * storedScale + storedShift
+	std::vector<float> storedShift;
+	std::vector<float> readScale; // stored cell to current standardization
+	std::vector<float> readShift;
+	std::vector<unsigned int> rescaleCols; // numeric cols whose read correction is pending
+
 	NumberInput()
 	{
 		//
 	    name = "";
 	    loaded = false;
+	    useFeatureHashing = false;
+	    storageType = STORE_FULL;
+	    standardizeFlag = 0;
+	    isClassification = false;
 	    OHEMaps.clear();
 	    featureIsCategorical.clear();
 	    trainTable.clear();
@@ -64,10 +93,26 @@ public:
 	    trainExpectedTable.clear();
 	    testTable.clear();
 	    testExpectedTable.clear();
+	    trainStore.clear();
+	    testStore.clear();
 	}
 
 	virtual void import(shmea::GString);
+	void import(shmea::GString, int);
 	void standardizeInputTable(const shmea::GString&, int = 0);
+	void setFeatureHashing(unsigned int, bool = true);
+	void setStorageType(int);
+
+	bool append(const shmea::GTable&);
+	bool append(const shmea::GList&);
+	bool appendRow(const shmea::GList&);
+	bool encodeRow(const shmea::GList&, shmea::GList&, shmea::GList&) const;
+	void growCategory(unsigned int, const std::string&);
+	void encodeParams(const RunningStat&, float&, float&) const;
+	void updateRescale();
+	void rescale();
+	void applyRescale(shmea::GList&, bool) const;
+	static bool cellToFloat(const shmea::GType&, float&);
 
 	virtual shmea::GList getTrainRow(unsigned int) const;
 	virtual shmea::GList getTrainExpectedRow(unsigned int) const;
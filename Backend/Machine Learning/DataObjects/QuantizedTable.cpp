@@ -0,0 +1,308 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "QuantizedTable.h"
+#include "../GMath/gmath.h"
+
+using namespace glades;
+
+glades::QuantizedTable::QuantizedTable(int newStorageType)
+{
+	storageType = newStorageType;
+	perRowScale = false;
+	rowCount = 0;
+	colCount = 0;
+}
+
+glades::QuantizedTable::QuantizedTable(const QuantizedTable& qt)
+{
+	storageType = qt.storageType;
+	perRowScale = qt.perRowScale;
+	rowCount = qt.rowCount;
+	colCount = qt.colCount;
+	codes = qt.codes;
+	halves = qt.halves;
+	scales = qt.scales;
+	offsets = qt.offsets;
+}
+
+glades::QuantizedTable::~QuantizedTable()
+{
+	clear();
+}
+
+/*!
+ * @brief set storage type
+ * @details switching type drops any rows already stored
+ * @param newStorageType DataInput::STORE_UINT8 or DataInput::STORE_FP16
+ */
+void glades::QuantizedTable::setStorageType(int newStorageType)
+{
+	if (newStorageType == storageType)
+		return;
+
+	clear();
+	storageType = newStorageType;
+}
+
+void glades::QuantizedTable::reserveRows(unsigned int newRowCount)
+{
+	if (storageType == DataInput::STORE_FP16)
+		halves.reserve(newRowCount * colCount);
+	else
+		codes.reserve(newRowCount * colCount);
+}
+
+/*!
+ * @brief quantize row
+ * @details appends one row of colCount floats. In per row mode the row gets its own scale/offset
+ * from its min and max, otherwise the col scale/offset pairs must already be set.
+ * @param row the float values to store
+ * @param len the number of valid values in row; the rest of the row is zero filled
+ */
+void glades::QuantizedTable::quantizeRow(const float* row, unsigned int len)
+{
+	if (len > colCount)
+		len = colCount;
+
+	if (storageType == DataInput::STORE_FP16)
+	{
+		for (unsigned int c = 0; c < colCount; ++c)
+			halves.push_back(GMath::floatToHalf((c < len) ? row[c] : 0.0f));
+	}
+	else
+	{
+		if (perRowScale)
+		{
+			float fMin = 0.0f;
+			float fMax = 0.0f;
+			for (unsigned int c = 0; c < colCount; ++c)
+			{
+				float cell = (c < len) ? row[c] : 0.0f;
+				if ((c == 0) || (cell < fMin))
+					fMin = cell;
+				if ((c == 0) || (cell > fMax))
+					fMax = cell;
+			}
+
+			scales.push_back((fMax - fMin) / 255.0f);
+			offsets.push_back(fMin);
+		}
+
+		for (unsigned int c = 0; c < colCount; ++c)
+		{
+			float cScale = perRowScale ? scales[rowCount] : scales[c];
+			float cOffset = perRowScale ? offsets[rowCount] : offsets[c];
+			float cell = (c < len) ? row[c] : 0.0f;
+
+			// constant cols/rows all decode to the offset
+			float code = 0.0f;
+			if (cScale > 0.0f)
+				code = floorf(((cell - cOffset) / cScale) + 0.5f);
+			if (code < 0.0f)
+				code = 0.0f;
+			if (code > 255.0f)
+				code = 255.0f;
+
+			codes.push_back((uint8_t)code);
+		}
+	}
+
+	++rowCount;
+}
+
+/*!
+ * @brief from table
+ * @details replaces the contents with a quantized copy of a standardized table. Each col gets its
+ * own scale/offset from its min and max, so a col of OHE or hashed values decodes back exactly.
+ * @param src the table to copy; every cell must be numeric
+ */
+void glades::QuantizedTable::fromTable(const shmea::GTable& src)
+{
+	int newStorageType = storageType;
+	clear();
+	storageType = newStorageType;
+	perRowScale = false;
+
+	if ((src.numberOfRows() == 0) || (src.numberOfCols() == 0))
+		return;
+
+	colCount = src.numberOfCols();
+
+	// copy the table out once as floats
+	std::vector<float> cells(src.numberOfRows() * colCount, 0.0f);
+	for (unsigned int r = 0; r < src.numberOfRows(); ++r)
+		for (unsigned int c = 0; c < colCount; ++c)
+			cells[(r * colCount) + c] = src.getCell(r, c).getFloat();
+
+	if (storageType != DataInput::STORE_FP16)
+	{
+		scales.resize(colCount, 0.0f);
+		offsets.resize(colCount, 0.0f);
+		for (unsigned int c = 0; c < colCount; ++c)
+		{
+			float fMin = cells[c];
+			float fMax = cells[c];
+			for (unsigned int r = 1; r < src.numberOfRows(); ++r)
+			{
+				float cell = cells[(r * colCount) + c];
+				if (cell < fMin)
+					fMin = cell;
+				if (cell > fMax)
+					fMax = cell;
+			}
+
+			scales[c] = (fMax - fMin) / 255.0f;
+			offsets[c] = fMin;
+		}
+	}
+
+	reserveRows(src.numberOfRows());
+	for (unsigned int r = 0; r < src.numberOfRows(); ++r)
+		quantizeRow(&cells[r * colCount], colCount);
+}
+
+/*!
+ * @brief add row
+ * @details appends a row with its own scale/offset. The first row fixes the col count; longer
+ * rows are truncated and shorter rows zero filled.
+ * @param row the standardized values to store
+ */
+void glades::QuantizedTable::addRow(const shmea::GList& row)
+{
+	if (rowCount == 0)
+	{
+		perRowScale = true;
+		colCount = row.size();
+	}
+
+	if ((!perRowScale) || (colCount == 0))
+	{
+		printf("[QTABLE] Rows can only be streamed into a per row table\n");
+		return;
+	}
+
+	std::vector<float> cells(row.size(), 0.0f);
+	for (unsigned int c = 0; c < row.size(); ++c)
+		cells[c] = row.getFloat(c);
+
+	quantizeRow(cells.empty() ? NULL : &cells[0], cells.size());
+}
+
+void glades::QuantizedTable::clear()
+{
+	perRowScale = false;
+	rowCount = 0;
+	colCount = 0;
+	codes.clear();
+	halves.clear();
+	scales.clear();
+	offsets.clear();
+}
+
+float glades::QuantizedTable::getCell(unsigned int row, unsigned int col) const
+{
+	if ((row >= rowCount) || (col >= colCount))
+		return 0.0f;
+
+	unsigned int index = (row * colCount) + col;
+	if (storageType == DataInput::STORE_FP16)
+		return GMath::halfToFloat(halves[index]);
+
+	unsigned int scaleIndex = perRowScale ? row : col;
+	return offsets[scaleIndex] + (codes[index] * scales[scaleIndex]);
+}
+
+/*!
+ * @brief get row
+ * @details dequantizes a row into a caller owned buffer
+ * @param row the row index
+ * @param dest at least numberOfCols() floats
+ */
+void glades::QuantizedTable::getRow(unsigned int row, float* dest) const
+{
+	if ((row >= rowCount) || (!dest))
+		return;
+
+	unsigned int base = row * colCount;
+	if (storageType == DataInput::STORE_FP16)
+	{
+		for (unsigned int c = 0; c < colCount; ++c)
+			dest[c] = GMath::halfToFloat(halves[base + c]);
+	}
+	else if (perRowScale)
+	{
+		float cScale = scales[row];
+		float cOffset = offsets[row];
+		for (unsigned int c = 0; c < colCount; ++c)
+			dest[c] = cOffset + (codes[base + c] * cScale);
+	}
+	else
+	{
+		for (unsigned int c = 0; c < colCount; ++c)
+			dest[c] = offsets[c] + (codes[base + c] * scales[c]);
+	}
+}
+
+shmea::GList glades::QuantizedTable::getRow(unsigned int row) const
+{
+	shmea::GList retList;
+	if ((row >= rowCount) || (colCount == 0))
+		return retList;
+
+	std::vector<float> cells(colCount, 0.0f);
+	getRow(row, &cells[0]);
+	for (unsigned int c = 0; c < colCount; ++c)
+		retList.addFloat(cells[c]);
+
+	return retList;
+}
+
+int glades::QuantizedTable::getStorageType() const
+{
+	return storageType;
+}
+
+unsigned int glades::QuantizedTable::numberOfRows() const
+{
+	return rowCount;
+}
+
+unsigned int glades::QuantizedTable::numberOfCols() const
+{
+	return colCount;
+}
+
+/*!
+ * @brief byte size
+ * @return the number of bytes held by the stored features and their scale/offset pairs
+ */
+unsigned int glades::QuantizedTable::byteSize() const
+{
+	return (codes.size() * sizeof(uint8_t)) + (halves.size() * sizeof(uint16_t)) +
+		   ((scales.size() + offsets.size()) * sizeof(float));
+}
+
+bool glades::QuantizedTable::empty() const
+{
+	return rowCount == 0;
+}
+
+void glades::QuantizedTable::print() const
+{
+	printf("[QTABLE] %u x %u %s (%u bytes)\n", rowCount, colCount,
+		   (storageType == DataInput::STORE_FP16) ? "fp16" : "uint8", byteSize());
+}
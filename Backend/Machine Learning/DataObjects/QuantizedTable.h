@@ -0,0 +1,76 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GQUANTIZEDTABLE
+#define _GQUANTIZEDTABLE
+
+#include "DataInput.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GTable.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace glades {
+
+/*!
+ * @brief compact feature storage
+ * @details holds a dense rows x cols block of features as uint8 codes or fp16 halves instead of
+ * one GType per cell. uint8 codes are dequantized as offset + code * scale, where the scale/offset
+ * pair is per col when built from a table and per row when rows are streamed in (images).
+ */
+class QuantizedTable
+{
+private:
+
+	int storageType;
+	bool perRowScale;
+	unsigned int rowCount;
+	unsigned int colCount;
+
+	std::vector<uint8_t> codes;
+	std::vector<uint16_t> halves;
+	std::vector<float> scales;
+	std::vector<float> offsets;
+
+	void reserveRows(unsigned int);
+	void quantizeRow(const float*, unsigned int);
+
+public:
+
+	QuantizedTable(int = DataInput::STORE_UINT8);
+	QuantizedTable(const QuantizedTable&);
+	virtual ~QuantizedTable();
+
+	void setStorageType(int);
+	void fromTable(const shmea::GTable&);
+	void addRow(const shmea::GList&);
+	void clear();
+
+	float getCell(unsigned int, unsigned int) const;
+	void getRow(unsigned int, float*) const;
+	shmea::GList getRow(unsigned int) const;
+
+	int getStorageType() const;
+	unsigned int numberOfRows() const;
+	unsigned int numberOfCols() const;
+	unsigned int byteSize() const;
+	bool empty() const;
+	void print() const;
+};
+};
+
+#endif
@@ -0,0 +1,532 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "StreamInput.h"
+#include "NumberInput.h"
+#include "../GMath/grandom.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace glades;
+
+/*!
+ * @brief StreamInput constructor
+ * @param newCapacity the number of replay slots
+ * @param newExpectedCount without a schema, how many trailing cols of a row are expected values
+ * @param newReplayType REPLAY_RESERVOIR or REPLAY_RECENT
+ */
+glades::StreamInput::StreamInput(unsigned int newCapacity, unsigned int newExpectedCount,
+								 int newReplayType)
+{
+	capacity = newCapacity;
+	expectedCount = newExpectedCount;
+	featureCount = 0;
+	nextRecent = 0;
+	replayType = newReplayType;
+	rowsSeen = 0;
+	droppedRows = 0;
+	closed = false;
+	readerThread = NULL;
+	readerFile = NULL;
+	readerFollow = false;
+	readerRunning = false;
+	schema = NULL;
+	name = "";
+	pthread_mutex_init(&queueMutex, NULL);
+	pthread_cond_init(&queueCond, NULL);
+}
+
+glades::StreamInput::~StreamInput()
+{
+	close();
+	stopReader();
+	pthread_cond_destroy(&queueCond);
+	pthread_mutex_destroy(&queueMutex);
+	slotRows.clear();
+	slotExpected.clear();
+	queue.clear();
+}
+
+/*!
+ * @brief set schema
+ * @details raw rows are standardized with the schema's import encoding (see
+ * NumberInput::encodeRow). The schema must outlive the stream and not change while rows flow.
+ * @param newSchema an imported NumberInput, or NULL for pre-standardized numeric rows
+ */
+void glades::StreamInput::setSchema(const NumberInput* newSchema)
+{
+	schema = newSchema;
+	OHEMaps.clear();
+	featureIsCategorical.clear();
+	if (schema)
+	{
+		OHEMaps = schema->OHEMaps;
+		featureIsCategorical = schema->featureIsCategorical;
+	}
+}
+
+/*!
+ * @brief import
+ * @details reads rows from a file ("-" for stdin) on a background thread until end of file
+ * @param fname the file to read
+ */
+void glades::StreamInput::import(shmea::GString fname)
+{
+	name = fname;
+	FILE* fd = (fname == "-") ? stdin : fopen(fname.c_str(), "r");
+	if (!fd)
+	{
+		printf("[STREAM] Could not open %s\n", fname.c_str());
+		close();
+		return;
+	}
+
+	startReader(fd, false);
+}
+
+/*!
+ * @brief start reader
+ * @details reads "feature,...,expected" lines from fd on a background thread. The stream owns fd
+ * and closes it when the reader stops (stdin excepted). The reader polls the descriptor with a
+ * timeout instead of blocking in a read, so stopReader() returns even on a silent pipe.
+ * @param fd an open file or pipe (popen)
+ * @param follow keep polling at end of file for appended lines, like tail -f
+ * @return whether the reader started
+ */
+bool glades::StreamInput::startReader(FILE* fd, bool follow)
+{
+	if ((!fd) || (readerThread))
+		return false;
+
+	readerFile = fd;
+	readerFollow = follow;
+	pthread_mutex_lock(&queueMutex);
+	readerRunning = true;
+	pthread_mutex_unlock(&queueMutex);
+	readerThread = (pthread_t*)malloc(sizeof(pthread_t));
+	if (pthread_create(readerThread, NULL, readerWorker, this) != 0)
+	{
+		free(readerThread);
+		readerThread = NULL;
+		pthread_mutex_lock(&queueMutex);
+		readerRunning = false;
+		pthread_mutex_unlock(&queueMutex);
+		return false;
+	}
+
+	return true;
+}
+
+void glades::StreamInput::stopReader()
+{
+	if (!readerThread)
+		return;
+
+	// The reader sees this within READER_POLL_MS
+	pthread_mutex_lock(&queueMutex);
+	readerRunning = false;
+	pthread_mutex_unlock(&queueMutex);
+	pthread_join(*readerThread, NULL);
+	free(readerThread);
+	readerThread = NULL;
+
+	if ((readerFile) && (readerFile != stdin))
+		fclose(readerFile);
+	readerFile = NULL;
+}
+
+bool glades::StreamInput::isReaderRunning()
+{
+	pthread_mutex_lock(&queueMutex);
+	bool retRunning = readerRunning;
+	pthread_mutex_unlock(&queueMutex);
+
+	return retRunning;
+}
+
+void* glades::StreamInput::readerWorker(void* y)
+{
+	StreamInput* si = (StreamInput*)y;
+
+	// Raw reads of the descriptor; stdio buffering would hide lines from poll()
+	int fd = fileno(si->readerFile);
+	char readBuffer[4096];
+	std::string pending;
+	bool endOfStream = false;
+	while (si->isReaderRunning())
+	{
+		struct pollfd readerPoll;
+		readerPoll.fd = fd;
+		readerPoll.events = POLLIN;
+		readerPoll.revents = 0;
+		int ready = poll(&readerPoll, 1, READER_POLL_MS);
+		if ((ready < 0) && (errno != EINTR))
+			break;
+		if (ready <= 0)
+			continue;
+
+		ssize_t bytesRead = read(fd, readBuffer, sizeof(readBuffer));
+		if ((bytesRead < 0) && ((errno == EINTR) || (errno == EAGAIN)))
+			continue;
+		if (bytesRead <= 0)
+		{
+			if (!si->readerFollow)
+			{
+				endOfStream = true;
+				break;
+			}
+
+			// wait for the file to grow
+			usleep(READER_POLL_MS * 1000);
+			continue;
+		}
+
+		// Push every complete line
+		pending.append(readBuffer, bytesRead);
+		std::string::size_type lineStart = 0;
+		std::string::size_type lineEnd = pending.find('\n');
+		while (lineEnd != std::string::npos)
+		{
+			si->pushLine(pending.substr(lineStart, lineEnd - lineStart + 1));
+			lineStart = lineEnd + 1;
+			lineEnd = pending.find('\n', lineStart);
+		}
+		pending.erase(0, lineStart);
+	}
+
+	// The last line may have no newline
+	if ((endOfStream) && (!pending.empty()))
+		si->pushLine(pending);
+
+	if (!si->readerFollow)
+		si->close();
+
+	return NULL;
+}
+
+bool glades::StreamInput::encode(const shmea::GList& row, StreamRow& newRow) const
+{
+	if (schema)
+		return schema->encodeRow(row, newRow.input, newRow.expected);
+
+	if (row.size() <= expectedCount)
+		return false;
+
+	newRow.input.clear();
+	newRow.expected.clear();
+	unsigned int inputCount = row.size() - expectedCount;
+	for (unsigned int c = 0; c < row.size(); ++c)
+	{
+		if (row.getType(c) == shmea::GType::STRING_TYPE)
+			return false;
+
+		if (c < inputCount)
+			newRow.input.addFloat(row.getFloat(c));
+		else
+			newRow.expected.addFloat(row.getFloat(c));
+	}
+
+	return true;
+}
+
+/*!
+ * @brief push
+ * @details thread safe. When the trainer falls more than MAX_QUEUED rows behind, the oldest
+ * queued row is dropped.
+ * @param row a raw row
+ * @return false if the row could not be encoded or the stream is closed
+ */
+bool glades::StreamInput::push(const shmea::GList& row)
+{
+	StreamRow newRow;
+	if (!encode(row, newRow))
+	{
+		printf("[STREAM] Skipping malformed row\n");
+		return false;
+	}
+
+	pthread_mutex_lock(&queueMutex);
+	if (closed)
+	{
+		pthread_mutex_unlock(&queueMutex);
+		return false;
+	}
+
+	// the first row fixes the width
+	if (featureCount == 0)
+		featureCount = newRow.input.size();
+
+	if (newRow.input.size() != featureCount)
+	{
+		pthread_mutex_unlock(&queueMutex);
+		printf("[STREAM] Row has %u features, expected %u\n", newRow.input.size(), featureCount);
+		return false;
+	}
+
+	if (queue.size() >= MAX_QUEUED)
+	{
+		queue.pop_front();
+		++droppedRows;
+	}
+
+	queue.push_back(newRow);
+	pthread_cond_signal(&queueCond);
+	pthread_mutex_unlock(&queueMutex);
+	return true;
+}
+
+/*!
+ * @brief push line
+ * @details parses one comma separated line; numeric cells become floats, anything else a string
+ * @param line the text line
+ * @return whether the row was queued
+ */
+bool glades::StreamInput::pushLine(const std::string& line)
+{
+	shmea::GList row;
+	std::string::size_type start = 0;
+	while (start <= line.length())
+	{
+		std::string::size_type end = line.find(',', start);
+		if (end == std::string::npos)
+			end = line.length();
+
+		// trim whitespace and the line ending
+		std::string cell = line.substr(start, end - start);
+		std::string::size_type first = cell.find_first_not_of(" \t\r\n");
+		std::string::size_type last = cell.find_last_not_of(" \t\r\n");
+		cell = (first == std::string::npos) ? "" : cell.substr(first, last - first + 1);
+
+		char* parseEnd = NULL;
+		float value = strtof(cell.c_str(), &parseEnd);
+		if ((!cell.empty()) && (parseEnd) && (*parseEnd == '\0'))
+			row.addFloat(value);
+		else
+			row.addString(cell.c_str());
+
+		start = end + 1;
+	}
+
+	// blank lines
+	if ((row.size() == 1) && (row.getType(0) == shmea::GType::STRING_TYPE) &&
+		(row.getString(0).length() == 0))
+		return false;
+
+	return push(row);
+}
+
+/*!
+ * @brief close
+ * @details no more rows will be accepted; the trainer drains the queue and stops
+ */
+void glades::StreamInput::close()
+{
+	pthread_mutex_lock(&queueMutex);
+	closed = true;
+	pthread_cond_broadcast(&queueCond);
+	pthread_mutex_unlock(&queueMutex);
+}
+
+/*!
+ * @brief pop
+ * @details waits for the next row
+ * @param inputRow set to the standardized input row
+ * @param expectedRow set to the expected row
+ * @param timeoutMs how long to wait for a row
+ * @return false on timeout or when the stream is closed and drained
+ */
+bool glades::StreamInput::pop(shmea::GList& inputRow, shmea::GList& expectedRow,
+							  unsigned int timeoutMs)
+{
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	struct timespec deadline;
+	int64_t usec = now.tv_usec + ((int64_t)timeoutMs * 1000);
+	deadline.tv_sec = now.tv_sec + (usec / 1000000);
+	deadline.tv_nsec = (usec % 1000000) * 1000;
+
+	pthread_mutex_lock(&queueMutex);
+	while ((queue.empty()) && (!closed))
+	{
+		if (pthread_cond_timedwait(&queueCond, &queueMutex, &deadline) == ETIMEDOUT)
+			break;
+	}
+
+	if (queue.empty())
+	{
+		pthread_mutex_unlock(&queueMutex);
+		return false;
+	}
+
+	inputRow = queue.front().input;
+	expectedRow = queue.front().expected;
+	queue.pop_front();
+	pthread_mutex_unlock(&queueMutex);
+	return true;
+}
+
+/*!
+ * @brief stage
+ * @details makes a popped row the newest row (train row 0)
+ */
+void glades::StreamInput::stage(const shmea::GList& inputRow, const shmea::GList& expectedRow)
+{
+	if (slotRows.empty())
+	{
+		slotRows.push_back(inputRow);
+		slotExpected.push_back(expectedRow);
+	}
+	else
+	{
+		slotRows[0] = inputRow;
+		slotExpected[0] = expectedRow;
+	}
+
+	++rowsSeen;
+}
+
+/*!
+ * @brief admit
+ * @details decides whether the staged row is kept for replay. Reservoir replay keeps every row
+ * seen with equal probability (Algorithm R); recent replay overwrites the oldest slot.
+ * @return the train row index the staged row was copied to, or -1 if it was not kept
+ */
+int glades::StreamInput::admit()
+{
+	if ((slotRows.empty()) || (capacity == 0))
+		return -1;
+
+	unsigned int slot = 0;
+	if (slotRows.size() <= capacity)
+	{
+		// still filling
+		slotRows.push_back(slotRows[0]);
+		slotExpected.push_back(slotExpected[0]);
+		return slotRows.size() - 1;
+	}
+	else if (replayType == REPLAY_RECENT)
+	{
+		slot = 1 + nextRecent;
+		nextRecent = (nextRecent + 1) % capacity;
+	}
+	else
+	{
+		int64_t dart = (int64_t)(GRandom::local().next() % (uint64_t)rowsSeen);
+		if (dart >= capacity)
+			return -1;
+
+		slot = 1 + dart;
+	}
+
+	slotRows[slot] = slotRows[0];
+	slotExpected[slot] = slotExpected[0];
+	return slot;
+}
+
+/*!
+ * @brief sample slot
+ * @return a random replay row index, or 0 (the newest row) if nothing has been kept yet
+ */
+unsigned int glades::StreamInput::sampleSlot() const
+{
+	if (slotRows.size() <= 1)
+		return 0;
+
+	return 1 + GRandom::local().nextBelow(slotRows.size() - 1);
+}
+
+bool glades::StreamInput::isClosed()
+{
+	pthread_mutex_lock(&queueMutex);
+	bool retVal = closed && queue.empty();
+	pthread_mutex_unlock(&queueMutex);
+	return retVal;
+}
+
+int64_t glades::StreamInput::getRowsSeen() const
+{
+	return rowsSeen;
+}
+
+int64_t glades::StreamInput::getDroppedRows()
+{
+	pthread_mutex_lock(&queueMutex);
+	int64_t retVal = droppedRows;
+	pthread_mutex_unlock(&queueMutex);
+	return retVal;
+}
+
+unsigned int glades::StreamInput::getCapacity() const
+{
+	return capacity;
+}
+
+unsigned int glades::StreamInput::getReplaySize() const
+{
+	return slotRows.empty() ? 0 : slotRows.size() - 1;
+}
+
+shmea::GList glades::StreamInput::getTrainRow(unsigned int index) const
+{
+	if (index >= slotRows.size())
+		return emptyRow;
+
+	return slotRows[index];
+}
+
+shmea::GList glades::StreamInput::getTrainExpectedRow(unsigned int index) const
+{
+	if (index >= slotExpected.size())
+		return emptyRow;
+
+	return slotExpected[index];
+}
+
+shmea::GList glades::StreamInput::getTestRow(unsigned int index) const
+{
+	return emptyRow;
+}
+
+shmea::GList glades::StreamInput::getTestExpectedRow(unsigned int index) const
+{
+	return emptyRow;
+}
+
+unsigned int glades::StreamInput::getTrainSize() const
+{
+	return slotRows.size();
+}
+
+unsigned int glades::StreamInput::getTestSize() const
+{
+	return 0;
+}
+
+unsigned int glades::StreamInput::getFeatureCount() const
+{
+	if (slotRows.empty())
+		return 0;
+
+	return slotRows[0].size();
+}
+
+int glades::StreamInput::getType() const
+{
+	return STREAM;
+}
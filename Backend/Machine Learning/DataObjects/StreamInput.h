@@ -0,0 +1,134 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GSTREAMINPUT
+#define _GSTREAMINPUT
+
+#include "DataInput.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GString.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace glades {
+
+class NumberInput;
+
+/*!
+ * @brief live row stream
+ * @details rows are pushed by any thread (a GNet service, a pipe or a followed file) into a
+ * bounded queue and popped by the training thread. Train row 0 is always the newest row; rows
+ * 1..capacity are a replay buffer the trainer mixes back in so the model does not drift onto the
+ * latest rows only. With a schema, raw rows are standardized the same way as the schema's
+ * imported data; without one every value must be numeric and the last expected cols are labels.
+ */
+class StreamInput : public DataInput
+{
+private:
+
+	class StreamRow
+	{
+	public:
+		shmea::GList input;
+		shmea::GList expected;
+	};
+
+	// Replay slots, [0] = newest row
+	std::vector<shmea::GList> slotRows;
+	std::vector<shmea::GList> slotExpected;
+	unsigned int capacity;
+	unsigned int expectedCount;
+	unsigned int featureCount;
+	unsigned int nextRecent;
+	int replayType;
+	int64_t rowsSeen;
+
+	// Incoming rows
+	pthread_mutex_t queueMutex;
+	pthread_cond_t queueCond;
+	std::deque<StreamRow> queue;
+	int64_t droppedRows;
+	bool closed;
+
+	// File/pipe reader
+	pthread_t* readerThread;
+	FILE* readerFile;
+	bool readerFollow;
+	bool readerRunning; // guarded by queueMutex
+
+	const NumberInput* schema;
+
+	static void* readerWorker(void*);
+	bool isReaderRunning();
+	bool encode(const shmea::GList&, StreamRow&) const;
+
+public:
+
+	static const unsigned int DEFAULT_CAPACITY = 1024;
+	static const unsigned int MAX_QUEUED = 65536;
+	static const int READER_POLL_MS = 100;
+
+	// replay flags
+	static const int REPLAY_RESERVOIR = 0; // uniform sample of every row seen
+	static const int REPLAY_RECENT = 1; // the last capacity rows
+
+	shmea::GList emptyRow;
+	shmea::GString name;
+
+	StreamInput(unsigned int = DEFAULT_CAPACITY, unsigned int = 1, int = REPLAY_RESERVOIR);
+	virtual ~StreamInput();
+
+	void setSchema(const NumberInput*);
+
+	// producers (any thread)
+	virtual void import(shmea::GString);
+	bool startReader(FILE*, bool = false);
+	void stopReader();
+	bool push(const shmea::GList&);
+	bool pushLine(const std::string&);
+	void close();
+
+	// consumer (training thread)
+	bool pop(shmea::GList&, shmea::GList&, unsigned int);
+	void stage(const shmea::GList&, const shmea::GList&);
+	int admit();
+	unsigned int sampleSlot() const;
+
+	bool isClosed();
+	int64_t getRowsSeen() const;
+	int64_t getDroppedRows();
+	unsigned int getCapacity() const;
+	unsigned int getReplaySize() const;
+
+	virtual shmea::GList getTrainRow(unsigned int) const;
+	virtual shmea::GList getTrainExpectedRow(unsigned int) const;
+
+	virtual shmea::GList getTestRow(unsigned int) const;
+	virtual shmea::GList getTestExpectedRow(unsigned int) const;
+
+	virtual unsigned int getTrainSize() const;
+	virtual unsigned int getTestSize() const;
+	virtual unsigned int getFeatureCount() const;
+
+	virtual int getType() const;
+};
+};
+
+#endif
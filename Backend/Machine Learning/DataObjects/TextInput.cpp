@@ -0,0 +1,358 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "TextInput.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GType.h"
+#include "../GMath/OHE.h"
+#include <ctype.h>
+#include <math.h>
+#include <unistd.h>
+
+using namespace glades;
+
+/*!
+ * @brief TextInput constructor
+ * @param buckets the hashed vocabulary size (feature count)
+ * @param newNGramOrder the largest n-gram to extract (1 = bag of words)
+ * @param newWorkerCount the number of tokenizer threads; 0 = one per core
+ */
+glades::TextInput::TextInput(unsigned int buckets, unsigned int newNGramOrder,
+							 unsigned int newWorkerCount)
+	: hasher(buckets, true)
+{
+	name = "";
+	loaded = false;
+	ngramOrder = newNGramOrder;
+	if (ngramOrder == 0)
+		ngramOrder = 1;
+
+	workerCount = newWorkerCount;
+	if (workerCount == 0)
+	{
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		workerCount = (cores > 0) ? (unsigned int)cores : 1;
+	}
+	if (workerCount > MAX_WORKERS)
+		workerCount = MAX_WORKERS;
+
+	OHEMaps.clear();
+	featureIsCategorical.clear();
+
+	// col 0 is the label
+	OHEMaps.push_back(new OHE());
+}
+
+glades::TextInput::~TextInput()
+{
+	name = "";
+	loaded = false;
+	for (unsigned int i = 0; i < OHEMaps.size(); ++i)
+		delete OHEMaps[i];
+	OHEMaps.clear();
+	featureIsCategorical.clear();
+	trainRows.clear();
+	testRows.clear();
+	trainLabels.clear();
+	testLabels.clear();
+}
+
+void glades::TextInput::import(shmea::GString fname)
+{
+	if (loaded)
+		return;
+
+	name = fname;
+	stream(fname, trainRows, trainLabels, true);
+
+	// Set the loaded flag
+	loaded = true;
+}
+
+/*!
+ * @brief import test corpus
+ * @details the labels are only looked up, so the expected rows keep the width the output layer
+ * was built for; a label training never saw encodes as all cold
+ * @param fname the corpus
+ */
+void glades::TextInput::importTest(shmea::GString fname)
+{
+	stream(fname, testRows, testLabels, false);
+}
+
+/*!
+ * @brief stream a corpus
+ * @details reads CHUNK_SIZE lines at a time and splits each chunk across the tokenizer threads.
+ * Rows keep file order since every thread writes to its own slice of the chunk.
+ * @param fname the corpus
+ * @param rows the rows to append to
+ * @param labels the labels to append to
+ * @param addLabels whether the labels go into the label OHE (training only)
+ */
+void glades::TextInput::stream(const shmea::GString& fname, std::vector<SparseRow>& rows,
+							   std::vector<std::string>& labels, bool addLabels)
+{
+	FILE* fd = fopen(fname.c_str(), "r");
+	if (!fd)
+	{
+		printf("[TEXT] Could not open %s\n", fname.c_str());
+		return;
+	}
+
+	char* lineBuffer = NULL;
+	size_t lineCapacity = 0;
+	std::vector<std::string> chunk;
+	chunk.reserve(CHUNK_SIZE);
+
+	bool eof = false;
+	while (!eof)
+	{
+		// Read the next chunk
+		chunk.clear();
+		while (chunk.size() < CHUNK_SIZE)
+		{
+			ssize_t lineLen = getline(&lineBuffer, &lineCapacity, fd);
+			if (lineLen < 0)
+			{
+				eof = true;
+				break;
+			}
+
+			// strip the newline
+			while ((lineLen > 0) &&
+				   ((lineBuffer[lineLen - 1] == '\n') || (lineBuffer[lineLen - 1] == '\r')))
+				--lineLen;
+
+			if (lineLen > 0)
+				chunk.push_back(std::string(lineBuffer, lineLen));
+		}
+
+		if (chunk.size() == 0)
+			break;
+
+		// Tokenize the chunk on the worker threads
+		unsigned int offset = rows.size();
+		rows.resize(offset + chunk.size());
+		labels.resize(offset + chunk.size());
+
+		std::vector<SparseRow> chunkRows(chunk.size());
+		std::vector<std::string> chunkLabels(chunk.size());
+
+		unsigned int cWorkers = workerCount;
+		if (cWorkers > chunk.size())
+			cWorkers = chunk.size();
+
+		std::vector<pthread_t> threads(cWorkers);
+		std::vector<TokenizerArgs> args(cWorkers);
+		unsigned int slice = (chunk.size() + cWorkers - 1) / cWorkers;
+		for (unsigned int t = 0; t < cWorkers; ++t)
+		{
+			args[t].owner = this;
+			args[t].lines = &chunk;
+			args[t].rows = &chunkRows;
+			args[t].labels = &chunkLabels;
+			args[t].start = t * slice;
+			args[t].end = (t + 1) * slice;
+			if (args[t].end > chunk.size())
+				args[t].end = chunk.size();
+		}
+
+		// Thread 0 is the calling thread
+		unsigned int launched = 0;
+		for (unsigned int t = 1; t < cWorkers; ++t)
+		{
+			if (pthread_create(&threads[launched], NULL, tokenizeWorker, &args[t]) != 0)
+				tokenizeWorker(&args[t]); // run it here instead
+			else
+				++launched;
+		}
+		tokenizeWorker(&args[0]);
+		for (unsigned int t = 0; t < launched; ++t)
+			pthread_join(threads[t], NULL);
+
+		// Move the chunk into the dataset
+		for (unsigned int i = 0; i < chunk.size(); ++i)
+		{
+			rows[offset + i].indices.swap(chunkRows[i].indices);
+			rows[offset + i].values.swap(chunkRows[i].values);
+			labels[offset + i].swap(chunkLabels[i]);
+			if (addLabels)
+				OHEMaps[0]->addString(labels[offset + i]);
+		}
+	}
+
+	free(lineBuffer);
+	fclose(fd);
+
+	printf("[TEXT] Loaded %lu documents from %s\n", (unsigned long)rows.size(), fname.c_str());
+}
+
+void* glades::TextInput::tokenizeWorker(void* y)
+{
+	TokenizerArgs* args = (TokenizerArgs*)y;
+	if (!args)
+		return NULL;
+
+	for (unsigned int i = args->start; i < args->end; ++i)
+		args->owner->tokenize((*args->lines)[i], (*args->rows)[i], (*args->labels)[i]);
+
+	return NULL;
+}
+
+/*!
+ * @brief tokenize a document
+ * @details lowercase alphanumeric tokens, 1..ngramOrder grams hashed into the vocabulary. The
+ * row is L2 normalized so long and short documents land on the same scale.
+ */
+void glades::TextInput::tokenize(const std::string& line, SparseRow& row, std::string& label) const
+{
+	row.indices.clear();
+	row.values.clear();
+
+	// label,text
+	std::string::size_type split = line.find(',');
+	if (split == std::string::npos)
+	{
+		label = line;
+		return;
+	}
+	label = line.substr(0, split);
+
+	// split into tokens
+	std::vector<std::string> tokens;
+	std::string cToken;
+	for (std::string::size_type i = split + 1; i <= line.length(); ++i)
+	{
+		unsigned char cChar = (i < line.length()) ? line[i] : ' ';
+		if (isalnum(cChar))
+			cToken += (char)tolower(cChar);
+		else if (cToken.length() > 0)
+		{
+			tokens.push_back(cToken);
+			cToken.clear();
+		}
+	}
+
+	// hash the n-grams into the row
+	std::map<unsigned int, float> counts;
+	for (unsigned int n = 1; n <= ngramOrder; ++n)
+	{
+		for (unsigned int t = 0; t + n <= tokens.size(); ++t)
+		{
+			std::string gram = tokens[t];
+			for (unsigned int k = 1; k < n; ++k)
+				gram += " " + tokens[t + k];
+
+			counts[hasher.indexAt(gram)] += hasher.signAt(gram);
+		}
+	}
+
+	// L2 normalize
+	float norm = 0.0f;
+	std::map<unsigned int, float>::const_iterator itr = counts.begin();
+	for (; itr != counts.end(); ++itr)
+		norm += itr->second * itr->second;
+	norm = sqrt(norm);
+	if (norm == 0.0f)
+		return;
+
+	row.indices.reserve(counts.size());
+	row.values.reserve(counts.size());
+	for (itr = counts.begin(); itr != counts.end(); ++itr)
+	{
+		if (itr->second == 0.0f)
+			continue;
+
+		row.indices.push_back(itr->first);
+		row.values.push_back(itr->second / norm);
+	}
+}
+
+shmea::GList glades::TextInput::expand(const SparseRow& row) const
+{
+	std::vector<float> dense(hasher.size(), 0.0f);
+	for (unsigned int i = 0; i < row.indices.size(); ++i)
+		dense[row.indices[i]] = row.values[i];
+
+	shmea::GList retList;
+	for (unsigned int i = 0; i < dense.size(); ++i)
+		retList.addFloat(dense[i]);
+
+	return retList;
+}
+
+shmea::GList glades::TextInput::expectedRow(const std::string& label) const
+{
+	// translate string to cell value for this col
+	std::vector<float> featureVector = (*OHEMaps[0])[label];
+
+	shmea::GList retRow;
+	for (unsigned int i = 0; i < featureVector.size(); ++i)
+		retRow.addFloat(featureVector[i]);
+	return retRow;
+}
+
+shmea::GList glades::TextInput::getTrainRow(unsigned int index) const
+{
+	if (index >= trainRows.size())
+		return emptyRow;
+
+	return expand(trainRows[index]);
+}
+
+shmea::GList glades::TextInput::getTrainExpectedRow(unsigned int index) const
+{
+	if (index >= trainLabels.size())
+		return emptyRow;
+
+	return expectedRow(trainLabels[index]);
+}
+
+shmea::GList glades::TextInput::getTestRow(unsigned int index) const
+{
+	if (index >= testRows.size())
+		return emptyRow;
+
+	return expand(testRows[index]);
+}
+
+shmea::GList glades::TextInput::getTestExpectedRow(unsigned int index) const
+{
+	if (index >= testLabels.size())
+		return emptyRow;
+
+	return expectedRow(testLabels[index]);
+}
+
+unsigned int glades::TextInput::getTrainSize() const
+{
+	return trainRows.size();
+}
+
+unsigned int glades::TextInput::getTestSize() const
+{
+	return testRows.size();
+}
+
+unsigned int glades::TextInput::getFeatureCount() const
+{
+	return hasher.size();
+}
+
+int glades::TextInput::getType() const
+{
+	return TEXT;
+}
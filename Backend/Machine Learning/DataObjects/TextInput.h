@@ -0,0 +1,107 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GTEXTINPUT
+#define _GTEXTINPUT
+
+#include "DataInput.h"
+#include "Backend/Database/GString.h"
+#include "Backend/Database/GTable.h"
+#include "../GMath/featurehasher.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <vector>
+#include <map>
+
+namespace glades {
+
+class OHE;
+
+/*!
+ * @brief streaming text dataset
+ * @details each line of the corpus is "label,text". The file is streamed in fixed size chunks and
+ * every chunk is tokenized on worker threads into hashed bag-of-words/n-gram rows, so only one
+ * chunk of raw text is ever in memory and the vocabulary never has to be stored.
+ */
+class TextInput : public DataInput
+{
+private:
+
+	// Sparse hashed row
+	class SparseRow
+	{
+	public:
+		std::vector<unsigned int> indices;
+		std::vector<float> values;
+	};
+
+	// Work handed to a tokenizer thread
+	class TokenizerArgs
+	{
+	public:
+		const TextInput* owner;
+		const std::vector<std::string>* lines;
+		std::vector<SparseRow>* rows;
+		std::vector<std::string>* labels;
+		unsigned int start;
+		unsigned int end;
+	};
+
+	std::vector<SparseRow> trainRows;
+	std::vector<SparseRow> testRows;
+	std::vector<std::string> trainLabels;
+	std::vector<std::string> testLabels;
+
+	FeatureHasher hasher;
+	unsigned int ngramOrder;
+	unsigned int workerCount;
+
+	static void* tokenizeWorker(void*);
+	void tokenize(const std::string&, SparseRow&, std::string&) const;
+	void stream(const shmea::GString&, std::vector<SparseRow>&, std::vector<std::string>&, bool);
+	shmea::GList expand(const SparseRow&) const;
+	shmea::GList expectedRow(const std::string&) const;
+
+public:
+
+	static const unsigned int CHUNK_SIZE = 4096; // lines per chunk
+	static const unsigned int MAX_WORKERS = 8;
+
+	shmea::GList emptyRow;
+	shmea::GString name;
+	bool loaded;
+
+	TextInput(unsigned int = FeatureHasher::DEFAULT_BUCKETS, unsigned int = 2, unsigned int = 0);
+	virtual ~TextInput();
+
+	virtual void import(shmea::GString);
+	void importTest(shmea::GString);
+
+	virtual shmea::GList getTrainRow(unsigned int) const;
+	virtual shmea::GList getTrainExpectedRow(unsigned int) const;
+
+	virtual shmea::GList getTestRow(unsigned int) const;
+	virtual shmea::GList getTestExpectedRow(unsigned int) const;
+
+	virtual unsigned int getTrainSize() const;
+	virtual unsigned int getTestSize() const;
+	virtual unsigned int getFeatureCount() const;
+
+	virtual int getType() const;
+};
+};
+
+#endif
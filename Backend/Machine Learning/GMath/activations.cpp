@@ -0,0 +1,161 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "activations.h"
+#include "kernels.h"
+
+using namespace glades;
+
+// Fast tanh goes through the runtime selected SIMD kernel
+static void fastTanhLayer(float* netInputs, unsigned int count, float)
+{
+	Kernels::get().fastTanh(netInputs, count);
+}
+
+/*!
+ * @brief ActivationPlan constructor
+ * @details identity plan: linear squash with a slope of 1 and MSE cost
+ */
+glades::ActivationPlan::ActivationPlan()
+{
+	squash = getSquashLayer(GMath::LINEAR);
+	errDer = getErrDerLayer(GMath::LINEAR);
+	costErrDer = getCostErrDerLayer(GMath::REGRESSION);
+	fxParam = 1.0f;
+}
+
+/*!
+ * @brief ActivationPlan constructor
+ * @details resolve the layer kernels for a layer's flags
+ * @param activationFx the GMath activation flag
+ * @param newFxParam the activation parameter
+ * @param costFx the GMath cost flag (only used by output layers)
+ * @param precision the GMath precision flag
+ */
+glades::ActivationPlan::ActivationPlan(int activationFx, float newFxParam, int costFx,
+									   int precision)
+{
+	if ((activationFx == GMath::LEAKY) && (newFxParam > 0.1f))
+		printf("[MATH] WARNING: Passed activation param too large for Leaky ReLU\n");
+
+	squash = getSquashLayer(activationFx, precision);
+	errDer = getErrDerLayer(activationFx);
+	costErrDer = getCostErrDerLayer(costFx);
+	fxParam = newFxParam;
+}
+
+/*!
+ * @brief get squash layer kernel
+ * @details pick the squash instantiation for an activation and precision
+ * @param activationFx the GMath activation flag
+ * @param precision the GMath precision flag
+ * @return the layer kernel
+ */
+ActivationPlan::SquashLayerFx glades::ActivationPlan::getSquashLayer(int activationFx,
+																	  int precision)
+{
+	if (precision == GMath::PRECISION_FAST)
+	{
+		switch (activationFx)
+		{
+		case GMath::TANH:
+			return &fastTanhLayer;
+		case GMath::TANHP:
+			return &squashLayer<GMath::TANHP, GMath::PRECISION_FAST>;
+		case GMath::SIGMOID:
+			return &squashLayer<GMath::SIGMOID, GMath::PRECISION_FAST>;
+		case GMath::SIGMOIDP:
+			return &squashLayer<GMath::SIGMOIDP, GMath::PRECISION_FAST>;
+		}
+	}
+
+	switch (activationFx)
+	{
+	case GMath::TANH:
+		return &squashLayer<GMath::TANH, GMath::PRECISION_EXACT>;
+	case GMath::TANHP:
+		return &squashLayer<GMath::TANHP, GMath::PRECISION_EXACT>;
+	case GMath::SIGMOID:
+		return &squashLayer<GMath::SIGMOID, GMath::PRECISION_EXACT>;
+	case GMath::SIGMOIDP:
+		return &squashLayer<GMath::SIGMOIDP, GMath::PRECISION_EXACT>;
+	case GMath::LINEAR:
+		return &squashLayer<GMath::LINEAR, GMath::PRECISION_EXACT>;
+	case GMath::RELU:
+		return &squashLayer<GMath::RELU, GMath::PRECISION_EXACT>;
+	case GMath::LEAKY:
+		return &squashLayer<GMath::LEAKY, GMath::PRECISION_EXACT>;
+	case GMath::STEP:
+		return &squashLayer<GMath::STEP, GMath::PRECISION_EXACT>;
+	}
+
+	return &squashLayer<-1, GMath::PRECISION_EXACT>;
+}
+
+/*!
+ * @brief get activation derivative layer kernel
+ * @details pick the derivative instantiation for an activation; derivatives take the squashed
+ * output so they need no transcendental
+ * @param activationFx the GMath activation flag
+ * @return the layer kernel
+ */
+ActivationPlan::ErrDerLayerFx glades::ActivationPlan::getErrDerLayer(int activationFx)
+{
+	switch (activationFx)
+	{
+	case GMath::TANH:
+		return &errDerLayer<GMath::TANH>;
+	case GMath::TANHP:
+		return &errDerLayer<GMath::TANHP>;
+	case GMath::SIGMOID:
+		return &errDerLayer<GMath::SIGMOID>;
+	case GMath::SIGMOIDP:
+		return &errDerLayer<GMath::SIGMOIDP>;
+	case GMath::LINEAR:
+		return &errDerLayer<GMath::LINEAR>;
+	case GMath::RELU:
+		return &errDerLayer<GMath::RELU>;
+	case GMath::LEAKY:
+		return &errDerLayer<GMath::LEAKY>;
+	case GMath::STEP:
+		return &errDerLayer<GMath::STEP>;
+	}
+
+	return &errDerLayer<-1>;
+}
+
+/*!
+ * @brief get cost derivative layer kernel
+ * @details pick the cost derivative instantiation for an output layer
+ * @param costFx the GMath cost flag
+ * @return the layer kernel
+ */
+ActivationPlan::CostErrDerLayerFx glades::ActivationPlan::getCostErrDerLayer(int costFx)
+{
+	switch (costFx)
+	{
+	case GMath::REGRESSION:
+		return &costErrDerLayer<GMath::REGRESSION>;
+	case GMath::CLASSIFICATION:
+		return &costErrDerLayer<GMath::CLASSIFICATION>;
+	case GMath::KL:
+		return &costErrDerLayer<GMath::KL>;
+	case GMath::SOFTMAX:
+		return &costErrDerLayer<GMath::SOFTMAX>;
+	}
+
+	return &costErrDerLayer<-1>;
+}
@@ -0,0 +1,228 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GACTIVATIONS
+#define _GACTIVATIONS
+
+#include "gmath.h"
+#include <math.h>
+#include <stdio.h>
+
+namespace glades {
+
+// Compile time activation/cost functors. Each specialization mirrors the matching case of
+// GMath::squash, GMath::activationErrDer or GMath::costErrDer exactly, so the layer kernels can
+// inline them instead of switching per neuron.
+
+template <int PRECISION>
+struct Transcendental
+{
+	static float tanhFx(float x) { return tanh(x); }
+	static float sigmoidFx(float x) { return 1.0f / (1.0f + exp(-x)); }
+};
+
+template <>
+struct Transcendental<GMath::PRECISION_FAST>
+{
+	static float tanhFx(float x) { return GMath::fastTanh(x); }
+	static float sigmoidFx(float x) { return GMath::fastSigmoid(x); }
+};
+
+// Unknown flags: squash to 0, derivative of 1 (same as the GMath defaults)
+template <int FX, int PRECISION>
+struct Activation
+{
+	static float squash(float, float) { return 0.0f; }
+	static float errDer(float, float) { return 1.0f; }
+};
+
+template <int PRECISION>
+struct Activation<GMath::TANH, PRECISION>
+{
+	static float squash(float x, float) { return Transcendental<PRECISION>::tanhFx(x); }
+	static float errDer(float y, float) { return 1.0f - (y * y); }
+};
+
+template <int PRECISION>
+struct Activation<GMath::TANHP, PRECISION>
+{
+	static float squash(float x, float fxParam)
+	{
+		if (x > 1.0f - fxParam)
+			return 1.0f;
+		if (x < fxParam - 1.0f)
+			return -1.0f;
+		return Transcendental<PRECISION>::tanhFx(x);
+	}
+	static float errDer(float y, float) { return 1.0f - (y * y); }
+};
+
+template <int PRECISION>
+struct Activation<GMath::SIGMOID, PRECISION>
+{
+	static float squash(float x, float) { return Transcendental<PRECISION>::sigmoidFx(x); }
+	static float errDer(float y, float) { return y * (1.0f - y); }
+};
+
+template <int PRECISION>
+struct Activation<GMath::SIGMOIDP, PRECISION>
+{
+	static float squash(float x, float fxParam)
+	{
+		if (x < fxParam)
+			return 0.01f;
+		if (x > 1.0f - fxParam)
+			return 0.99f;
+		return Transcendental<PRECISION>::sigmoidFx(x);
+	}
+	static float errDer(float y, float) { return y * (1.0f - y); }
+};
+
+template <int PRECISION>
+struct Activation<GMath::LINEAR, PRECISION>
+{
+	static float squash(float x, float fxParam) { return fxParam * x; }
+	static float errDer(float, float fxParam) { return fxParam; }
+};
+
+template <int PRECISION>
+struct Activation<GMath::RELU, PRECISION>
+{
+	static float squash(float x, float) { return (x < GMath::OUTLIER) ? 0.0f : x; }
+	static float errDer(float y, float) { return (y > 0.0f) ? 1.0f : 0.0f; }
+};
+
+template <int PRECISION>
+struct Activation<GMath::LEAKY, PRECISION>
+{
+	static float squash(float x, float fxParam) { return (x < GMath::OUTLIER) ? fxParam * x : x; }
+	static float errDer(float y, float fxParam)
+	{
+		if (y > 0.0f)
+			return 1.0f;
+		return (fxParam < 0.0f) ? fxParam : -fxParam;
+	}
+};
+
+template <int PRECISION>
+struct Activation<GMath::STEP, PRECISION>
+{
+	static float squash(float x, float fxParam) { return (x < fxParam) ? 0.0f : 1.0f; }
+	static float errDer(float, float) { return 0.0f; }
+};
+
+template <int COST>
+struct Cost
+{
+	static float errDer(float, float) { return 1.0f; }
+};
+
+template <>
+struct Cost<GMath::REGRESSION>
+{
+	static float errDer(float expectation, float prediction)
+	{
+		return 2.0f * (prediction - expectation);
+	}
+};
+
+template <>
+struct Cost<GMath::CLASSIFICATION>
+{
+	static float errDer(float expectation, float prediction)
+	{
+		return (prediction - expectation) / ((1 - prediction) * prediction);
+	}
+};
+
+template <>
+struct Cost<GMath::KL>
+{
+	static float errDer(float expectation, float prediction) { return -(expectation / prediction); }
+};
+
+template <>
+struct Cost<GMath::SOFTMAX>
+{
+	static float errDer(float expectation, float prediction, float expectationSum)
+	{
+		return (prediction * expectationSum) - expectation;
+	}
+};
+
+// Layer kernels: one tight loop per instantiation
+template <int FX, int PRECISION>
+void squashLayer(float* netInputs, unsigned int count, float fxParam)
+{
+	for (unsigned int i = 0; i < count; ++i)
+		netInputs[i] = Activation<FX, PRECISION>::squash(netInputs[i], fxParam);
+}
+
+template <int FX>
+void errDerLayer(const float* outputs, float* errDers, unsigned int count, float fxParam)
+{
+	for (unsigned int i = 0; i < count; ++i)
+		errDers[i] = Activation<FX, GMath::PRECISION_EXACT>::errDer(outputs[i], fxParam);
+}
+
+template <int COST>
+void costErrDerLayer(const float* expectations, const float* predictions, float* errDers,
+					 unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i)
+		errDers[i] = Cost<COST>::errDer(expectations[i], predictions[i]);
+}
+
+// The softmax gradient needs the row's target total (see GMath::costErrDer)
+template <>
+inline void costErrDerLayer<GMath::SOFTMAX>(const float* expectations, const float* predictions,
+											float* errDers, unsigned int count)
+{
+	float expectationSum = 0.0f;
+	for (unsigned int i = 0; i < count; ++i)
+		expectationSum += expectations[i];
+
+	for (unsigned int i = 0; i < count; ++i)
+		errDers[i] = Cost<GMath::SOFTMAX>::errDer(expectations[i], predictions[i], expectationSum);
+}
+
+/*!
+ * @brief activation plan
+ * @details the kernels one layer uses, resolved once from its activation/cost flags so the
+ * forward and backward passes never switch on them
+ */
+class ActivationPlan
+{
+public:
+	typedef void (*SquashLayerFx)(float*, unsigned int, float);
+	typedef void (*ErrDerLayerFx)(const float*, float*, unsigned int, float);
+	typedef void (*CostErrDerLayerFx)(const float*, const float*, float*, unsigned int);
+
+	SquashLayerFx squash;
+	ErrDerLayerFx errDer;
+	CostErrDerLayerFx costErrDer;
+	float fxParam;
+
+	ActivationPlan();
+	ActivationPlan(int, float, int = GMath::REGRESSION, int = GMath::PRECISION_EXACT);
+
+	static SquashLayerFx getSquashLayer(int, int = GMath::PRECISION_EXACT);
+	static ErrDerLayerFx getErrDerLayer(int);
+	static CostErrDerLayerFx getCostErrDerLayer(int);
+};
+};
+
+#endif
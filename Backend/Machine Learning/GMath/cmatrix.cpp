@@ -17,14 +17,13 @@
 #include "cmatrix.h"
 #include "Backend/Database/GList.h"
 #include "Backend/Database/GTable.h"
-#include "Backend/Database/GType.h"
-#include "gmath.h"
+#include <algorithm>
 
 using namespace glades;
 
 glades::CMatrix::CMatrix()
 {
-	//
+	classCount = 0;
 }
 
 glades::CMatrix::~CMatrix()
@@ -36,24 +35,57 @@ void glades::CMatrix::build(unsigned int numberOfClasses)
 {
 	clean();
 
-	// build an nxn gtable of int 0's
-	for (unsigned int i = 0; i < numberOfClasses; ++i)
+	// nxn counts and the per class params, all zero
+	classCount = numberOfClasses;
+	counts.assign(classCount * classCount, 0);
+	truePositive.assign(classCount, 0);
+	trueNegative.assign(classCount, 0);
+	falsePositive.assign(classCount, 0);
+	falseNegative.assign(classCount, 0);
+}
+
+/*!
+ * @brief argmax
+ * @details index of the largest strictly positive value, the class a one hot or probability
+ * vector votes for
+ * @param x the vector
+ * @param n the vector length
+ * @return the winning index, or -1 when no value is positive
+ */
+int glades::CMatrix::argmax(const float* x, unsigned int n)
+{
+	float max = 0.0f;
+	int index = -1;
+	for (unsigned int i = 0; i < n; ++i)
 	{
-		shmea::GList newList;
+		if (x[i] > max)
+		{
+			max = x[i];
+			index = i;
+		}
+	}
 
-		for (unsigned int j = 0; j < numberOfClasses; ++j)
-			newList.addInt(0);
+	return index;
+}
 
-		matrix.addRow(newList);
+/*!
+ * @brief add result
+ * @param expected the expected class (row)
+ * @param predicted the predicted class (col)
+ */
+void glades::CMatrix::addResult(unsigned int expected, unsigned int predicted)
+{
+	if ((expected >= classCount) || (predicted >= classCount))
+		return;
 
-		// build params
-		truePositive.addInt(0);
-		trueNegative.addInt(0);
-		falsePositive.addInt(0);
-		falseNegative.addInt(0);
-	}
+	++counts[(expected * classCount) + predicted];
 }
 
+/*!
+ * @brief add result
+ * @details count one sample from an interleaved expected/predicted list
+ * @param result expected0, predicted0, expected1, predicted1, ...
+ */
 void glades::CMatrix::addResult(const shmea::GList& result)
 {
 	// error checks
@@ -62,85 +94,173 @@ void glades::CMatrix::addResult(const shmea::GList& result)
 		printf("[CMATRIX] Bad result list size [0]: %d\n", result.size());
 		return;
 	}
-	if ((result.size() / 2) != matrix.numberOfCols())
+	if ((result.size() / 2) != classCount)
 	{
 		printf("[CMATRIX] Bad result list size [1]: %d\n", result.size());
 		return;
 	}
 
-	// split into expected list and predicted list
-	shmea::GList expected, predicted;
-	for (unsigned int i = 0; i < result.size(); ++i)
+	// split into expected and predicted
+	std::vector<float> expected(classCount);
+	std::vector<float> predicted(classCount);
+	for (unsigned int i = 0; i < classCount; ++i)
 	{
-		if ((i % 2) == 0)
-			expected.addFloat(result.getFloat(i));
-		else
-			predicted.addFloat(result.getFloat(i));
+		expected[i] = result.getFloat(2 * i);
+		predicted[i] = result.getFloat((2 * i) + 1);
 	}
 
-	// run lists through vector decomp
-	shmea::GList expectedDecomp = GMath::naiveVectorDecomp(expected);
-	shmea::GList predictedDecomp = GMath::naiveVectorDecomp(predicted);
+	addResults(&predicted[0], &expected[0], 1);
+}
+
+/*!
+ * @brief add results
+ * @details count a batch of samples. A sample with no positive expected or predicted value
+ * is not counted.
+ * @param pred n rows of classCount predicted values
+ * @param exp n rows of classCount expected values
+ * @param n the number of samples
+ */
+void glades::CMatrix::addResults(const float* pred, const float* exp, unsigned int n)
+{
+	if (classCount == 0)
+		return;
 
-	// increment confusion matrix
-	// schema: expected -> row; predicted -> col
-	for (unsigned int i = 0; i < expectedDecomp.size(); ++i)
+	for (unsigned int s = 0; s < n; ++s)
 	{
-		if (expectedDecomp.getInt(i) == 1)
-		{
-			for (unsigned int j = 0; j < predictedDecomp.size(); ++j)
-			{
-				int newCount = (matrix.getCell(i, j).getInt() + predictedDecomp.getInt(j));
-				matrix.setCell(i, j, newCount);
-			}
-		}
+		int expected = argmax(exp + (s * classCount), classCount);
+		int predicted = argmax(pred + (s * classCount), classCount);
+		if ((expected < 0) || (predicted < 0))
+			continue;
+
+		++counts[(expected * classCount) + predicted];
+	}
+}
+
+/*!
+ * @brief merge
+ * @details add another matrix's counts into this one, e.g. a worker thread's at epoch end
+ * @param other a matrix of the same size
+ */
+void glades::CMatrix::merge(const CMatrix& other)
+{
+	if (other.classCount != classCount)
+	{
+		printf("[CMATRIX] Cannot merge a %ux%u matrix into a %ux%u matrix\n", other.classCount,
+			   other.classCount, classCount, classCount);
+		return;
 	}
+
+	for (unsigned int i = 0; i < counts.size(); ++i)
+		counts[i] += other.counts[i];
+}
+
+/*!
+ * @brief copy
+ * @details copy the counts and params into this matrix's own buffers, which are only resized when
+ * the class count changes, so a matrix copied into every epoch allocates once
+ * @param other the matrix to copy
+ */
+void glades::CMatrix::copy(const CMatrix& other)
+{
+	if (other.classCount != classCount)
+		build(other.classCount);
+
+	std::copy(other.counts.begin(), other.counts.end(), counts.begin());
+	std::copy(other.truePositive.begin(), other.truePositive.end(), truePositive.begin());
+	std::copy(other.trueNegative.begin(), other.trueNegative.end(), trueNegative.begin());
+	std::copy(other.falsePositive.begin(), other.falsePositive.end(), falsePositive.begin());
+	std::copy(other.falseNegative.begin(), other.falseNegative.end(), falseNegative.begin());
+}
+
+/*!
+ * @brief swap
+ * @details exchange the buffers with another matrix, without copying them
+ * @param other the matrix to swap with
+ */
+void glades::CMatrix::swap(CMatrix& other)
+{
+	std::swap(classCount, other.classCount);
+	counts.swap(other.counts);
+	truePositive.swap(other.truePositive);
+	trueNegative.swap(other.trueNegative);
+	falsePositive.swap(other.falsePositive);
+	falseNegative.swap(other.falseNegative);
 }
 
 void glades::CMatrix::updateResultParams()
 {
 	// schema: expected -> row; predicted -> col
-	int size = matrix.numberOfRows();
+	// TN for a class counts the other classes' correct predictions
+	uint64_t trace = 0;
+	for (unsigned int i = 0; i < classCount; ++i)
+	{
+		truePositive[i] = counts[(i * classCount) + i];
+		falsePositive[i] = 0;
+		falseNegative[i] = 0;
+		trace += truePositive[i];
+	}
 
-	// order( 2(n^2) - n ) operation to update params
-	for (int row = 0; row < size; ++row)
+	for (unsigned int row = 0; row < classCount; ++row)
 	{
-		for (int col = 0; col < size; ++col)
+		const uint64_t* cRow = &counts[row * classCount];
+		for (unsigned int col = 0; col < classCount; ++col)
 		{
-			shmea::GType value(matrix.getCell(row, col));
-
-			if (row != col)
-			{
-				falsePositive.setGType(col, (falsePositive.getInt(col) + value.getInt()));
-				falseNegative.setGType(row, (falseNegative.getInt(row) + value.getInt()));
-			}
-			else
-			{
-				// row == col needs third loop for TN's
-				for (int itr = 0; itr < size; ++itr)
-				{
-					if (itr == row)
-						truePositive.setGType(itr, value);
-					else
-						trueNegative.setGType(itr, (trueNegative.getInt(itr) + value.getInt()));
-				}
-			}
+			if (row == col)
+				continue;
+
+			falsePositive[col] += cRow[col];
+			falseNegative[row] += cRow[col];
 		}
 	}
+
+	for (unsigned int i = 0; i < classCount; ++i)
+		trueNegative[i] = trace - truePositive[i];
+}
+
+unsigned int glades::CMatrix::size() const
+{
+	return classCount;
+}
+
+uint64_t glades::CMatrix::getCount(unsigned int expected, unsigned int predicted) const
+{
+	if ((expected >= classCount) || (predicted >= classCount))
+		return 0;
+
+	return counts[(expected * classCount) + predicted];
+}
+
+uint64_t glades::CMatrix::getTotal() const
+{
+	uint64_t total = 0;
+	for (unsigned int i = 0; i < counts.size(); ++i)
+		total += counts[i];
+
+	return total;
 }
 
 shmea::GTable glades::CMatrix::getMatrix() const
 {
+	shmea::GTable matrix;
+	for (unsigned int i = 0; i < classCount; ++i)
+	{
+		shmea::GList newList;
+		for (unsigned int j = 0; j < classCount; ++j)
+			newList.addLong((int64_t)counts[(i * classCount) + j]);
+
+		matrix.addRow(newList);
+	}
+
 	return matrix;
 }
 
 float glades::CMatrix::getClassAccuracy(unsigned int index) const
 {
-	if (index > matrix.numberOfRows())
+	if (index >= classCount)
 		return 0.0f;
 
-	float truth = ((float)(truePositive.getInt(index) + trueNegative.getInt(index)));
-	float untruth = ((float)(falsePositive.getInt(index) + falseNegative.getInt(index)));
+	float truth = ((float)(truePositive[index] + trueNegative[index]));
+	float untruth = ((float)(falsePositive[index] + falseNegative[index]));
 
 	return (truth / (truth + untruth));
 }
@@ -149,102 +269,102 @@ float glades::CMatrix::getOverallAccuracy() const
 {
 	float totalAccuracy = 0.0f;
 
-	for (unsigned int i = 0; i < matrix.numberOfRows(); ++i)
+	for (unsigned int i = 0; i < classCount; ++i)
 		totalAccuracy += getClassAccuracy(i);
 
-	totalAccuracy /= ((float)(matrix.numberOfRows()));
+	totalAccuracy /= ((float)classCount);
 
 	return totalAccuracy;
 }
 
 float glades::CMatrix::getClassPrecision(unsigned int index) const
 {
-	if (index > matrix.numberOfRows())
+	if (index >= classCount)
 		return 0.0f;
 
-	return (((float)(truePositive.getInt(index))) /
-			((float)(truePositive.getInt(index) + falsePositive.getInt(index))));
+	return (((float)(truePositive[index])) /
+			((float)(truePositive[index] + falsePositive[index])));
 }
 
 float glades::CMatrix::getOverallPrecision() const
 {
 	float totalPrecision = 0.0f;
 
-	for (unsigned int i = 0; i < matrix.numberOfRows(); ++i)
+	for (unsigned int i = 0; i < classCount; ++i)
 		totalPrecision += getClassPrecision(i);
 
-	totalPrecision /= ((float)(matrix.numberOfRows()));
+	totalPrecision /= ((float)classCount);
 
 	return totalPrecision;
 }
 
 float glades::CMatrix::getClassRecall(unsigned int index) const
 {
-	if (index > matrix.numberOfRows())
+	if (index >= classCount)
 		return 0.0f;
 
-	return (((float)(truePositive.getInt(index))) /
-			((float)(truePositive.getInt(index) + falseNegative.getInt(index))));
+	return (((float)(truePositive[index])) /
+			((float)(truePositive[index] + falseNegative[index])));
 }
 
 float glades::CMatrix::getOverallRecall() const
 {
 	float totalRecall = 0.0f;
 
-	for (unsigned int i = 0; i < matrix.numberOfRows(); ++i)
+	for (unsigned int i = 0; i < classCount; ++i)
 		totalRecall += getClassRecall(i);
 
-	totalRecall /= ((float)(matrix.numberOfRows()));
+	totalRecall /= ((float)classCount);
 
 	return totalRecall;
 }
 
 float glades::CMatrix::getClassSpecificity(unsigned int index) const
 {
-	if (index > matrix.numberOfRows())
+	if (index >= classCount)
 		return 0.0f;
 
-	return (((float)(trueNegative.getInt(index))) /
-			((float)(trueNegative.getInt(index) + falsePositive.getInt(index))));
+	return (((float)(trueNegative[index])) /
+			((float)(trueNegative[index] + falsePositive[index])));
 }
 
 float glades::CMatrix::getOverallSpecificity() const
 {
 	float totalSpecificity = 0.0f;
 
-	for (unsigned int i = 0; i < matrix.numberOfRows(); ++i)
+	for (unsigned int i = 0; i < classCount; ++i)
 		totalSpecificity += getClassSpecificity(i);
 
-	totalSpecificity /= ((float)(matrix.numberOfRows()));
+	totalSpecificity /= ((float)classCount);
 
 	return totalSpecificity;
 }
 
 float glades::CMatrix::getClassFalseAlarm(unsigned int index) const
 {
-	if (index > matrix.numberOfRows())
+	if (index >= classCount)
 		return 0.0f;
 
 	// also 1.0f - specificity
-	return (((float)(falsePositive.getInt(index))) /
-			((float)(trueNegative.getInt(index) + falsePositive.getInt(index))));
+	return (((float)(falsePositive[index])) /
+			((float)(trueNegative[index] + falsePositive[index])));
 }
 
 float glades::CMatrix::getOverallFalseAlarm() const
 {
 	float totalFalseAlarm = 0.0f;
 
-	for (unsigned int i = 0; i < matrix.numberOfRows(); ++i)
+	for (unsigned int i = 0; i < classCount; ++i)
 		totalFalseAlarm += getClassFalseAlarm(i);
 
-	totalFalseAlarm /= ((float)(matrix.numberOfRows()));
+	totalFalseAlarm /= ((float)classCount);
 
 	return totalFalseAlarm;
 }
 
 float glades::CMatrix::getClassF1Score(unsigned int index) const
 {
-	if (index > matrix.numberOfRows())
+	if (index >= classCount)
 		return 0.0f;
 
 	float cRecall = getClassRecall(index);
@@ -257,51 +377,52 @@ float glades::CMatrix::getOverallF1Score() const
 {
 	float totalF1Score = 0.0f;
 
-	for (unsigned int i = 0; i < matrix.numberOfRows(); ++i)
+	for (unsigned int i = 0; i < classCount; ++i)
 		totalF1Score += getClassF1Score(i);
 
-	totalF1Score /= ((float)(matrix.numberOfRows()));
+	totalF1Score /= ((float)classCount);
 
 	return totalF1Score;
 }
 
+static void printParams(const char* label, const std::vector<uint64_t>& params)
+{
+	printf("[CMATRIX] %s...\n", label);
+	for (unsigned int i = 0; i < params.size(); ++i)
+		printf("%llu%s", (unsigned long long)params[i], (i + 1 < params.size()) ? "\t" : "\n");
+}
+
 void glades::CMatrix::print() const
 {
 	// bare print for now, pretty it up later
-	printf("[CMATRIX] Confusion Matrix...");
-	matrix.print();
-
-	printf("[CMATRIX] True Positives...\n");
-	truePositive.print();
-
-	printf("[CMATRIX] True Negatives...\n");
-	trueNegative.print();
-
-	printf("[CMATRIX] False Positives...\n");
-	falsePositive.print();
+	printf("[CMATRIX] Confusion Matrix...\n");
+	for (unsigned int i = 0; i < classCount; ++i)
+	{
+		for (unsigned int j = 0; j < classCount; ++j)
+			printf("%llu%s", (unsigned long long)counts[(i * classCount) + j],
+				   (j + 1 < classCount) ? "\t" : "\n");
+	}
 
-	printf("[CMATRIX] False Negatives...\n");
-	falseNegative.print();
+	printParams("True Positives", truePositive);
+	printParams("True Negatives", trueNegative);
+	printParams("False Positives", falsePositive);
+	printParams("False Negatives", falseNegative);
 }
 
 void glades::CMatrix::reset()
 {
-	// maintain shape, reset all cells to int 0's and reset params
-	for (unsigned int i = 0; i < matrix.numberOfRows(); ++i)
-	{
-		for (unsigned int j = 0; j < matrix.numberOfCols(); ++j)
-			matrix.setCell(i, j, shmea::GType(0));
-
-		truePositive.setGType(i, shmea::GType(0));
-		trueNegative.setGType(i, shmea::GType(0));
-		falsePositive.setGType(i, shmea::GType(0));
-		falseNegative.setGType(i, shmea::GType(0));
-	}
+	// maintain shape, reset all cells and params to 0
+	counts.assign(counts.size(), 0);
+	truePositive.assign(classCount, 0);
+	trueNegative.assign(classCount, 0);
+	falsePositive.assign(classCount, 0);
+	falseNegative.assign(classCount, 0);
 }
 
 void glades::CMatrix::clean()
 {
-	matrix.clear();
+	classCount = 0;
+	counts.clear();
 
 	truePositive.clear();
 	trueNegative.clear();
@@ -19,20 +19,28 @@
 
 #include "Backend/Database/GList.h"
 #include "Backend/Database/GTable.h"
+#include <stdint.h>
 #include <string>
 #include <vector>
 
 namespace glades {
 
+/*!
+ * @brief confusion matrix
+ * @details dense row major uint64 counts, expected class -> row, predicted class -> col. Samples
+ * are counted straight from the argmax of their expected and predicted vectors. Each thread
+ * scoring samples keeps its own CMatrix and merges it into the epoch's matrix when it finishes.
+ */
 class CMatrix
 {
 private:
-	shmea::GTable matrix;
+	unsigned int classCount;
+	std::vector<uint64_t> counts;
 
-	shmea::GList truePositive;
-	shmea::GList trueNegative;
-	shmea::GList falsePositive;
-	shmea::GList falseNegative;
+	std::vector<uint64_t> truePositive;
+	std::vector<uint64_t> trueNegative;
+	std::vector<uint64_t> falsePositive;
+	std::vector<uint64_t> falseNegative;
 
 public:
 	CMatrix();
@@ -40,10 +48,19 @@ public:
 
 	// sets
 	void build(unsigned int);
+	void addResult(unsigned int, unsigned int);
 	void addResult(const shmea::GList&);
+	void addResults(const float*, const float*, unsigned int);
+	void merge(const CMatrix&);
+	void copy(const CMatrix&);
+	void swap(CMatrix&);
 	void updateResultParams();
 
 	// gets
+	static int argmax(const float*, unsigned int);
+	unsigned int size() const;
+	uint64_t getCount(unsigned int, unsigned int) const;
+	uint64_t getTotal() const;
 	shmea::GTable getMatrix() const;
 	float getClassAccuracy(unsigned int) const;
 	float getOverallAccuracy() const;
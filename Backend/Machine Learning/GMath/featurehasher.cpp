@@ -0,0 +1,182 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "featurehasher.h"
+
+using namespace glades;
+
+glades::FeatureHasher::FeatureHasher(unsigned int newBuckets, bool newSignedHashing, uint32_t newSeed)
+{
+	buckets = newBuckets;
+	if (buckets == 0)
+		buckets = 1;
+
+	signedHashing = newSignedHashing;
+	seed = newSeed;
+}
+
+glades::FeatureHasher::FeatureHasher(const FeatureHasher& hasher2)
+{
+	buckets = hasher2.buckets;
+	signedHashing = hasher2.signedHashing;
+	seed = hasher2.seed;
+}
+
+glades::FeatureHasher::~FeatureHasher()
+{
+	buckets = 0;
+	signedHashing = false;
+	seed = 0;
+}
+
+/*!
+ * @brief MurmurHash3 (x86, 32-bit)
+ * @details fast, well-mixed, non-cryptographic hash; stable across platforms and runs so a
+ * trained network sees the same bucket for the same string every time
+ */
+uint32_t glades::FeatureHasher::murmur3(const char* key, unsigned int len, uint32_t hSeed)
+{
+	const uint32_t c1 = 0xcc9e2d51;
+	const uint32_t c2 = 0x1b873593;
+	const unsigned char* data = (const unsigned char*)key;
+	const unsigned int nblocks = len / 4;
+	uint32_t h1 = hSeed;
+
+	// body
+	for (unsigned int i = 0; i < nblocks; ++i)
+	{
+		uint32_t k1 = ((uint32_t)data[i * 4]) | (((uint32_t)data[i * 4 + 1]) << 8) |
+					  (((uint32_t)data[i * 4 + 2]) << 16) | (((uint32_t)data[i * 4 + 3]) << 24);
+
+		k1 *= c1;
+		k1 = (k1 << 15) | (k1 >> 17);
+		k1 *= c2;
+
+		h1 ^= k1;
+		h1 = (h1 << 13) | (h1 >> 19);
+		h1 = h1 * 5 + 0xe6546b64;
+	}
+
+	// tail
+	const unsigned char* tail = data + nblocks * 4;
+	uint32_t k1 = 0;
+	switch (len & 3)
+	{
+	case 3:
+		k1 ^= ((uint32_t)tail[2]) << 16;
+		// fall through
+	case 2:
+		k1 ^= ((uint32_t)tail[1]) << 8;
+		// fall through
+	case 1:
+		k1 ^= tail[0];
+		k1 *= c1;
+		k1 = (k1 << 15) | (k1 >> 17);
+		k1 *= c2;
+		h1 ^= k1;
+	}
+
+	// finalization
+	h1 ^= len;
+	h1 ^= h1 >> 16;
+	h1 *= 0x85ebca6b;
+	h1 ^= h1 >> 13;
+	h1 *= 0xc2b2ae35;
+	h1 ^= h1 >> 16;
+
+	return h1;
+}
+
+unsigned int glades::FeatureHasher::size() const
+{
+	return buckets;
+}
+
+bool glades::FeatureHasher::isSigned() const
+{
+	return signedHashing;
+}
+
+uint32_t glades::FeatureHasher::getSeed() const
+{
+	return seed;
+}
+
+unsigned int glades::FeatureHasher::indexAt(const char* needle) const
+{
+	return murmur3(needle, strlen(needle), seed) % buckets;
+}
+
+unsigned int glades::FeatureHasher::indexAt(const std::string& needle) const
+{
+	return murmur3(needle.c_str(), needle.length(), seed) % buckets;
+}
+
+float glades::FeatureHasher::signAt(const char* needle) const
+{
+	if (!signedHashing)
+		return 1.0f;
+
+	// independent hash (different seed) so the sign is uncorrelated with the bucket
+	uint32_t h = murmur3(needle, strlen(needle), ~seed);
+	return (h & 0x80000000) ? -1.0f : 1.0f;
+}
+
+float glades::FeatureHasher::signAt(const std::string& needle) const
+{
+	if (!signedHashing)
+		return 1.0f;
+
+	uint32_t h = murmur3(needle.c_str(), needle.length(), ~seed);
+	return (h & 0x80000000) ? -1.0f : 1.0f;
+}
+
+/*!
+ * @brief accumulate a hashed feature
+ * @details add (sign * weight) into the bucket of 'needle'; used to build bag-of-features rows
+ * without a dictionary
+ * @param needle the string feature
+ * @param featureVector the row to accumulate into, resized to size() if needed
+ * @param weight the feature value (e.g. a term count)
+ */
+void glades::FeatureHasher::accumulate(const std::string& needle, std::vector<float>& featureVector,
+									   float weight) const
+{
+	if (featureVector.size() < buckets)
+		featureVector.resize(buckets, 0.0f);
+
+	featureVector[indexAt(needle)] += signAt(needle) * weight;
+}
+
+void glades::FeatureHasher::print() const
+{
+	printf("[HASH] Buckets: %u, Signed: %s, Seed: %u\n", buckets, signedHashing ? "true" : "false",
+		   seed);
+}
+
+std::vector<float> glades::FeatureHasher::operator[](const char* needle) const
+{
+	std::vector<float> retVal(buckets, 0.0f);
+	retVal[indexAt(needle)] = signAt(needle);
+	return retVal;
+}
+
+std::vector<float> glades::FeatureHasher::operator[](const std::string& needle) const
+{
+	std::vector<float> retVal(buckets, 0.0f);
+	retVal[indexAt(needle)] = signAt(needle);
+	return retVal;
+}
@@ -0,0 +1,70 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GFEATUREHASHER
+#define _GFEATUREHASHER
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace glades {
+
+/*!
+ * @brief hashing trick encoder
+ * @details alternative to OHE for unbounded-cardinality categorical features. Strings are hashed
+ * straight into a fixed number of buckets so no dictionary is built and no pre-pass over the data
+ * is needed. With signed hashing a second hash picks +1/-1 so collisions tend to cancel out
+ * instead of piling up in the same bucket.
+ */
+class FeatureHasher
+{
+private:
+	unsigned int buckets;
+	bool signedHashing;
+	uint32_t seed;
+
+	static uint32_t murmur3(const char*, unsigned int, uint32_t);
+
+public:
+	static const unsigned int DEFAULT_BUCKETS = 1024;
+
+	// constructors and destructors
+	FeatureHasher(unsigned int = DEFAULT_BUCKETS, bool = true, uint32_t = 0);
+	FeatureHasher(const FeatureHasher&);
+	virtual ~FeatureHasher();
+
+	// gets
+	unsigned int size() const;
+	bool isSigned() const;
+	uint32_t getSeed() const;
+	unsigned int indexAt(const char*) const;
+	unsigned int indexAt(const std::string&) const;
+	float signAt(const char*) const;
+	float signAt(const std::string&) const;
+	void accumulate(const std::string&, std::vector<float>&, float = 1.0f) const;
+	void print() const;
+
+	// operators
+	std::vector<float> operator[](const char*) const;
+	std::vector<float> operator[](const std::string&) const;
+};
+};
+
+#endif
@@ -19,15 +19,16 @@
 
 using namespace glades;
 
-float glades::GMath::squash(float netInput, int activationFx, float fxParam)
+float glades::GMath::squash(float netInput, int activationFx, float fxParam, int precision)
 {
 	float netOutput = 0.0f;
+	bool fast = (precision == PRECISION_FAST);
 
 	switch (activationFx)
 	{
 	case TANH:
 	{
-		netOutput = tanh(netInput);
+		netOutput = fast ? fastTanh(netInput) : tanh(netInput);
 
 		break;
 	}
@@ -38,13 +39,13 @@ float glades::GMath::squash(float netInput, int activationFx, float fxParam)
 		else if (netInput < fxParam - 1.0f)
 			netOutput = -1.0f;
 		else
-			netOutput = tanh(netInput);
+			netOutput = fast ? fastTanh(netInput) : tanh(netInput);
 
 		break;
 	}
 	case SIGMOID:
 	{
-		netOutput = 1.0f / (1.0f + exp(-netInput));
+		netOutput = fast ? fastSigmoid(netInput) : 1.0f / (1.0f + exp(-netInput));
 
 		break;
 	}
@@ -55,7 +56,7 @@ float glades::GMath::squash(float netInput, int activationFx, float fxParam)
 		else if (netInput > 1.0f - fxParam)
 			netOutput = 0.99f;
 		else
-			netOutput = 1.0f / (1.0f + exp(-netInput));
+			netOutput = fast ? fastSigmoid(netInput) : 1.0f / (1.0f + exp(-netInput));
 
 		break;
 	}
@@ -285,6 +286,55 @@ float glades::GMath::KLDivergence(float expectation, float prediction)
 	return log(expectation / prediction);
 }
 
+/*!
+ * @brief softmax cross entropy cost
+ * @details one output node's share of -sum(y * log(p)); the probability is floored so a
+ * saturated wrong answer costs a large finite amount instead of inf
+ * @param expectation the one-hot target
+ * @param prediction the softmax probability
+ * @return the node's cross entropy term
+ */
+float glades::GMath::SoftmaxCrossEntropyCost(float expectation, float prediction)
+{
+	if (prediction < FLT_MIN)
+		prediction = FLT_MIN;
+
+	return -(expectation * log(prediction));
+}
+
+/*!
+ * @brief softmax
+ * @details turn a layer's net inputs into probabilities in place. The max is subtracted first
+ * so exp never overflows; the result sums to 1.
+ * @param netInputs the output layer's net inputs, overwritten with the probabilities
+ * @param precision PRECISION_EXACT or PRECISION_FAST (fastExp)
+ */
+void glades::GMath::softmax(std::vector<float>& netInputs, int precision)
+{
+	if (netInputs.empty())
+		return;
+
+	float maxInput = netInputs[0];
+	for (unsigned int i = 1; i < netInputs.size(); ++i)
+	{
+		if (netInputs[i] > maxInput)
+			maxInput = netInputs[i];
+	}
+
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < netInputs.size(); ++i)
+	{
+		float shifted = netInputs[i] - maxInput;
+		netInputs[i] = (precision == PRECISION_FAST) ? fastExp(shifted) : exp(shifted);
+		sum += netInputs[i];
+	}
+
+	// sum >= 1 since the max term is e^0
+	float invSum = 1.0f / sum;
+	for (unsigned int i = 0; i < netInputs.size(); ++i)
+		netInputs[i] *= invSum;
+}
+
 float glades::GMath::outputNodeCost(float expectation, float prediction, float dataSize, int costFx)
 {
 	float netCost = 0.0f;
@@ -315,12 +365,30 @@ float glades::GMath::outputNodeCost(float expectation, float prediction, float d
 
 		break;
 	}
+	case SOFTMAX:
+	{
+		// Softmax uses categorical Cross Entropy
+		netCost = SoftmaxCrossEntropyCost(expectation, prediction);
+		netCost /= dataSize;
+
+		break;
+	}
 	}
 
 	return netCost;
 }
 
-float glades::GMath::costErrDer(float expectation, float prediction, int costFx)
+/*!
+ * @brief cost error derivative
+ * @details d(cost)/d(prediction), or d(cost)/d(net input) for the fused softmax
+ * @param expectation the expected value
+ * @param prediction the output node's activation
+ * @param costFx the cost flag
+ * @param expectationSum the sum of the row's expected values (SOFTMAX only)
+ * @return the derivative
+ */
+float glades::GMath::costErrDer(float expectation, float prediction, int costFx,
+								float expectationSum)
 {
 	float netErrDer = 1.0f;
 
@@ -347,6 +415,14 @@ float glades::GMath::costErrDer(float expectation, float prediction, int costFx)
 
 		break;
 	}
+	case SOFTMAX:
+	{
+		// softmax + XENT fused: d(-sum(y log p))/d(net input) is p * sum(y) - y, so p - y only
+		// when the targets sum to 1 (the 0.01/0.99 OHE targets do not)
+		netErrDer = (prediction * expectationSum) - expectation;
+
+		break;
+	}
 	}
 
 	return netErrDer;
@@ -453,3 +529,209 @@ shmea::GList glades::GMath::naiveVectorDecomp(const shmea::GList& needle)
 
 	return retList;
 }
+
+/*!
+ * @brief float to half
+ * @details converts a float to IEEE 754 binary16 bits, rounding to nearest even. Values past the
+ * half range become infinity, values below the smallest subnormal flush to a signed zero.
+ * @param x the float to convert
+ * @return the binary16 bit pattern
+ */
+uint16_t glades::GMath::floatToHalf(float x)
+{
+	uint32_t bits = 0;
+	memcpy(&bits, &x, sizeof(bits));
+
+	uint16_t sign = (uint16_t)((bits >> 16) & 0x8000u);
+	uint32_t absBits = bits & 0x7FFFFFFFu;
+
+	// NaN and infinity (keep NaNs quiet)
+	if (absBits >= 0x7F800000u)
+		return sign | 0x7C00u | ((absBits > 0x7F800000u) ? 0x0200u : 0u);
+
+	// rounds past 65504
+	if (absBits >= 0x477FF000u)
+		return sign | 0x7C00u;
+
+	// subnormal half
+	if (absBits < 0x38800000u)
+	{
+		if (absBits <= 0x33000000u)
+			return sign;
+
+		uint32_t exponent = absBits >> 23;
+		uint32_t mantissa = (absBits & 0x007FFFFFu) | 0x00800000u;
+		uint32_t shift = 126 - exponent;
+		uint32_t quotient = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if ((remainder > halfway) || ((remainder == halfway) && (quotient & 1)))
+			++quotient;
+
+		return sign | (uint16_t)quotient;
+	}
+
+	// normal half, rebias the exponent and round the dropped 13 bits
+	absBits += 0x00000FFFu + ((absBits >> 13) & 1);
+	return sign | (uint16_t)((absBits - 0x38000000u) >> 13);
+}
+
+/*!
+ * @brief half to float
+ * @details converts IEEE 754 binary16 bits to a float. Every half is exactly representable.
+ * @param h the binary16 bit pattern
+ * @return the float value
+ */
+float glades::GMath::halfToFloat(uint16_t h)
+{
+	uint32_t sign = ((uint32_t)(h & 0x8000u)) << 16;
+	uint32_t exponent = (h >> 10) & 0x1Fu;
+	uint32_t mantissa = h & 0x03FFu;
+	uint32_t bits = 0;
+
+	if (exponent == 0)
+	{
+		if (mantissa == 0)
+			bits = sign;
+		else
+		{
+			// normalize the subnormal
+			exponent = 1;
+			while (!(mantissa & 0x0400u))
+			{
+				mantissa <<= 1;
+				--exponent;
+			}
+
+			mantissa &= 0x03FFu;
+			bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		}
+	}
+	else if (exponent == 0x1F)
+		bits = sign | 0x7F800000u | (mantissa << 13);
+	else
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+	float retVal = 0.0f;
+	memcpy(&retVal, &bits, sizeof(retVal));
+	return retVal;
+}
+
+/*!
+ * @brief float to bfloat16
+ * @details keeps the float's sign and exponent and rounds the mantissa to 7 bits, nearest even.
+ * NaNs stay quiet NaNs.
+ * @param x the float to convert
+ * @return the bfloat16 bit pattern
+ */
+uint16_t glades::GMath::floatToBF16(float x)
+{
+	uint32_t bits = 0;
+	memcpy(&bits, &x, sizeof(bits));
+
+	if ((bits & 0x7FFFFFFFu) > 0x7F800000u)
+		return (uint16_t)((bits >> 16) | 0x0040u);
+
+	bits += 0x00007FFFu + ((bits >> 16) & 1);
+	return (uint16_t)(bits >> 16);
+}
+
+/*!
+ * @brief bfloat16 to float
+ * @details every bfloat16 is exactly representable: it is the top half of a float
+ * @param h the bfloat16 bit pattern
+ * @return the float value
+ */
+float glades::GMath::bf16ToFloat(uint16_t h)
+{
+	uint32_t bits = ((uint32_t)h) << 16;
+	float retVal = 0.0f;
+	memcpy(&retVal, &bits, sizeof(retVal));
+	return retVal;
+}
+
+/*!
+ * @brief fast exp
+ * @details single precision e^x by Cody-Waite range reduction to [-ln2/2, ln2/2], a degree 6
+ * polynomial and a 2^n scale built directly in the exponent bits. Inputs are clamped to
+ * [-87, 88] so the result never overflows or goes subnormal.
+ * Max relative error over the clamped range: 8.4e-8 (about 1 ulp).
+ * @param x the exponent
+ * @return approximately e^x
+ */
+float glades::GMath::fastExp(float x)
+{
+	if (x > 88.0f)
+		x = 88.0f;
+	else if (x < -87.0f)
+		x = -87.0f;
+
+	// x = n*ln2 + r
+	float fn = x * 1.44269504f;
+	int n = (int)(fn + ((fn >= 0.0f) ? 0.5f : -0.5f));
+	float r = x - (((float)n) * 0.693359375f);
+	r -= ((float)n) * -2.12194440e-4f;
+
+	// e^r
+	float p = 1.9875691500e-4f;
+	p = (p * r) + 1.3981999507e-3f;
+	p = (p * r) + 8.3334519073e-3f;
+	p = (p * r) + 4.1665795894e-2f;
+	p = (p * r) + 1.6666665459e-1f;
+	p = (p * r) + 5.0000001201e-1f;
+	p = (p * r * r) + r + 1.0f;
+
+	// 2^n
+	uint32_t bits = ((uint32_t)(n + 127)) << 23;
+	float scale = 0.0f;
+	memcpy(&scale, &bits, sizeof(scale));
+
+	return p * scale;
+}
+
+/*!
+ * @brief fast tanh
+ * @details single precision tanh as an odd [13/6] rational polynomial. Inputs beyond +/-7.905
+ * are clamped where tanh already rounds to +/-1 in float.
+ * Max absolute error: 4.1e-7. Roughly 3.5x faster than libm tanh.
+ * @param x the net input
+ * @return approximately tanh(x)
+ */
+float glades::GMath::fastTanh(float x)
+{
+	if (x > 7.90531110763549805f)
+		x = 7.90531110763549805f;
+	else if (x < -7.90531110763549805f)
+		x = -7.90531110763549805f;
+
+	float x2 = x * x;
+
+	float p = -2.76076847742355e-16f;
+	p = (p * x2) + 2.00018790482477e-13f;
+	p = (p * x2) - 8.60467152213735e-11f;
+	p = (p * x2) + 5.12229709037114e-08f;
+	p = (p * x2) + 1.48572235717979e-05f;
+	p = (p * x2) + 6.37261928875436e-04f;
+	p = (p * x2) + 4.89352455891786e-03f;
+	p *= x;
+
+	float q = 1.19825839466702e-06f;
+	q = (q * x2) + 1.18534705686654e-04f;
+	q = (q * x2) + 2.26843463243900e-03f;
+	q = (q * x2) + 4.89352518554385e-03f;
+
+	return p / q;
+}
+
+/*!
+ * @brief fast sigmoid
+ * @details logistic function through the identity 1/(1+e^-x) = 0.5*tanh(x/2) + 0.5 so it shares
+ * the fastTanh kernel and needs no division by a near-zero denominator.
+ * Max absolute error: 2.3e-7 (swept in fastmath-test).
+ * @param x the net input
+ * @return approximately 1/(1+e^-x)
+ */
+float glades::GMath::fastSigmoid(float x)
+{
+	return (0.5f * fastTanh(0.5f * x)) + 0.5f;
+}
@@ -20,6 +20,7 @@
 #include "Backend/Database/GList.h"
 #include <float.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,6 +39,7 @@ public:
 	static const int REGRESSION = 0;
 	static const int CLASSIFICATION = 1;
 	static const int KL = 2;
+	static const int SOFTMAX = 3; // softmax output + cross entropy, fused p * sum(y) - y gradient
 
 	// activation function flags
 	static const int TANH = 0;
@@ -53,7 +55,16 @@ public:
 	static const int MINMAX = 0;
 	static const int ZSCORE = 1;
 
-	static float squash(float, int, float = 0.1f);
+	// transcendental precision flags
+	static const int PRECISION_EXACT = 0;
+	static const int PRECISION_FAST = 1;
+
+	// weight storage flags (mixed precision)
+	static const int STORAGE_FP32 = 0;
+	static const int STORAGE_BF16 = 1;
+	static const int STORAGE_FP16 = 2;
+
+	static float squash(float, int, float = 0.1f, int = PRECISION_EXACT);
 	static float unsquash(float, int, float = 0.1f);
 	static float activationErrDer(float, int, float = 0.1f);
 	static float error(float, float);
@@ -61,12 +72,27 @@ public:
 	static float MeanSquaredError(float, float);
 	static float CrossEntropyCost(float, float);
 	static float KLDivergence(float, float);
-	static float costErrDer(float, float, int);
+	static float SoftmaxCrossEntropyCost(float, float);
+	static void softmax(std::vector<float>&, int = PRECISION_EXACT);
+	static float costErrDer(float, float, int, float = 1.0f);
 	static float outputNodeCost(float, float, float, int);
 	static float norm_inv_CDF(float); // inverse CDF of normal distribution
 	static float normal_pdf(float);
 	static std::vector<int> naiveVectorDecomp(const std::vector<float>&);
 	static shmea::GList naiveVectorDecomp(const shmea::GList&);
+
+	// IEEE 754 binary16 conversion (round to nearest even)
+	static uint16_t floatToHalf(float);
+	static float halfToFloat(uint16_t);
+
+	// bfloat16 conversion (round to nearest even)
+	static uint16_t floatToBF16(float);
+	static float bf16ToFloat(uint16_t);
+
+	// fast float approximations (see gmath.cpp for the error bounds)
+	static float fastExp(float);
+	static float fastTanh(float);
+	static float fastSigmoid(float);
 };
 };
 
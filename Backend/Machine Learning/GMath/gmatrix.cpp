@@ -0,0 +1,394 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "gmatrix.h"
+#include "kernels.h"
+#include "reduction.h"
+
+using namespace glades;
+
+unsigned int glades::GMatrix::threadCount = 1;
+
+// One thread's share of C = A B: rows [rowStart, rowEnd)
+struct GemmTask
+{
+	const GMatrix* A;
+	const GMatrix* B;
+	GMatrix* C;
+	unsigned int rowStart;
+	unsigned int rowEnd;
+};
+
+static void gemmBlocked(const GMatrix& A, const GMatrix& B, GMatrix& C, unsigned int rowStart,
+						unsigned int rowEnd)
+{
+	const Kernels::Table& kernels = Kernels::get();
+	unsigned int K = A.numberOfCols();
+	unsigned int N = B.numberOfCols();
+	for (unsigned int kk = 0; kk < K; kk += GMatrix::BLOCK_K)
+	{
+		unsigned int kc = (K - kk < GMatrix::BLOCK_K) ? K - kk : GMatrix::BLOCK_K;
+		for (unsigned int jj = 0; jj < N; jj += GMatrix::BLOCK_N)
+		{
+			unsigned int nc = (N - jj < GMatrix::BLOCK_N) ? N - jj : GMatrix::BLOCK_N;
+			kernels.gemm(A.row(rowStart) + kk, B.row(kk) + jj, C.row(rowStart) + jj,
+						 rowEnd - rowStart, nc, kc, A.stride(), B.stride(), C.stride());
+		}
+	}
+}
+
+static void* gemmWorker(void* y)
+{
+	GemmTask* task = (GemmTask*)y;
+	gemmBlocked(*task->A, *task->B, *task->C, task->rowStart, task->rowEnd);
+	return NULL;
+}
+
+glades::GMatrix::GMatrix()
+{
+	nRows = 0;
+	nCols = 0;
+	ld = 0;
+	values = NULL;
+}
+
+glades::GMatrix::GMatrix(unsigned int newRows, unsigned int newCols, float value)
+{
+	values = NULL;
+	allocate(newRows, newCols);
+	fill(value);
+}
+
+glades::GMatrix::GMatrix(const GMatrix& other)
+{
+	values = NULL;
+	allocate(other.nRows, other.nCols);
+	if (values)
+		memcpy(values, other.values, nRows * ld * sizeof(float));
+}
+
+GMatrix& glades::GMatrix::operator=(const GMatrix& other)
+{
+	if (this == &other)
+		return *this;
+
+	if ((nRows != other.nRows) || (nCols != other.nCols))
+		allocate(other.nRows, other.nCols);
+
+	if (values)
+		memcpy(values, other.values, nRows * ld * sizeof(float));
+
+	return *this;
+}
+
+glades::GMatrix::~GMatrix()
+{
+	release();
+}
+
+void glades::GMatrix::allocate(unsigned int newRows, unsigned int newCols)
+{
+	release();
+	nRows = newRows;
+	nCols = newCols;
+	ld = ((newCols + ROW_PAD - 1) / ROW_PAD) * ROW_PAD;
+	if ((nRows == 0) || (ld == 0))
+		return;
+
+	void* block = NULL;
+	if (posix_memalign(&block, ALIGNMENT, nRows * ld * sizeof(float)) != 0)
+	{
+		printf("[MATH] Unable to allocate a %ux%u matrix\n", nRows, nCols);
+		nRows = 0;
+		nCols = 0;
+		ld = 0;
+		return;
+	}
+
+	// padding stays zero so whole rows can be fed to the kernels
+	values = (float*)block;
+	memset(values, 0, nRows * ld * sizeof(float));
+}
+
+void glades::GMatrix::release()
+{
+	if (values)
+		free(values);
+	values = NULL;
+	nRows = 0;
+	nCols = 0;
+	ld = 0;
+}
+
+unsigned int glades::GMatrix::numberOfRows() const
+{
+	return nRows;
+}
+
+unsigned int glades::GMatrix::numberOfCols() const
+{
+	return nCols;
+}
+
+/*!
+ * @brief stride
+ * @details distance between the starts of two rows, in floats
+ * @return the padded row length
+ */
+unsigned int glades::GMatrix::stride() const
+{
+	return ld;
+}
+
+bool glades::GMatrix::empty() const
+{
+	return (nRows == 0) || (nCols == 0);
+}
+
+float* glades::GMatrix::data()
+{
+	return values;
+}
+
+const float* glades::GMatrix::data() const
+{
+	return values;
+}
+
+float* glades::GMatrix::row(unsigned int r)
+{
+	return values + (r * ld);
+}
+
+const float* glades::GMatrix::row(unsigned int r) const
+{
+	return values + (r * ld);
+}
+
+float& glades::GMatrix::operator()(unsigned int r, unsigned int c)
+{
+	return values[(r * ld) + c];
+}
+
+float glades::GMatrix::operator()(unsigned int r, unsigned int c) const
+{
+	return values[(r * ld) + c];
+}
+
+GMatrix glades::GMatrix::transpose() const
+{
+	GMatrix retMatrix(nCols, nRows);
+	for (unsigned int r = 0; r < nRows; ++r)
+	{
+		const float* src = row(r);
+		for (unsigned int c = 0; c < nCols; ++c)
+			retMatrix(c, r) = src[c];
+	}
+
+	return retMatrix;
+}
+
+void glades::GMatrix::print() const
+{
+	for (unsigned int r = 0; r < nRows; ++r)
+	{
+		for (unsigned int c = 0; c < nCols; ++c)
+			printf("%f ", (*this)(r, c));
+		printf("\n");
+	}
+}
+
+/*!
+ * @brief resize
+ * @details reshape; the contents are zeroed and the block is kept when the shape is unchanged
+ * @param newRows the row count
+ * @param newCols the column count
+ */
+void glades::GMatrix::resize(unsigned int newRows, unsigned int newCols)
+{
+	// same shape: keep the block, just clear it
+	if ((values) && (nRows == newRows) && (nCols == newCols))
+	{
+		memset(values, 0, nRows * ld * sizeof(float));
+		return;
+	}
+
+	allocate(newRows, newCols);
+}
+
+void glades::GMatrix::fill(float value)
+{
+	for (unsigned int r = 0; r < nRows; ++r)
+	{
+		float* dst = row(r);
+		for (unsigned int c = 0; c < nCols; ++c)
+			dst[c] = value;
+	}
+}
+
+void glades::GMatrix::setIdentity()
+{
+	fill(0.0f);
+	for (unsigned int i = 0; (i < nRows) && (i < nCols); ++i)
+		(*this)(i, i) = 1.0f;
+}
+
+void glades::GMatrix::scale(float factor)
+{
+	for (unsigned int r = 0; r < nRows; ++r)
+	{
+		float* dst = row(r);
+		for (unsigned int c = 0; c < nCols; ++c)
+			dst[c] *= factor;
+	}
+}
+
+void glades::GMatrix::clear()
+{
+	release();
+}
+
+/*!
+ * @brief multiply
+ * @details C = A B (or C += A B), cache blocked over K and N with the register blocked kernel
+ * inside each block. Large products are split by rows across getThreads() threads; the bands
+ * start on 4 row boundaries so each row takes the same kernel path for any thread count.
+ * @param A the left matrix (M x K)
+ * @param B the right matrix (K x N)
+ * @param C the result (resized to M x N unless accumulating)
+ * @param accumulate add into C instead of overwriting it
+ */
+void glades::GMatrix::multiply(const GMatrix& A, const GMatrix& B, GMatrix& C, bool accumulate)
+{
+	if (A.nCols != B.nRows)
+	{
+		printf("[MATH] Matrix shape mismatch: (%u,%u) x (%u,%u)\n", A.nRows, A.nCols, B.nRows,
+			   B.nCols);
+		return;
+	}
+
+	if ((!accumulate) || (C.nRows != A.nRows) || (C.nCols != B.nCols))
+		C.resize(A.nRows, B.nCols);
+
+	if ((A.empty()) || (B.empty()))
+		return;
+
+	unsigned int M = A.nRows;
+	unsigned int threads = threadCount;
+	double flops = ((double)M) * ((double)B.nCols) * ((double)A.nCols);
+	if (flops < THREAD_MIN_FLOPS)
+		threads = 1;
+	if (threads > M)
+		threads = M;
+
+	if (threads <= 1)
+	{
+		gemmBlocked(A, B, C, 0, M);
+		return;
+	}
+
+	// Each thread gets a contiguous band of rows (a multiple of 4 for the kernel)
+	unsigned int band = (((M + threads - 1) / threads) + 3) & ~3u;
+	pthread_t* workers = new pthread_t[threads];
+	GemmTask* tasks = new GemmTask[threads];
+	unsigned int launched = 0;
+	for (unsigned int start = 0; start < M; start += band)
+	{
+		GemmTask& task = tasks[launched];
+		task.A = &A;
+		task.B = &B;
+		task.C = &C;
+		task.rowStart = start;
+		task.rowEnd = (start + band < M) ? start + band : M;
+		if (launched == threads - 1)
+			task.rowEnd = M;
+
+		if (pthread_create(&workers[launched], NULL, gemmWorker, &task) != 0)
+			gemmWorker(&task); // run it here instead
+		else
+			++launched;
+
+		if (task.rowEnd == M)
+			break;
+	}
+
+	for (unsigned int i = 0; i < launched; ++i)
+		pthread_join(workers[i], NULL);
+
+	delete[] workers;
+	delete[] tasks;
+}
+
+/*!
+ * @brief multiply vector
+ * @details y = A x
+ * @param A the matrix (M x N)
+ * @param x N values
+ * @param y M values, overwritten
+ */
+void glades::GMatrix::multiplyVector(const GMatrix& A, const float* x, float* y)
+{
+	if (A.empty())
+		return;
+
+	Kernels::get().gemv(A.values, x, y, A.nRows, A.nCols, A.ld);
+}
+
+/*!
+ * @brief multiply transpose vector
+ * @details y = A^T x, without forming the transpose
+ * @param A the matrix (M x N)
+ * @param x M values
+ * @param y N values, overwritten
+ */
+void glades::GMatrix::multiplyTransposeVector(const GMatrix& A, const float* x, float* y)
+{
+	if (A.empty())
+		return;
+
+	memset(y, 0, A.nCols * sizeof(float));
+	Kernels::get().gemvT(A.values, x, y, A.nRows, A.nCols, A.ld);
+}
+
+/*!
+ * @brief dot
+ * @details x . y on the calling thread, in the current Reduction mode. The forward pass calls this
+ * once per node per row, far too often to start threads for; products thread by rows in
+ * multiply() instead.
+ * @param x n values
+ * @param y n values
+ * @param n the element count
+ * @return the dot product
+ */
+float glades::GMatrix::dot(const float* x, const float* y, unsigned int n)
+{
+	return Reduction::dot(x, y, n, 1);
+}
+
+/*!
+ * @brief set threads
+ * @details how many threads large products may use (1 = single threaded, the default)
+ * @param newThreadCount the thread count
+ */
+void glades::GMatrix::setThreads(unsigned int newThreadCount)
+{
+	threadCount = (newThreadCount > 0) ? newThreadCount : 1;
+}
+
+unsigned int glades::GMatrix::getThreads()
+{
+	return threadCount;
+}
@@ -0,0 +1,98 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GMATRIX
+#define _GMATRIX
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace glades {
+
+/*!
+ * @brief dense matrix
+ * @details row major float matrix on 64 byte aligned storage. Each row is padded to a multiple
+ * of 16 floats (stride) so rows start on a cache line and the SIMD kernels never split one.
+ * The products are cache blocked on top of the runtime selected Kernels and can split their
+ * rows across threads.
+ */
+class GMatrix
+{
+private:
+
+	unsigned int nRows;
+	unsigned int nCols;
+	unsigned int ld;
+	float* values;
+
+	static unsigned int threadCount;
+
+	void allocate(unsigned int, unsigned int);
+	void release();
+
+public:
+
+	static const unsigned int ALIGNMENT = 64;
+	static const unsigned int ROW_PAD = 16;
+
+	// cache blocking: a KC x NC panel of B stays in L2 while the rows of A stream past it
+	static const unsigned int BLOCK_K = 256;
+	static const unsigned int BLOCK_N = 512;
+
+	// below this many multiply-adds a product stays on the calling thread
+	static const unsigned int THREAD_MIN_FLOPS = 1 << 18;
+
+	GMatrix();
+	GMatrix(unsigned int, unsigned int, float = 0.0f);
+	GMatrix(const GMatrix&);
+	GMatrix& operator=(const GMatrix&);
+	virtual ~GMatrix();
+
+	// gets
+	unsigned int numberOfRows() const;
+	unsigned int numberOfCols() const;
+	unsigned int stride() const;
+	bool empty() const;
+	float* data();
+	const float* data() const;
+	float* row(unsigned int);
+	const float* row(unsigned int) const;
+	float& operator()(unsigned int, unsigned int);
+	float operator()(unsigned int, unsigned int) const;
+	GMatrix transpose() const;
+	void print() const;
+
+	// sets
+	void resize(unsigned int, unsigned int);
+	void fill(float);
+	void setIdentity();
+	void scale(float);
+	void clear();
+
+	// products
+	static void multiply(const GMatrix&, const GMatrix&, GMatrix&, bool = false);
+	static void multiplyVector(const GMatrix&, const float*, float*);
+	static void multiplyTransposeVector(const GMatrix&, const float*, float*);
+	static float dot(const float*, const float*, unsigned int);
+
+	static void setThreads(unsigned int);
+	static unsigned int getThreads();
+};
+};
+
+#endif
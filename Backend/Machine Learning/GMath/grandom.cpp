@@ -0,0 +1,246 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "grandom.h"
+#include "gmath.h"
+#include <sys/time.h>
+#include <math.h>
+
+using namespace glades;
+
+pthread_once_t glades::GRandom::normalOnce = PTHREAD_ONCE_INIT;
+pthread_once_t glades::GRandom::localOnce = PTHREAD_ONCE_INIT;
+pthread_key_t glades::GRandom::localKey;
+float glades::GRandom::normalStrips[glades::GRandom::NORMAL_STRIPS + 1];
+
+static inline uint64_t rotl(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+glades::GRandom::GRandom(uint64_t newSeed)
+{
+	seed(newSeed);
+}
+
+/*!
+ * @brief splitmix64
+ * @details advance a splitmix64 state and return its next output
+ * @param x the state
+ * @return 64 random bits
+ */
+uint64_t glades::GRandom::splitmix64(uint64_t& x)
+{
+	x += 0x9E3779B97F4A7C15ULL;
+	uint64_t z = x;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/*!
+ * @brief for sample
+ * @details the stream for one sample of a seeded run; nearby indices give unrelated streams
+ * @param runSeed the run seed
+ * @param sampleIndex the sample (row) index
+ * @return the sample's generator
+ */
+GRandom glades::GRandom::forSample(uint64_t runSeed, uint64_t sampleIndex)
+{
+	uint64_t key = runSeed;
+	uint64_t mixedSeed = splitmix64(key);
+	key = mixedSeed ^ sampleIndex;
+	return GRandom(splitmix64(key));
+}
+
+void glades::GRandom::makeLocalKey()
+{
+	pthread_key_create(&localKey, &freeLocal);
+}
+
+void glades::GRandom::freeLocal(void* y)
+{
+	delete (GRandom*)y;
+}
+
+/*!
+ * @brief local
+ * @details the calling thread's own stream, seeded from the clock and the thread on first use
+ * @return the thread's generator
+ */
+GRandom& glades::GRandom::local()
+{
+	pthread_once(&localOnce, &makeLocalKey);
+	GRandom* rng = (GRandom*)pthread_getspecific(localKey);
+	if (!rng)
+	{
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		uint64_t newSeed = (((uint64_t)now.tv_sec) << 20) ^ ((uint64_t)now.tv_usec);
+		newSeed ^= (uint64_t)(uintptr_t)pthread_self();
+		rng = new GRandom(newSeed);
+		pthread_setspecific(localKey, rng);
+	}
+
+	return *rng;
+}
+
+void glades::GRandom::seed(uint64_t newSeed)
+{
+	uint64_t x = newSeed;
+	for (unsigned int i = 0; i < 4; ++i)
+		s[i] = splitmix64(x);
+}
+
+uint64_t glades::GRandom::next()
+{
+	const uint64_t result = rotl(s[1] * 5, 7) * 9;
+	const uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+
+	return result;
+}
+
+/*!
+ * @brief next float
+ * @return a uniform float in [0, 1)
+ */
+float glades::GRandom::nextFloat()
+{
+	// top 24 bits fill the float mantissa exactly
+	return ((float)(next() >> 40)) * (1.0f / 16777216.0f);
+}
+
+/*!
+ * @brief next below
+ * @param bound the exclusive upper bound
+ * @return a uniform integer in [0, bound)
+ */
+unsigned int glades::GRandom::nextBelow(unsigned int bound)
+{
+	if (bound == 0)
+		return 0;
+
+	// multiply-shift keeps the high bits and avoids the modulo bias of rand() % bound
+	return (unsigned int)(((next() >> 32) * (uint64_t)bound) >> 32);
+}
+
+/*!
+ * @brief build normal table
+ * @details the half normal cut into NORMAL_STRIPS strips of equal probability; strip i spans
+ * [normalStrips[i + 1], normalStrips[i]] and strip 0 is the tail
+ */
+void glades::GRandom::buildNormalTable()
+{
+	float normal_CDF = 1.0;
+	for (unsigned int i = 1; i < NORMAL_STRIPS; i++)
+	{
+		normal_CDF = normal_CDF - (1 / ((float)NORMAL_STRIPS * 2));
+		normalStrips[i] = GMath::norm_inv_CDF(normal_CDF);
+	}
+	normalStrips[0] = normalStrips[1];
+	normalStrips[NORMAL_STRIPS] = 0;
+}
+
+/*!
+ * @brief next normal
+ * @details standard normal sample: pick a strip, then rejection sample inside it against the
+ * pdf (the tail beyond the last strip, about 3.5 sigma, is not drawn)
+ * @return the sample
+ */
+float glades::GRandom::nextNormal()
+{
+	pthread_once(&normalOnce, &buildNormalTable);
+	while (true)
+	{
+		uint64_t bits = next();
+		unsigned int strip = 1 + (unsigned int)(((bits >> 32) * (NORMAL_STRIPS - 1)) >> 32);
+		float low = normalStrips[strip + 1];
+		float high = normalStrips[strip];
+		float x = low + nextFloat() * (high - low);
+		float u = ((float)((bits >> 8) & 0xFFFFFF)) * (1.0f / 16777216.0f);
+		if (u * GMath::normal_pdf(low) <= GMath::normal_pdf(x))
+			return (bits & 1) ? -x : x;
+	}
+}
+
+/*!
+ * @brief fill uniform
+ * @param values the output, n uniform floats in [0, 1)
+ * @param n the count
+ */
+void glades::GRandom::fillUniform(float* values, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 1 < n; i += 2)
+	{
+		// two 24 bit draws per 64 bit output
+		uint64_t bits = next();
+		values[i] = ((float)(bits >> 40)) * (1.0f / 16777216.0f);
+		values[i + 1] = ((float)((bits >> 8) & 0xFFFFFF)) * (1.0f / 16777216.0f);
+	}
+
+	if (i < n)
+		values[i] = nextFloat();
+}
+
+/*!
+ * @brief fill bernoulli
+ * @details set each of the first n flags with probability p, two 32 bit integer compares per
+ * 64 bit draw (no division or float math per flag)
+ * @param flags the output (grown to n if needed)
+ * @param n the count
+ * @param p the probability of true
+ * @return the number of flags left false
+ */
+unsigned int glades::GRandom::fillBernoulli(std::vector<bool>& flags, unsigned int n, float p)
+{
+	if (flags.size() < n)
+		flags.resize(n, false);
+
+	uint64_t threshold = (uint64_t)(((double)p) * 4294967296.0);
+	if (p <= 0.0f)
+		threshold = 0;
+	else if (p >= 1.0f)
+		threshold = 0x100000000ULL;
+
+	unsigned int kept = 0;
+	unsigned int i = 0;
+	for (; i + 1 < n; i += 2)
+	{
+		uint64_t bits = next();
+		bool first = (bits >> 32) < threshold;
+		bool second = (bits & 0xFFFFFFFFULL) < threshold;
+		flags[i] = first;
+		flags[i + 1] = second;
+		kept += (!first) + (!second);
+	}
+
+	if (i < n)
+	{
+		bool last = (next() >> 32) < threshold;
+		flags[i] = last;
+		kept += !last;
+	}
+
+	return kept;
+}
@@ -0,0 +1,69 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GRANDOM
+#define _GRANDOM
+
+#include <pthread.h>
+#include <stdint.h>
+#include <vector>
+
+namespace glades {
+
+/*!
+ * @brief random stream
+ * @details xoshiro256** generator seeded through splitmix64. Streams carry their own state, so
+ * each network (and each thread, through local()) draws without the global lock of rand().
+ * A stream is a pure function of its seed: work that is split across threads draws from
+ * forSample(seed, sampleIndex) so each sample sees the same numbers whichever thread handles it.
+ */
+class GRandom
+{
+private:
+	uint64_t s[4];
+
+	static pthread_once_t normalOnce;
+	static pthread_once_t localOnce;
+	static pthread_key_t localKey;
+	static float normalStrips[];
+
+	static void buildNormalTable();
+	static void makeLocalKey();
+	static void freeLocal(void*);
+
+public:
+	// equal probability strips of the half normal used by nextNormal
+	static const unsigned int NORMAL_STRIPS = 2048;
+
+	GRandom(uint64_t = 0);
+
+	static uint64_t splitmix64(uint64_t&);
+	static GRandom forSample(uint64_t, uint64_t);
+	static GRandom& local();
+
+	void seed(uint64_t);
+	uint64_t next();
+	float nextFloat();
+	unsigned int nextBelow(unsigned int);
+	float nextNormal();
+
+	// bulk
+	void fillUniform(float*, unsigned int);
+	unsigned int fillBernoulli(std::vector<bool>&, unsigned int, float);
+};
+};
+
+#endif
@@ -0,0 +1,290 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "halfmatrix.h"
+#include "gmath.h"
+#include "gmatrix.h"
+#include "kernels.h"
+
+using namespace glades;
+
+glades::HalfMatrix::HalfMatrix()
+{
+	nRows = 0;
+	nCols = 0;
+	ld = 0;
+	format = GMath::STORAGE_BF16;
+	values = NULL;
+}
+
+glades::HalfMatrix::HalfMatrix(unsigned int newRows, unsigned int newCols, int newFormat)
+{
+	values = NULL;
+	format = GMath::STORAGE_BF16;
+	resize(newRows, newCols, newFormat);
+}
+
+glades::HalfMatrix::HalfMatrix(const HalfMatrix& other)
+{
+	values = NULL;
+	format = other.format;
+	allocate(other.nRows, other.nCols);
+	if (values)
+		memcpy(values, other.values, nRows * ld * sizeof(uint16_t));
+}
+
+HalfMatrix& glades::HalfMatrix::operator=(const HalfMatrix& other)
+{
+	if (this == &other)
+		return *this;
+
+	if ((nRows != other.nRows) || (nCols != other.nCols))
+		allocate(other.nRows, other.nCols);
+
+	format = other.format;
+	if (values)
+		memcpy(values, other.values, nRows * ld * sizeof(uint16_t));
+
+	return *this;
+}
+
+glades::HalfMatrix::~HalfMatrix()
+{
+	release();
+}
+
+void glades::HalfMatrix::allocate(unsigned int newRows, unsigned int newCols)
+{
+	release();
+	nRows = newRows;
+	nCols = newCols;
+	ld = ((newCols + ROW_PAD - 1) / ROW_PAD) * ROW_PAD;
+	if ((nRows == 0) || (ld == 0))
+		return;
+
+	void* block = NULL;
+	if (posix_memalign(&block, ALIGNMENT, nRows * ld * sizeof(uint16_t)) != 0)
+	{
+		printf("[MATH] Unable to allocate a %ux%u half matrix\n", nRows, nCols);
+		nRows = 0;
+		nCols = 0;
+		ld = 0;
+		return;
+	}
+
+	// zero is +0 in both formats
+	values = (uint16_t*)block;
+	memset(values, 0, nRows * ld * sizeof(uint16_t));
+}
+
+void glades::HalfMatrix::release()
+{
+	if (values)
+		free(values);
+	values = NULL;
+	nRows = 0;
+	nCols = 0;
+	ld = 0;
+}
+
+unsigned int glades::HalfMatrix::numberOfRows() const
+{
+	return nRows;
+}
+
+unsigned int glades::HalfMatrix::numberOfCols() const
+{
+	return nCols;
+}
+
+unsigned int glades::HalfMatrix::stride() const
+{
+	return ld;
+}
+
+int glades::HalfMatrix::getFormat() const
+{
+	return format;
+}
+
+bool glades::HalfMatrix::empty() const
+{
+	return (nRows == 0) || (nCols == 0);
+}
+
+const uint16_t* glades::HalfMatrix::row(unsigned int r) const
+{
+	return values + (r * ld);
+}
+
+/*!
+ * @brief get
+ * @param r the row
+ * @param c the column
+ * @return the stored value widened to float
+ */
+float glades::HalfMatrix::get(unsigned int r, unsigned int c) const
+{
+	uint16_t h = values[(r * ld) + c];
+	if (format == GMath::STORAGE_FP16)
+		return GMath::halfToFloat(h);
+
+	return GMath::bf16ToFloat(h);
+}
+
+/*!
+ * @brief unpack row
+ * @param r the row
+ * @param x nCols floats to receive the row
+ */
+void glades::HalfMatrix::unpackRow(unsigned int r, float* x) const
+{
+	const Kernels::Table& kernels = Kernels::get();
+	if (format == GMath::STORAGE_FP16)
+		kernels.unpackFP16(row(r), x, nCols);
+	else
+		kernels.unpackBF16(row(r), x, nCols);
+}
+
+/*!
+ * @brief unpack
+ * @param dest resized to this matrix's shape and filled with the widened values
+ */
+void glades::HalfMatrix::unpack(GMatrix& dest) const
+{
+	dest.resize(nRows, nCols);
+	for (unsigned int r = 0; r < nRows; ++r)
+		unpackRow(r, dest.row(r));
+}
+
+/*!
+ * @brief resize
+ * @details clears the contents
+ * @param newRows the row count
+ * @param newCols the column count
+ * @param newFormat GMath::STORAGE_FP16 or GMath::STORAGE_BF16; anything else stores bfloat16
+ */
+void glades::HalfMatrix::resize(unsigned int newRows, unsigned int newCols, int newFormat)
+{
+	format = (newFormat == GMath::STORAGE_FP16) ? GMath::STORAGE_FP16 : GMath::STORAGE_BF16;
+	if ((values) && (nRows == newRows) && (nCols == newCols))
+	{
+		memset(values, 0, nRows * ld * sizeof(uint16_t));
+		return;
+	}
+
+	allocate(newRows, newCols);
+}
+
+/*!
+ * @brief set
+ * @param r the row
+ * @param c the column
+ * @param value rounded to the storage format
+ */
+void glades::HalfMatrix::set(unsigned int r, unsigned int c, float value)
+{
+	if (format == GMath::STORAGE_FP16)
+		values[(r * ld) + c] = GMath::floatToHalf(value);
+	else
+		values[(r * ld) + c] = GMath::floatToBF16(value);
+}
+
+/*!
+ * @brief pack row
+ * @param r the row
+ * @param x nCols floats to round into the row
+ */
+void glades::HalfMatrix::packRow(unsigned int r, const float* x)
+{
+	const Kernels::Table& kernels = Kernels::get();
+	uint16_t* dest = values + (r * ld);
+	if (format == GMath::STORAGE_FP16)
+		kernels.packFP16(x, dest, nCols);
+	else
+		kernels.packBF16(x, dest, nCols);
+}
+
+/*!
+ * @brief pack
+ * @param src the fp32 matrix to round
+ * @param newFormat GMath::STORAGE_FP16 or GMath::STORAGE_BF16
+ */
+void glades::HalfMatrix::pack(const GMatrix& src, int newFormat)
+{
+	resize(src.numberOfRows(), src.numberOfCols(), newFormat);
+	for (unsigned int r = 0; r < nRows; ++r)
+		packRow(r, src.row(r));
+}
+
+void glades::HalfMatrix::clear()
+{
+	release();
+}
+
+/*!
+ * @brief dot row
+ * @param r the row
+ * @param x nCols floats
+ * @return row r . x, accumulated in float
+ */
+float glades::HalfMatrix::dotRow(unsigned int r, const float* x) const
+{
+	const Kernels::Table& kernels = Kernels::get();
+	if (format == GMath::STORAGE_FP16)
+		return kernels.dotFP16(row(r), x, nCols);
+
+	return kernels.dotBF16(row(r), x, nCols);
+}
+
+/*!
+ * @brief dot row indexed
+ * @details the dot over a subset of the columns, e.g. the inputs that survived dropout
+ * @param r the row
+ * @param cols the n columns to read
+ * @param n the number of columns
+ * @param x n floats, x[k] goes with column cols[k]
+ * @return sum of row r's cols[k] entry times x[k], accumulated in float
+ */
+float glades::HalfMatrix::dotRowIndexed(unsigned int r, const unsigned int* cols, unsigned int n,
+										const float* x) const
+{
+	const uint16_t* rowValues = row(r);
+	float sum = 0.0f;
+	if (format == GMath::STORAGE_FP16)
+	{
+		for (unsigned int k = 0; k < n; ++k)
+			sum += GMath::halfToFloat(rowValues[cols[k]]) * x[k];
+	}
+	else
+	{
+		for (unsigned int k = 0; k < n; ++k)
+			sum += GMath::bf16ToFloat(rowValues[cols[k]]) * x[k];
+	}
+
+	return sum;
+}
+
+/*!
+ * @brief multiply vector
+ * @param x nCols floats
+ * @param y nRows floats to receive this * x
+ */
+void glades::HalfMatrix::multiplyVector(const float* x, float* y) const
+{
+	for (unsigned int r = 0; r < nRows; ++r)
+		y[r] = dotRow(r, x);
+}
@@ -0,0 +1,85 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _HALFMATRIX
+#define _HALFMATRIX
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace glades {
+
+class GMatrix;
+
+/*!
+ * @brief half precision matrix
+ * @details row major matrix of 16 bit values, either binary16 (GMath::STORAGE_FP16) or bfloat16
+ * (GMath::STORAGE_BF16), on 64 byte aligned rows padded to 32 values. It holds the compact copy
+ * of weights whose fp32 master copy lives elsewhere: values are rounded to nearest even on the
+ * way in, and products widen them back to float and accumulate in float.
+ */
+class HalfMatrix
+{
+private:
+
+	unsigned int nRows;
+	unsigned int nCols;
+	unsigned int ld;
+	int format;
+	uint16_t* values;
+
+	void allocate(unsigned int, unsigned int);
+	void release();
+
+public:
+
+	static const unsigned int ALIGNMENT = 64;
+	static const unsigned int ROW_PAD = 32;
+
+	HalfMatrix();
+	HalfMatrix(unsigned int, unsigned int, int);
+	HalfMatrix(const HalfMatrix&);
+	HalfMatrix& operator=(const HalfMatrix&);
+	virtual ~HalfMatrix();
+
+	// gets
+	unsigned int numberOfRows() const;
+	unsigned int numberOfCols() const;
+	unsigned int stride() const;
+	int getFormat() const;
+	bool empty() const;
+	const uint16_t* row(unsigned int) const;
+	float get(unsigned int, unsigned int) const;
+	void unpackRow(unsigned int, float*) const;
+	void unpack(GMatrix&) const;
+
+	// sets
+	void resize(unsigned int, unsigned int, int);
+	void set(unsigned int, unsigned int, float);
+	void packRow(unsigned int, const float*);
+	void pack(const GMatrix&, int);
+	void clear();
+
+	// products
+	float dotRow(unsigned int, const float*) const;
+	float dotRowIndexed(unsigned int, const unsigned int*, unsigned int, const float*) const;
+	void multiplyVector(const float*, float*) const;
+};
+};
+
+#endif
@@ -0,0 +1,230 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "kernels.h"
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+using namespace glades;
+
+pthread_once_t glades::Kernels::initOnce = PTHREAD_ONCE_INIT;
+const Kernels::Table* glades::Kernels::active = NULL;
+
+static Kernels::Table tables[4];
+static bool available[4] = {false, false, false, false};
+
+#if defined(__x86_64__) || defined(__i386__)
+// XCR0: which register states the OS saves on a context switch
+static uint64_t readXCR0()
+{
+	uint32_t eax = 0;
+	uint32_t edx = 0;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return (((uint64_t)edx) << 32) | eax;
+}
+#endif
+
+/*!
+ * @brief detect ISA
+ * @details the widest instruction set both the CPU and the OS (saved register state) support
+ * @return one of the ISA_* flags
+ */
+int glades::Kernels::detectISA()
+{
+	int isa = ISA_SCALAR;
+
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return isa;
+
+	if (edx & bit_SSE2)
+		isa = ISA_SSE2;
+
+	// AVX needs the OS to save the ymm state
+	bool hasFMA = (ecx & bit_FMA) != 0;
+	bool hasF16C = (ecx & bit_F16C) != 0;
+	if (!((ecx & bit_OSXSAVE) && (ecx & bit_AVX)))
+		return isa;
+
+	uint64_t xcr0 = readXCR0();
+	if ((xcr0 & 0x6) != 0x6)
+		return isa;
+
+	if (__get_cpuid_max(0, NULL) < 7)
+		return isa;
+
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	if ((ebx & bit_AVX2) && (hasFMA) && (hasF16C))
+		isa = ISA_AVX2;
+
+	// AVX-512 also needs the opmask and zmm state saved
+	if ((isa == ISA_AVX2) && (ebx & bit_AVX512F) && ((xcr0 & 0xE6) == 0xE6))
+		isa = ISA_AVX512;
+#endif
+
+	return isa;
+}
+
+/*!
+ * @brief init
+ * @details load every compiled kernel table and activate the best one the machine runs,
+ * capped by GLADES_ISA if it is set
+ */
+void glades::Kernels::init()
+{
+	int cpuISA = detectISA();
+	available[ISA_SCALAR] = loadScalar(tables[ISA_SCALAR]);
+	available[ISA_SSE2] = (cpuISA >= ISA_SSE2) && loadSSE2(tables[ISA_SSE2]);
+	available[ISA_AVX2] = (cpuISA >= ISA_AVX2) && loadAVX2(tables[ISA_AVX2]);
+	available[ISA_AVX512] = (cpuISA >= ISA_AVX512) && loadAVX512(tables[ISA_AVX512]);
+	for (int i = ISA_SSE2; i <= ISA_AVX512; ++i)
+	{
+		if (available[i])
+			inheritScalar(tables[i]);
+	}
+
+	int maxISA = ISA_AVX512;
+	const char* envISA = getenv("GLADES_ISA");
+	if (envISA)
+	{
+		for (int i = ISA_SCALAR; i <= ISA_AVX512; ++i)
+		{
+			if (strcmp(envISA, isaName(i)) == 0)
+				maxISA = i;
+		}
+	}
+
+	for (int i = maxISA; i >= ISA_SCALAR; --i)
+	{
+		if (available[i])
+		{
+			active = &tables[i];
+			break;
+		}
+	}
+
+	printf("[MATH] Kernels: %s\n", active->name);
+}
+
+/*!
+ * @brief inherit scalar
+ * @details point the entries an ISA has no better kernel for at the scalar ones
+ * @param table the table to complete
+ */
+void glades::Kernels::inheritScalar(Table& table)
+{
+	const Table& scalar = tables[ISA_SCALAR];
+	if (!table.packFP16)
+		table.packFP16 = scalar.packFP16;
+	if (!table.unpackFP16)
+		table.unpackFP16 = scalar.unpackFP16;
+	if (!table.dotFP16)
+		table.dotFP16 = scalar.dotFP16;
+	if (!table.packBF16)
+		table.packBF16 = scalar.packBF16;
+	if (!table.unpackBF16)
+		table.unpackBF16 = scalar.unpackBF16;
+	if (!table.dotBF16)
+		table.dotBF16 = scalar.dotBF16;
+}
+
+/*!
+ * @brief get kernels
+ * @details the active kernel table; the first call detects the CPU
+ * @return the active table
+ */
+const Kernels::Table& glades::Kernels::get()
+{
+	pthread_once(&initOnce, init);
+	return *active;
+}
+
+/*!
+ * @brief get kernel table
+ * @details a specific ISA's table, e.g. to compare paths
+ * @param isa one of the ISA_* flags
+ * @return the table, or NULL if it was not compiled in or the machine can't run it
+ */
+const Kernels::Table* glades::Kernels::getTable(int isa)
+{
+	pthread_once(&initOnce, init);
+	if ((isa < ISA_SCALAR) || (isa > ISA_AVX512) || (!available[isa]))
+		return NULL;
+
+	return &tables[isa];
+}
+
+/*!
+ * @brief get ISA
+ * @details which kernel path is active
+ * @return one of the ISA_* flags
+ */
+int glades::Kernels::getISA()
+{
+	return get().isa;
+}
+
+/*!
+ * @brief get ISA name
+ * @details which kernel path is active
+ * @return "scalar", "sse2", "avx2" or "avx512"
+ */
+const char* glades::Kernels::getISAName()
+{
+	return get().name;
+}
+
+/*!
+ * @brief set ISA
+ * @details force a kernel path; call before any training starts
+ * @param isa one of the ISA_* flags
+ * @return false if that path is not available here
+ */
+bool glades::Kernels::setISA(int isa)
+{
+	const Table* table = getTable(isa);
+	if (!table)
+		return false;
+
+	active = table;
+	return true;
+}
+
+/*!
+ * @brief ISA name
+ * @param isa one of the ISA_* flags
+ * @return the flag's name
+ */
+const char* glades::Kernels::isaName(int isa)
+{
+	switch (isa)
+	{
+	case ISA_SCALAR:
+		return "scalar";
+	case ISA_SSE2:
+		return "sse2";
+	case ISA_AVX2:
+		return "avx2";
+	case ISA_AVX512:
+		return "avx512";
+	}
+
+	return "unknown";
+}
@@ -0,0 +1,108 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GKERNELS
+#define _GKERNELS
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace glades {
+
+/*!
+ * @brief dense kernels
+ * @details dot/axpy/GEMV/GEMM/sum, the fast tanh activation and fp16/bf16 weight conversions,
+ * built once per instruction set
+ * (each kernels_*.cpp gets its own compiler flags) and picked at startup from cpuid, so one
+ * binary runs on any x86-64 and still uses AVX2/AVX-512 where the CPU and OS support it.
+ * Matrices are row major with explicit leading dimensions (row strides, in floats).
+ * Setting GLADES_ISA=scalar|sse2|avx2|avx512 caps the selection.
+ */
+class Kernels
+{
+public:
+	static const int ISA_SCALAR = 0;
+	static const int ISA_SSE2 = 1;
+	static const int ISA_AVX2 = 2;
+	static const int ISA_AVX512 = 3;
+
+	// x . y
+	typedef float (*DotFx)(const float*, const float*, unsigned int);
+	// y += a * x
+	typedef void (*AxpyFx)(float, const float*, float*, unsigned int);
+	// y = A x (rows x cols, lda) and y += A^T x
+	typedef void (*GemvFx)(const float*, const float*, float*, unsigned int, unsigned int,
+						   unsigned int);
+	// C += A B: A is M x K (lda), B is K x N (ldb), C is M x N (ldc)
+	typedef void (*GemmFx)(const float*, const float*, float*, unsigned int, unsigned int,
+						   unsigned int, unsigned int, unsigned int, unsigned int);
+	// sum of x
+	typedef float (*SumFx)(const float*, unsigned int);
+	// x = GMath::fastTanh(x) in place
+	typedef void (*MapFx)(float*, unsigned int);
+	// float <-> 16 bit storage (binary16 or bfloat16), round to nearest even
+	typedef void (*PackFx)(const float*, uint16_t*, unsigned int);
+	typedef void (*UnpackFx)(const uint16_t*, float*, unsigned int);
+	// w . x with w in 16 bit storage
+	typedef float (*DotHalfFx)(const uint16_t*, const float*, unsigned int);
+
+	struct Table
+	{
+		int isa;
+		const char* name;
+		DotFx dot;
+		AxpyFx axpy;
+		GemvFx gemv;
+		GemvFx gemvT;
+		GemmFx gemm;
+		SumFx sum;
+		MapFx fastTanh;
+		PackFx packFP16;
+		UnpackFx unpackFP16;
+		DotHalfFx dotFP16;
+		PackFx packBF16;
+		UnpackFx unpackBF16;
+		DotHalfFx dotBF16;
+	};
+
+	static const Table& get();
+	static const Table* getTable(int);
+	static int getISA();
+	static const char* getISAName();
+	static int detectISA();
+	static bool setISA(int);
+	static const char* isaName(int);
+
+private:
+	static pthread_once_t initOnce;
+	static const Table* active;
+
+	static void init();
+	static void inheritScalar(Table&);
+
+	// one per kernels_*.cpp; false when that ISA was not compiled in. Entries a load leaves NULL
+	// fall back to the scalar kernel.
+	static bool loadScalar(Table&);
+	static bool loadSSE2(Table&);
+	static bool loadAVX2(Table&);
+	static bool loadAVX512(Table&);
+};
+};
+
+#endif
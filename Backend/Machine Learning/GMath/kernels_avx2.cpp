@@ -0,0 +1,404 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "kernels.h"
+
+// AVX2 path: 8 floats per register, fused multiply-add, F16C half conversions.
+// Built with its own ISA flags: include only headers without inline code, or the linker may
+// hand another translation unit a copy that uses these instructions.
+
+#if defined(__AVX2__) && defined(__FMA__) && defined(__F16C__)
+#include <immintrin.h>
+
+using namespace glades;
+
+static inline float hsum(__m256 v)
+{
+	__m128 sums = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	__m128 shuf = _mm_movehdup_ps(sums);
+	sums = _mm_add_ps(sums, shuf);
+	shuf = _mm_movehl_ps(shuf, sums);
+	sums = _mm_add_ss(sums, shuf);
+	return _mm_cvtss_f32(sums);
+}
+
+static inline void toFP16(const float* x, uint16_t* h)
+{
+	__m128i v = _mm256_cvtps_ph(_mm256_loadu_ps(x), _MM_FROUND_TO_NEAREST_INT);
+	_mm_storeu_si128((__m128i*)h, v);
+}
+
+static inline __m256 fromFP16(const uint16_t* h)
+{
+	return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)h));
+}
+
+// x + 0x7FFF + lsb rounds to nearest even, NaNs keep a quiet bit
+static inline void toBF16(const float* x, uint16_t* h)
+{
+	const __m256i absMask = _mm256_set1_epi32(0x7FFFFFFF);
+	const __m256i inf = _mm256_set1_epi32(0x7F800000);
+	__m256i b = _mm256_castps_si256(_mm256_loadu_ps(x));
+	__m256i lsb = _mm256_and_si256(_mm256_srli_epi32(b, 16), _mm256_set1_epi32(1));
+	__m256i r = _mm256_add_epi32(b, _mm256_add_epi32(_mm256_set1_epi32(0x7FFF), lsb));
+	r = _mm256_srai_epi32(r, 16);
+	__m256i qnan = _mm256_or_si256(_mm256_srai_epi32(b, 16), _mm256_set1_epi32(0x40));
+	__m256i isNaN = _mm256_cmpgt_epi32(_mm256_and_si256(b, absMask), inf);
+	r = _mm256_blendv_epi8(r, qnan, isNaN);
+
+	// lanes are sign extended, so the saturating pack only narrows
+	__m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+	_mm_storeu_si128((__m128i*)h, packed);
+}
+
+static inline __m256 fromBF16(const uint16_t* h)
+{
+	__m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)h));
+	return _mm256_castsi256_ps(_mm256_slli_epi32(v, 16));
+}
+
+static float dotAVX2(const float* x, const float* y, unsigned int n)
+{
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	unsigned int i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), acc0);
+		acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8), acc1);
+	}
+	for (; i + 8 <= n; i += 8)
+		acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), acc0);
+
+	float sum = hsum(_mm256_add_ps(acc0, acc1));
+	for (; i < n; ++i)
+		sum += x[i] * y[i];
+
+	return sum;
+}
+
+static void axpyAVX2(float a, const float* x, float* y, unsigned int n)
+{
+	__m256 va = _mm256_set1_ps(a);
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256 vy = _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i));
+		_mm256_storeu_ps(y + i, vy);
+	}
+
+	for (; i < n; ++i)
+		y[i] += a * x[i];
+}
+
+static void gemvAVX2(const float* A, const float* x, float* y, unsigned int rows,
+					 unsigned int cols, unsigned int lda)
+{
+	for (unsigned int r = 0; r < rows; ++r)
+		y[r] = dotAVX2(A + (r * lda), x, cols);
+}
+
+static void gemvTAVX2(const float* A, const float* x, float* y, unsigned int rows,
+					  unsigned int cols, unsigned int lda)
+{
+	for (unsigned int r = 0; r < rows; ++r)
+		axpyAVX2(x[r], A + (r * lda), y, cols);
+}
+
+// Register blocked: four rows of C stay in registers across the whole K loop, each B vector is
+// loaded once per four rows
+static void gemmAVX2(const float* A, const float* B, float* C, unsigned int M,
+					 unsigned int N, unsigned int K, unsigned int lda, unsigned int ldb,
+					 unsigned int ldc)
+{
+	unsigned int i = 0;
+	for (; i + 4 <= M; i += 4)
+	{
+		const float* a0 = A + (i * lda);
+		const float* a1 = a0 + lda;
+		const float* a2 = a1 + lda;
+		const float* a3 = a2 + lda;
+		float* c0 = C + (i * ldc);
+		float* c1 = c0 + ldc;
+		float* c2 = c1 + ldc;
+		float* c3 = c2 + ldc;
+
+		unsigned int j = 0;
+		for (; j + 8 <= N; j += 8)
+		{
+			__m256 s0 = _mm256_loadu_ps(c0 + j);
+			__m256 s1 = _mm256_loadu_ps(c1 + j);
+			__m256 s2 = _mm256_loadu_ps(c2 + j);
+			__m256 s3 = _mm256_loadu_ps(c3 + j);
+			for (unsigned int k = 0; k < K; ++k)
+			{
+				__m256 b = _mm256_loadu_ps(B + (k * ldb) + j);
+				s0 = _mm256_fmadd_ps(_mm256_set1_ps(a0[k]), b, s0);
+				s1 = _mm256_fmadd_ps(_mm256_set1_ps(a1[k]), b, s1);
+				s2 = _mm256_fmadd_ps(_mm256_set1_ps(a2[k]), b, s2);
+				s3 = _mm256_fmadd_ps(_mm256_set1_ps(a3[k]), b, s3);
+			}
+			_mm256_storeu_ps(c0 + j, s0);
+			_mm256_storeu_ps(c1 + j, s1);
+			_mm256_storeu_ps(c2 + j, s2);
+			_mm256_storeu_ps(c3 + j, s3);
+		}
+
+		// leftover columns
+		for (; j < N; ++j)
+		{
+			float s0 = c0[j], s1 = c1[j], s2 = c2[j], s3 = c3[j];
+			for (unsigned int k = 0; k < K; ++k)
+			{
+				float b = B[(k * ldb) + j];
+				s0 += a0[k] * b;
+				s1 += a1[k] * b;
+				s2 += a2[k] * b;
+				s3 += a3[k] * b;
+			}
+			c0[j] = s0;
+			c1[j] = s1;
+			c2[j] = s2;
+			c3[j] = s3;
+		}
+	}
+
+	// leftover rows
+	for (; i < M; ++i)
+	{
+		for (unsigned int k = 0; k < K; ++k)
+			axpyAVX2(A[(i * lda) + k], B + (k * ldb), C + (i * ldc), N);
+	}
+}
+
+static float sumAVX2(const float* x, unsigned int n)
+{
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	unsigned int i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(x + i));
+		acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(x + i + 8));
+	}
+	for (; i + 8 <= n; i += 8)
+		acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(x + i));
+
+	float sum = hsum(_mm256_add_ps(acc0, acc1));
+	for (; i < n; ++i)
+		sum += x[i];
+
+	return sum;
+}
+
+// Same operations in the same order as GMath::fastTanh, so every lane matches the scalar result
+// bit for bit as long as the compiler doesn't fuse them (CMake passes -ffp-contract=off)
+static inline __m256 tanhAVX2(__m256 x)
+{
+	const __m256 clampHi = _mm256_set1_ps(7.90531110763549805f);
+	const __m256 clampLo = _mm256_set1_ps(-7.90531110763549805f);
+	x = _mm256_min_ps(clampHi, _mm256_max_ps(clampLo, x));
+	__m256 x2 = _mm256_mul_ps(x, x);
+
+	__m256 p = _mm256_set1_ps(-2.76076847742355e-16f);
+	p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(2.00018790482477e-13f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(-8.60467152213735e-11f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(5.12229709037114e-08f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(1.48572235717979e-05f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(6.37261928875436e-04f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(4.89352455891786e-03f));
+	p = _mm256_mul_ps(p, x);
+
+	__m256 q = _mm256_set1_ps(1.19825839466702e-06f);
+	q = _mm256_add_ps(_mm256_mul_ps(q, x2), _mm256_set1_ps(1.18534705686654e-04f));
+	q = _mm256_add_ps(_mm256_mul_ps(q, x2), _mm256_set1_ps(2.26843463243900e-03f));
+	q = _mm256_add_ps(_mm256_mul_ps(q, x2), _mm256_set1_ps(4.89352518554385e-03f));
+
+	return _mm256_div_ps(p, q);
+}
+
+static void fastTanhAVX2(float* x, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(x + i, tanhAVX2(_mm256_loadu_ps(x + i)));
+
+	// zero padded tail
+	if (i < n)
+	{
+		float tail[8];
+		memset(tail, 0, sizeof(tail));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		_mm256_storeu_ps(tail, tanhAVX2(_mm256_loadu_ps(tail)));
+		memcpy(x + i, tail, (n - i) * sizeof(float));
+	}
+}
+
+static void packFP16AVX2(const float* x, uint16_t* h, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+		toFP16(x + i, h + i);
+
+	// zero padded tail
+	if (i < n)
+	{
+		float tail[8];
+		uint16_t packed[8];
+		memset(tail, 0, sizeof(tail));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		toFP16(tail, packed);
+		memcpy(h + i, packed, (n - i) * sizeof(uint16_t));
+	}
+}
+
+static void unpackFP16AVX2(const uint16_t* h, float* x, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(x + i, fromFP16(h + i));
+
+	if (i < n)
+	{
+		uint16_t packed[8];
+		float tail[8];
+		memset(packed, 0, sizeof(packed));
+		memcpy(packed, h + i, (n - i) * sizeof(uint16_t));
+		_mm256_storeu_ps(tail, fromFP16(packed));
+		memcpy(x + i, tail, (n - i) * sizeof(float));
+	}
+}
+
+static float dotFP16AVX2(const uint16_t* w, const float* x, unsigned int n)
+{
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	unsigned int i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		acc0 = _mm256_fmadd_ps(fromFP16(w + i), _mm256_loadu_ps(x + i), acc0);
+		acc1 = _mm256_fmadd_ps(fromFP16(w + i + 8), _mm256_loadu_ps(x + i + 8), acc1);
+	}
+	for (; i + 8 <= n; i += 8)
+		acc0 = _mm256_fmadd_ps(fromFP16(w + i), _mm256_loadu_ps(x + i), acc0);
+
+	// zero padded tail, both operands
+	if (i < n)
+	{
+		uint16_t packed[8];
+		float tail[8];
+		memset(packed, 0, sizeof(packed));
+		memset(tail, 0, sizeof(tail));
+		memcpy(packed, w + i, (n - i) * sizeof(uint16_t));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		acc1 = _mm256_fmadd_ps(fromFP16(packed), _mm256_loadu_ps(tail), acc1);
+	}
+
+	return hsum(_mm256_add_ps(acc0, acc1));
+}
+
+static void packBF16AVX2(const float* x, uint16_t* h, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+		toBF16(x + i, h + i);
+
+	// zero padded tail
+	if (i < n)
+	{
+		float tail[8];
+		uint16_t packed[8];
+		memset(tail, 0, sizeof(tail));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		toBF16(tail, packed);
+		memcpy(h + i, packed, (n - i) * sizeof(uint16_t));
+	}
+}
+
+static void unpackBF16AVX2(const uint16_t* h, float* x, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(x + i, fromBF16(h + i));
+
+	if (i < n)
+	{
+		uint16_t packed[8];
+		float tail[8];
+		memset(packed, 0, sizeof(packed));
+		memcpy(packed, h + i, (n - i) * sizeof(uint16_t));
+		_mm256_storeu_ps(tail, fromBF16(packed));
+		memcpy(x + i, tail, (n - i) * sizeof(float));
+	}
+}
+
+static float dotBF16AVX2(const uint16_t* w, const float* x, unsigned int n)
+{
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	unsigned int i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		acc0 = _mm256_fmadd_ps(fromBF16(w + i), _mm256_loadu_ps(x + i), acc0);
+		acc1 = _mm256_fmadd_ps(fromBF16(w + i + 8), _mm256_loadu_ps(x + i + 8), acc1);
+	}
+	for (; i + 8 <= n; i += 8)
+		acc0 = _mm256_fmadd_ps(fromBF16(w + i), _mm256_loadu_ps(x + i), acc0);
+
+	// zero padded tail, both operands
+	if (i < n)
+	{
+		uint16_t packed[8];
+		float tail[8];
+		memset(packed, 0, sizeof(packed));
+		memset(tail, 0, sizeof(tail));
+		memcpy(packed, w + i, (n - i) * sizeof(uint16_t));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		acc1 = _mm256_fmadd_ps(fromBF16(packed), _mm256_loadu_ps(tail), acc1);
+	}
+
+	return hsum(_mm256_add_ps(acc0, acc1));
+}
+
+
+bool glades::Kernels::loadAVX2(Table& table)
+{
+	table.isa = ISA_AVX2;
+	table.name = isaName(ISA_AVX2);
+	table.dot = &dotAVX2;
+	table.axpy = &axpyAVX2;
+	table.gemv = &gemvAVX2;
+	table.gemvT = &gemvTAVX2;
+	table.gemm = &gemmAVX2;
+	table.sum = &sumAVX2;
+	table.fastTanh = &fastTanhAVX2;
+	table.packFP16 = &packFP16AVX2;
+	table.unpackFP16 = &unpackFP16AVX2;
+	table.dotFP16 = &dotFP16AVX2;
+	table.packBF16 = &packBF16AVX2;
+	table.unpackBF16 = &unpackBF16AVX2;
+	table.dotBF16 = &dotBF16AVX2;
+	return true;
+}
+
+#else
+
+bool glades::Kernels::loadAVX2(Table& table)
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,399 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "kernels.h"
+
+// AVX-512 path: 16 floats per register, fused multiply-add.
+// Built with its own ISA flags: include only headers without inline code, or the linker may
+// hand another translation unit a copy that uses these instructions.
+
+#if defined(__AVX512F__)
+// GCC 12's AVX-512 intrinsics seed results with self-initialized undefined vectors
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+
+using namespace glades;
+
+static inline float hsum(__m512 v)
+{
+	return _mm512_reduce_add_ps(v);
+}
+
+static inline void toFP16(const float* x, uint16_t* h)
+{
+	__m256i v = _mm512_cvtps_ph(_mm512_loadu_ps(x), _MM_FROUND_TO_NEAREST_INT);
+	_mm256_storeu_si256((__m256i*)h, v);
+}
+
+static inline __m512 fromFP16(const uint16_t* h)
+{
+	return _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)h));
+}
+
+// x + 0x7FFF + lsb rounds to nearest even, NaNs keep a quiet bit
+static inline void toBF16(const float* x, uint16_t* h)
+{
+	const __m512i absMask = _mm512_set1_epi32(0x7FFFFFFF);
+	const __m512i inf = _mm512_set1_epi32(0x7F800000);
+	__m512i b = _mm512_castps_si512(_mm512_loadu_ps(x));
+	__m512i lsb = _mm512_and_si512(_mm512_srli_epi32(b, 16), _mm512_set1_epi32(1));
+	__m512i r = _mm512_add_epi32(b, _mm512_add_epi32(_mm512_set1_epi32(0x7FFF), lsb));
+	r = _mm512_srli_epi32(r, 16);
+	__m512i qnan = _mm512_or_si512(_mm512_srli_epi32(b, 16), _mm512_set1_epi32(0x40));
+	__mmask16 isNaN = _mm512_cmpgt_epi32_mask(_mm512_and_si512(b, absMask), inf);
+	r = _mm512_mask_blend_epi32(isNaN, r, qnan);
+	_mm256_storeu_si256((__m256i*)h, _mm512_cvtepi32_epi16(r));
+}
+
+static inline __m512 fromBF16(const uint16_t* h)
+{
+	__m512i v = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)h));
+	return _mm512_castsi512_ps(_mm512_slli_epi32(v, 16));
+}
+
+static float dotAVX512(const float* x, const float* y, unsigned int n)
+{
+	__m512 acc0 = _mm512_setzero_ps();
+	__m512 acc1 = _mm512_setzero_ps();
+	unsigned int i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), acc0);
+		acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(y + i + 16), acc1);
+	}
+	for (; i + 16 <= n; i += 16)
+		acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), acc0);
+
+	float sum = hsum(_mm512_add_ps(acc0, acc1));
+	for (; i < n; ++i)
+		sum += x[i] * y[i];
+
+	return sum;
+}
+
+static void axpyAVX512(float a, const float* x, float* y, unsigned int n)
+{
+	__m512 va = _mm512_set1_ps(a);
+	unsigned int i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		__m512 vy = _mm512_fmadd_ps(va, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i));
+		_mm512_storeu_ps(y + i, vy);
+	}
+
+	for (; i < n; ++i)
+		y[i] += a * x[i];
+}
+
+static void gemvAVX512(const float* A, const float* x, float* y, unsigned int rows,
+					   unsigned int cols, unsigned int lda)
+{
+	for (unsigned int r = 0; r < rows; ++r)
+		y[r] = dotAVX512(A + (r * lda), x, cols);
+}
+
+static void gemvTAVX512(const float* A, const float* x, float* y, unsigned int rows,
+						unsigned int cols, unsigned int lda)
+{
+	for (unsigned int r = 0; r < rows; ++r)
+		axpyAVX512(x[r], A + (r * lda), y, cols);
+}
+
+// Register blocked: four rows of C stay in registers across the whole K loop, each B vector is
+// loaded once per four rows
+static void gemmAVX512(const float* A, const float* B, float* C, unsigned int M,
+					   unsigned int N, unsigned int K, unsigned int lda, unsigned int ldb,
+					   unsigned int ldc)
+{
+	unsigned int i = 0;
+	for (; i + 4 <= M; i += 4)
+	{
+		const float* a0 = A + (i * lda);
+		const float* a1 = a0 + lda;
+		const float* a2 = a1 + lda;
+		const float* a3 = a2 + lda;
+		float* c0 = C + (i * ldc);
+		float* c1 = c0 + ldc;
+		float* c2 = c1 + ldc;
+		float* c3 = c2 + ldc;
+
+		unsigned int j = 0;
+		for (; j + 16 <= N; j += 16)
+		{
+			__m512 s0 = _mm512_loadu_ps(c0 + j);
+			__m512 s1 = _mm512_loadu_ps(c1 + j);
+			__m512 s2 = _mm512_loadu_ps(c2 + j);
+			__m512 s3 = _mm512_loadu_ps(c3 + j);
+			for (unsigned int k = 0; k < K; ++k)
+			{
+				__m512 b = _mm512_loadu_ps(B + (k * ldb) + j);
+				s0 = _mm512_fmadd_ps(_mm512_set1_ps(a0[k]), b, s0);
+				s1 = _mm512_fmadd_ps(_mm512_set1_ps(a1[k]), b, s1);
+				s2 = _mm512_fmadd_ps(_mm512_set1_ps(a2[k]), b, s2);
+				s3 = _mm512_fmadd_ps(_mm512_set1_ps(a3[k]), b, s3);
+			}
+			_mm512_storeu_ps(c0 + j, s0);
+			_mm512_storeu_ps(c1 + j, s1);
+			_mm512_storeu_ps(c2 + j, s2);
+			_mm512_storeu_ps(c3 + j, s3);
+		}
+
+		// leftover columns
+		for (; j < N; ++j)
+		{
+			float s0 = c0[j], s1 = c1[j], s2 = c2[j], s3 = c3[j];
+			for (unsigned int k = 0; k < K; ++k)
+			{
+				float b = B[(k * ldb) + j];
+				s0 += a0[k] * b;
+				s1 += a1[k] * b;
+				s2 += a2[k] * b;
+				s3 += a3[k] * b;
+			}
+			c0[j] = s0;
+			c1[j] = s1;
+			c2[j] = s2;
+			c3[j] = s3;
+		}
+	}
+
+	// leftover rows
+	for (; i < M; ++i)
+	{
+		for (unsigned int k = 0; k < K; ++k)
+			axpyAVX512(A[(i * lda) + k], B + (k * ldb), C + (i * ldc), N);
+	}
+}
+
+static float sumAVX512(const float* x, unsigned int n)
+{
+	__m512 acc0 = _mm512_setzero_ps();
+	__m512 acc1 = _mm512_setzero_ps();
+	unsigned int i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		acc0 = _mm512_add_ps(acc0, _mm512_loadu_ps(x + i));
+		acc1 = _mm512_add_ps(acc1, _mm512_loadu_ps(x + i + 16));
+	}
+	for (; i + 16 <= n; i += 16)
+		acc0 = _mm512_add_ps(acc0, _mm512_loadu_ps(x + i));
+
+	float sum = hsum(_mm512_add_ps(acc0, acc1));
+	for (; i < n; ++i)
+		sum += x[i];
+
+	return sum;
+}
+
+// Same operations in the same order as GMath::fastTanh, so every lane matches the scalar result
+// bit for bit as long as the compiler doesn't fuse them (CMake passes -ffp-contract=off)
+static inline __m512 tanhAVX512(__m512 x)
+{
+	const __m512 clampHi = _mm512_set1_ps(7.90531110763549805f);
+	const __m512 clampLo = _mm512_set1_ps(-7.90531110763549805f);
+	x = _mm512_min_ps(clampHi, _mm512_max_ps(clampLo, x));
+	__m512 x2 = _mm512_mul_ps(x, x);
+
+	__m512 p = _mm512_set1_ps(-2.76076847742355e-16f);
+	p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(2.00018790482477e-13f));
+	p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(-8.60467152213735e-11f));
+	p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(5.12229709037114e-08f));
+	p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(1.48572235717979e-05f));
+	p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(6.37261928875436e-04f));
+	p = _mm512_add_ps(_mm512_mul_ps(p, x2), _mm512_set1_ps(4.89352455891786e-03f));
+	p = _mm512_mul_ps(p, x);
+
+	__m512 q = _mm512_set1_ps(1.19825839466702e-06f);
+	q = _mm512_add_ps(_mm512_mul_ps(q, x2), _mm512_set1_ps(1.18534705686654e-04f));
+	q = _mm512_add_ps(_mm512_mul_ps(q, x2), _mm512_set1_ps(2.26843463243900e-03f));
+	q = _mm512_add_ps(_mm512_mul_ps(q, x2), _mm512_set1_ps(4.89352518554385e-03f));
+
+	return _mm512_div_ps(p, q);
+}
+
+static void fastTanhAVX512(float* x, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 16 <= n; i += 16)
+		_mm512_storeu_ps(x + i, tanhAVX512(_mm512_loadu_ps(x + i)));
+
+	// zero padded tail
+	if (i < n)
+	{
+		float tail[16];
+		memset(tail, 0, sizeof(tail));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		_mm512_storeu_ps(tail, tanhAVX512(_mm512_loadu_ps(tail)));
+		memcpy(x + i, tail, (n - i) * sizeof(float));
+	}
+}
+
+static void packFP16AVX512(const float* x, uint16_t* h, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 16 <= n; i += 16)
+		toFP16(x + i, h + i);
+
+	// zero padded tail
+	if (i < n)
+	{
+		float tail[16];
+		uint16_t packed[16];
+		memset(tail, 0, sizeof(tail));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		toFP16(tail, packed);
+		memcpy(h + i, packed, (n - i) * sizeof(uint16_t));
+	}
+}
+
+static void unpackFP16AVX512(const uint16_t* h, float* x, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 16 <= n; i += 16)
+		_mm512_storeu_ps(x + i, fromFP16(h + i));
+
+	if (i < n)
+	{
+		uint16_t packed[16];
+		float tail[16];
+		memset(packed, 0, sizeof(packed));
+		memcpy(packed, h + i, (n - i) * sizeof(uint16_t));
+		_mm512_storeu_ps(tail, fromFP16(packed));
+		memcpy(x + i, tail, (n - i) * sizeof(float));
+	}
+}
+
+static float dotFP16AVX512(const uint16_t* w, const float* x, unsigned int n)
+{
+	__m512 acc0 = _mm512_setzero_ps();
+	__m512 acc1 = _mm512_setzero_ps();
+	unsigned int i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		acc0 = _mm512_fmadd_ps(fromFP16(w + i), _mm512_loadu_ps(x + i), acc0);
+		acc1 = _mm512_fmadd_ps(fromFP16(w + i + 16), _mm512_loadu_ps(x + i + 16), acc1);
+	}
+	for (; i + 16 <= n; i += 16)
+		acc0 = _mm512_fmadd_ps(fromFP16(w + i), _mm512_loadu_ps(x + i), acc0);
+
+	// zero padded tail, both operands
+	if (i < n)
+	{
+		uint16_t packed[16];
+		float tail[16];
+		memset(packed, 0, sizeof(packed));
+		memset(tail, 0, sizeof(tail));
+		memcpy(packed, w + i, (n - i) * sizeof(uint16_t));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		acc1 = _mm512_fmadd_ps(fromFP16(packed), _mm512_loadu_ps(tail), acc1);
+	}
+
+	return hsum(_mm512_add_ps(acc0, acc1));
+}
+
+static void packBF16AVX512(const float* x, uint16_t* h, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 16 <= n; i += 16)
+		toBF16(x + i, h + i);
+
+	// zero padded tail
+	if (i < n)
+	{
+		float tail[16];
+		uint16_t packed[16];
+		memset(tail, 0, sizeof(tail));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		toBF16(tail, packed);
+		memcpy(h + i, packed, (n - i) * sizeof(uint16_t));
+	}
+}
+
+static void unpackBF16AVX512(const uint16_t* h, float* x, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 16 <= n; i += 16)
+		_mm512_storeu_ps(x + i, fromBF16(h + i));
+
+	if (i < n)
+	{
+		uint16_t packed[16];
+		float tail[16];
+		memset(packed, 0, sizeof(packed));
+		memcpy(packed, h + i, (n - i) * sizeof(uint16_t));
+		_mm512_storeu_ps(tail, fromBF16(packed));
+		memcpy(x + i, tail, (n - i) * sizeof(float));
+	}
+}
+
+static float dotBF16AVX512(const uint16_t* w, const float* x, unsigned int n)
+{
+	__m512 acc0 = _mm512_setzero_ps();
+	__m512 acc1 = _mm512_setzero_ps();
+	unsigned int i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		acc0 = _mm512_fmadd_ps(fromBF16(w + i), _mm512_loadu_ps(x + i), acc0);
+		acc1 = _mm512_fmadd_ps(fromBF16(w + i + 16), _mm512_loadu_ps(x + i + 16), acc1);
+	}
+	for (; i + 16 <= n; i += 16)
+		acc0 = _mm512_fmadd_ps(fromBF16(w + i), _mm512_loadu_ps(x + i), acc0);
+
+	// zero padded tail, both operands
+	if (i < n)
+	{
+		uint16_t packed[16];
+		float tail[16];
+		memset(packed, 0, sizeof(packed));
+		memset(tail, 0, sizeof(tail));
+		memcpy(packed, w + i, (n - i) * sizeof(uint16_t));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		acc1 = _mm512_fmadd_ps(fromBF16(packed), _mm512_loadu_ps(tail), acc1);
+	}
+
+	return hsum(_mm512_add_ps(acc0, acc1));
+}
+
+
+bool glades::Kernels::loadAVX512(Table& table)
+{
+	table.isa = ISA_AVX512;
+	table.name = isaName(ISA_AVX512);
+	table.dot = &dotAVX512;
+	table.axpy = &axpyAVX512;
+	table.gemv = &gemvAVX512;
+	table.gemvT = &gemvTAVX512;
+	table.gemm = &gemmAVX512;
+	table.sum = &sumAVX512;
+	table.fastTanh = &fastTanhAVX512;
+	table.packFP16 = &packFP16AVX512;
+	table.unpackFP16 = &unpackFP16AVX512;
+	table.dotFP16 = &dotFP16AVX512;
+	table.packBF16 = &packBF16AVX512;
+	table.unpackBF16 = &unpackBF16AVX512;
+	table.dotBF16 = &dotBF16AVX512;
+	return true;
+}
+
+#else
+
+bool glades::Kernels::loadAVX512(Table& table)
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,138 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "kernels.h"
+#include "gmath.h"
+
+using namespace glades;
+
+// Reference path: plain loops, no instruction set assumptions
+
+static float dotScalar(const float* x, const float* y, unsigned int n)
+{
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < n; ++i)
+		sum += x[i] * y[i];
+
+	return sum;
+}
+
+static void axpyScalar(float a, const float* x, float* y, unsigned int n)
+{
+	for (unsigned int i = 0; i < n; ++i)
+		y[i] += a * x[i];
+}
+
+static void gemvScalar(const float* A, const float* x, float* y, unsigned int rows,
+					   unsigned int cols, unsigned int lda)
+{
+	for (unsigned int r = 0; r < rows; ++r)
+		y[r] = dotScalar(A + (r * lda), x, cols);
+}
+
+static void gemvTScalar(const float* A, const float* x, float* y, unsigned int rows,
+						unsigned int cols, unsigned int lda)
+{
+	for (unsigned int r = 0; r < rows; ++r)
+		axpyScalar(x[r], A + (r * lda), y, cols);
+}
+
+static void gemmScalar(const float* A, const float* B, float* C, unsigned int M, unsigned int N,
+					   unsigned int K, unsigned int lda, unsigned int ldb, unsigned int ldc)
+{
+	for (unsigned int i = 0; i < M; ++i)
+	{
+		for (unsigned int k = 0; k < K; ++k)
+			axpyScalar(A[(i * lda) + k], B + (k * ldb), C + (i * ldc), N);
+	}
+}
+
+static float sumScalar(const float* x, unsigned int n)
+{
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < n; ++i)
+		sum += x[i];
+
+	return sum;
+}
+
+static void fastTanhScalar(float* x, unsigned int n)
+{
+	for (unsigned int i = 0; i < n; ++i)
+		x[i] = GMath::fastTanh(x[i]);
+}
+
+static void packFP16Scalar(const float* x, uint16_t* h, unsigned int n)
+{
+	for (unsigned int i = 0; i < n; ++i)
+		h[i] = GMath::floatToHalf(x[i]);
+}
+
+static void unpackFP16Scalar(const uint16_t* h, float* x, unsigned int n)
+{
+	for (unsigned int i = 0; i < n; ++i)
+		x[i] = GMath::halfToFloat(h[i]);
+}
+
+static float dotFP16Scalar(const uint16_t* w, const float* x, unsigned int n)
+{
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < n; ++i)
+		sum += GMath::halfToFloat(w[i]) * x[i];
+
+	return sum;
+}
+
+static void packBF16Scalar(const float* x, uint16_t* h, unsigned int n)
+{
+	for (unsigned int i = 0; i < n; ++i)
+		h[i] = GMath::floatToBF16(x[i]);
+}
+
+static void unpackBF16Scalar(const uint16_t* h, float* x, unsigned int n)
+{
+	for (unsigned int i = 0; i < n; ++i)
+		x[i] = GMath::bf16ToFloat(h[i]);
+}
+
+static float dotBF16Scalar(const uint16_t* w, const float* x, unsigned int n)
+{
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < n; ++i)
+		sum += GMath::bf16ToFloat(w[i]) * x[i];
+
+	return sum;
+}
+
+bool glades::Kernels::loadScalar(Table& table)
+{
+	table.isa = ISA_SCALAR;
+	table.name = isaName(ISA_SCALAR);
+	table.dot = &dotScalar;
+	table.axpy = &axpyScalar;
+	table.gemv = &gemvScalar;
+	table.gemvT = &gemvTScalar;
+	table.gemm = &gemmScalar;
+	table.sum = &sumScalar;
+	table.fastTanh = &fastTanhScalar;
+	table.packFP16 = &packFP16Scalar;
+	table.unpackFP16 = &unpackFP16Scalar;
+	table.dotFP16 = &dotFP16Scalar;
+	table.packBF16 = &packBF16Scalar;
+	table.unpackBF16 = &unpackBF16Scalar;
+	table.dotBF16 = &dotBF16Scalar;
+	return true;
+}
@@ -0,0 +1,329 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "kernels.h"
+
+// SSE2 path: 4 floats per register, baseline on every x86-64.
+// Built with its own ISA flags: include only headers without inline code, or the linker may
+// hand another translation unit a copy that uses these instructions.
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+
+using namespace glades;
+
+static inline float hsum(__m128 v)
+{
+	__m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+	__m128 sums = _mm_add_ps(v, shuf);
+	shuf = _mm_movehl_ps(shuf, sums);
+	sums = _mm_add_ss(sums, shuf);
+	return _mm_cvtss_f32(sums);
+}
+
+// x + 0x7FFF + lsb rounds to nearest even, NaNs keep a quiet bit. The arithmetic shift keeps
+// every lane inside int16 so the saturating pack only narrows
+static inline __m128i roundBF16(__m128i b)
+{
+	const __m128i absMask = _mm_set1_epi32(0x7FFFFFFF);
+	const __m128i inf = _mm_set1_epi32(0x7F800000);
+	__m128i lsb = _mm_and_si128(_mm_srli_epi32(b, 16), _mm_set1_epi32(1));
+	__m128i r = _mm_add_epi32(b, _mm_add_epi32(_mm_set1_epi32(0x7FFF), lsb));
+	r = _mm_srai_epi32(r, 16);
+	__m128i qnan = _mm_or_si128(_mm_srai_epi32(b, 16), _mm_set1_epi32(0x40));
+	__m128i isNaN = _mm_cmpgt_epi32(_mm_and_si128(b, absMask), inf);
+	return _mm_or_si128(_mm_and_si128(isNaN, qnan), _mm_andnot_si128(isNaN, r));
+}
+
+static inline void toBF16(const float* x, uint16_t* h)
+{
+	__m128i lo = roundBF16(_mm_castps_si128(_mm_loadu_ps(x)));
+	__m128i hi = roundBF16(_mm_castps_si128(_mm_loadu_ps(x + 4)));
+	_mm_storeu_si128((__m128i*)h, _mm_packs_epi32(lo, hi));
+}
+
+static inline __m128 fromBF16(const uint16_t* h)
+{
+	__m128i v = _mm_loadl_epi64((const __m128i*)h);
+	return _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), v));
+}
+
+static float dotSSE2(const float* x, const float* y, unsigned int n)
+{
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(y + i + 4)));
+	}
+	for (; i + 4 <= n; i += 4)
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+
+	float sum = hsum(_mm_add_ps(acc0, acc1));
+	for (; i < n; ++i)
+		sum += x[i] * y[i];
+
+	return sum;
+}
+
+static void axpySSE2(float a, const float* x, float* y, unsigned int n)
+{
+	__m128 va = _mm_set1_ps(a);
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 vy = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i)));
+		_mm_storeu_ps(y + i, vy);
+	}
+
+	for (; i < n; ++i)
+		y[i] += a * x[i];
+}
+
+static void gemvSSE2(const float* A, const float* x, float* y, unsigned int rows,
+					 unsigned int cols, unsigned int lda)
+{
+	for (unsigned int r = 0; r < rows; ++r)
+		y[r] = dotSSE2(A + (r * lda), x, cols);
+}
+
+static void gemvTSSE2(const float* A, const float* x, float* y, unsigned int rows,
+					  unsigned int cols, unsigned int lda)
+{
+	for (unsigned int r = 0; r < rows; ++r)
+		axpySSE2(x[r], A + (r * lda), y, cols);
+}
+
+// Register blocked: four rows of C stay in registers across the whole K loop, each B vector is
+// loaded once per four rows
+static void gemmSSE2(const float* A, const float* B, float* C, unsigned int M,
+					 unsigned int N, unsigned int K, unsigned int lda, unsigned int ldb,
+					 unsigned int ldc)
+{
+	unsigned int i = 0;
+	for (; i + 4 <= M; i += 4)
+	{
+		const float* a0 = A + (i * lda);
+		const float* a1 = a0 + lda;
+		const float* a2 = a1 + lda;
+		const float* a3 = a2 + lda;
+		float* c0 = C + (i * ldc);
+		float* c1 = c0 + ldc;
+		float* c2 = c1 + ldc;
+		float* c3 = c2 + ldc;
+
+		unsigned int j = 0;
+		for (; j + 4 <= N; j += 4)
+		{
+			__m128 s0 = _mm_loadu_ps(c0 + j);
+			__m128 s1 = _mm_loadu_ps(c1 + j);
+			__m128 s2 = _mm_loadu_ps(c2 + j);
+			__m128 s3 = _mm_loadu_ps(c3 + j);
+			for (unsigned int k = 0; k < K; ++k)
+			{
+				__m128 b = _mm_loadu_ps(B + (k * ldb) + j);
+				s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_set1_ps(a0[k]), b));
+				s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_set1_ps(a1[k]), b));
+				s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_set1_ps(a2[k]), b));
+				s3 = _mm_add_ps(s3, _mm_mul_ps(_mm_set1_ps(a3[k]), b));
+			}
+			_mm_storeu_ps(c0 + j, s0);
+			_mm_storeu_ps(c1 + j, s1);
+			_mm_storeu_ps(c2 + j, s2);
+			_mm_storeu_ps(c3 + j, s3);
+		}
+
+		// leftover columns
+		for (; j < N; ++j)
+		{
+			float s0 = c0[j], s1 = c1[j], s2 = c2[j], s3 = c3[j];
+			for (unsigned int k = 0; k < K; ++k)
+			{
+				float b = B[(k * ldb) + j];
+				s0 += a0[k] * b;
+				s1 += a1[k] * b;
+				s2 += a2[k] * b;
+				s3 += a3[k] * b;
+			}
+			c0[j] = s0;
+			c1[j] = s1;
+			c2[j] = s2;
+			c3[j] = s3;
+		}
+	}
+
+	// leftover rows
+	for (; i < M; ++i)
+	{
+		for (unsigned int k = 0; k < K; ++k)
+			axpySSE2(A[(i * lda) + k], B + (k * ldb), C + (i * ldc), N);
+	}
+}
+
+static float sumSSE2(const float* x, unsigned int n)
+{
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		acc0 = _mm_add_ps(acc0, _mm_loadu_ps(x + i));
+		acc1 = _mm_add_ps(acc1, _mm_loadu_ps(x + i + 4));
+	}
+	for (; i + 4 <= n; i += 4)
+		acc0 = _mm_add_ps(acc0, _mm_loadu_ps(x + i));
+
+	float sum = hsum(_mm_add_ps(acc0, acc1));
+	for (; i < n; ++i)
+		sum += x[i];
+
+	return sum;
+}
+
+// Same operations in the same order as GMath::fastTanh, so every lane matches the scalar result
+// bit for bit as long as the compiler doesn't fuse them (CMake passes -ffp-contract=off)
+static inline __m128 tanhSSE2(__m128 x)
+{
+	const __m128 clampHi = _mm_set1_ps(7.90531110763549805f);
+	const __m128 clampLo = _mm_set1_ps(-7.90531110763549805f);
+	x = _mm_min_ps(clampHi, _mm_max_ps(clampLo, x));
+	__m128 x2 = _mm_mul_ps(x, x);
+
+	__m128 p = _mm_set1_ps(-2.76076847742355e-16f);
+	p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(2.00018790482477e-13f));
+	p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-8.60467152213735e-11f));
+	p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(5.12229709037114e-08f));
+	p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.48572235717979e-05f));
+	p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(6.37261928875436e-04f));
+	p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(4.89352455891786e-03f));
+	p = _mm_mul_ps(p, x);
+
+	__m128 q = _mm_set1_ps(1.19825839466702e-06f);
+	q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(1.18534705686654e-04f));
+	q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(2.26843463243900e-03f));
+	q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(4.89352518554385e-03f));
+
+	return _mm_div_ps(p, q);
+}
+
+static void fastTanhSSE2(float* x, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_ps(x + i, tanhSSE2(_mm_loadu_ps(x + i)));
+
+	// zero padded tail
+	if (i < n)
+	{
+		float tail[4];
+		memset(tail, 0, sizeof(tail));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		_mm_storeu_ps(tail, tanhSSE2(_mm_loadu_ps(tail)));
+		memcpy(x + i, tail, (n - i) * sizeof(float));
+	}
+}
+
+static void packBF16SSE2(const float* x, uint16_t* h, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+		toBF16(x + i, h + i);
+
+	// zero padded tail
+	if (i < n)
+	{
+		float tail[8];
+		uint16_t packed[8];
+		memset(tail, 0, sizeof(tail));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		toBF16(tail, packed);
+		memcpy(h + i, packed, (n - i) * sizeof(uint16_t));
+	}
+}
+
+static void unpackBF16SSE2(const uint16_t* h, float* x, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_ps(x + i, fromBF16(h + i));
+
+	if (i < n)
+	{
+		uint16_t packed[8];
+		float tail[4];
+		memset(packed, 0, sizeof(packed));
+		memcpy(packed, h + i, (n - i) * sizeof(uint16_t));
+		_mm_storeu_ps(tail, fromBF16(packed));
+		memcpy(x + i, tail, (n - i) * sizeof(float));
+	}
+}
+
+static float dotBF16SSE2(const uint16_t* w, const float* x, unsigned int n)
+{
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(fromBF16(w + i), _mm_loadu_ps(x + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(fromBF16(w + i + 4), _mm_loadu_ps(x + i + 4)));
+	}
+	for (; i + 4 <= n; i += 4)
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(fromBF16(w + i), _mm_loadu_ps(x + i)));
+
+	// zero padded tail, both operands
+	if (i < n)
+	{
+		uint16_t packed[8];
+		float tail[4];
+		memset(packed, 0, sizeof(packed));
+		memset(tail, 0, sizeof(tail));
+		memcpy(packed, w + i, (n - i) * sizeof(uint16_t));
+		memcpy(tail, x + i, (n - i) * sizeof(float));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(fromBF16(packed), _mm_loadu_ps(tail)));
+	}
+
+	return hsum(_mm_add_ps(acc0, acc1));
+}
+
+
+bool glades::Kernels::loadSSE2(Table& table)
+{
+	table.isa = ISA_SSE2;
+	table.name = isaName(ISA_SSE2);
+	table.dot = &dotSSE2;
+	table.axpy = &axpySSE2;
+	table.gemv = &gemvSSE2;
+	table.gemvT = &gemvTSSE2;
+	table.gemm = &gemmSSE2;
+	table.sum = &sumSSE2;
+	table.fastTanh = &fastTanhSSE2;
+	table.packBF16 = &packBF16SSE2;
+	table.unpackBF16 = &unpackBF16SSE2;
+	table.dotBF16 = &dotBF16SSE2;
+	return true;
+}
+
+#else
+
+bool glades::Kernels::loadSSE2(Table& table)
+{
+	return false;
+}
+
+#endif
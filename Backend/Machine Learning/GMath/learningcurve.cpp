@@ -0,0 +1,394 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "learningcurve.h"
+
+using namespace glades;
+
+glades::LearningCurve::Bucket::Bucket()
+{
+	clear();
+}
+
+/*!
+ * @brief add
+ * @details widen the bucket's epoch span; NaN values (series not recorded that epoch) only do that
+ * @param epoch the point's epoch
+ * @param value the point's value
+ */
+void glades::LearningCurve::Bucket::add(int64_t epoch, float value)
+{
+	if (firstEpoch > lastEpoch)
+	{
+		firstEpoch = epoch;
+		lastEpoch = epoch;
+	}
+	if (epoch < firstEpoch)
+		firstEpoch = epoch;
+	if (epoch > lastEpoch)
+		lastEpoch = epoch;
+
+	if (value != value)
+		return;
+
+	if ((count == 0) || (value < fMin))
+		fMin = value;
+	if ((count == 0) || (value > fMax))
+		fMax = value;
+	sum += value;
+	++count;
+}
+
+void glades::LearningCurve::Bucket::merge(const Bucket& other)
+{
+	if (other.firstEpoch > other.lastEpoch)
+		return;
+
+	if (firstEpoch > lastEpoch)
+	{
+		*this = other;
+		return;
+	}
+
+	if (other.firstEpoch < firstEpoch)
+		firstEpoch = other.firstEpoch;
+	if (other.lastEpoch > lastEpoch)
+		lastEpoch = other.lastEpoch;
+
+	if (other.count == 0)
+		return;
+
+	if ((count == 0) || (other.fMin < fMin))
+		fMin = other.fMin;
+	if ((count == 0) || (other.fMax > fMax))
+		fMax = other.fMax;
+	sum += other.sum;
+	count += other.count;
+}
+
+void glades::LearningCurve::Bucket::clear()
+{
+	firstEpoch = 0;
+	lastEpoch = -1;
+	count = 0;
+	fMin = 0.0f;
+	fMax = 0.0f;
+	sum = 0.0;
+}
+
+float glades::LearningCurve::Bucket::getMean() const
+{
+	if (count == 0)
+		return 0.0f;
+
+	return (float)(sum / count);
+}
+
+glades::LearningCurve::LearningCurve()
+{
+	seriesCount = 0;
+	capacity = 0;
+	pointCount = 0;
+}
+
+glades::LearningCurve::~LearningCurve()
+{
+	clean();
+}
+
+/*!
+ * @brief build
+ * @details size the recorder and drop every point
+ * @param newSeriesCount the values recorded per epoch
+ * @param newCapacity buckets kept per level (rounded up to even, at least 2)
+ */
+void glades::LearningCurve::build(unsigned int newSeriesCount, unsigned int newCapacity)
+{
+	clean();
+	if (newSeriesCount == 0)
+		return;
+
+	seriesCount = newSeriesCount;
+	capacity = (newCapacity < 2) ? 2 : newCapacity + (newCapacity % 2);
+	reset();
+}
+
+/*!
+ * @brief add
+ * @details record one epoch; O(1) amortized
+ * @param epoch the epoch
+ * @param values seriesCount values, NaN for a series not measured this epoch
+ */
+void glades::LearningCurve::add(int64_t epoch, const float* values)
+{
+	if ((seriesCount == 0) || (!values))
+		return;
+
+	++pointCount;
+	for (unsigned int s = 0; s < seriesCount; ++s)
+		open[0][s].add(epoch, values[s]);
+	openPoints[0] = 1;
+	close(0);
+}
+
+/*!
+ * @brief close
+ * @details move a level's full open bucket into its ring and fold it into the next level's open
+ * bucket, cascading up while those fill. The first time a ring would drop its oldest bucket the
+ * next level is created from the ring's buckets merged in pairs, so it starts with the whole
+ * history.
+ * @param level the level whose open bucket is full
+ */
+void glades::LearningCurve::close(unsigned int level)
+{
+	while (level < rings.size())
+	{
+		if ((ringSize[level] == capacity) && (level + 1 == rings.size()) &&
+			(rings.size() < MAX_LEVELS))
+		{
+			// Start the next level with the pairs of this full ring
+			rings.push_back(std::vector<Bucket>(capacity * seriesCount));
+			ringStart.push_back(0);
+			ringSize.push_back(capacity / 2);
+			open.push_back(std::vector<Bucket>(seriesCount));
+			openPoints.push_back(0);
+
+			const std::vector<Bucket>& ring = rings[level];
+			std::vector<Bucket>& nextRing = rings[level + 1];
+			for (unsigned int i = 0; i < capacity / 2; ++i)
+			{
+				unsigned int oldRow = (ringStart[level] + (2 * i)) % capacity;
+				unsigned int youngRow = (oldRow + 1) % capacity;
+				for (unsigned int s = 0; s < seriesCount; ++s)
+				{
+					Bucket& cBucket = nextRing[(i * seriesCount) + s];
+					cBucket = ring[(oldRow * seriesCount) + s];
+					cBucket.merge(ring[(youngRow * seriesCount) + s]);
+				}
+			}
+		}
+
+		// Into the ring, over the oldest bucket once full
+		std::vector<Bucket>& ring = rings[level];
+		unsigned int row = 0;
+		if (ringSize[level] < capacity)
+		{
+			row = (ringStart[level] + ringSize[level]) % capacity;
+			++ringSize[level];
+		}
+		else
+		{
+			row = ringStart[level];
+			ringStart[level] = (ringStart[level] + 1) % capacity;
+		}
+
+		for (unsigned int s = 0; s < seriesCount; ++s)
+			ring[(row * seriesCount) + s] = open[level][s];
+
+		// Up a level, if there is one
+		bool cascade = false;
+		if (level + 1 < rings.size())
+		{
+			for (unsigned int s = 0; s < seriesCount; ++s)
+				open[level + 1][s].merge(open[level][s]);
+			openPoints[level + 1] += openPoints[level];
+			cascade = (openPoints[level + 1] >= (((uint64_t)1) << (level + 1)));
+		}
+
+		for (unsigned int s = 0; s < seriesCount; ++s)
+			open[level][s].clear();
+		openPoints[level] = 0;
+
+		if (!cascade)
+			break;
+		++level;
+	}
+}
+
+/*!
+ * @brief covers
+ * @param level the level
+ * @param firstEpoch the oldest epoch wanted
+ * @return whether the level still holds every bucket from firstEpoch on
+ */
+bool glades::LearningCurve::covers(unsigned int level, int64_t firstEpoch) const
+{
+	if ((level + 1 >= rings.size()) || (ringSize[level] < capacity))
+		return true;
+
+	return rings[level][ringStart[level] * seriesCount].firstEpoch <= firstEpoch;
+}
+
+/*!
+ * @brief reset
+ * @details drop every point, keeping the series count and capacity
+ */
+void glades::LearningCurve::reset()
+{
+	pointCount = 0;
+	rings.clear();
+	ringStart.clear();
+	ringSize.clear();
+	open.clear();
+	openPoints.clear();
+	if (seriesCount == 0)
+		return;
+
+	rings.push_back(std::vector<Bucket>(capacity * seriesCount));
+	ringStart.push_back(0);
+	ringSize.push_back(0);
+	open.push_back(std::vector<Bucket>(seriesCount));
+	openPoints.push_back(0);
+}
+
+void glades::LearningCurve::clean()
+{
+	seriesCount = 0;
+	capacity = 0;
+	reset();
+}
+
+unsigned int glades::LearningCurve::size() const
+{
+	return seriesCount;
+}
+
+unsigned int glades::LearningCurve::getCapacity() const
+{
+	return capacity;
+}
+
+unsigned int glades::LearningCurve::getLevelCount() const
+{
+	return rings.size();
+}
+
+int64_t glades::LearningCurve::getPointCount() const
+{
+	return pointCount;
+}
+
+/*!
+ * @brief get last
+ * @param series the series
+ * @param point filled with the newest point
+ * @return whether there is one
+ */
+bool glades::LearningCurve::getLast(unsigned int series, Bucket& point) const
+{
+	if ((series >= seriesCount) || (ringSize[0] == 0))
+		return false;
+
+	unsigned int row = (ringStart[0] + ringSize[0] - 1) % capacity;
+	point = rings[0][(row * seriesCount) + series];
+	return true;
+}
+
+/*!
+ * @brief get curve
+ * @details the series from firstEpoch on in at most maxPoints buckets, oldest first. Reads the
+ * finest level reaching back to firstEpoch plus the still open buckets below it, then merges
+ * runs of neighbours if there are more than maxPoints. Buckets without values are left out.
+ * @param series the series
+ * @param maxPoints the most buckets wanted
+ * @param points filled with the buckets
+ * @param firstEpoch the oldest epoch wanted
+ * @return the number of buckets
+ */
+unsigned int glades::LearningCurve::getCurve(unsigned int series, unsigned int maxPoints,
+											 std::vector<Bucket>& points,
+											 int64_t firstEpoch) const
+{
+	points.clear();
+	if ((series >= seriesCount) || (maxPoints == 0) || (pointCount == 0))
+		return 0;
+
+	unsigned int level = 0;
+	while (!covers(level, firstEpoch))
+		++level;
+
+	std::vector<Bucket> buckets;
+	const std::vector<Bucket>& ring = rings[level];
+	for (unsigned int i = 0; i < ringSize[level]; ++i)
+	{
+		unsigned int row = (ringStart[level] + i) % capacity;
+		const Bucket& cBucket = ring[(row * seriesCount) + series];
+		if ((cBucket.count > 0) && (cBucket.lastEpoch >= firstEpoch))
+			buckets.push_back(cBucket);
+	}
+
+	// The points not closed at this level yet, oldest level first
+	Bucket tail;
+	for (int l = level; l >= 0; --l)
+		tail.merge(open[l][series]);
+	if ((tail.count > 0) && (tail.lastEpoch >= firstEpoch))
+		buckets.push_back(tail);
+
+	// Down to maxPoints
+	unsigned int group = (buckets.size() + maxPoints - 1) / maxPoints;
+	if (group <= 1)
+	{
+		points.swap(buckets);
+		return points.size();
+	}
+
+	for (unsigned int i = 0; i < buckets.size(); i += group)
+	{
+		Bucket cPoint = buckets[i];
+		for (unsigned int j = i + 1; (j < i + group) && (j < buckets.size()); ++j)
+			cPoint.merge(buckets[j]);
+		points.push_back(cPoint);
+	}
+
+	return points.size();
+}
+
+/*!
+ * @brief get GList
+ * @details getCurve() flattened for the GUI: last epoch (long), mean, min, max (floats) per point
+ * @param series the series
+ * @param maxPoints the most points wanted
+ * @param firstEpoch the oldest epoch wanted
+ * @return the flattened curve
+ */
+shmea::GList glades::LearningCurve::getGList(unsigned int series, unsigned int maxPoints,
+											 int64_t firstEpoch) const
+{
+	std::vector<Bucket> points;
+	getCurve(series, maxPoints, points, firstEpoch);
+
+	shmea::GList retList;
+	for (unsigned int i = 0; i < points.size(); ++i)
+	{
+		retList.addLong(points[i].lastEpoch);
+		retList.addFloat(points[i].getMean());
+		retList.addFloat(points[i].fMin);
+		retList.addFloat(points[i].fMax);
+	}
+
+	return retList;
+}
+
+void glades::LearningCurve::print(unsigned int series, unsigned int maxPoints) const
+{
+	std::vector<Bucket> points;
+	getCurve(series, maxPoints, points);
+
+	printf("[CURVE] Epochs\t\tMean\t\tMin\t\tMax\n");
+	for (unsigned int i = 0; i < points.size(); ++i)
+		printf("[CURVE] %ld-%ld\t%f\t%f\t%f\n", (long)points[i].firstEpoch,
+			   (long)points[i].lastEpoch, points[i].getMean(), points[i].fMin, points[i].fMax);
+}
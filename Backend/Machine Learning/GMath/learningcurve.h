@@ -0,0 +1,98 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _LEARNINGCURVE
+#define _LEARNINGCURVE
+
+#include "Backend/Database/GList.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace glades {
+
+/*!
+ * @brief learning curve recorder
+ * @details fixed memory, multi-resolution history of a few per-epoch series (loss, accuracy,
+ * ...). Level l keeps a ring of its newest capacity buckets, each summarizing 2^l points
+ * (min/max/mean and the epoch span). Every add() closes a level 0 bucket and folds it into the
+ * open bucket of level 1, which closes after two, and so on, so the work per point is O(1)
+ * amortized and memory grows with log2(points / capacity) levels at most. A query reads the
+ * finest level that still reaches back far enough and merges neighbouring buckets down to the
+ * requested number of points.
+ */
+class LearningCurve
+{
+public:
+	class Bucket
+	{
+	public:
+		int64_t firstEpoch;
+		int64_t lastEpoch;
+		unsigned int count;
+		float fMin;
+		float fMax;
+		double sum;
+
+		Bucket();
+		void add(int64_t, float);
+		void merge(const Bucket&);
+		void clear();
+		float getMean() const;
+	};
+
+private:
+	unsigned int seriesCount;
+	unsigned int capacity;
+	int64_t pointCount;
+
+	// per level: capacity x seriesCount closed buckets (ring, row major), the oldest row and
+	// the number of rows in use, then the open buckets and the points folded into them
+	std::vector<std::vector<Bucket> > rings;
+	std::vector<unsigned int> ringStart;
+	std::vector<unsigned int> ringSize;
+	std::vector<std::vector<Bucket> > open;
+	std::vector<uint64_t> openPoints;
+
+	void close(unsigned int);
+	bool covers(unsigned int, int64_t) const;
+
+public:
+	static const unsigned int DEFAULT_CAPACITY = 512;
+	static const unsigned int MAX_LEVELS = 40;
+
+	LearningCurve();
+	~LearningCurve();
+
+	// sets
+	void build(unsigned int, unsigned int = DEFAULT_CAPACITY);
+	void add(int64_t, const float*);
+	void reset();
+	void clean();
+
+	// gets
+	unsigned int size() const;
+	unsigned int getCapacity() const;
+	unsigned int getLevelCount() const;
+	int64_t getPointCount() const;
+	bool getLast(unsigned int, Bucket&) const;
+	unsigned int getCurve(unsigned int, unsigned int, std::vector<Bucket>&, int64_t = 0) const;
+	shmea::GList getGList(unsigned int, unsigned int, int64_t = 0) const;
+	void print(unsigned int, unsigned int) const;
+};
+};
+
+#endif
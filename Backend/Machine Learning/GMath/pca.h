@@ -31,7 +31,7 @@ double dot_product(const std::vector<double>& vec1, const std::vector<double>& v
 std::vector<double> matrix_vector_multiply(const std::vector<std::vector<double> >& matrix, const std::vector<double>& vec);
 
 // Custom comparison function for sorting in descending order
-bool compare_pairs(const std::pair<double, std::vector<double> >& pair1, const std::pair<double, std::vector<double> >& pair2);
+bool compare_pairs(const std::pair<double, size_t>& pair1, const std::pair<double, size_t>& pair2);
 
 // Multiply two matrices: C = A * B
 std::vector<std::vector<double> > matrixMultiply(const std::vector<std::vector<double> >& A,
@@ -0,0 +1,199 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "reduction.h"
+#include "kernels.h"
+#include <vector>
+
+using namespace glades;
+
+int glades::Reduction::mode = glades::Reduction::MODE_FAST;
+
+// One thread's share of the leaves [leafStart, leafEnd)
+struct ReductionTask
+{
+	const float* x;
+	const float* y;
+	float* partials;
+	unsigned int n;
+	unsigned int leafSize;
+	unsigned int leafStart;
+	unsigned int leafEnd;
+};
+
+static void* reductionWorker(void* y)
+{
+	ReductionTask* task = (ReductionTask*)y;
+	const Kernels::Table& kernels = Kernels::get();
+	for (unsigned int leaf = task->leafStart; leaf < task->leafEnd; ++leaf)
+	{
+		unsigned int offset = leaf * task->leafSize;
+		unsigned int count = task->n - offset;
+		if (count > task->leafSize)
+			count = task->leafSize;
+
+		if (task->y)
+			task->partials[leaf] = kernels.dot(task->x + offset, task->y + offset, count);
+		else
+			task->partials[leaf] = kernels.sum(task->x + offset, count);
+	}
+
+	return NULL;
+}
+
+/*!
+ * @brief reduce
+ * @details sum of x (y == NULL) or x . y, computed as per-leaf partials and then combined
+ * @param x the values
+ * @param y the second operand of a dot product, or NULL
+ * @param n the element count
+ * @param threads the most threads to use
+ * @param cMode the mode, read once by the caller
+ * @return the reduction
+ */
+float glades::Reduction::reduce(const float* x, const float* y, unsigned int n,
+								unsigned int threads, int cMode)
+{
+	if (n == 0)
+		return 0.0f;
+
+	if ((threads == 0) || (n < THREAD_MIN_SIZE))
+		threads = 1;
+
+	// Fast mode: one leaf per thread. Deterministic mode: the leaf shape ignores threads.
+	unsigned int leafSize = LEAF_SIZE;
+	if (cMode == MODE_FAST)
+	{
+		if (threads == 1)
+		{
+			if (y)
+				return Kernels::get().dot(x, y, n);
+			return Kernels::get().sum(x, n);
+		}
+
+		leafSize = (n + threads - 1) / threads;
+	}
+
+	unsigned int leaves = (n + leafSize - 1) / leafSize;
+	if (threads > leaves)
+		threads = leaves;
+
+	// One thread below the threading cutoff: the leaves fit on the stack
+	if ((threads == 1) && (leaves <= THREAD_MIN_SIZE / LEAF_SIZE))
+	{
+		float stackPartials[THREAD_MIN_SIZE / LEAF_SIZE];
+		ReductionTask task;
+		task.x = x;
+		task.y = y;
+		task.partials = stackPartials;
+		task.n = n;
+		task.leafSize = leafSize;
+		task.leafStart = 0;
+		task.leafEnd = leaves;
+		reductionWorker(&task);
+		return treeSum(stackPartials, leaves);
+	}
+
+	std::vector<float> partials(leaves);
+	std::vector<ReductionTask> tasks(threads);
+	std::vector<pthread_t> workers(threads);
+	unsigned int leavesPerThread = (leaves + threads - 1) / threads;
+	unsigned int launched = 0;
+	for (unsigned int t = 0; t < threads; ++t)
+	{
+		ReductionTask& task = tasks[t];
+		task.x = x;
+		task.y = y;
+		task.partials = &partials[0];
+		task.n = n;
+		task.leafSize = leafSize;
+		task.leafStart = t * leavesPerThread;
+		task.leafEnd = task.leafStart + leavesPerThread;
+		if (task.leafEnd > leaves)
+			task.leafEnd = leaves;
+		if (task.leafStart >= task.leafEnd)
+			break;
+
+		// the last share runs on the calling thread
+		if ((t == threads - 1) || (pthread_create(&workers[launched], NULL, reductionWorker,
+												  &task) != 0))
+			reductionWorker(&task);
+		else
+			++launched;
+	}
+
+	for (unsigned int i = 0; i < launched; ++i)
+		pthread_join(workers[i], NULL);
+
+	if (cMode == MODE_FAST)
+	{
+		float total = 0.0f;
+		for (unsigned int i = 0; i < leaves; ++i)
+			total += partials[i];
+		return total;
+	}
+
+	return treeSum(&partials[0], leaves);
+}
+
+float glades::Reduction::sum(const float* x, unsigned int n, unsigned int threads)
+{
+	return reduce(x, NULL, n, threads, mode);
+}
+
+float glades::Reduction::dot(const float* x, const float* y, unsigned int n,
+							 unsigned int threads)
+{
+	return reduce(x, y, n, threads, mode);
+}
+
+/*!
+ * @brief tree sum
+ * @details pairwise sum with a shape that depends only on count: neighbours at distance 1 are
+ * added, then at distance 2, 4, ... The values are overwritten.
+ * @param values the partials
+ * @param count the number of partials
+ * @return the total
+ */
+float glades::Reduction::treeSum(float* values, unsigned int count)
+{
+	if (count == 0)
+		return 0.0f;
+
+	for (unsigned int width = 1; width < count; width *= 2)
+	{
+		for (unsigned int i = 0; i + width < count; i += 2 * width)
+			values[i] += values[i + width];
+	}
+
+	return values[0];
+}
+
+void glades::Reduction::setMode(int newMode)
+{
+	if ((newMode != MODE_FAST) && (newMode != MODE_DETERMINISTIC))
+	{
+		printf("[MATH] Unknown reduction mode: %d\n", newMode);
+		return;
+	}
+
+	mode = newMode;
+}
+
+int glades::Reduction::getMode()
+{
+	return mode;
+}
@@ -0,0 +1,63 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GREDUCTION
+#define _GREDUCTION
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace glades {
+
+/*!
+ * @brief parallel reductions
+ * @details sum and dot over large arrays, optionally split across threads.
+ * MODE_FAST gives each thread one contiguous chunk and adds the chunk totals in order, so the
+ * rounding depends on the thread count. MODE_DETERMINISTIC always cuts the input into the same
+ * LEAF_SIZE leaves and adds the leaf totals with a fixed pairwise tree; threads only decide who
+ * computes which leaf, so the result is bit identical for any thread count (on a given ISA).
+ * A threaded call starts and joins its threads, so split only large one-off reductions; hot
+ * loops call with one thread and thread at a coarser level. The mode is a plain global: set it
+ * before any training or GEMM thread starts, never while a reduction may be running.
+ */
+class Reduction
+{
+private:
+	static int mode;
+
+	static float reduce(const float*, const float*, unsigned int, unsigned int, int);
+
+public:
+	static const int MODE_FAST = 0;
+	static const int MODE_DETERMINISTIC = 1;
+
+	static const unsigned int LEAF_SIZE = 1024;
+
+	// below this many elements a reduction stays on the calling thread
+	static const unsigned int THREAD_MIN_SIZE = 1 << 15;
+
+	static float sum(const float*, unsigned int, unsigned int = 1);
+	static float dot(const float*, const float*, unsigned int, unsigned int = 1);
+	static float treeSum(float*, unsigned int);
+
+	static void setMode(int);
+	static int getMode();
+};
+};
+
+#endif
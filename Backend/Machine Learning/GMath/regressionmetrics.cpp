@@ -0,0 +1,304 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "regressionmetrics.h"
+
+using namespace glades;
+
+const float glades::RegressionMetrics::ERROR_ACCURACY = 0.01f;
+const float glades::RegressionMetrics::MIN_ERROR = 1.0e-6f;
+const float glades::RegressionMetrics::MAX_ERROR = 1.0e6f;
+
+glades::RegressionMetrics::RegressionMetrics()
+{
+	outputCount = 0;
+	errorTotal = 0;
+	logGamma = 0.0;
+}
+
+glades::RegressionMetrics::~RegressionMetrics()
+{
+	clean();
+}
+
+/*!
+ * @brief build
+ * @details size the accumulators; clears the sums and the error sketch
+ * @param newOutputCount the number of output nodes
+ */
+void glades::RegressionMetrics::build(unsigned int newOutputCount)
+{
+	clean();
+	outputCount = newOutputCount;
+	sumSquaredError.assign(outputCount, 0.0);
+	sumAbsError.assign(outputCount, 0.0);
+	targets.assign(outputCount, RunningStat());
+
+	// Bin k > 0 holds (MIN_ERROR * gamma^(k-1), MIN_ERROR * gamma^k]
+	double gamma = (1.0 + ERROR_ACCURACY) / (1.0 - ERROR_ACCURACY);
+	logGamma = log(gamma);
+	unsigned int bins = 2 + (unsigned int)ceil(log(MAX_ERROR / MIN_ERROR) / logGamma);
+	errorBins.assign(bins, 0);
+}
+
+unsigned int glades::RegressionMetrics::binOf(float absError) const
+{
+	// NaN lands in the top bin
+	if (absError != absError)
+		return errorBins.size() - 1;
+
+	if (absError <= MIN_ERROR)
+		return 0;
+
+	double k = ceil(log(absError / MIN_ERROR) / logGamma);
+	return (k < errorBins.size() - 1) ? (unsigned int)k : errorBins.size() - 1;
+}
+
+float glades::RegressionMetrics::binValue(unsigned int bin) const
+{
+	if (bin == 0)
+		return 0.0f;
+
+	// the point within ERROR_ACCURACY of both bin edges
+	double gamma = exp(logGamma);
+	return (float)(MIN_ERROR * 2.0 * exp(bin * logGamma) / (gamma + 1.0));
+}
+
+/*!
+ * @brief add result
+ * @param outputIndex the output node
+ * @param expected the expected value
+ * @param predicted the output node's activation
+ */
+void glades::RegressionMetrics::addResult(unsigned int outputIndex, float expected,
+										  float predicted)
+{
+	if (outputIndex >= outputCount)
+		return;
+
+	double err = (double)predicted - expected;
+	sumSquaredError[outputIndex] += err * err;
+	sumAbsError[outputIndex] += fabs(err);
+	targets[outputIndex].add(expected);
+
+	++errorBins[binOf((float)fabs(err))];
+	++errorTotal;
+}
+
+/*!
+ * @brief add results
+ * @param pred n rows of outputCount predictions
+ * @param exp n rows of outputCount expected values
+ * @param n the number of samples
+ */
+void glades::RegressionMetrics::addResults(const float* pred, const float* exp, unsigned int n)
+{
+	for (unsigned int s = 0; s < n; ++s)
+	{
+		const float* cPred = pred + (s * outputCount);
+		const float* cExp = exp + (s * outputCount);
+		for (unsigned int o = 0; o < outputCount; ++o)
+			addResult(o, cExp[o], cPred[o]);
+	}
+}
+
+/*!
+ * @brief merge
+ * @param other metrics with the same output count
+ */
+void glades::RegressionMetrics::merge(const RegressionMetrics& other)
+{
+	if (other.outputCount != outputCount)
+	{
+		printf("[REG] Cannot merge %u outputs into %u\n", other.outputCount, outputCount);
+		return;
+	}
+
+	for (unsigned int o = 0; o < outputCount; ++o)
+	{
+		sumSquaredError[o] += other.sumSquaredError[o];
+		sumAbsError[o] += other.sumAbsError[o];
+		targets[o].merge(other.targets[o]);
+	}
+
+	for (unsigned int i = 0; i < errorBins.size(); ++i)
+		errorBins[i] += other.errorBins[i];
+	errorTotal += other.errorTotal;
+}
+
+/*!
+ * @brief reset
+ * @details zero the sums and the sketch, keeping the sizes
+ */
+void glades::RegressionMetrics::reset()
+{
+	sumSquaredError.assign(outputCount, 0.0);
+	sumAbsError.assign(outputCount, 0.0);
+	targets.assign(outputCount, RunningStat());
+	errorBins.assign(errorBins.size(), 0);
+	errorTotal = 0;
+}
+
+void glades::RegressionMetrics::clean()
+{
+	outputCount = 0;
+	sumSquaredError.clear();
+	sumAbsError.clear();
+	targets.clear();
+	errorBins.clear();
+	errorTotal = 0;
+	logGamma = 0.0;
+}
+
+unsigned int glades::RegressionMetrics::size() const
+{
+	return outputCount;
+}
+
+/*!
+ * @brief get count
+ * @return the number of (output, row) results added
+ */
+uint64_t glades::RegressionMetrics::getCount() const
+{
+	return errorTotal;
+}
+
+float glades::RegressionMetrics::getMSE(unsigned int outputIndex) const
+{
+	if ((outputIndex >= outputCount) || (targets[outputIndex].size() == 0))
+		return 0.0f;
+
+	return (float)(sumSquaredError[outputIndex] / targets[outputIndex].size());
+}
+
+float glades::RegressionMetrics::getRMSE(unsigned int outputIndex) const
+{
+	return sqrt(getMSE(outputIndex));
+}
+
+float glades::RegressionMetrics::getMAE(unsigned int outputIndex) const
+{
+	if ((outputIndex >= outputCount) || (targets[outputIndex].size() == 0))
+		return 0.0f;
+
+	return (float)(sumAbsError[outputIndex] / targets[outputIndex].size());
+}
+
+/*!
+ * @brief get R^2
+ * @param outputIndex the output node
+ * @return 1 - SSE / SST, or 0 when the targets do not vary
+ */
+float glades::RegressionMetrics::getR2(unsigned int outputIndex) const
+{
+	if (outputIndex >= outputCount)
+		return 0.0f;
+
+	const RunningStat& cTargets = targets[outputIndex];
+	if (cTargets.size() < 2)
+		return 0.0f;
+
+	double sst = cTargets.getVariance() * (cTargets.size() - 1);
+	if (sst <= 0.0)
+		return 0.0f;
+
+	return (float)(1.0 - (sumSquaredError[outputIndex] / sst));
+}
+
+float glades::RegressionMetrics::getOverallMSE() const
+{
+	if (errorTotal == 0)
+		return 0.0f;
+
+	double sse = 0.0;
+	for (unsigned int o = 0; o < outputCount; ++o)
+		sse += sumSquaredError[o];
+
+	return (float)(sse / errorTotal);
+}
+
+float glades::RegressionMetrics::getOverallRMSE() const
+{
+	return sqrt(getOverallMSE());
+}
+
+float glades::RegressionMetrics::getOverallMAE() const
+{
+	if (errorTotal == 0)
+		return 0.0f;
+
+	double sae = 0.0;
+	for (unsigned int o = 0; o < outputCount; ++o)
+		sae += sumAbsError[o];
+
+	return (float)(sae / errorTotal);
+}
+
+/*!
+ * @brief get overall R^2
+ * @return the mean of the output nodes' R^2
+ */
+float glades::RegressionMetrics::getOverallR2() const
+{
+	if (outputCount == 0)
+		return 0.0f;
+
+	float r2 = 0.0f;
+	for (unsigned int o = 0; o < outputCount; ++o)
+		r2 += getR2(o);
+
+	return r2 / outputCount;
+}
+
+/*!
+ * @brief get error quantile
+ * @details read the q quantile of the absolute errors off the sketch, within ERROR_ACCURACY of
+ * the exact value (errors below MIN_ERROR read as 0, above MAX_ERROR as MAX_ERROR)
+ * @param q the quantile in [0, 1], e.g. 0.95
+ * @return the absolute error
+ */
+float glades::RegressionMetrics::getErrorQuantile(float q) const
+{
+	if (errorTotal == 0)
+		return 0.0f;
+
+	if (q < 0.0f)
+		q = 0.0f;
+	if (q > 1.0f)
+		q = 1.0f;
+
+	uint64_t rank = (uint64_t)(q * (errorTotal - 1));
+	uint64_t seen = 0;
+	for (unsigned int i = 0; i < errorBins.size(); ++i)
+	{
+		seen += errorBins[i];
+		if (seen > rank)
+			return binValue(i);
+	}
+
+	return binValue(errorBins.size() - 1);
+}
+
+void glades::RegressionMetrics::print() const
+{
+	printf("[REG] MSE: %f RMSE: %f MAE: %f R2: %f\n", getOverallMSE(), getOverallRMSE(),
+		   getOverallMAE(), getOverallR2());
+	printf("[REG] |error| P50: %f P95: %f P99: %f\n", getErrorQuantile(0.5f),
+		   getErrorQuantile(0.95f), getErrorQuantile(0.99f));
+	for (unsigned int o = 0; (outputCount > 1) && (o < outputCount); ++o)
+		printf("[REG] %u: MSE: %f MAE: %f R2: %f\n", o, getMSE(o), getMAE(o), getR2(o));
+}
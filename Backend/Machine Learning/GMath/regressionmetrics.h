@@ -0,0 +1,86 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _REGRESSIONMETRICS
+#define _REGRESSIONMETRICS
+
+#include "runningstat.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace glades {
+
+/*!
+ * @brief streaming regression metrics
+ * @details MSE/RMSE/MAE/R^2 per output node in one pass: squared and absolute error sums plus a
+ * RunningStat of the targets for the total sum of squares. Error quantiles come from a fixed
+ * log-bucketed histogram of the absolute errors (relative accuracy ERROR_ACCURACY between
+ * MIN_ERROR and MAX_ERROR), so nothing per row is kept. Like CMatrix and ROCCurve, each thread
+ * can fill its own accumulator and merge it at epoch end.
+ */
+class RegressionMetrics
+{
+private:
+	unsigned int outputCount;
+
+	// per output node
+	std::vector<double> sumSquaredError;
+	std::vector<double> sumAbsError;
+	std::vector<RunningStat> targets;
+
+	// |error| sketch over every output, bin 0 holds errors at or below MIN_ERROR
+	std::vector<uint64_t> errorBins;
+	uint64_t errorTotal;
+	double logGamma;
+
+	unsigned int binOf(float) const;
+	float binValue(unsigned int) const;
+
+public:
+	static const float ERROR_ACCURACY;
+	static const float MIN_ERROR;
+	static const float MAX_ERROR;
+
+	RegressionMetrics();
+	~RegressionMetrics();
+
+	// sets
+	void build(unsigned int);
+	void addResult(unsigned int, float, float);
+	void addResults(const float*, const float*, unsigned int);
+	void merge(const RegressionMetrics&);
+	void reset();
+	void clean();
+
+	// gets
+	unsigned int size() const;
+	uint64_t getCount() const;
+	float getMSE(unsigned int) const;
+	float getRMSE(unsigned int) const;
+	float getMAE(unsigned int) const;
+	float getR2(unsigned int) const;
+	float getOverallMSE() const;
+	float getOverallRMSE() const;
+	float getOverallMAE() const;
+	float getOverallR2() const;
+	float getErrorQuantile(float) const;
+	void print() const;
+};
+};
+
+#endif
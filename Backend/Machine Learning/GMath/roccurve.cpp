@@ -0,0 +1,343 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "roccurve.h"
+
+using namespace glades;
+
+const float glades::ROCCurve::POSITIVE_THRESHOLD = 0.5f;
+
+glades::ROCCurve::ROCCurve()
+{
+	classCount = 0;
+	bins = 0;
+	minScore = 0.0f;
+	maxScore = 1.0f;
+	binScale = 0.0f;
+}
+
+glades::ROCCurve::~ROCCurve()
+{
+	clean();
+}
+
+/*!
+ * @brief build
+ * @details size the histograms; clears the counts
+ * @param newClassCount the number of classes (output nodes)
+ * @param newBins the number of score bins per class
+ * @param newMinScore the lowest score, lower scores land in the first bin
+ * @param newMaxScore the highest score, higher scores land in the last bin
+ */
+void glades::ROCCurve::build(unsigned int newClassCount, unsigned int newBins, float newMinScore,
+							 float newMaxScore)
+{
+	clean();
+	if ((newBins == 0) || (newMaxScore <= newMinScore))
+	{
+		printf("[ROC] Bad histogram: %u bins over [%f, %f]\n", newBins, newMinScore, newMaxScore);
+		return;
+	}
+
+	classCount = newClassCount;
+	bins = newBins;
+	minScore = newMinScore;
+	maxScore = newMaxScore;
+	binScale = ((float)bins) / (maxScore - minScore);
+	positives.assign(classCount * bins, 0);
+	negatives.assign(classCount * bins, 0);
+}
+
+unsigned int glades::ROCCurve::binOf(float score) const
+{
+	// NaN fails both comparisons and lands in bin 0
+	if (!(score > minScore))
+		return 0;
+
+	unsigned int bin = (unsigned int)((score - minScore) * binScale);
+	return (bin < bins) ? bin : bins - 1;
+}
+
+/*!
+ * @brief add result
+ * @param classIndex the class
+ * @param score the predicted score for the class
+ * @param positive whether the class was the expected one
+ */
+void glades::ROCCurve::addResult(unsigned int classIndex, float score, bool positive)
+{
+	if (classIndex >= classCount)
+		return;
+
+	unsigned int cell = (classIndex * bins) + binOf(score);
+	if (positive)
+		++positives[cell];
+	else
+		++negatives[cell];
+}
+
+/*!
+ * @brief add results
+ * @param pred n rows of classCount predicted scores
+ * @param exp n rows of classCount expected values
+ * @param n the number of samples
+ */
+void glades::ROCCurve::addResults(const float* pred, const float* exp, unsigned int n)
+{
+	for (unsigned int s = 0; s < n; ++s)
+	{
+		const float* cPred = pred + (s * classCount);
+		const float* cExp = exp + (s * classCount);
+		for (unsigned int c = 0; c < classCount; ++c)
+		{
+			unsigned int cell = (c * bins) + binOf(cPred[c]);
+			if (cExp[c] > POSITIVE_THRESHOLD)
+				++positives[cell];
+			else
+				++negatives[cell];
+		}
+	}
+}
+
+/*!
+ * @brief merge
+ * @param other a curve with the same classes and bins
+ */
+void glades::ROCCurve::merge(const ROCCurve& other)
+{
+	if ((other.classCount != classCount) || (other.bins != bins))
+	{
+		printf("[ROC] Cannot merge %ux%u histograms into %ux%u\n", other.classCount, other.bins,
+			   classCount, bins);
+		return;
+	}
+
+	for (unsigned int i = 0; i < positives.size(); ++i)
+	{
+		positives[i] += other.positives[i];
+		negatives[i] += other.negatives[i];
+	}
+}
+
+void glades::ROCCurve::reset()
+{
+	positives.assign(positives.size(), 0);
+	negatives.assign(negatives.size(), 0);
+}
+
+void glades::ROCCurve::clean()
+{
+	classCount = 0;
+	bins = 0;
+	binScale = 0.0f;
+	positives.clear();
+	negatives.clear();
+}
+
+unsigned int glades::ROCCurve::size() const
+{
+	return classCount;
+}
+
+unsigned int glades::ROCCurve::numberOfBins() const
+{
+	return bins;
+}
+
+uint64_t glades::ROCCurve::getPositives(unsigned int classIndex) const
+{
+	if (classIndex >= classCount)
+		return 0;
+
+	uint64_t total = 0;
+	const uint64_t* cPos = &positives[classIndex * bins];
+	for (unsigned int b = 0; b < bins; ++b)
+		total += cPos[b];
+
+	return total;
+}
+
+uint64_t glades::ROCCurve::getNegatives(unsigned int classIndex) const
+{
+	if (classIndex >= classCount)
+		return 0;
+
+	uint64_t total = 0;
+	const uint64_t* cNeg = &negatives[classIndex * bins];
+	for (unsigned int b = 0; b < bins; ++b)
+		total += cNeg[b];
+
+	return total;
+}
+
+/*!
+ * @brief get AUC
+ * @details area under the ROC curve: the chance a random positive outscores a random negative,
+ * ties within a bin counting half. Sweeps the thresholds from the top bin down.
+ * @param classIndex the class
+ * @return the AUC, or 0.5 when the class has no positives or no negatives
+ */
+float glades::ROCCurve::getAUC(unsigned int classIndex) const
+{
+	uint64_t P = getPositives(classIndex);
+	uint64_t N = getNegatives(classIndex);
+	if ((P == 0) || (N == 0))
+		return 0.5f;
+
+	const uint64_t* cPos = &positives[classIndex * bins];
+	const uint64_t* cNeg = &negatives[classIndex * bins];
+	double area = 0.0;
+	uint64_t tp = 0;
+	for (unsigned int b = bins; b > 0; --b)
+	{
+		area += ((double)cNeg[b - 1]) * (((double)tp) + (0.5 * (double)cPos[b - 1]));
+		tp += cPos[b - 1];
+	}
+
+	return (float)(area / (((double)P) * ((double)N)));
+}
+
+/*!
+ * @brief get overall AUC
+ * @details macro average over the classes that saw both positives and negatives
+ * @return the average AUC, or 0.5 when no class qualifies
+ */
+float glades::ROCCurve::getOverallAUC() const
+{
+	float total = 0.0f;
+	unsigned int counted = 0;
+	for (unsigned int c = 0; c < classCount; ++c)
+	{
+		if ((getPositives(c) == 0) || (getNegatives(c) == 0))
+			continue;
+
+		total += getAUC(c);
+		++counted;
+	}
+
+	if (counted == 0)
+		return 0.5f;
+
+	return total / ((float)counted);
+}
+
+/*!
+ * @brief get average precision
+ * @details area under the precision-recall curve as the sum of precision times the recall gained
+ * at each threshold
+ * @param classIndex the class
+ * @return the average precision, or 0 when the class has no positives
+ */
+float glades::ROCCurve::getAveragePrecision(unsigned int classIndex) const
+{
+	uint64_t P = getPositives(classIndex);
+	if (P == 0)
+		return 0.0f;
+
+	const uint64_t* cPos = &positives[classIndex * bins];
+	const uint64_t* cNeg = &negatives[classIndex * bins];
+	double ap = 0.0;
+	uint64_t tp = 0;
+	uint64_t fp = 0;
+	for (unsigned int b = bins; b > 0; --b)
+	{
+		tp += cPos[b - 1];
+		fp += cNeg[b - 1];
+		if (cPos[b - 1] > 0)
+			ap += (((double)cPos[b - 1]) / ((double)P)) * (((double)tp) / ((double)(tp + fp)));
+	}
+
+	return (float)ap;
+}
+
+/*!
+ * @brief get ROC
+ * @details one point per threshold, from (0, 0) with every bin above the threshold to (1, 1)
+ * @param classIndex the class
+ * @param fpr receives the false positive rates
+ * @param tpr receives the true positive rates
+ */
+void glades::ROCCurve::getROC(unsigned int classIndex, std::vector<float>& fpr,
+							  std::vector<float>& tpr) const
+{
+	fpr.clear();
+	tpr.clear();
+	uint64_t P = getPositives(classIndex);
+	uint64_t N = getNegatives(classIndex);
+	if ((P == 0) || (N == 0))
+		return;
+
+	const uint64_t* cPos = &positives[classIndex * bins];
+	const uint64_t* cNeg = &negatives[classIndex * bins];
+	fpr.reserve(bins + 1);
+	tpr.reserve(bins + 1);
+	fpr.push_back(0.0f);
+	tpr.push_back(0.0f);
+	uint64_t tp = 0;
+	uint64_t fp = 0;
+	for (unsigned int b = bins; b > 0; --b)
+	{
+		if ((cPos[b - 1] == 0) && (cNeg[b - 1] == 0))
+			continue;
+
+		tp += cPos[b - 1];
+		fp += cNeg[b - 1];
+		fpr.push_back((float)(((double)fp) / ((double)N)));
+		tpr.push_back((float)(((double)tp) / ((double)P)));
+	}
+}
+
+/*!
+ * @brief get PR
+ * @details one point per non empty threshold, from the top bin down
+ * @param classIndex the class
+ * @param recall receives the recalls
+ * @param precision receives the precisions
+ */
+void glades::ROCCurve::getPR(unsigned int classIndex, std::vector<float>& recall,
+							 std::vector<float>& precision) const
+{
+	recall.clear();
+	precision.clear();
+	uint64_t P = getPositives(classIndex);
+	if (P == 0)
+		return;
+
+	const uint64_t* cPos = &positives[classIndex * bins];
+	const uint64_t* cNeg = &negatives[classIndex * bins];
+	recall.reserve(bins);
+	precision.reserve(bins);
+	uint64_t tp = 0;
+	uint64_t fp = 0;
+	for (unsigned int b = bins; b > 0; --b)
+	{
+		if ((cPos[b - 1] == 0) && (cNeg[b - 1] == 0))
+			continue;
+
+		tp += cPos[b - 1];
+		fp += cNeg[b - 1];
+		recall.push_back((float)(((double)tp) / ((double)P)));
+		precision.push_back((float)(((double)tp) / ((double)(tp + fp))));
+	}
+}
+
+void glades::ROCCurve::print() const
+{
+	printf("[ROC] %u classes, %u bins\n", classCount, bins);
+	for (unsigned int c = 0; c < classCount; ++c)
+		printf("[ROC] Class %u: AUC %f AP %f (%llu+ %llu-)\n", c, getAUC(c), getAveragePrecision(c),
+			   (unsigned long long)getPositives(c), (unsigned long long)getNegatives(c));
+}
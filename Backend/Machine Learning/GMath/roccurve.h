@@ -0,0 +1,81 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _ROCCURVE
+#define _ROCCURVE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace glades {
+
+/*!
+ * @brief streaming ROC/PR curves
+ * @details each class (one vs rest) keeps two fixed histograms of its predicted scores, one for
+ * rows where it was the expected class and one for the rest. Every bin edge is a threshold, so
+ * the ROC and precision-recall curves and the AUC come out of one O(bins) sweep at epoch end
+ * without keeping the predictions. Scores tied within a bin count as half above the threshold,
+ * so the AUC is exact up to the bin width. Like CMatrix, each thread can fill its own curve and
+ * merge it at epoch end.
+ */
+class ROCCurve
+{
+private:
+	unsigned int classCount;
+	unsigned int bins;
+	float minScore;
+	float maxScore;
+	float binScale;
+
+	// classCount x bins, row major
+	std::vector<uint64_t> positives;
+	std::vector<uint64_t> negatives;
+
+	unsigned int binOf(float) const;
+
+public:
+	static const unsigned int DEFAULT_BINS = 1024;
+
+	// an expected value above this marks the row as a positive for that class
+	static const float POSITIVE_THRESHOLD;
+
+	ROCCurve();
+	~ROCCurve();
+
+	// sets
+	void build(unsigned int, unsigned int = DEFAULT_BINS, float = 0.0f, float = 1.0f);
+	void addResult(unsigned int, float, bool);
+	void addResults(const float*, const float*, unsigned int);
+	void merge(const ROCCurve&);
+	void reset();
+	void clean();
+
+	// gets
+	unsigned int size() const;
+	unsigned int numberOfBins() const;
+	uint64_t getPositives(unsigned int) const;
+	uint64_t getNegatives(unsigned int) const;
+	float getAUC(unsigned int) const;
+	float getOverallAUC() const;
+	float getAveragePrecision(unsigned int) const;
+	void getROC(unsigned int, std::vector<float>&, std::vector<float>&) const;
+	void getPR(unsigned int, std::vector<float>&, std::vector<float>&) const;
+	void print() const;
+};
+};
+
+#endif
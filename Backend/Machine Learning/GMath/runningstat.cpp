@@ -0,0 +1,146 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "runningstat.h"
+
+using namespace glades;
+
+glades::RunningStat::RunningStat()
+{
+	clear();
+}
+
+glades::RunningStat::RunningStat(const RunningStat& rs)
+{
+	count = rs.count;
+	fMin = rs.fMin;
+	fMax = rs.fMax;
+	mean = rs.mean;
+	m2 = rs.m2;
+}
+
+glades::RunningStat::~RunningStat()
+{
+	clear();
+}
+
+void glades::RunningStat::add(float x)
+{
+	if (count == 0)
+	{
+		fMin = x;
+		fMax = x;
+	}
+
+	if (x < fMin)
+		fMin = x;
+	if (x > fMax)
+		fMax = x;
+
+	++count;
+	double delta = x - mean;
+	mean += delta / count;
+	m2 += delta * (x - mean);
+}
+
+/*!
+ * @brief merge
+ * @details combines another accumulator into this one (Chan et al. parallel variance)
+ * @param rs the accumulator to fold in
+ */
+void glades::RunningStat::merge(const RunningStat& rs)
+{
+	if (rs.count == 0)
+		return;
+
+	if (count == 0)
+	{
+		count = rs.count;
+		fMin = rs.fMin;
+		fMax = rs.fMax;
+		mean = rs.mean;
+		m2 = rs.m2;
+		return;
+	}
+
+	if (rs.fMin < fMin)
+		fMin = rs.fMin;
+	if (rs.fMax > fMax)
+		fMax = rs.fMax;
+
+	double total = (double)count + rs.count;
+	double delta = rs.mean - mean;
+	mean += delta * (rs.count / total);
+	m2 += rs.m2 + (delta * delta * ((double)count * rs.count / total));
+	count += rs.count;
+}
+
+void glades::RunningStat::clear()
+{
+	count = 0;
+	fMin = 0.0f;
+	fMax = 0.0f;
+	mean = 0.0;
+	m2 = 0.0;
+}
+
+unsigned int glades::RunningStat::size() const
+{
+	return count;
+}
+
+float glades::RunningStat::getMin() const
+{
+	return fMin;
+}
+
+float glades::RunningStat::getMax() const
+{
+	return fMax;
+}
+
+float glades::RunningStat::getRange() const
+{
+	return fMax - fMin;
+}
+
+double glades::RunningStat::getMean() const
+{
+	return mean;
+}
+
+/*!
+ * @brief variance
+ * @return the sample variance (n - 1), or 0 with fewer than two values
+ */
+double glades::RunningStat::getVariance() const
+{
+	if (count < 2)
+		return 0.0;
+
+	return m2 / (count - 1);
+}
+
+double glades::RunningStat::getStDev() const
+{
+	return sqrt(getVariance());
+}
+
+void glades::RunningStat::print() const
+{
+	printf("[STAT] n: %u, min: %f, max: %f, mean: %f, stdev: %f\n", count, fMin, fMax, mean,
+		   getStDev());
+}
@@ -0,0 +1,62 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GRUNNINGSTAT
+#define _GRUNNINGSTAT
+
+#include <math.h>
+#include <stdio.h>
+
+namespace glades {
+
+/*!
+ * @brief running statistics
+ * @details single pass count/min/max/mean/variance of a stream of values (Welford). Two
+ * accumulators can be merged, so partial results from threads or appended batches combine
+ * without revisiting old values.
+ */
+class RunningStat
+{
+private:
+
+	unsigned int count;
+	float fMin;
+	float fMax;
+	double mean;
+	double m2;
+
+public:
+
+	RunningStat();
+	RunningStat(const RunningStat&);
+	virtual ~RunningStat();
+
+	void add(float);
+	void merge(const RunningStat&);
+	void clear();
+
+	unsigned int size() const;
+	float getMin() const;
+	float getMax() const;
+	float getRange() const;
+	double getMean() const;
+	double getVariance() const;
+	double getStDev() const;
+	void print() const;
+};
+};
+
+#endif
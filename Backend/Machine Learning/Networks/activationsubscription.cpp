@@ -0,0 +1,295 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "activationsubscription.h"
+#include <algorithm>
+
+using namespace glades;
+
+glades::ActivationSubscription::Range::Range(unsigned int newLayer, unsigned int newFirstNode,
+											 unsigned int newNodeCount, unsigned int newStride)
+{
+	layer = newLayer;
+	firstNode = newFirstNode;
+	nodeCount = newNodeCount;
+	stride = (newStride > 0) ? newStride : 1;
+}
+
+bool glades::ActivationSubscription::Range::operator==(const Range& other) const
+{
+	return ((layer == other.layer) && (firstNode == other.firstNode) &&
+			(nodeCount == other.nodeCount) && (stride == other.stride));
+}
+
+/*!
+ * @brief ActivationSubscription constructor
+ * @details subscribes every computed node of the last training row, every epoch
+ */
+glades::ActivationSubscription::ActivationSubscription()
+{
+	sampleInterval = 1;
+	width = 0;
+	recording = false;
+	capturedEpoch = -1;
+	addRange(Range());
+}
+
+/*!
+ * @brief clear
+ * @details drop every range and probe row; nothing is recorded until some are added
+ */
+void glades::ActivationSubscription::clear()
+{
+	ranges.clear();
+	probeRows.clear();
+	sampleInterval = 1;
+}
+
+void glades::ActivationSubscription::addRange(const Range& newRange)
+{
+	ranges.push_back(newRange);
+}
+
+/*!
+ * @brief add layer
+ * @details subscribe every node of a layer
+ * @param layer the layer, 0 for the input row
+ */
+void glades::ActivationSubscription::addLayer(unsigned int layer)
+{
+	addRange(Range(layer));
+}
+
+void glades::ActivationSubscription::addProbeRow(unsigned int row)
+{
+	probeRows.push_back(row);
+}
+
+/*!
+ * @brief set sample interval
+ * @param newInterval record on every newInterval'th epoch
+ */
+void glades::ActivationSubscription::setSampleInterval(int newInterval)
+{
+	sampleInterval = (newInterval > 0) ? newInterval : 1;
+}
+
+const std::vector<ActivationSubscription::Range>& glades::ActivationSubscription::getRanges() const
+{
+	return ranges;
+}
+
+const std::vector<unsigned int>& glades::ActivationSubscription::getProbeRows() const
+{
+	return probeRows;
+}
+
+int glades::ActivationSubscription::getSampleInterval() const
+{
+	return sampleInterval;
+}
+
+/*!
+ * @brief bind
+ * @details resolve the request against a network: expand ALL, clamp the ranges to the layers,
+ * drop probe rows past the data and allocate the values
+ * @param layerSizes the nodes per layer, input layer first
+ * @param rowCount the number of training rows
+ * @return whether anything will be recorded
+ */
+bool glades::ActivationSubscription::bind(const std::vector<int>& layerSizes, unsigned int rowCount)
+{
+	boundRanges.clear();
+	boundColumns.clear();
+	boundProbes.clear();
+	layerWanted.assign(layerSizes.size(), 0);
+	width = 0;
+	values.clear();
+	recording = false;
+	capturedEpoch = -1;
+
+	for (unsigned int i = 0; i < ranges.size(); ++i)
+	{
+		const Range& cRange = ranges[i];
+		unsigned int firstLayer = cRange.layer;
+		unsigned int lastLayer = cRange.layer;
+		if (cRange.layer == ALL)
+		{
+			firstLayer = 1;
+			lastLayer = layerSizes.size() - 1;
+		}
+
+		for (unsigned int l = firstLayer; (l <= lastLayer) && (l < layerSizes.size()); ++l)
+		{
+			if ((layerSizes[l] <= 0) || (cRange.firstNode >= (unsigned int)layerSizes[l]))
+				continue;
+
+			unsigned int available =
+				((unsigned int)layerSizes[l] - cRange.firstNode + cRange.stride - 1) / cRange.stride;
+			unsigned int cNodeCount = std::min(cRange.nodeCount, available);
+			if (cNodeCount == 0)
+				continue;
+
+			boundRanges.push_back(Range(l, cRange.firstNode, cNodeCount, cRange.stride));
+			boundColumns.push_back(width);
+			width += cNodeCount;
+			layerWanted[l] = 1;
+		}
+	}
+
+	// Probe the last row by default
+	if ((probeRows.empty()) && (rowCount > 0))
+		boundProbes.push_back(rowCount - 1);
+	for (unsigned int i = 0; i < probeRows.size(); ++i)
+	{
+		if (probeRows[i] < rowCount)
+			boundProbes.push_back(probeRows[i]);
+	}
+	std::sort(boundProbes.begin(), boundProbes.end());
+	boundProbes.erase(std::unique(boundProbes.begin(), boundProbes.end()), boundProbes.end());
+
+	uint64_t valueCount = (uint64_t)boundProbes.size() * width;
+	if (valueCount > MAX_VALUES)
+		printf("[NN] Activation subscription of %lu values is over the %u limit\n",
+			   (unsigned long)valueCount, MAX_VALUES);
+
+	if ((valueCount == 0) || (valueCount > MAX_VALUES))
+	{
+		boundRanges.clear();
+		boundColumns.clear();
+		boundProbes.clear();
+		layerWanted.assign(layerSizes.size(), 0);
+		width = 0;
+		return false;
+	}
+
+	values.assign(valueCount, 0.0f);
+	return true;
+}
+
+/*!
+ * @brief begin epoch
+ * @details decide whether this epoch records
+ * @param epoch the epoch about to run
+ * @return whether it records
+ */
+bool glades::ActivationSubscription::beginEpoch(int epoch)
+{
+	recording = (isBound()) && ((epoch % sampleInterval) == 0);
+	if (recording)
+		capturedEpoch = epoch;
+
+	return recording;
+}
+
+/*!
+ * @brief get probe
+ * @param row a training row
+ * @return the row's probe index, or -1 when this epoch does not record it
+ */
+int glades::ActivationSubscription::getProbe(unsigned int row) const
+{
+	if (!recording)
+		return -1;
+
+	std::vector<unsigned int>::const_iterator itr =
+		std::lower_bound(boundProbes.begin(), boundProbes.end(), row);
+	if ((itr == boundProbes.end()) || (*itr != row))
+		return -1;
+
+	return itr - boundProbes.begin();
+}
+
+bool glades::ActivationSubscription::wantsLayer(unsigned int layer) const
+{
+	return ((layer < layerWanted.size()) && (layerWanted[layer]));
+}
+
+/*!
+ * @brief record
+ * @details copy a layer's subscribed nodes into a probe row
+ * @param probe the probe index from getProbe
+ * @param layer the layer
+ * @param layerValues the layer's activations, by node
+ * @param layerSize the number of nodes
+ */
+void glades::ActivationSubscription::record(int probe, unsigned int layer, const float* layerValues,
+											unsigned int layerSize)
+{
+	if ((probe < 0) || ((unsigned int)probe >= boundProbes.size()) || (!wantsLayer(layer)))
+		return;
+
+	float* probeValues = &values[probe * width];
+	for (unsigned int i = 0; i < boundRanges.size(); ++i)
+	{
+		const Range& cRange = boundRanges[i];
+		if (cRange.layer != layer)
+			continue;
+
+		float* dest = &probeValues[boundColumns[i]];
+		if ((cRange.stride == 1) && (cRange.firstNode + cRange.nodeCount <= layerSize))
+		{
+			memcpy(dest, &layerValues[cRange.firstNode], cRange.nodeCount * sizeof(float));
+			continue;
+		}
+
+		unsigned int node = cRange.firstNode;
+		for (unsigned int j = 0; (j < cRange.nodeCount) && (node < layerSize); ++j)
+		{
+			dest[j] = layerValues[node];
+			node += cRange.stride;
+		}
+	}
+}
+
+bool glades::ActivationSubscription::isBound() const
+{
+	return (!values.empty());
+}
+
+const std::vector<ActivationSubscription::Range>&
+glades::ActivationSubscription::getBoundRanges() const
+{
+	return boundRanges;
+}
+
+const std::vector<unsigned int>& glades::ActivationSubscription::getBoundProbes() const
+{
+	return boundProbes;
+}
+
+unsigned int glades::ActivationSubscription::getWidth() const
+{
+	return width;
+}
+
+/*!
+ * @brief get values
+ * @return the recorded activations, getWidth() per probe row
+ */
+const std::vector<float>& glades::ActivationSubscription::getValues() const
+{
+	return values;
+}
+
+/*!
+ * @brief get captured epoch
+ * @return the last epoch that recorded, or -1
+ */
+int glades::ActivationSubscription::getCapturedEpoch() const
+{
+	return capturedEpoch;
+}
@@ -0,0 +1,107 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GACTIVATIONSUBSCRIPTION
+#define _GACTIVATIONSUBSCRIPTION
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace glades {
+
+/*!
+ * @brief activation subscription
+ * @details which activations the trainer records for the GUI: neuron ranges of chosen layers,
+ * the training rows to probe and how often (in epochs) to record them. bind() resolves the
+ * request against the network's layer sizes and preallocates the buffer, so recording in the
+ * forward pass is a copy of the subscribed nodes of the probe rows and nothing else.
+ *
+ * Layer 0 is the input row; ALL as a range's layer means every layer the forward pass computes
+ * (hidden and output). With no probe rows the last training row is probed. Values are probe
+ * major: each probe row's subscribed nodes, range after range.
+ */
+class ActivationSubscription
+{
+public:
+	static const unsigned int ALL = 0xFFFFFFFF;
+	static const unsigned int MAX_VALUES = 1 << 20; // recorded floats per sample
+
+	/*!
+	 * @brief neuron range
+	 * @details nodeCount nodes of a layer from firstNode, every stride'th one
+	 */
+	class Range
+	{
+	public:
+		unsigned int layer;
+		unsigned int firstNode;
+		unsigned int nodeCount;
+		unsigned int stride;
+
+		Range(unsigned int = ALL, unsigned int = 0, unsigned int = ALL, unsigned int = 1);
+		bool operator==(const Range&) const;
+	};
+
+private:
+	// the request
+	std::vector<Range> ranges;
+	std::vector<unsigned int> probeRows;
+	int sampleInterval;
+
+	// bound to a network
+	std::vector<Range> boundRanges; // clamped, nodeCount is the number of recorded nodes
+	std::vector<unsigned int> boundColumns; // per bound range, its first value in a probe row
+	std::vector<unsigned int> boundProbes; // sorted
+	std::vector<char> layerWanted;
+	unsigned int width; // values per probe row
+	std::vector<float> values;
+
+	bool recording;
+	int capturedEpoch;
+
+public:
+	ActivationSubscription();
+
+	// request
+	void clear();
+	void addRange(const Range&);
+	void addLayer(unsigned int);
+	void addProbeRow(unsigned int);
+	void setSampleInterval(int);
+	const std::vector<Range>& getRanges() const;
+	const std::vector<unsigned int>& getProbeRows() const;
+	int getSampleInterval() const;
+
+	// trainer
+	bool bind(const std::vector<int>&, unsigned int);
+	bool beginEpoch(int);
+	int getProbe(unsigned int) const;
+	bool wantsLayer(unsigned int) const;
+	void record(int, unsigned int, const float*, unsigned int);
+
+	// gets
+	bool isBound() const;
+	const std::vector<Range>& getBoundRanges() const;
+	const std::vector<unsigned int>& getBoundProbes() const;
+	unsigned int getWidth() const;
+	const std::vector<float>& getValues() const;
+	int getCapturedEpoch() const;
+};
+};
+
+#endif
@@ -11,91 +11,85 @@ void GaussianProcess::addSample(float x, float y)
 void GaussianProcess::fit()
 {
     unsigned int n = X_.size();
-    K_.resize(n);
-    for (unsigned int i = 0; i < n; ++i)
-    {
-        K_[i].resize(n);
-    }
+    K_.resize(n, n);
 
     // Build the covariance matrix
     for (unsigned int i = 0; i < n; ++i)
     {
+        float* kRow = K_.row(i);
         for (unsigned int j = 0; j < n; ++j)
         {
-            K_[i][j] = rbfKernel(X_[i], X_[j], length_scale_, variance_);
+            kRow[j] = rbfKernel(X_[i], X_[j], length_scale_, variance_);
         }
-        K_[i][i] += noise_;  // Add noise to the diagonal
+        kRow[i] += noise_;  // Add noise to the diagonal
     }
 
     // Compute the inverse of the covariance matrix (K_inv = K^-1)
     K_inv_ = invertMatrix(K_);
+
+    // The mean weights only depend on the samples, so predict() is a single dot
+    alpha_.resize(n);
+    if (n > 0)
+        GMatrix::multiplyVector(K_inv_, &y_[0], &alpha_[0]);
 }
 
 std::pair<float, float> GaussianProcess::predict(float x) const
 {
-    unsigned int n = X_.size();
-    std::vector<float> k(n);
+    unsigned int n = alpha_.size();
+    float sigma2 = rbfKernel(x, x, length_scale_, variance_);
+    if (n == 0)
+        return std::make_pair(0.0f, sigma2);
 
     // Compute k vector
+    std::vector<float> k(n);
     for (unsigned int i = 0; i < n; ++i)
     {
         k[i] = rbfKernel(X_[i], x, length_scale_, variance_);
     }
 
-    // Compute mean prediction (mu)
-    float mu = 0.0f;
-    for (unsigned int i = 0; i < n; ++i)
-    {
-        for (unsigned int j = 0; j < n; ++j)
-        {
-            mu += k[i] * K_inv_[i][j] * y_[j];
-        }
-    }
+    // Compute mean prediction (mu = k^T K_inv y)
+    float mu = GMatrix::dot(&k[0], &alpha_[0], n);
 
-    // Compute variance (sigma^2)
-    float sigma2 = rbfKernel(x, x, length_scale_, variance_);
-    for (unsigned int i = 0; i < n; ++i)
-    {
-        for (unsigned int j = 0; j < n; ++j)
-        {
-            sigma2 -= k[i] * K_inv_[i][j] * k[j];
-        }
-    }
+    // Compute variance (sigma^2 = k(x, x) - k^T K_inv k)
+    std::vector<float> kInvK(n);
+    GMatrix::multiplyVector(K_inv_, &k[0], &kInvK[0]);
+    sigma2 -= GMatrix::dot(&k[0], &kInvK[0], n);
 
     return std::make_pair(mu, sigma2);
 }
 
-// Matrix inversion using Gaussian elimination (for small matrices)
-std::vector<std::vector<float> > GaussianProcess::invertMatrix(const std::vector<std::vector<float> >& matrix) const
+// Matrix inversion using Gauss-Jordan elimination (for small matrices)
+GMatrix GaussianProcess::invertMatrix(const GMatrix& matrix) const
 {
-    unsigned int n = matrix.size();
-    std::vector<std::vector<float> > inv_matrix(n, std::vector<float>(n, 0.0f));
-    std::vector<std::vector<float> > A = matrix;
+    unsigned int n = matrix.numberOfRows();
+    GMatrix inv_matrix(n, n);
+    GMatrix A = matrix;
 
     // Initialize the identity matrix
-    for (unsigned int i = 0; i < n; ++i)
-    {
-        inv_matrix[i][i] = 1.0f;
-    }
+    inv_matrix.setIdentity();
 
     // Gaussian elimination
     for (unsigned int i = 0; i < n; ++i)
     {
-        float diag_element = A[i][i];
+        float* pivotRow = A.row(i);
+        float* pivotInv = inv_matrix.row(i);
+        float diag_element = pivotRow[i];
         for (unsigned int j = 0; j < n; ++j)
         {
-            A[i][j] /= diag_element;
-            inv_matrix[i][j] /= diag_element;
+            pivotRow[j] /= diag_element;
+            pivotInv[j] /= diag_element;
         }
         for (unsigned int k = 0; k < n; ++k)
         {
             if (k != i)
     	{
-                float factor = A[k][i];
+                float* aRow = A.row(k);
+                float* invRow = inv_matrix.row(k);
+                float factor = aRow[i];
                 for (unsigned int j = 0; j < n; ++j)
     	    {
-                    A[k][j] -= factor * A[i][j];
-                    inv_matrix[k][j] -= factor * inv_matrix[i][j];
+                    aRow[j] -= factor * pivotRow[j];
+                    invRow[j] -= factor * pivotInv[j];
                 }
             }
         }
@@ -124,24 +118,10 @@ void GaussianProcess::printInput() const
 void GaussianProcess::print() const
 {
 	printf("K: \n");
-	for (unsigned int i = 0; i < K_.size(); ++i)
-	{
-		for (unsigned int j = 0; j < K_[i].size(); ++j)
-		{
-			printf("%f ", K_[i][j]);
-		}
-		printf("\n");
-	}
+	K_.print();
 
 	printf("K_inv: \n");
-	for (unsigned int i = 0; i < K_inv_.size(); ++i)
-	{
-		for (unsigned int j = 0; j < K_inv_[i].size(); ++j)
-		{
-			printf("%f ", K_inv_[i][j]);
-		}
-		printf("\n");
-	}
+	K_inv_.print();
 }
 
 float BayesianOptimizer::optimize(std::vector<std::pair<float, float> > data)
@@ -19,6 +19,7 @@
 
 #include "Backend/Database/GTable.h"
 #include "../GMath/OHE.h"
+#include "../GMath/gmatrix.h"
 #include <iostream>
 #include <vector>
 #include <cmath>
@@ -47,14 +48,15 @@ public:
 private:
     std::vector<float> X_;                 // Observations (inputs)
     std::vector<float> y_;                 // Observations (outputs)
-    std::vector<std::vector<float> > K_;        // Covariance matrix
-    std::vector<std::vector<float> > K_inv_;    // Inverse of covariance matrix
+    GMatrix K_;                       // Covariance matrix
+    GMatrix K_inv_;                   // Inverse of covariance matrix
+    std::vector<float> alpha_;        // K_inv * y, cached by fit()
     float length_scale_;              // Length scale of the RBF kernel
     float variance_;                  // Variance of the RBF kernel
     float noise_;                     // Noise level
 
     // Matrix inversion using Gaussian elimination (for small matrices)
-    std::vector<std::vector<float> > invertMatrix(const std::vector<std::vector<float> >& matrix) const;
+    GMatrix invertMatrix(const GMatrix& matrix) const;
 
     // Kernel function for Gaussian Process (RBF Kernel)
     static float rbfKernel(float x1, float x2, float length_scale = 1.0, float variance = 1.0)
@@ -0,0 +1,299 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "inference.h"
+#include "Backend/Database/GList.h"
+#include "../DataObjects/DataInput.h"
+#include "../GMath/gmath.h"
+#include "../State/LayerBuilder.h"
+#include "../State/layer.h"
+#include "../State/node.h"
+#include "../Structure/nninfo.h"
+#include <algorithm>
+
+using namespace glades;
+
+glades::InferenceModel::InferenceModel()
+{
+	epoch = 0;
+	outputType = GMath::REGRESSION;
+	outputActivation = GMath::SIGMOID;
+	precision = GMath::PRECISION_EXACT;
+}
+
+glades::InferenceModel::~InferenceModel()
+{
+	clear();
+}
+
+// Resize only on a shape change, so a model captured over and over keeps its blocks
+static void reshape(GMatrix& matrix, unsigned int rows, unsigned int cols)
+{
+	if ((matrix.numberOfRows() != rows) || (matrix.numberOfCols() != cols))
+		matrix.resize(rows, cols);
+}
+
+// The share of a layer's nodes training keeps; Layer::generateDropout only drops for 0 < p < 1
+static float keepRate(float pDropout)
+{
+	if ((pDropout <= 0.0f) || (pDropout >= 1.0f))
+		return 1.0f;
+
+	return 1.0f - pDropout;
+}
+
+/*!
+ * @brief capture
+ * @details copy the network's current fp32 master weights, biases and activation kernels. One
+ * pass over the weights, about the cost of forwarding a single row. Training drops nodes without
+ * rescaling the survivors, so each layer's weights are scaled by the share of its input nodes
+ * training keeps: the model sees every node and predicts what training does on average. The
+ * weight and batch buffers of an earlier capture are reused when the network's shape has not
+ * changed.
+ * @param meat the network's layers
+ * @param skeleton the network's structure
+ * @param activationPlan each layer's resolved kernels
+ * @param newEpoch the epoch the weights come from
+ * @param masters the network's per layer weights (rows are output nodes) while it trains; NULL
+ * reads the edges
+ * @return whether the network was built
+ */
+bool glades::InferenceModel::capture(LayerBuilder& meat, const NNInfo* skeleton,
+									 const std::vector<ActivationPlan>& activationPlan,
+									 int newEpoch, const std::vector<GMatrix>* masters)
+{
+	if (!skeleton)
+	{
+		clear();
+		return false;
+	}
+
+	int layerCount = skeleton->numHiddenLayers() + 1;
+	if ((int)activationPlan.size() != layerCount)
+	{
+		clear();
+		return false;
+	}
+
+	weights.resize(layerCount);
+	bias.assign(layerCount, 0.0f);
+	for (int l = 0; l < layerCount; ++l)
+	{
+		Layer* cInputLayer = meat.getLayer(0, l);
+		Layer* cOutputLayer = meat.getLayer(0, l + 1);
+		if ((!cInputLayer) || (!cOutputLayer) || (cInputLayer->size() == 0) ||
+			(cOutputLayer->size() == 0))
+		{
+			clear();
+			return false;
+		}
+
+		// Input Layer fundamentally cannot have a bias
+		if (cInputLayer->getType() != Layer::INPUT_TYPE)
+			bias[l] = cInputLayer->getBiasWeight();
+
+		const GMatrix* master = NULL;
+		if ((masters) && (l < (int)masters->size()) &&
+			((*masters)[l].numberOfRows() == cOutputLayer->size()) &&
+			((*masters)[l].numberOfCols() == cInputLayer->size()))
+			master = &(*masters)[l];
+
+		// The rate SGDHelper draws the input layer's mask with
+		float keep = keepRate((l == 0) ? skeleton->getPInput() : skeleton->getPDropout(l - 1));
+
+		GMatrix& cWeights = weights[l];
+		reshape(cWeights, cInputLayer->size(), cOutputLayer->size());
+		for (unsigned int j = 0; j < cOutputLayer->size(); ++j)
+		{
+			Node* cOutputNode = (*cOutputLayer)[j];
+			for (unsigned int i = 0; i < cInputLayer->size(); ++i)
+				cWeights(i, j) =
+					keep * (master ? (*master)(j, i) : cOutputNode->getEdgeWeight(i));
+		}
+	}
+
+	plan = activationPlan;
+	epoch = newEpoch;
+	outputType = skeleton->getOutputType();
+	outputActivation = skeleton->getActivationType(skeleton->numHiddenLayers());
+	precision = skeleton->getPrecision();
+
+	// Batch buffers, allocated once
+	acts.resize(layerCount + 1);
+	reshape(acts[0], BATCH_SIZE, getInputSize());
+	for (int l = 0; l < layerCount; ++l)
+		reshape(acts[l + 1], BATCH_SIZE, weights[l].numberOfCols());
+	expected.resize(BATCH_SIZE * getOutputSize());
+
+	return true;
+}
+
+/*!
+ * @brief predict
+ * @details push up to BATCH_SIZE train rows of a data set through the model: the bias and the
+ * layer's activation kernel follow each GEMM, softmax outputs are normalized per row. The
+ * predictions are left in getOutput() and the expected values in getExpected().
+ * @param di the rows to score
+ * @param batchStart the first row of the batch
+ * @return the number of rows in the batch
+ */
+unsigned int glades::InferenceModel::predict(const DataInput* di, unsigned int batchStart)
+{
+	if ((empty()) || (!di) || (batchStart >= di->getTrainSize()))
+		return 0;
+
+	unsigned int batchRows = di->getTrainSize() - batchStart;
+	if (batchRows > BATCH_SIZE)
+		batchRows = BATCH_SIZE;
+
+	unsigned int featureCount = getInputSize();
+	unsigned int outputSize = getOutputSize();
+
+	// Inputs and expected values; rows past the end of the data stay zero
+	GMatrix& X = acts[0];
+	X.fill(0.0f);
+	for (unsigned int b = 0; b < batchRows; ++b)
+	{
+		const shmea::GList cRow = di->getTrainRow(batchStart + b);
+		float* xRow = X.row(b);
+		for (unsigned int c = 0; (c < featureCount) && (c < cRow.size()); ++c)
+			xRow[c] = LayerBuilder::cellWeight(cRow[c]);
+
+		const shmea::GList expectedRow = di->getTrainExpectedRow(batchStart + b);
+		for (unsigned int i = 0; i < outputSize; ++i)
+			expected[(b * outputSize) + i] = expectedRow.getFloat(i);
+	}
+
+	// Layer by layer over the whole batch
+	unsigned int layerCount = getLayerCount();
+	for (unsigned int l = 0; l < layerCount; ++l)
+	{
+		GMatrix& Y = acts[l + 1];
+		GMatrix::multiply(acts[l], weights[l], Y);
+
+		bool isOutputLayer = (l == layerCount - 1);
+		const ActivationPlan& cPlan = plan[l];
+		for (unsigned int b = 0; b < batchRows; ++b)
+		{
+			float* yRow = Y.row(b);
+			for (unsigned int j = 0; j < Y.numberOfCols(); ++j)
+				yRow[j] += bias[l];
+
+			if ((isOutputLayer) && (outputType == GMath::SOFTMAX))
+			{
+				net.assign(yRow, yRow + Y.numberOfCols());
+				GMath::softmax(net, precision);
+				for (unsigned int j = 0; j < Y.numberOfCols(); ++j)
+					yRow[j] = net[j];
+			}
+			else
+				cPlan.squash(yRow, Y.numberOfCols(), cPlan.fxParam);
+		}
+	}
+
+	return batchRows;
+}
+
+/*!
+ * @brief swap
+ * @details exchange two models without copying their weights
+ * @param other the model to swap with
+ */
+void glades::InferenceModel::swap(InferenceModel& other)
+{
+	std::swap(epoch, other.epoch);
+	std::swap(outputType, other.outputType);
+	std::swap(outputActivation, other.outputActivation);
+	std::swap(precision, other.precision);
+	weights.swap(other.weights);
+	bias.swap(other.bias);
+	plan.swap(other.plan);
+	acts.swap(other.acts);
+	expected.swap(other.expected);
+	net.swap(other.net);
+}
+
+void glades::InferenceModel::clear()
+{
+	epoch = 0;
+	weights.clear();
+	bias.clear();
+	plan.clear();
+	acts.clear();
+	expected.clear();
+	net.clear();
+}
+
+bool glades::InferenceModel::empty() const
+{
+	return weights.empty();
+}
+
+int glades::InferenceModel::getEpoch() const
+{
+	return epoch;
+}
+
+int glades::InferenceModel::getOutputType() const
+{
+	return outputType;
+}
+
+int glades::InferenceModel::getOutputActivation() const
+{
+	return outputActivation;
+}
+
+unsigned int glades::InferenceModel::getLayerCount() const
+{
+	return weights.size();
+}
+
+unsigned int glades::InferenceModel::getInputSize() const
+{
+	if (weights.empty())
+		return 0;
+
+	return weights[0].numberOfRows();
+}
+
+unsigned int glades::InferenceModel::getOutputSize() const
+{
+	if (weights.empty())
+		return 0;
+
+	return weights[weights.size() - 1].numberOfCols();
+}
+
+/*!
+ * @brief get output
+ * @details the last predict() batch's output activations, one row per data row
+ * @return the output layer's batch matrix
+ */
+const GMatrix& glades::InferenceModel::getOutput() const
+{
+	return acts[acts.size() - 1];
+}
+
+/*!
+ * @brief get expected
+ * @param b the row within the last predict() batch
+ * @return that row's expected output values
+ */
+const float* glades::InferenceModel::getExpected(unsigned int b) const
+{
+	return &expected[b * getOutputSize()];
+}
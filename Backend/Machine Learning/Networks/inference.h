@@ -0,0 +1,82 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GINFERENCE
+#define _GINFERENCE
+
+#include "../GMath/activations.h"
+#include "../GMath/gmatrix.h"
+#include <stdio.h>
+#include <vector>
+
+namespace glades {
+
+class DataInput;
+class LayerBuilder;
+class NNInfo;
+
+/*!
+ * @brief inference model
+ * @details a detached fp32 copy of a network's weights: each layer's weights as an inputs x
+ * outputs GMatrix (so a batch of rows times the matrix gives the layer's net inputs), its bias
+ * and its activation kernels. Rows are scored BATCH_SIZE at a time with one blocked GEMM per
+ * layer; every node is active and nothing is kept for back propagation. Once captured it no
+ * longer touches the network, so another thread can score with it while training goes on.
+ */
+class InferenceModel
+{
+private:
+	int epoch;
+	int outputType;
+	int outputActivation;
+	int precision;
+
+	std::vector<GMatrix> weights;
+	std::vector<float> bias;
+	std::vector<ActivationPlan> plan;
+
+	// the activations of one batch of rows per layer, [0] = inputs, and their expected values
+	std::vector<GMatrix> acts;
+	std::vector<float> expected;
+	std::vector<float> net;
+
+public:
+	// rows per batch
+	static const unsigned int BATCH_SIZE = 64;
+
+	InferenceModel();
+	~InferenceModel();
+
+	bool capture(LayerBuilder&, const NNInfo*, const std::vector<ActivationPlan>&, int,
+				 const std::vector<GMatrix>* = NULL);
+	unsigned int predict(const DataInput*, unsigned int);
+	void swap(InferenceModel&);
+	void clear();
+
+	// gets
+	bool empty() const;
+	int getEpoch() const;
+	int getOutputType() const;
+	int getOutputActivation() const;
+	unsigned int getLayerCount() const;
+	unsigned int getInputSize() const;
+	unsigned int getOutputSize() const;
+	const GMatrix& getOutput() const;
+	const float* getExpected(unsigned int) const;
+};
+};
+
+#endif
@@ -21,8 +21,10 @@
 #include "Backend/Database/ServiceData.h"
 #include "Backend/Networking/main.h"
 #include "../GMath/OHE.h"
+#include "../GMath/activations.h"
 #include "../GMath/cmatrix.h"
 #include "../GMath/gmath.h"
+#include "../GMath/grandom.h"
 #include "../State/LayerBuilder.h"
 #include "../State/NetworkState.h"
 #include "../State/Terminator.h"
@@ -32,6 +34,7 @@
 #include "../Structure/nninfo.h"
 #include "../DataObjects/NumberInput.h"
 #include "../DataObjects/ImageInput.h"
+#include "../DataObjects/StreamInput.h"
 
 using namespace glades;
 
@@ -48,9 +51,12 @@ glades::NNetwork::NNetwork()
 	skeleton = NULL;
 	serverInstance = NULL;
 	cConnection = NULL;
+	validationInput = NULL;
+	validationInterval = Validator::DEFAULT_INTERVAL;
 	clean();
 	netType = TYPE_DFF;
 	minibatchSize = NNInfo::BATCH_STOCHASTIC;
+	setSeed(GRandom::local().next());
 }
 
 /*!
@@ -67,10 +73,13 @@ glades::NNetwork::NNetwork(NNInfo* newNNInfo)
 	skeleton = NULL;
 	serverInstance = NULL;
 	cConnection = NULL;
+	validationInput = NULL;
+	validationInterval = Validator::DEFAULT_INTERVAL;
 	clean();
 	skeleton = newNNInfo;
 	netType = TYPE_DFF;
 	minibatchSize = skeleton->getBatchSize();
+	setSeed(GRandom::local().next());
 }
 
 glades::NNetwork::~NNetwork()
@@ -96,6 +105,23 @@ int glades::NNetwork::getEpochs() const
 	return epochs;
 }
 
+/*!
+ * @brief set seed
+ * @details seed this network's random stream (weight init and dropout); set it before training
+ * to make a run reproducible
+ * @param newSeed the seed
+ */
+void glades::NNetwork::setSeed(uint64_t newSeed)
+{
+	seed = newSeed;
+	meat.setSeed(seed);
+}
+
+uint64_t glades::NNetwork::getSeed() const
+{
+	return seed;
+}
+
 void glades::NNetwork::stop()
 {
 	running = false;
@@ -106,9 +132,69 @@ void glades::NNetwork::train(DataInput* newDataInput)
     run(newDataInput, RUN_TRAIN);
 }
 
+/*!
+ * @brief test
+ * @details score a data set with the inference path: no dropout, no gradients, metrics only.
+ * An untrained network is built first.
+ * @param newDataInput the rows to score
+ */
 void glades::NNetwork::test(DataInput* newDataInput)
 {
-    run(newDataInput, RUN_TEST);
+	if (!skeleton)
+		return;
+
+	if (!newDataInput)
+		return;
+
+	di = newDataInput;
+	if ((di->getTrainSize() <= 0) || (di->getFeatureCount() <= 0))
+		return;
+
+	if ((meat.getLayersSize() <= 0) && (!meat.build(skeleton, di, netType)))
+		return;
+
+	evaluate();
+}
+
+/*!
+ * @brief set validation data
+ * @details score a snapshot of the weights on newValidationInput every interval epochs of
+ * train(), on a separate thread while the next epochs run. The rows must not be the ones being
+ * trained on and must stay unchanged during training.
+ * @param newValidationInput the validation rows, or NULL to turn validation off
+ * @param newInterval epochs between snapshots
+ */
+void glades::NNetwork::setValidationData(const DataInput* newValidationInput, int newInterval)
+{
+	validationInput = newValidationInput;
+	validationInterval = newInterval;
+}
+
+const DataInput* glades::NNetwork::getValidationData() const
+{
+	return validationInput;
+}
+
+/*!
+ * @brief ack weight frame
+ * @details called by the GUI service when the GUI has decoded a WEIGHTS_BIN frame; later frames
+ * are sent as deltas against it
+ * @param frameId the frame's id
+ */
+void glades::NNetwork::ackWeightFrame(int64_t frameId)
+{
+	weightStream.ack(frameId);
+}
+
+/*!
+ * @brief subscribe activations
+ * @details called by the GUI service to choose the layers, neuron ranges, probe rows and epoch
+ * interval of the activations it is sent; takes effect at the next epoch
+ * @param newSubscription the subscription
+ */
+void glades::NNetwork::subscribeActivations(const ActivationSubscription& newSubscription)
+{
+	telemetry.subscribe(newSubscription);
 }
 
 void glades::NNetwork::run(DataInput* newDataInput, int runType)
@@ -132,17 +218,23 @@ void glades::NNetwork::run(DataInput* newDataInput, int runType)
 
 	// Set the mini batch size
 	minibatchSize = skeleton->getBatchSize();
+	buildActivationPlan();
 	// Valid layers?
 	if ((meat.getInputLayersSize() <= 0) || (meat.getLayersSize() <= 0))
 		return;
 
+	packLayerWeights();
+
 	if ((di->getTrainSize() <= 0) || (di->getFeatureCount() <= 0))
 		return;
 
 	// Build empty confusion matrix
 	if ((skeleton->getOutputType() == GMath::CLASSIFICATION) ||
-		(skeleton->getOutputType() == GMath::KL))
-		confusionMatrix.build(skeleton->getOutputLayerSize());
+		(skeleton->getOutputType() == GMath::KL) ||
+		(skeleton->getOutputType() == GMath::SOFTMAX))
+		buildClassMetrics();
+	else if (skeleton->getOutputType() == GMath::REGRESSION)
+		regressionMetrics.build(skeleton->getOutputLayerSize());
 
 	// if (DEBUG_ADVANCED)
 	//	meat.print(skeleton);
@@ -156,20 +248,37 @@ void glades::NNetwork::run(DataInput* newDataInput, int runType)
 	if (runType == RUN_TRAIN)
 	{
 		if (skeleton->getOutputType() == GMath::REGRESSION)
-			printf("[NN] Epochs\tAccuracy\n");
+			printf("[NN] Epochs\tAccuracy\tRMSE\t\tMAE\t\tR2\t\tP95 |Error|\n");
 
 		if ((skeleton->getOutputType() == GMath::CLASSIFICATION) ||
-			(skeleton->getOutputType() == GMath::KL))
-			printf("[NN] Epochs\tAccuracy\tPrecision\tRecall\t\tSpecificity\tF1 Score\n");
+			(skeleton->getOutputType() == GMath::KL) ||
+			(skeleton->getOutputType() == GMath::SOFTMAX))
+			printf("[NN] Epochs\tAccuracy\tPrecision\tRecall\t\tSpecificity\tF1 Score\tAUC\n");
 	}
 
 	// Reset the different graphcs e.g. learning curve
 	resetGraphs();
+	evalPolicy.reset();
+
+	// Validation runs beside training
+	if ((runType == RUN_TRAIN) && (validationInput) && (validationInput != di))
+		validator.start(validationInput, validationInterval);
 
 	// arbitrary independent var (time dimension)
 	running = true;
 	firstRunActivation = false;
+	weightStream.reset();
+	if ((runType == RUN_TRAIN) && (serverInstance && cConnection))
+		telemetry.start(serverInstance, cConnection, &weightStream);
+
+	// Record only the subscribed activations
+	std::vector<int> layerSizes;
+	for (int cLayerCounter = 0; cLayerCounter < skeleton->numHiddenLayers() + 2; ++cLayerCounter)
+		layerSizes.push_back(meat.getLayerSize(cLayerCounter));
+	activationSubscription.bind(layerSizes, di->getTrainSize());
+
 	int64_t lastUpdateTime = 0;
+	int64_t lastPlotEpoch = epochs;
 	while (running)
 	{
 		/*if (DEBUG_ADVANCED)
@@ -179,10 +288,24 @@ void glades::NNetwork::run(DataInput* newDataInput, int runType)
 		overallTotalError = 0.0f;
 		overallTotalAccuracy = 0.0f;
 
-		// Reset confusion matrix
-		if ((skeleton->getOutputType() == GMath::CLASSIFICATION) ||
-			(skeleton->getOutputType() == GMath::KL))
+		// Loss and accuracy are kept every epoch, the full metrics when the policy says so
+		collectMetrics = evalPolicy.due(epochs + 1, getCurrentTimeMilliseconds());
+
+		// Reset the class metrics
+		if ((collectMetrics) && ((skeleton->getOutputType() == GMath::CLASSIFICATION) ||
+								 (skeleton->getOutputType() == GMath::KL) ||
+								 (skeleton->getOutputType() == GMath::SOFTMAX)))
+		{
 			confusionMatrix.reset();
+			rocCurve.reset();
+		}
+		else if ((collectMetrics) && (skeleton->getOutputType() == GMath::REGRESSION))
+			regressionMetrics.reset();
+
+		// Take the GUI's latest activation subscription
+		if (telemetry.takeSubscription(activationSubscription))
+			activationSubscription.bind(layerSizes, di->getTrainSize());
+		activationSubscription.beginEpoch(epochs + 1);
 
 		// Recursive FwdPass/BackProp
 		//printf("Input Layers Size: %d\n", meat.getInputLayersSize());
@@ -194,14 +317,25 @@ void glades::NNetwork::run(DataInput* newDataInput, int runType)
 		overallTotalAccuracy /=
 			((float)meat.getInputLayersSize()) * ((float)skeleton->getOutputLayerSize());
 
-		if (skeleton->getOutputType() == GMath::REGRESSION)
+		// Hand the validator this epoch's weights; skipped while the last ones are still queued
+		if (validator.due(epochs))
+		{
+			InferenceModel* snapshot = validator.stage();
+			if ((snapshot) && (snapshot->capture(meat, skeleton, activationPlan, epochs,
+												  &layerMasters)))
+				validator.submit();
+		}
+
+		if ((collectMetrics) && (skeleton->getOutputType() == GMath::REGRESSION))
 		{
 			// Display and debugging
 			if (runType == RUN_TRAIN)
 			{
 				// if (DEBUG_SIMPLE)
 				{
-					printf("\33[2K[NN] %d\t%f%%\r", epochs, overallTotalAccuracy);
+					printf("\33[2K[NN] %d\t%f%%\t%f\t%f\t%f\t%f\r", epochs, overallTotalAccuracy,
+						   regressionMetrics.getOverallRMSE(), regressionMetrics.getOverallMAE(),
+						   regressionMetrics.getOverallR2(), regressionMetrics.getErrorQuantile(0.95f));
 					fflush(stdout);
 				}
 				/*else if (DEBUG_ADVANCED)
@@ -212,8 +346,9 @@ void glades::NNetwork::run(DataInput* newDataInput, int runType)
 				}*/
 			}
 		}
-		else if ((skeleton->getOutputType() == GMath::CLASSIFICATION) ||
-				 (skeleton->getOutputType() == GMath::KL))
+		else if ((collectMetrics) && ((skeleton->getOutputType() == GMath::CLASSIFICATION) ||
+									  (skeleton->getOutputType() == GMath::KL) ||
+									  (skeleton->getOutputType() == GMath::SOFTMAX)))
 		{
 			confusionMatrix.updateResultParams();
 
@@ -222,6 +357,7 @@ void glades::NNetwork::run(DataInput* newDataInput, int runType)
 			overallClassRecall = (confusionMatrix.getOverallRecall() * 100.0f);
 			overallClassSpecificity = (confusionMatrix.getOverallSpecificity() * 100.0f);
 			overallClassF1 = confusionMatrix.getOverallF1Score() * 100.0f;
+			overallClassAUC = rocCurve.getOverallAUC();
 
 			// Display and debugging
 			if (runType == RUN_TRAIN)
@@ -230,16 +366,16 @@ void glades::NNetwork::run(DataInput* newDataInput, int runType)
 				{
 					if (epochs < 100)
 					{
-						printf("\33[2K[NN] %d\t\t%f%%\t%f%%\t%f%%\t%f%%\t%f%%\r", epochs,
+						printf("\33[2K[NN] %d\t\t%f%%\t%f%%\t%f%%\t%f%%\t%f%%\t%f\r", epochs,
 							   overallClassAccuracy, overallClassPrecision, overallClassRecall,
-							   overallClassSpecificity, overallClassF1);
+							   overallClassSpecificity, overallClassF1, overallClassAUC);
 						fflush(stdout);
 					}
 					else
 					{
-						printf("\33[2K[NN] %d\t%f%%\t%f%%\t%f%%\t%f%%\t%f%%\r", epochs,
+						printf("\33[2K[NN] %d\t%f%%\t%f%%\t%f%%\t%f%%\t%f%%\t%f\r", epochs,
 							   overallClassAccuracy, overallClassPrecision, overallClassRecall,
-							   overallClassSpecificity, overallClassF1);
+							   overallClassSpecificity, overallClassF1, overallClassAUC);
 						fflush(stdout);
 					}
 				}
@@ -255,6 +391,17 @@ void glades::NNetwork::run(DataInput* newDataInput, int runType)
 			}
 		}
 
+		if (collectMetrics)
+			evalPolicy.mark(getCurrentTimeMilliseconds());
+
+		// Every epoch goes on the learning curve
+		float curvePoint[CURVE_SERIES] = {overallTotalError, overallTotalAccuracy, NAN};
+		if ((collectMetrics) && (skeleton->getOutputType() == GMath::REGRESSION))
+			curvePoint[CURVE_METRIC] = regressionMetrics.getOverallR2();
+		else if (collectMetrics)
+			curvePoint[CURVE_METRIC] = overallClassF1;
+		learningCurve.add(epochs, curvePoint);
+
 		if (runType == RUN_TRAIN)
 		{
 			// Update the GUI with the metrics
@@ -264,100 +411,68 @@ void glades::NNetwork::run(DataInput* newDataInput, int runType)
 			if ((serverInstance && cConnection) && ((epochs < 10) || (timeDiff > 16))) // 60fps
 			{
 				//printf("\n\nms - lastUpdateTime == diff;   %lld - %lld == %lld\n\n", ms, lastUpdateTime, timeDiff);
+				// Capture the frame; the telemetry thread builds and sends the messages
+				TelemetryFrame& frame = telemetry.stage();
+				frame.epoch = epochs;
+				frame.outputType = skeleton->getOutputType();
+
 				// First epoch is random
-				if (epochs > 0)
+				frame.hasProgress = (epochs > 0);
+				if (frame.hasProgress)
 				{
-					// Update the learning curve
-					shmea::GList wData;
-					wData.addInt(epochs-1); // -1 because we dont plot the first point
-					wData.addFloat(overallTotalError);
-
-					shmea::GList argData;
-					argData.addString("PROGRESSIVE");
-
-					shmea::ServiceData* cData = new shmea::ServiceData(cConnection, "GUI_Callback");
-					cData->set(wData);
-					cData->setArgList(argData);
-					serverInstance->send(cData);
+					// Update the learning curve with the mean loss since the last update
+					std::vector<LearningCurve::Bucket> plotPoints;
+					frame.plotLoss = overallTotalError;
+					if (learningCurve.getCurve(CURVE_LOSS, 1, plotPoints, lastPlotEpoch + 1) > 0)
+						frame.plotLoss = plotPoints[0].getMean();
+					lastPlotEpoch = epochs;
 
 					//Update the weights of the Neural Network
 		//TODO: Send meat to the frontend to create the Neural Network Visualization 
-					argData.clear();
-
-					argData.addString("ACTIVATIONS");
-					cData = new shmea::ServiceData(cConnection, "GUI_Callback");
 					if(!firstRunActivation)
 					{
 						firstRunActivation = true;
-						//TODO: Create in header file
-						shmea::GList layerSizes;
-						for(unsigned int cLayerCounter = 0; cLayerCounter < skeleton->numHiddenLayers() + 2; ++cLayerCounter)
-						{
-						    layerSizes.addInt(meat.getLayerSize(cLayerCounter));
-						}
-
-						cData->set(layerSizes);
-						cData->setArgList(argData);
-					} 
-					else 
-					{
-					    cData->set(cNodeActivations);
-					    cData->setArgList(argData);
+						telemetry.setLayerSizes(layerSizes);
 					}
-					serverInstance->send(cData);
-
-
-					argData.clear();
-					shmea::GList obtainedWeights = meat.getWeights();
-
-					argData.addString("WEIGHTS");
-					cData = new shmea::ServiceData(cConnection, "GUI_Callback");
-					cData->set(obtainedWeights);
-					cData->setArgList(argData);
-					serverInstance->send(cData);
-
-
-					//shmea::GList obtainedActivations = meat.getActivations()
-					//cData->set(
+					frame.activationEpoch = activationSubscription.getCapturedEpoch();
+					frame.activations = activationSubscription.getValues();
+					frame.activationRanges = activationSubscription.getBoundRanges();
+					frame.activationProbes = activationSubscription.getBoundProbes();
+
+					// Weights go as a binary frame, a delta once the GUI acknowledges one (see
+					// ackWeightFrame)
+					getLayerWeights(frame.weights, frame.weightCounts);
 				}
 
 				// Update the accuracy label
-				{
-					shmea::GList argData;
-					argData.addString("ACC");
-
-					shmea::GList wData;
-					wData.addInt(epochs);
-					wData.addFloat(overallTotalAccuracy);
-
-					// Update the Accuracy label
-					shmea::ServiceData* cData = new shmea::ServiceData(cConnection, "GUI_Callback");
-					cData->set(wData);
-					cData->setArgList(argData);
-					serverInstance->send(cData);
-				}
+				frame.accuracy = overallTotalAccuracy;
 
 				if ((skeleton->getOutputType() == GMath::CLASSIFICATION) ||
-					(skeleton->getOutputType() == GMath::KL))
+					(skeleton->getOutputType() == GMath::KL) ||
+					(skeleton->getOutputType() == GMath::SOFTMAX))
 				{
 					// Update the ROC Curve and Conf Matrix
-					shmea::GList argData;
-					argData.addString("CONF");
-					argData.addFloat(confusionMatrix.getOverallFalseAlarm());
-					argData.addFloat(confusionMatrix.getOverallRecall());
-
-					shmea::ServiceData* cData = new shmea::ServiceData(cConnection, "GUI_Callback");
-					cData->set(confusionMatrix.getMatrix());
-					cData->setArgList(argData);
-					serverInstance->send(cData);
+					frame.confusionMatrix.copy(confusionMatrix); // into the frame's own buffers
+					frame.falseAlarm = confusionMatrix.getOverallFalseAlarm();
+					frame.recall = confusionMatrix.getOverallRecall();
+					frame.auc = overallClassAUC;
+				}
+				else if (skeleton->getOutputType() == GMath::REGRESSION)
+				{
+					// Update the regression diagnostics
+					frame.rmse = regressionMetrics.getOverallRMSE();
+					frame.mae = regressionMetrics.getOverallMAE();
+					frame.r2 = regressionMetrics.getOverallR2();
+					frame.errorP50 = regressionMetrics.getErrorQuantile(0.5f);
+					frame.errorP95 = regressionMetrics.getErrorQuantile(0.95f);
+					frame.errorP99 = regressionMetrics.getErrorQuantile(0.99f);
 				}
 
+				telemetry.publish();
 				lastUpdateTime = ms;
 			}
 		}
 
-		cNodeActivations.clear();
-
 		// Update the scatter plot graph
 		/*if ((Frontend::simulationPanel) && (Frontend::simulationPanel->isFocused()))
 			Frontend::simulationPanel->PlotScatter(getResults());
@@ -375,19 +490,42 @@ void glades::NNetwork::run(DataInput* newDataInput, int runType)
 
 	// For the carriage controlled print
 	if (runType == RUN_TRAIN)
+	{
 		printf("\n");
+
+		// Send the last frame
+		if (telemetry.isRunning())
+		{
+			telemetry.stop();
+			telemetry.print();
+		}
+
+		// Let the queued snapshots finish
+		if (validator.isRunning())
+		{
+			validator.stop();
+			ValidationResult lastResult;
+			if (validator.getLast(lastResult))
+				printf("[NN] Validation (epoch %d) Loss: %f Accuracy: %f%%\n", lastResult.epoch,
+					   lastResult.loss, lastResult.accuracy);
+		}
+	}
 	else if (runType == RUN_TEST)
 	{
 		// Update the network vars and print
 		printf("[NN] %s Accuracy: %f%%\n", skeleton->getName().c_str(), overallTotalAccuracy);
 	}
 
+	// The edges get the trained weights back for printing, saving and test()
+	syncEdgeWeights();
+
 	// Print the results
 	meat.print(skeleton);
 
 	// Clean confusion matrix
 	if ((skeleton->getOutputType() == GMath::CLASSIFICATION) ||
-		(skeleton->getOutputType() == GMath::KL))
+		(skeleton->getOutputType() == GMath::KL) ||
+		(skeleton->getOutputType() == GMath::SOFTMAX))
 		confusionMatrix.clean();
 
 	printf("\n");
@@ -396,6 +534,217 @@ void glades::NNetwork::run(DataInput* newDataInput, int runType)
 	running = false;
 }
 
+/*!
+ * @brief evaluate
+ * @details the inference path behind test(). Takes an InferenceModel snapshot of the weights,
+ * then pushes the rows through in batches of InferenceModel::BATCH_SIZE: one blocked GEMM per
+ * layer, the bias, and the layer's activation kernel over the whole batch. Every node is active
+ * and nothing is kept for back propagation; each row only feeds the error/accuracy totals, the
+ * confusion matrix and the ROC histograms.
+ */
+void glades::NNetwork::evaluate()
+{
+	buildActivationPlan();
+	if (!inferModel.capture(meat, skeleton, activationPlan, epochs))
+		return;
+
+	bool isClassifier = (skeleton->getOutputType() == GMath::CLASSIFICATION) ||
+						(skeleton->getOutputType() == GMath::KL) ||
+						(skeleton->getOutputType() == GMath::SOFTMAX);
+	if (isClassifier)
+		buildClassMetrics();
+	else if (skeleton->getOutputType() == GMath::REGRESSION)
+		regressionMetrics.build(inferModel.getOutputSize());
+
+	printf("[NN] Testing...\n");
+	running = true;
+	overallTotalError = 0.0f;
+	overallTotalAccuracy = 0.0f;
+
+	unsigned int rowCount = di->getTrainSize();
+	unsigned int outputSize = inferModel.getOutputSize();
+	for (unsigned int batchStart = 0; (running) && (batchStart < rowCount);
+		 batchStart += InferenceModel::BATCH_SIZE)
+	{
+		unsigned int batchRows = inferModel.predict(di, batchStart);
+
+		// Metrics only
+		const GMatrix& P = inferModel.getOutput();
+		for (unsigned int b = 0; b < batchRows; ++b)
+		{
+			const float* pRow = P.row(b);
+			const float* eRow = inferModel.getExpected(b);
+			for (unsigned int i = 0; i < outputSize; ++i)
+				scoreOutputNode(eRow[i], pRow[i], outputSize);
+
+			if (isClassifier)
+			{
+				confusionMatrix.addResults(pRow, eRow, 1);
+				rocCurve.addResults(pRow, eRow, 1);
+			}
+			else if (regressionMetrics.size() == outputSize)
+				regressionMetrics.addResults(pRow, eRow, 1);
+		}
+	}
+
+	inferModel.clear();
+	overallTotalAccuracy /= ((float)rowCount) * ((float)outputSize);
+	printf("[NN] %s Accuracy: %f%%\n", skeleton->getName().c_str(), overallTotalAccuracy);
+	if (isClassifier)
+	{
+		confusionMatrix.updateResultParams();
+		overallClassAccuracy = (confusionMatrix.getOverallAccuracy() * 100.0f);
+		overallClassPrecision = (confusionMatrix.getOverallPrecision() * 100.0f);
+		overallClassRecall = (confusionMatrix.getOverallRecall() * 100.0f);
+		overallClassSpecificity = (confusionMatrix.getOverallSpecificity() * 100.0f);
+		overallClassF1 = confusionMatrix.getOverallF1Score() * 100.0f;
+		overallClassAUC = rocCurve.getOverallAUC();
+		printf("[NN] Accuracy\tPrecision\tRecall\t\tSpecificity\tF1 Score\tAUC\n");
+		printf("[NN] %f%%\t%f%%\t%f%%\t%f%%\t%f%%\t%f\n", overallClassAccuracy,
+			   overallClassPrecision, overallClassRecall, overallClassSpecificity,
+			   overallClassF1, overallClassAUC);
+	}
+	else if (regressionMetrics.size() == outputSize)
+		regressionMetrics.print();
+
+	running = false;
+}
+
+/*!
+ * @brief train stream
+ * @details online training. Every row popped from the stream gets one SGD step, followed by
+ * replayCount steps on rows drawn from the stream's replay buffer, and may then be kept for
+ * replay itself. Weights are updated after every step. Metrics are reported (and the terminator
+ * checked) once per capacity rows; epochs counts rows. Runs until the stream is closed and
+ * drained, stop() is called or the terminator triggers.
+ * @param si the row stream
+ * @param replayCount replayed rows per new row
+ */
+void glades::NNetwork::trainStream(StreamInput* si, unsigned int replayCount)
+{
+	if (!skeleton)
+		return;
+
+	if (!si)
+		return;
+
+	di = si;
+	minibatchSize = NNInfo::BATCH_STOCHASTIC;
+	buildActivationPlan();
+	bool isClassifier = (skeleton->getOutputType() == GMath::CLASSIFICATION) ||
+						(skeleton->getOutputType() == GMath::KL) ||
+						(skeleton->getOutputType() == GMath::SOFTMAX);
+	unsigned int windowSize = (si->getCapacity() > 0) ? si->getCapacity() : 1;
+
+	printf("[NN] Online training...\n");
+	resetGraphs();
+
+	// A network built by an earlier run trains on from its edges; a new one packs on its first row
+	packLayerWeights();
+
+	running = true;
+	firstRunActivation = false;
+	collectMetrics = true;
+	overallTotalError = 0.0f;
+	overallTotalAccuracy = 0.0f;
+	unsigned int windowSteps = 0;
+	int64_t skippedRows = 0;
+	shmea::GList inputRow;
+	shmea::GList expectedRow;
+	while (running)
+	{
+		if (!si->pop(inputRow, expectedRow, 100))
+		{
+			if (si->isClosed())
+				break;
+			continue;
+		}
+
+		si->stage(inputRow, expectedRow);
+
+		// The first row sizes the network
+		if (meat.getInputLayersSize() == 0)
+		{
+			if (!meat.build(skeleton, di, netType))
+				break;
+
+			packLayerWeights();
+
+			if (isClassifier)
+				buildClassMetrics();
+			else if (skeleton->getOutputType() == GMath::REGRESSION)
+				regressionMetrics.build(skeleton->getOutputLayerSize());
+		}
+		else if (!meat.setInputLayer(0, inputRow))
+		{
+			// Popped already, so count it
+			++skippedRows;
+			printf("\n[NN] Skipping stream row %ld: it does not fit the input layer\n",
+				   (long)(epochs + skippedRows));
+			continue;
+		}
+
+		// Learn the new row, then rehearse old ones
+		SGDHelper(0, RUN_TRAIN);
+		++windowSteps;
+		for (unsigned int k = 0; (k < replayCount) && (si->getReplaySize() > 0); ++k)
+		{
+			SGDHelper(si->sampleSlot(), RUN_TRAIN);
+			++windowSteps;
+		}
+
+		// Keep it for replay?
+		int slot = si->admit();
+		if (slot > 0)
+			meat.setInputLayer(slot, inputRow);
+
+		++epochs;
+		if ((epochs % windowSize) != 0)
+			continue;
+
+		overallTotalAccuracy /= ((float)windowSteps) * ((float)skeleton->getOutputLayerSize());
+		if (isClassifier)
+		{
+			confusionMatrix.updateResultParams();
+			overallClassAccuracy = (confusionMatrix.getOverallAccuracy() * 100.0f);
+			overallClassF1 = confusionMatrix.getOverallF1Score() * 100.0f;
+			overallClassAUC = rocCurve.getOverallAUC();
+			printf("\33[2K[NN] %d rows\t%f%%\t%f%%\t%f\t(%ld dropped)\r", epochs,
+				   overallClassAccuracy, overallClassF1, overallClassAUC,
+				   (long)si->getDroppedRows());
+			confusionMatrix.reset();
+			rocCurve.reset();
+		}
+		else
+			printf("\33[2K[NN] %d rows\t%f%%\t%f\t%f\t(%ld dropped)\r", epochs,
+				   overallTotalAccuracy, regressionMetrics.getOverallRMSE(),
+				   regressionMetrics.getOverallR2(), (long)si->getDroppedRows());
+		fflush(stdout);
+
+		float curvePoint[CURVE_SERIES] = {overallTotalError, overallTotalAccuracy, NAN};
+		curvePoint[CURVE_METRIC] =
+			isClassifier ? overallClassF1 : regressionMetrics.getOverallR2();
+		learningCurve.add(epochs, curvePoint);
+		regressionMetrics.reset();
+
+		if (terminator.triggered(time(NULL), epochs, overallTotalAccuracy))
+			break;
+
+		overallTotalError = 0.0f;
+		overallTotalAccuracy = 0.0f;
+		windowSteps = 0;
+	}
+
+	printf("\n[NN] Online training stopped after %d rows (%ld skipped)\n", epochs,
+		   (long)skippedRows);
+	syncEdgeWeights();
+
+	if (isClassifier)
+		confusionMatrix.clean();
+
+	running = false;
+}
+
 void glades::NNetwork::SGDHelper(unsigned int inputRowCounter, int runType)
 {
 	if (!skeleton)
@@ -408,7 +757,8 @@ void glades::NNetwork::SGDHelper(unsigned int inputRowCounter, int runType)
 	std::vector<float> pHiddenVec;
 	for (int i = 0; i < skeleton->numHiddenLayers(); ++i)
 		pHiddenVec.push_back(skeleton->getPDropout(i));
-	meat.scrambleDropout(inputRowCounter, skeleton->getPInput(), pHiddenVec);
+	uint64_t sampleIndex = ((uint64_t)epochs * meat.getInputLayersSize()) + inputRowCounter;
+	meat.scrambleDropout(inputRowCounter, sampleIndex, skeleton->getPInput(), pHiddenVec);
 
 	// Reset the results
 	results.clear();
@@ -417,11 +767,6 @@ void glades::NNetwork::SGDHelper(unsigned int inputRowCounter, int runType)
 	// Forward Pass and trigger events
 	ForwardPass(inputRowCounter, 0, 1, 0, 0);
 
-	// Add current results to cmatrix for accuracy vars
-	if ((skeleton->getOutputType() == GMath::CLASSIFICATION) ||
-		(skeleton->getOutputType() == GMath::KL))
-		confusionMatrix.addResult(results);
-
 	//printf("-------------------------------\n");
 
 	// Back Propagation and trigger events
@@ -458,210 +803,452 @@ void glades::NNetwork::ForwardPass(unsigned int inputRowCounter,
 		int cInputLayerCounter, int cOutputLayerCounter,
 		unsigned int cInputNodeCounter, unsigned int cOutputNodeCounter)
 {
+	layerNodes.clear();
+	layerNet.clear();
+
+	// Is this row one the GUI subscribed to?
+	int activationProbe = activationSubscription.getProbe(inputRowCounter);
 	for(unsigned int cLayerCounter = 0; cLayerCounter < skeleton->numHiddenLayers()+1; ++cLayerCounter)
 	{
 	    cInputLayerCounter = cLayerCounter;
 	    cOutputLayerCounter = cLayerCounter + 1;
 
-	    for(cOutputNodeCounter = 0; cOutputNodeCounter < meat.getLayerSize(cOutputLayerCounter); ++cOutputNodeCounter)
+	    Layer* cInputLayer = meat.getLayer(inputRowCounter, cInputLayerCounter);
+	    Layer* cOutputLayer = meat.getLayer(inputRowCounter, cOutputLayerCounter);
+	    if ((!cInputLayer) || (!cOutputLayer) || (cInputLayer->size() == 0))
+		    return;
+
+	    // The input row, if subscribed
+	    if ((activationProbe >= 0) && (cLayerCounter == 0) && (activationSubscription.wantsLayer(0)))
 	    {
-		for(cInputNodeCounter = 0; cInputNodeCounter < meat.getLayerSize(cInputLayerCounter); ++cInputNodeCounter)
-		{
-		    NetworkState* netState =
-			    meat.getNetworkStateFromLoc(inputRowCounter, cInputLayerCounter, cOutputLayerCounter,
-									 cInputNodeCounter, cOutputNodeCounter);
-		    if (!netState)
-			    return;
+		    for (unsigned int i = 0; i < cInputLayer->size(); ++i)
+			    layerNet.push_back((*cInputLayer)[i]->getWeight());
+		    activationSubscription.record(activationProbe, 0, &layerNet[0], layerNet.size());
+		    layerNet.clear();
+	    }
+
+	    // Only the surviving input nodes feed the layer
+	    const std::vector<unsigned int>& activeInputs = cInputLayer->getActiveNodes();
 
-		    //printf("ForwardPass: %d %d %d %d %d\n", inputRowCounter, cInputLayerCounter, cOutputLayerCounter,
-			    //cInputNodeCounter, cOutputNodeCounter);
+	    // The layer's fp32 weights, once the run has packed them
+	    const GMatrix* master = NULL;
+	    if (((unsigned int)cInputLayerCounter < layerMasters.size()) &&
+		(layerMasters[cInputLayerCounter].numberOfCols() == cInputLayer->size()) &&
+		(layerMasters[cInputLayerCounter].numberOfRows() == cOutputLayer->size()))
+		    master = &layerMasters[cInputLayerCounter];
 
-		    // Does Dropout occur?
-		    bool dropout = (!((netState->validInputNode) && (netState->validOutputNode)));
+	    // Packed weights are the ones the pass reads
+	    const HalfMatrix* halfWeights = NULL;
+	    if ((master) && ((unsigned int)cInputLayerCounter < layerWeights.size()))
+		    halfWeights = &layerWeights[cInputLayerCounter];
 
-		    // Add the input node activation to the output node
-		    if (!dropout)
+	    // Gather the surviving inputs once; when none were dropped the rows dot them densely
+	    bool denseInputs = (activeInputs.size() == cInputLayer->size());
+	    if (master)
+	    {
+		    layerInputs.resize(activeInputs.size());
+		    for (unsigned int i = 0; i < activeInputs.size(); ++i)
+			    layerInputs[i] = (*cInputLayer)[activeInputs[i]]->getWeight();
+	    }
+
+	    // Add the bias if we are in a hidden layer or output layer
+	    // Input Layer fundamentally cannot have a bias
+	    bool hasBias = (cInputLayer->getType() != Layer::INPUT_TYPE);
+	    for(cOutputNodeCounter = 0; cOutputNodeCounter < cOutputLayer->size(); ++cOutputNodeCounter)
+	    {
+		Node* cOutputNode = (*cOutputLayer)[cOutputNodeCounter];
+
+		// A dropped output node gets no edges, just its bias
+		float cOutputNodeActivation = 0.0f;
+		if ((!cOutputLayer->possiblePath(cOutputNodeCounter)) || (activeInputs.empty()))
+		    cOutputNodeActivation = 0.0f;
+		else if ((halfWeights) && (denseInputs))
+		    cOutputNodeActivation = halfWeights->dotRow(cOutputNodeCounter, &layerInputs[0]);
+		else if (halfWeights)
+		    cOutputNodeActivation = halfWeights->dotRowIndexed(cOutputNodeCounter,
+									&activeInputs[0], activeInputs.size(),
+									&layerInputs[0]);
+		else if ((master) && (denseInputs))
+		    cOutputNodeActivation = GMatrix::dot(master->row(cOutputNodeCounter),
+							 &layerInputs[0], cInputLayer->size());
+		else if (master)
+		{
+		    // Sparse over the surviving inputs
+		    const float* masterRow = master->row(cOutputNodeCounter);
+		    for (unsigned int i = 0; i < activeInputs.size(); ++i)
+			    cOutputNodeActivation += masterRow[activeInputs[i]] * layerInputs[i];
+		}
+		else
+		{
+		    for (unsigned int i = 0; i < activeInputs.size(); ++i)
 		    {
-			    float cEdgeActivation = netState->cOutputNode->getEdgeWeight(cInputNodeCounter) *
-								netState->cInputNode->getWeight();
-			    netState->cOutputNode->setActivation(cInputNodeCounter, cEdgeActivation);
+			    cInputNodeCounter = activeInputs[i];
+			    cOutputNodeActivation += cOutputNode->getEdgeWeight(cInputNodeCounter) *
+						     (*cInputLayer)[cInputNodeCounter]->getWeight();
 		    }
-		    // Last Input Node for the Output Node
-		    float cOutputLayerActivation = 0.0f;
-		    if (netState->lastValidInputNode)
-		    {
-			    // Get the current output node activation
-			    float cOutputNodeActivation = netState->cOutputNode->getActivation();
-
-			    // Clean the output node activation for next run (cleanup)
-			    netState->cOutputNode->clearActivation();
+		}
 
-			    // Add the bias if we are in a hidden layer or output layer
-			    // Input Layer fundamentally cannot have a bias
-			    if (netState->cInputLayer->getType() != Layer::INPUT_TYPE)
-				    cOutputNodeActivation += netState->cInputLayer->getBiasWeight();
+		if (hasBias)
+		    cOutputNodeActivation += cInputLayer->getBiasWeight();
 
-			    // Set Our prediction based on the cOutputNode activation
-			    int cActivationFx = skeleton->getActivationType(cInputLayerCounter);
-			    float cActivationParam = skeleton->getActivationParam(cInputLayerCounter);
-			    cOutputLayerActivation =
-				    GMath::squash(cOutputNodeActivation, cActivationFx, cActivationParam);
+		// Hold the net input; the layer is squashed in one pass below
+		layerNodes.push_back(cOutputNode);
+		layerNet.push_back(cOutputNodeActivation);
+	    }
 
-			    //We add the current node activation to the list of activations that will be sent on the network for visualization purposes
-			    if(inputRowCounter == di->getTrainSize()-1)
-			    {
-				cNodeActivations.addFloat(cOutputNodeActivation);
-			    }
+	    // Set Our predictions based on the layer's net inputs
+	    if (!layerNet.empty())
+	    {
+		    bool isOutputLayer = (cOutputLayerCounter == skeleton->numHiddenLayers() + 1);
+		    if ((isOutputLayer) && (skeleton->getOutputType() == GMath::SOFTMAX))
+			    GMath::softmax(layerNet, skeleton->getPrecision());
+		    else
+		    {
+			    const ActivationPlan& plan = activationPlan[cInputLayerCounter];
+			    plan.squash(&layerNet[0], layerNet.size(), plan.fxParam);
+		    }
 
-			    netState->cOutputNode->setWeight(cOutputLayerActivation);
+		    for (unsigned int i = 0; i < layerNet.size(); ++i)
+			    layerNodes[i]->setWeight(layerNet[i]);
+		    activationSubscription.record(activationProbe, cOutputLayerCounter, &layerNet[0],
+						  layerNet.size());
 
-			    // Output layer calculations
-			    if (netState->cOutputLayer->getType() == Layer::OUTPUT_TYPE)
+		    // Output layer calculations
+		    if (isOutputLayer)
+		    {
+			    const shmea::GList expectedRow = di->getTrainExpectedRow(inputRowCounter);
+			    layerExp.resize(layerNet.size());
+			    for (unsigned int i = 0; i < layerNet.size(); ++i)
 			    {
-				    // Get the prediction and expected vars
-				    float prediction = netState->cOutputNode->getWeight();
-				    shmea::GType expectedCell =
-					    di->getTrainExpectedRow(inputRowCounter)[cOutputNodeCounter];
-				    float expectation = expectedCell;
-				    //printf("Expectation: %f Prediction: %f\n", expectation, prediction);
-
-				    // Add the expected and predicted to the result row
-				    results.addFloat(expectation);
-				    results.addFloat(prediction);
-
-				    // Cost function calculations
-				    float dataSize = (float)(di->getTrainSize() * netState->cOutputLayer->size());
-				    int costFx = skeleton->getOutputType();
-				    float cOutputCost = GMath::outputNodeCost(expectation, prediction, dataSize, costFx);
-
-				    // Error across every input instance
-				    overallTotalError += cOutputCost;
-
-				    // Accuracy vars
-				    float percentError = GMath::PercentError(prediction, expectation, cOutputCost);
-				    float calculatedError = GMath::error(expectation, prediction);
-				    bool isCorrect = percentError < GMath::OUTLIER;
-				    float accuracy = (1.0f - percentError) * 100.0f;
-				    if (accuracy < 0.0f)
-					    accuracy = 0.0f;
-				    overallTotalAccuracy += accuracy;
-
-				    // Advanced Debugging
-				    /*if (DEBUG_ADVANCED)
-				    {
-					    printf("%f\t%f\t%f\t%f\t%f%%\t(%s)\n", expectation, prediction, calculatedError,
-						    cOutputCost, (1.0f - percentError) * 100.0f, isCorrect ? "True" : "False");
-
-					    // Multiple output nodes
-					    if (netState->cOutputLayer->size() > 1)
-						    printf("-----------------------------------------------------------\n");
-				    }*/
+				    layerExp[i] = expectedRow.getFloat(i);
+				    results.addFloat(layerExp[i]);
+				    results.addFloat(layerNet[i]);
+				    scoreOutputNode(layerExp[i], layerNet[i], layerNet.size());
 			    }
+
+			    // Count the row in the confusion matrix and the score histograms
+			    bool countRow = (collectMetrics) && (evalPolicy.sampled(inputRowCounter));
+			    if ((countRow) && (confusionMatrix.size() == layerNet.size()))
+				    confusionMatrix.addResults(&layerNet[0], &layerExp[0], 1);
+			    if ((countRow) && (rocCurve.size() == layerNet.size()))
+				    rocCurve.addResults(&layerNet[0], &layerExp[0], 1);
+			    if ((countRow) && (regressionMetrics.size() == layerNet.size()))
+				    regressionMetrics.addResults(&layerNet[0], &layerExp[0], 1);
 		    }
 
-		    
+		    layerNodes.clear();
+		    layerNet.clear();
+	    }
+	}
+}
 
+/*!
+ * @brief layer error derivatives
+ * @details run the layer plan's derivative kernel over a layer's outputs. Output layers get the
+ * cost derivative stored on each node; hidden layers get the activation derivative in layerDer.
+ * @param cOutputLayer the layer being back propagated into
+ * @param cInputLayerCounter the plan index of the layer
+ * @param expectedRow the expected values for the current row
+ */
+void glades::NNetwork::layerErrDers(Layer* cOutputLayer, unsigned int cInputLayerCounter,
+									const shmea::GList& expectedRow)
+{
+	const ActivationPlan& plan = activationPlan[cInputLayerCounter];
+	unsigned int layerSize = cOutputLayer->size();
+	layerNet.resize(layerSize);
+	layerDer.resize(layerSize);
+	for (unsigned int i = 0; i < layerSize; ++i)
+		layerNet[i] = (*cOutputLayer)[i]->getWeight();
+
+	if (cOutputLayer->getType() == Layer::OUTPUT_TYPE)
+	{
+		// Cost function error derivative for output layer(s)
+		layerExp.resize(layerSize);
+		for (unsigned int i = 0; i < layerSize; ++i)
+			layerExp[i] = expectedRow.getFloat(i);
 
-		    delete netState;
+		plan.costErrDer(&layerExp[0], &layerNet[0], &layerDer[0], layerSize);
+		for (unsigned int i = 0; i < layerSize; ++i)
+		{
+			(*cOutputLayer)[i]->clearErrDer();
+			(*cOutputLayer)[i]->adjustErrDer(layerDer[i]);
 		}
-		
-	
-	    }
-	if(inputRowCounter == di->getTrainSize()-1)
-	       {
-		   cNodeActivations.addString(",");
+	}
+	else
+		plan.errDer(&layerNet[0], &layerDer[0], layerSize, 0.01f);
+
+	layerNet.clear();
+}
+
+/*!
+ * @brief build activation plan
+ * @details resolve each layer's activation and cost kernels once per run so the passes never
+ * switch on the flags; index i squashes the outputs of layer i (the output layer's entry also
+ * carries the cost kernel)
+ */
+void glades::NNetwork::buildActivationPlan()
+{
+	activationPlan.clear();
+	int layerCount = skeleton->numHiddenLayers() + 1;
+	for (int i = 0; i < layerCount; ++i)
+	{
+		int costFx = (i == layerCount - 1) ? skeleton->getOutputType() : GMath::REGRESSION;
+		activationPlan.push_back(ActivationPlan(skeleton->getActivationType(i),
+												 skeleton->getActivationParam(i), costFx,
+												 skeleton->getPrecision()));
+	}
+}
+
+/*!
+ * @brief pack layer weights
+ * @details copy every layer's edge weights into its fp32 GMatrix master, the weight store the
+ * forward and backward passes train. When the NNInfo asks for bf16 or fp16 weight storage the
+ * masters are also rounded into a HalfMatrix, and the packed copy becomes the one both passes
+ * read; the master then only accumulates the optimizer steps (small updates would round away in
+ * 16 bits) and back propagation re-rounds each entry it steps. With fp32 storage there is no
+ * packed copy.
+ */
+void glades::NNetwork::packLayerWeights()
+{
+	layerMasters.clear();
+	layerWeights.clear();
+
+	int layerCount = skeleton->numHiddenLayers() + 1;
+	layerMasters.resize(layerCount);
+	for (int l = 0; l < layerCount; ++l)
+	{
+		Layer* cInputLayer = meat.getLayer(0, l);
+		Layer* cOutputLayer = meat.getLayer(0, l + 1);
+		if ((!cInputLayer) || (!cOutputLayer))
+		{
+			layerMasters.clear();
+			return;
+		}
+
+		GMatrix& master = layerMasters[l];
+		master.resize(cOutputLayer->size(), cInputLayer->size());
+		for (unsigned int j = 0; j < cOutputLayer->size(); ++j)
+		{
+			Node* cOutputNode = (*cOutputLayer)[j];
+			float* masterRow = master.row(j);
+			for (unsigned int i = 0; i < cInputLayer->size(); ++i)
+				masterRow[i] = cOutputNode->getEdgeWeight(i);
+		}
+	}
+
+	int storage = skeleton->getWeightStorage();
+	if (storage == GMath::STORAGE_FP32)
+		return;
+
+	layerWeights.resize(layerCount);
+	for (int l = 0; l < layerCount; ++l)
+		layerWeights[l].pack(layerMasters[l], storage);
+}
+
+/*!
+ * @brief sync edge weights
+ * @details write the trained layerMasters back onto the edges, for everything that still reads
+ * the network through its nodes (save, print, the inference snapshot in test())
+ */
+void glades::NNetwork::syncEdgeWeights()
+{
+	for (unsigned int l = 0; l < layerMasters.size(); ++l)
+	{
+		Layer* cOutputLayer = meat.getLayer(0, l + 1);
+		if (!cOutputLayer)
+			return;
+
+		const GMatrix& master = layerMasters[l];
+		for (unsigned int j = 0; (j < master.numberOfRows()) && (j < cOutputLayer->size()); ++j)
+		{
+			Node* cOutputNode = (*cOutputLayer)[j];
+			const float* masterRow = master.row(j);
+			for (unsigned int i = 0; i < master.numberOfCols(); ++i)
+				cOutputNode->setEdgeWeight(i, masterRow[i]);
 		}
 	}
 }
 
+/*!
+ * @brief get layer weights
+ * @details every trained weight, flat and in the order of LayerBuilder::getWeights()
+ * @param weights filled with the weights
+ * @param layerSizes filled with the number of weights per layer
+ */
+void glades::NNetwork::getLayerWeights(std::vector<float>& weights,
+									   std::vector<unsigned int>& layerSizes) const
+{
+	weights.clear();
+	layerSizes.clear();
+	for (unsigned int l = 0; l < layerMasters.size(); ++l)
+	{
+		// Rows are padded to the GMatrix stride, so copy them one at a time
+		const GMatrix& master = layerMasters[l];
+		for (unsigned int j = 0; j < master.numberOfRows(); ++j)
+			weights.insert(weights.end(), master.row(j), master.row(j) + master.numberOfCols());
+		layerSizes.push_back(master.numberOfRows() * master.numberOfCols());
+	}
+}
+
+/*!
+ * @brief build class metrics
+ * @details size the confusion matrix and the ROC score histograms to the output layer. Scores are
+ * binned over the output activation's range, anything outside lands in the end bins.
+ */
+void glades::NNetwork::buildClassMetrics()
+{
+	unsigned int outputSize = skeleton->getOutputLayerSize();
+	confusionMatrix.build(outputSize);
+
+	float minScore = 0.0f;
+	int outputActivation = skeleton->getActivationType(skeleton->numHiddenLayers());
+	if ((skeleton->getOutputType() != GMath::SOFTMAX) && (outputActivation == GMath::TANH))
+		minScore = -1.0f;
+
+	rocCurve.build(outputSize, ROCCurve::DEFAULT_BINS, minScore, 1.0f);
+}
+
+/*!
+ * @brief score output node
+ * @details add one output node's cost and accuracy to the epoch totals
+ * @param expectation the output node's expected value
+ * @param prediction the output node's activation
+ * @param outputLayerSize the number of output nodes
+ */
+void glades::NNetwork::scoreOutputNode(float expectation, float prediction,
+									   unsigned int outputLayerSize)
+{
+	//printf("Expectation: %f Prediction: %f\n", expectation, prediction);
+
+	// Cost function calculations
+	float dataSize = (float)(di->getTrainSize() * outputLayerSize);
+	int costFx = skeleton->getOutputType();
+	float cOutputCost = GMath::outputNodeCost(expectation, prediction, dataSize, costFx);
+
+	// Error across every input instance
+	overallTotalError += cOutputCost;
+
+	// Accuracy vars
+	float percentError = GMath::PercentError(prediction, expectation, cOutputCost);
+	float calculatedError = GMath::error(expectation, prediction);
+	bool isCorrect = percentError < GMath::OUTLIER;
+	float accuracy = (1.0f - percentError) * 100.0f;
+	if (accuracy < 0.0f)
+		accuracy = 0.0f;
+	overallTotalAccuracy += accuracy;
+
+	// Advanced Debugging
+	/*if (DEBUG_ADVANCED)
+	{
+		printf("%f\t%f\t%f\t%f\t%f%%\t(%s)\n", expectation, prediction, calculatedError,
+			cOutputCost, (1.0f - percentError) * 100.0f, isCorrect ? "True" : "False");
+
+		// Multiple output nodes
+		if (outputLayerSize > 1)
+			printf("-----------------------------------------------------------\n");
+	}*/
+}
+
 void glades::NNetwork::BackPropagation(unsigned int inputRowCounter, int cInputLayerCounter,
 									   int cOutputLayerCounter, unsigned int cInputNodeCounter,
 									   unsigned int cOutputNodeCounter)
 {
+	const shmea::GList expectedRow = di->getTrainExpectedRow(inputRowCounter);
 	for(unsigned int cLayerCounter = skeleton->numHiddenLayers()+1; cLayerCounter > 0; --cLayerCounter)
 	{
 	    cOutputLayerCounter = cLayerCounter;
 	    cInputLayerCounter = cLayerCounter - 1;
-	    for(cInputNodeCounter = 0; cInputNodeCounter < meat.getLayerSize(cInputLayerCounter); ++cInputNodeCounter)
+	    Layer* cInputLayer = meat.getLayer(inputRowCounter, cInputLayerCounter);
+	    Layer* cOutputLayer = meat.getLayer(inputRowCounter, cOutputLayerCounter);
+	    if ((!cInputLayer) || (!cOutputLayer) || (cInputLayer->size() == 0) ||
+		(cOutputLayer->size() == 0))
+		    return;
+
+	    // Error derivatives for the whole output layer, once per layer
+	    layerErrDers(cOutputLayer, cInputLayerCounter, expectedRow);
+
+	    // MSE applied through gradient descent
+	    float learningRate = skeleton->getLearningRate(cInputLayerCounter);
+	    float momentumFactor = skeleton->getMomentumFactor(cInputLayerCounter);
+	    float weightDecay1 = skeleton->getWeightDecay1(cInputLayerCounter);
+	    float weightDecay2 = skeleton->getWeightDecay2(cInputLayerCounter);
+	    bool applyBatch = ((inputRowCounter % minibatchSize) == 0);
+	    bool hasBias = (cInputLayer->getType() != Layer::INPUT_TYPE);
+	    bool hiddenOutput = (cOutputLayer->getType() == Layer::HIDDEN_TYPE);
+	    // With packed storage the error flows back through the packed weights like the forward
+	    // pass; the fp32 master only takes the optimizer step
+	    GMatrix* master = NULL;
+	    if ((cInputLayerCounter < (int)layerMasters.size()) &&
+		(layerMasters[cInputLayerCounter].numberOfCols() == cInputLayer->size()) &&
+		(layerMasters[cInputLayerCounter].numberOfRows() == cOutputLayer->size()))
+		    master = &layerMasters[cInputLayerCounter];
+	    HalfMatrix* halfWeights = NULL;
+	    if ((master) && (cInputLayerCounter < (int)layerWeights.size()))
+		    halfWeights = &layerWeights[cInputLayerCounter];
+
+	    // Dropped nodes on either side take no part in the update
+	    const std::vector<unsigned int>& activeInputs = cInputLayer->getActiveNodes();
+	    const std::vector<unsigned int>& activeOutputs = cOutputLayer->getActiveNodes();
+	    unsigned int lastInputNode = activeInputs.back();
+	    for (unsigned int i = 0; i < activeInputs.size(); ++i)
 	    {
-		for(cOutputNodeCounter = 0; cOutputNodeCounter < meat.getLayerSize(cOutputLayerCounter); ++cOutputNodeCounter)
+		cInputNodeCounter = activeInputs[i];
+		Node* cInputNode = (*cInputLayer)[cInputNodeCounter];
+		for (unsigned int j = 0; j < activeOutputs.size(); ++j)
 		{
-		    NetworkState* netState =
-			    meat.getNetworkStateFromLoc(inputRowCounter, cInputLayerCounter, cOutputLayerCounter,
-									 cInputNodeCounter, cOutputNodeCounter);
-		    if (!netState)
-			    return;
-
-		    //printf("BackPropagation: %d %d %d %d %d\n", inputRowCounter, cInputLayerCounter,
-			    //cOutputLayerCounter, cInputNodeCounter, cOutputNodeCounter);
+		    cOutputNodeCounter = activeOutputs[j];
+		    Node* cOutputNode = (*cOutputLayer)[cOutputNodeCounter];
 
 		    // Output Layer Error Derivative Calculation
 		    float cOutputDer = 1.0f; // Output der is linear so its 1
-		    if (netState->cOutputLayer->getType() == Layer::OUTPUT_TYPE)
-		    {
-			    // Cost function error derivative for output layer(s)
-			    float prediction = netState->cOutputNode->getWeight();
-			    float expectation = 0.0f;
-			    shmea::GType expectedCell =
-				    di->getTrainExpectedRow(inputRowCounter)[cOutputNodeCounter];
-			    expectation = expectedCell.getFloat();
-
-			    int costFx = skeleton->getOutputType();
-			    netState->cOutputNode->clearErrDer();
-			    netState->cOutputNode->adjustErrDer(GMath::costErrDer(expectation, prediction, costFx));
-		    }
-		    else if (netState->cOutputLayer->getType() == Layer::HIDDEN_TYPE)
-		    {
-			    // Activation error derivative
-			    int cActivationFx = skeleton->getActivationType(cInputLayerCounter);
-			    cOutputDer =
-				    GMath::activationErrDer(netState->cOutputNode->getWeight(), cActivationFx, 0.01f);
-		    }
-
-		    // Does Dropout occur?
-		    bool dropout = (!((netState->validInputNode) && (netState->validOutputNode)));
+		    if (hiddenOutput)
+			    cOutputDer = layerDer[cOutputNodeCounter]; // Activation error derivative
 
 		    // Node error derivative
-		    float cOutNetErrDer = netState->cOutputNode->getErrDer();
-		    if (!dropout)
+		    float cOutNetErrDer = cOutputNode->getErrDer();
+		    cOutNetErrDer *= cOutputDer; // current error partial
+
+		    // Clean the output node err der (cleanup)
+		    if (cInputNodeCounter == lastInputNode)
+			    cOutputNode->clearErrDer();
+
+		    float baseError = learningRate * cOutNetErrDer;
+
+		    // Add the weight delta
+		    cOutputNode->getDelta(cInputNodeCounter, baseError, cInputNode->getWeight(),
+					  learningRate, momentumFactor, weightDecay1, weightDecay2);
+
+		    // Apply all deltas if we've hit the minibatch size
+		    if ((applyBatch) && (master))
 		    {
-			    cOutNetErrDer *= cOutputDer; // current error partial
-
-			    // Clean the output node err der (cleanup)
-			    if (cInputNodeCounter == netState->cInputLayer->size() - 1)
-				    netState->cOutputNode->clearErrDer();
-
-			    // MSE applied through gradient descent
-			    float learningRate = skeleton->getLearningRate(cInputLayerCounter);
-			    float momentumFactor = skeleton->getMomentumFactor(cInputLayerCounter);
-			    float weightDecay1 = skeleton->getWeightDecay1(cInputLayerCounter);
-			    float weightDecay2 = skeleton->getWeightDecay2(cInputLayerCounter);
-			    float baseError = learningRate * cOutNetErrDer;
-
-			    // Add the weight delta
-			    netState->cOutputNode->getDelta(cInputNodeCounter, baseError,
-											    netState->cInputNode->getWeight(), learningRate,
-											    momentumFactor, weightDecay1, weightDecay2);
-
-			    // Apply all deltas if we've hit the minibatch size
-			    if ((inputRowCounter % minibatchSize) == 0)
-			    {
-				    netState->cOutputNode->applyDeltas(cInputNodeCounter, minibatchSize);
-				    netState->cOutputNode->clearPrevDeltas(cInputNodeCounter);
-			    }
+			    float& cWeight = (*master)(cOutputNodeCounter, cInputNodeCounter);
+			    cWeight -= cOutputNode->getBatchDelta(cInputNodeCounter, minibatchSize);
+			    cOutputNode->clearPrevDeltas(cInputNodeCounter);
 
-			    // Update the bias (inputs fundamentally cannot have a bias)
-			    if (netState->cInputLayer->getType() != Layer::INPUT_TYPE)
-				    netState->cInputLayer->setBiasWeight(netState->cInputLayer->getBiasWeight() -
-												 baseError);
+			    // Refresh the reduced precision copy from the master weight
+			    if (halfWeights)
+				    halfWeights->set(cOutputNodeCounter, cInputNodeCounter, cWeight);
+		    }
+		    else if (applyBatch)
+		    {
+			    cOutputNode->applyDeltas(cInputNodeCounter, minibatchSize);
+			    cOutputNode->clearPrevDeltas(cInputNodeCounter);
 		    }
 
-		    // Update the error partials for the next recursive calls
-		    float cInNetErrDer = netState->cInputNode->getErrDer() +
-						 (cOutNetErrDer * netState->cOutputNode->getEdgeWeight(cInputNodeCounter));
-		    netState->cInputNode->adjustErrDer(cInNetErrDer);
+		    // Update the bias (inputs fundamentally cannot have a bias)
+		    if (hasBias)
+			    cInputLayer->setBiasWeight(cInputLayer->getBiasWeight() - baseError);
 
-		    delete netState;
+		    // Update the error partials for the next recursive calls
+		    float cWeight = 0.0f;
+		    if (halfWeights)
+			    cWeight = halfWeights->get(cOutputNodeCounter, cInputNodeCounter);
+		    else if (master)
+			    cWeight = (*master)(cOutputNodeCounter, cInputNodeCounter);
+		    else
+			    cWeight = cOutputNode->getEdgeWeight(cInputNodeCounter);
+		    float cInNetErrDer = cInputNode->getErrDer() + (cOutNetErrDer * cWeight);
+		    cInputNode->adjustErrDer(cInNetErrDer);
 		}
 	    }
 	}
@@ -727,15 +1314,20 @@ void glades::NNetwork::setServer(GNet::GServer* newServer, GNet::Connection* new
 	cConnection = newConnection;
 }
 
-shmea::GList glades::NNetwork::getLearningCurve() const
+const LearningCurve& glades::NNetwork::getLearningCurve() const
 {
 	return learningCurve;
 }
 
-// const std::vector<Point2*>& NNetwork::getROCCurve() const
-// {
-// 	return rocCurve;
-// }
+const ROCCurve& glades::NNetwork::getROCCurve() const
+{
+	return rocCurve;
+}
+
+const RegressionMetrics& glades::NNetwork::getRegressionMetrics() const
+{
+	return regressionMetrics;
+}
 
 shmea::GList glades::NNetwork::getResults() const
 {
@@ -747,6 +1339,9 @@ void glades::NNetwork::clean()
 	id = -1;
 	skeleton = NULL;
 	confusionMatrix.clean();
+	rocCurve.clean();
+	regressionMetrics.clean();
+	validator.clear();
 	serverInstance = NULL;
 	cConnection = NULL;
 	results.clear();
@@ -758,17 +1353,16 @@ void glades::NNetwork::clean()
 	overallClassPrecision = 0.0f;
 	overallClassRecall = 0.0f;
 	overallClassF1 = 0.0f;
+	overallClassAUC = 0.0f;
+	collectMetrics = true;
 	minibatchSize = NNInfo::BATCH_STOCHASTIC;
 }
 
 void glades::NNetwork::resetGraphs()
 {
-	learningCurve.clear();
+	learningCurve.build(CURVE_SERIES);
 
-	/*for (unsigned int i = 0; i < rocCurve.size(); ++i)
-		delete rocCurve[i];*/
-	rocCurve.clear();
-	rocCurve.reserve(10000); // arbitrary number
+	rocCurve.reset();
 
 	// create the results again
 	results.clear();
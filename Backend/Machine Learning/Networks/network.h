@@ -19,10 +19,22 @@
 
 #include "Backend/Database/GList.h"
 #include "Backend/Database/GTable.h"
+#include "../State/EvalPolicy.h"
 #include "../State/Terminator.h"
+#include "../GMath/activations.h"
 #include "../GMath/cmatrix.h"
+#include "../GMath/gmatrix.h"
+#include "../GMath/halfmatrix.h"
+#include "../GMath/learningcurve.h"
+#include "../GMath/regressionmetrics.h"
+#include "../GMath/roccurve.h"
 #include "../State/LayerBuilder.h"
 #include "bayes.h"
+#include "activationsubscription.h"
+#include "inference.h"
+#include "telemetry.h"
+#include "validator.h"
+#include "weightstream.h"
 #include <algorithm>
 #include <map>
 #include <stdio.h>
@@ -33,8 +45,6 @@
 #include <iostream>
 #include <sys/time.h>
 
-class Point2;
-
 namespace shmea {
 class GTable;
 };
@@ -47,6 +57,7 @@ class Connection;
 namespace glades {
 
 class DataInput;
+class StreamInput;
 class NNInfo;
 class Layer;
 class Node;
@@ -66,6 +77,8 @@ private:
 	NNInfo* skeleton;
 	LayerBuilder meat;
 	CMatrix confusionMatrix;
+	ROCCurve rocCurve;
+	RegressionMetrics regressionMetrics;
 	GNet::GServer* serverInstance;
 	GNet::Connection* cConnection;
 	glades::NaiveBayes bModel;
@@ -81,24 +94,56 @@ private:
 	float overallClassRecall;
 	float overallClassSpecificity;
 	float overallClassF1;
+	float overallClassAUC;
 	int minibatchSize;
 	int64_t id;
+	uint64_t seed;
 
 	bool firstRunActivation;
+	bool collectMetrics; // this epoch builds the full metrics (see evalPolicy)
 
 	// for tables & graphs
-	shmea::GList learningCurve;
-	std::vector<Point2*> rocCurve;
+	LearningCurve learningCurve;
 	shmea::GList results;
 	shmea::GTable nbRecord;
 	//Only for sending on the network
-	shmea::GList cNodeActivations;
+	ActivationSubscription activationSubscription;
+
+	// per layer kernels and their scratch buffers
+	std::vector<ActivationPlan> activationPlan;
+	std::vector<Node*> layerNodes;
+	std::vector<float> layerNet;
+	std::vector<float> layerExp;
+	std::vector<float> layerDer;
+
+	// fp32 weights of each layer (rows are output nodes, cols are input nodes), the store the
+	// passes train; the edges are written back by syncEdgeWeights()
+	std::vector<GMatrix> layerMasters;
+	// bf16/fp16 copy of layerMasters; when packed, the weights both passes read, with the
+	// masters kept for the optimizer step
+	std::vector<HalfMatrix> layerWeights;
+	std::vector<float> layerInputs;
+
+	// detached weights for the inference path
+	InferenceModel inferModel;
+
+	// scored on the validator's thread during train()
+	const DataInput* validationInput;
+	int validationInterval;
 
 	void run(DataInput*, int);
+	void evaluate();
 	void SGDHelper(unsigned int, int); // Stochastic Gradient Descent
 
 	void ForwardPass(unsigned int, int, int, unsigned int, unsigned int);
 	void BackPropagation(unsigned int, int, int, unsigned int, unsigned int);
+	void layerErrDers(Layer*, unsigned int, const shmea::GList&);
+	void buildActivationPlan();
+	void buildClassMetrics();
+	void packLayerWeights();
+	void syncEdgeWeights();
+	void getLayerWeights(std::vector<float>&, std::vector<unsigned int>&) const;
+	void scoreOutputNode(float, float, unsigned int);
 
 public:
 	static const int TYPE_DFF = 0;
@@ -108,7 +153,18 @@ public:
 	static const int RUN_TEST = 1;
 	static const int RUN_VALIDATE = 2;
 
+	// learning curve series; the metric is the F1 score for classifiers and R^2 for regression,
+	// recorded on the epochs the evalPolicy collects metrics
+	static const unsigned int CURVE_LOSS = 0;
+	static const unsigned int CURVE_ACCURACY = 1;
+	static const unsigned int CURVE_METRIC = 2;
+	static const unsigned int CURVE_SERIES = 3;
+
 	Terminator terminator;
+	EvalPolicy evalPolicy;
+	Validator validator;
+	WeightStream weightStream;
+	TelemetryPublisher telemetry;
 
 	NNetwork();
 	NNetwork(NNInfo*);
@@ -116,6 +172,8 @@ public:
 	int64_t getCurrentTimeMilliseconds() const;
 	bool getRunning() const;
 	int getEpochs() const;
+	void setSeed(uint64_t);
+	uint64_t getSeed() const;
 	void stop();
 
 	// Database
@@ -126,6 +184,11 @@ public:
 	// Stochastic Gradient Descent
 	void train(DataInput*);
 	void test(DataInput*);
+	void trainStream(StreamInput*, unsigned int = 4);
+	void setValidationData(const DataInput*, int = Validator::DEFAULT_INTERVAL);
+	const DataInput* getValidationData() const;
+	void ackWeightFrame(int64_t);
+	void subscribeActivations(const ActivationSubscription&);
 
 	int64_t getID() const;
 	shmea::GString getName() const;
@@ -133,8 +196,9 @@ public:
 	float getAccuracy() const;
 
 	// graphing
-	shmea::GList getLearningCurve() const;
-	// const std::vector<Point2*>& getROCCurve() const;
+	const LearningCurve& getLearningCurve() const;
+	const ROCCurve& getROCCurve() const;
+	const RegressionMetrics& getRegressionMetrics() const;
 	shmea::GList getResults() const;
 	void clean();
 	void resetGraphs();
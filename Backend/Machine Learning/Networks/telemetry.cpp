@@ -0,0 +1,527 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "telemetry.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GString.h"
+#include "Backend/Database/GTable.h"
+#include "Backend/Database/ServiceData.h"
+#include "Backend/Networking/main.h"
+#include "weightstream.h"
+#include "../GMath/gmath.h"
+#include <algorithm>
+#include <sys/time.h>
+
+using namespace glades;
+
+static int64_t telemetryTimeMilliseconds()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return ((int64_t)tv.tv_sec * 1000) + (tv.tv_usec / 1000);
+}
+
+glades::TelemetryFrame::TelemetryFrame()
+{
+	captureTime = 0;
+	epoch = 0;
+	outputType = GMath::REGRESSION;
+	hasProgress = false;
+	plotLoss = 0.0f;
+	activationEpoch = -1;
+	accuracy = 0.0f;
+	falseAlarm = 0.0f;
+	recall = 0.0f;
+	auc = 0.0f;
+	rmse = 0.0f;
+	mae = 0.0f;
+	r2 = 0.0f;
+	errorP50 = 0.0f;
+	errorP95 = 0.0f;
+	errorP99 = 0.0f;
+}
+
+/*!
+ * @brief swap
+ * @details exchange two frames; the vectors trade buffers, so refilling a frame does not allocate
+ * @param other the frame to swap with
+ */
+void glades::TelemetryFrame::swap(TelemetryFrame& other)
+{
+	std::swap(captureTime, other.captureTime);
+	std::swap(epoch, other.epoch);
+	std::swap(outputType, other.outputType);
+	std::swap(hasProgress, other.hasProgress);
+	std::swap(plotLoss, other.plotLoss);
+	weights.swap(other.weights);
+	weightCounts.swap(other.weightCounts);
+	std::swap(activationEpoch, other.activationEpoch);
+	activations.swap(other.activations);
+	activationRanges.swap(other.activationRanges);
+	activationProbes.swap(other.activationProbes);
+	std::swap(accuracy, other.accuracy);
+	confusionMatrix.swap(other.confusionMatrix);
+	std::swap(falseAlarm, other.falseAlarm);
+	std::swap(recall, other.recall);
+	std::swap(auc, other.auc);
+	std::swap(rmse, other.rmse);
+	std::swap(mae, other.mae);
+	std::swap(r2, other.r2);
+	std::swap(errorP50, other.errorP50);
+	std::swap(errorP95, other.errorP95);
+	std::swap(errorP99, other.errorP99);
+}
+
+glades::TelemetryPublisher::TelemetryPublisher()
+{
+	serverInstance = NULL;
+	cConnection = NULL;
+	weightStream = NULL;
+	slotFull = false;
+	layerSizesPending = false;
+	stopping = false;
+	subscriptionPending = false;
+	publisherThread = NULL;
+	published = 0;
+	sent = 0;
+	dropped = 0;
+	pthread_mutex_init(&slotMutex, NULL);
+	pthread_cond_init(&slotCond, NULL);
+}
+
+glades::TelemetryPublisher::~TelemetryPublisher()
+{
+	stop();
+	pthread_cond_destroy(&slotCond);
+	pthread_mutex_destroy(&slotMutex);
+}
+
+/*!
+ * @brief start
+ * @details start the publisher thread and zero the counters
+ * @param newServerInstance the server to send through
+ * @param newConnection the GUI's connection
+ * @param newWeightStream encodes the weight frames, or NULL to send no weights
+ * @return whether the thread started
+ */
+bool glades::TelemetryPublisher::start(GNet::GServer* newServerInstance,
+									   GNet::Connection* newConnection,
+									   WeightStream* newWeightStream)
+{
+	if ((!newServerInstance) || (!newConnection) || (publisherThread))
+		return false;
+
+	serverInstance = newServerInstance;
+	cConnection = newConnection;
+	weightStream = newWeightStream;
+	slotFull = false;
+	layerSizesPending = false;
+	stopping = false;
+	published = 0;
+	sent = 0;
+	dropped = 0;
+	latency.clear();
+	sentRanges.clear();
+	sentProbes.clear();
+
+	publisherThread = (pthread_t*)malloc(sizeof(pthread_t));
+	if (pthread_create(publisherThread, NULL, publisherWorker, this) != 0)
+	{
+		free(publisherThread);
+		publisherThread = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/*!
+ * @brief stop
+ * @details send the frame left in the slot, then join the publisher thread
+ */
+void glades::TelemetryPublisher::stop()
+{
+	if (!publisherThread)
+		return;
+
+	pthread_mutex_lock(&slotMutex);
+	stopping = true;
+	pthread_cond_broadcast(&slotCond);
+	pthread_mutex_unlock(&slotMutex);
+
+	pthread_join(*publisherThread, NULL);
+	free(publisherThread);
+	publisherThread = NULL;
+}
+
+bool glades::TelemetryPublisher::isRunning() const
+{
+	return (publisherThread != NULL);
+}
+
+/*!
+ * @brief stage
+ * @details the frame the trainer fills before publish(). It holds an older frame's values, so
+ * every field must be set.
+ * @return the staged frame
+ */
+TelemetryFrame& glades::TelemetryPublisher::stage()
+{
+	return staged;
+}
+
+/*!
+ * @brief publish
+ * @details move the staged frame into the slot, dropping the frame there if the publisher has
+ * not taken it yet. Never waits for a send. Without a publisher thread the slot keeps the newest
+ * frame until take() or start().
+ */
+void glades::TelemetryPublisher::publish()
+{
+	staged.captureTime = telemetryTimeMilliseconds();
+	pthread_mutex_lock(&slotMutex);
+	if (slotFull)
+		++dropped;
+	slot.swap(staged);
+	slotFull = true;
+	++published;
+	pthread_cond_signal(&slotCond);
+	pthread_mutex_unlock(&slotMutex);
+}
+
+/*!
+ * @brief take
+ * @details empty the slot without the publisher thread, for a caller that sends the frame itself
+ * @param cFrame swapped with the newest published frame if there is one
+ * @return whether there was one
+ */
+bool glades::TelemetryPublisher::take(TelemetryFrame& cFrame)
+{
+	if (publisherThread)
+		return false;
+
+	pthread_mutex_lock(&slotMutex);
+	bool retFull = slotFull;
+	if (slotFull)
+	{
+		cFrame.swap(slot);
+		slotFull = false;
+	}
+	pthread_mutex_unlock(&slotMutex);
+
+	return retFull;
+}
+
+/*!
+ * @brief set layer sizes
+ * @details sent once, in place of the activations of the next frame sent (never dropped)
+ * @param newLayerSizes the nodes per layer
+ */
+void glades::TelemetryPublisher::setLayerSizes(const std::vector<int>& newLayerSizes)
+{
+	pthread_mutex_lock(&slotMutex);
+	layerSizes = newLayerSizes;
+	layerSizesPending = true;
+	pthread_mutex_unlock(&slotMutex);
+}
+
+/*!
+ * @brief subscribe
+ * @details called by the GUI service to change which activations are recorded; the trainer
+ * binds it at the start of its next epoch
+ * @param newSubscription the subscription
+ */
+void glades::TelemetryPublisher::subscribe(const ActivationSubscription& newSubscription)
+{
+	pthread_mutex_lock(&slotMutex);
+	requestedSubscription = newSubscription;
+	subscriptionPending = true;
+	pthread_mutex_unlock(&slotMutex);
+}
+
+/*!
+ * @brief take subscription
+ * @details hand the trainer the GUI's latest subscription, once
+ * @param cSubscription set to the subscription if there is a new one
+ * @return whether there was a new one
+ */
+bool glades::TelemetryPublisher::takeSubscription(ActivationSubscription& cSubscription)
+{
+	pthread_mutex_lock(&slotMutex);
+	bool retPending = subscriptionPending;
+	if (subscriptionPending)
+	{
+		cSubscription = requestedSubscription;
+		subscriptionPending = false;
+	}
+	pthread_mutex_unlock(&slotMutex);
+
+	return retPending;
+}
+
+void* glades::TelemetryPublisher::publisherWorker(void* y)
+{
+	TelemetryPublisher* publisher = (TelemetryPublisher*)y;
+	std::vector<int> cLayerSizes;
+	pthread_mutex_lock(&publisher->slotMutex);
+	while (true)
+	{
+		while ((!publisher->slotFull) && (!publisher->stopping))
+			pthread_cond_wait(&publisher->slotCond, &publisher->slotMutex);
+
+		if (!publisher->slotFull)
+			break;
+
+		publisher->sending.swap(publisher->slot);
+		publisher->slotFull = false;
+		bool sendLayerSizes = (publisher->layerSizesPending) && (publisher->sending.hasProgress);
+		if (sendLayerSizes)
+		{
+			cLayerSizes = publisher->layerSizes;
+			publisher->layerSizesPending = false;
+		}
+		pthread_mutex_unlock(&publisher->slotMutex);
+
+		publisher->send(publisher->sending, sendLayerSizes, cLayerSizes);
+		float cLatency = (float)(telemetryTimeMilliseconds() - publisher->sending.captureTime);
+
+		pthread_mutex_lock(&publisher->slotMutex);
+		++publisher->sent;
+		publisher->latency.add(cLatency);
+	}
+	pthread_mutex_unlock(&publisher->slotMutex);
+
+	return NULL;
+}
+
+/*!
+ * @brief send
+ * @details build and send one frame's GUI_Callback messages (publisher thread)
+ * @param frame the frame
+ * @param sendLayerSizes whether the activations message carries the layer sizes instead
+ * @param cLayerSizes the layer sizes
+ */
+void glades::TelemetryPublisher::send(const TelemetryFrame& frame, bool sendLayerSizes,
+									  const std::vector<int>& cLayerSizes)
+{
+	// First epoch is random
+	if (frame.hasProgress)
+	{
+		// Update the learning curve
+		shmea::GList wData;
+		wData.addInt(frame.epoch - 1); // -1 because we dont plot the first point
+		wData.addFloat(frame.plotLoss);
+
+		shmea::GList argData;
+		argData.addString("PROGRESSIVE");
+
+		shmea::ServiceData* cData = new shmea::ServiceData(cConnection, "GUI_Callback");
+		cData->set(wData);
+		cData->setArgList(argData);
+		serverInstance->send(cData);
+
+		// The layer sizes first, then the activations
+		if (sendLayerSizes)
+		{
+			shmea::GList sizeData;
+			for (unsigned int i = 0; i < cLayerSizes.size(); ++i)
+				sizeData.addInt(cLayerSizes[i]);
+
+			argData.clear();
+			argData.addString("ACTIVATIONS");
+			cData = new shmea::ServiceData(cConnection, "GUI_Callback");
+			cData->set(sizeData);
+			cData->setArgList(argData);
+			serverInstance->send(cData);
+		}
+		else if ((frame.activationEpoch >= 0) && (!frame.activationRanges.empty()))
+			sendActivations(frame);
+
+		// Weights as a binary frame, a delta once the GUI acknowledges one
+		int64_t frameId = -1;
+		if (weightStream)
+			frameId = weightStream->encode(frame.weights, frame.weightCounts, frameBytes);
+		if (frameId >= 0)
+		{
+			shmea::GList frameData;
+			frameData.addLong(frameId);
+			frameData.addString(shmea::GString(&frameBytes[0], frameBytes.size()));
+
+			argData.clear();
+			argData.addString("WEIGHTS_BIN");
+			cData = new shmea::ServiceData(cConnection, "GUI_Callback");
+			cData->set(frameData);
+			cData->setArgList(argData);
+			serverInstance->send(cData);
+		}
+	}
+
+	// Update the accuracy label
+	{
+		shmea::GList argData;
+		argData.addString("ACC");
+
+		shmea::GList wData;
+		wData.addInt(frame.epoch);
+		wData.addFloat(frame.accuracy);
+
+		shmea::ServiceData* cData = new shmea::ServiceData(cConnection, "GUI_Callback");
+		cData->set(wData);
+		cData->setArgList(argData);
+		serverInstance->send(cData);
+	}
+
+	if ((frame.outputType == GMath::CLASSIFICATION) || (frame.outputType == GMath::KL) ||
+		(frame.outputType == GMath::SOFTMAX))
+	{
+		// Update the ROC Curve and Conf Matrix
+		shmea::GList argData;
+		argData.addString("CONF");
+		argData.addFloat(frame.falseAlarm);
+		argData.addFloat(frame.recall);
+		argData.addFloat(frame.auc);
+
+		shmea::ServiceData* cData = new shmea::ServiceData(cConnection, "GUI_Callback");
+		cData->set(frame.confusionMatrix.getMatrix());
+		cData->setArgList(argData);
+		serverInstance->send(cData);
+	}
+	else if (frame.outputType == GMath::REGRESSION)
+	{
+		// Update the regression diagnostics
+		shmea::GList argData;
+		argData.addString("REG");
+
+		shmea::GList wData;
+		wData.addInt(frame.epoch);
+		wData.addFloat(frame.rmse);
+		wData.addFloat(frame.mae);
+		wData.addFloat(frame.r2);
+		wData.addFloat(frame.errorP50);
+		wData.addFloat(frame.errorP95);
+		wData.addFloat(frame.errorP99);
+
+		shmea::ServiceData* cData = new shmea::ServiceData(cConnection, "GUI_Callback");
+		cData->set(wData);
+		cData->setArgList(argData);
+		serverInstance->send(cData);
+	}
+}
+
+/*!
+ * @brief send activations
+ * @details an ACTIVATION_LAYOUT message when the subscription changed: the probe count, the probe
+ * rows, then (layer, first node, node count, stride) per range. Then the ACTIVATIONS message,
+ * with the recording epoch as an argument: per probe row, each range's values followed by ",".
+ * The default subscription gives the old shape, one list per layer for the last row.
+ * @param frame the frame
+ */
+void glades::TelemetryPublisher::sendActivations(const TelemetryFrame& frame)
+{
+	if ((frame.activationRanges != sentRanges) || (frame.activationProbes != sentProbes))
+	{
+		sentRanges = frame.activationRanges;
+		sentProbes = frame.activationProbes;
+
+		shmea::GList layoutData;
+		layoutData.addInt(sentProbes.size());
+		for (unsigned int i = 0; i < sentProbes.size(); ++i)
+			layoutData.addInt(sentProbes[i]);
+		for (unsigned int i = 0; i < sentRanges.size(); ++i)
+		{
+			layoutData.addInt(sentRanges[i].layer);
+			layoutData.addInt(sentRanges[i].firstNode);
+			layoutData.addInt(sentRanges[i].nodeCount);
+			layoutData.addInt(sentRanges[i].stride);
+		}
+
+		shmea::GList argData;
+		argData.addString("ACTIVATION_LAYOUT");
+		shmea::ServiceData* cData = new shmea::ServiceData(cConnection, "GUI_Callback");
+		cData->set(layoutData);
+		cData->setArgList(argData);
+		serverInstance->send(cData);
+	}
+
+	shmea::GList activationData;
+	unsigned int a = 0;
+	for (unsigned int p = 0; p < frame.activationProbes.size(); ++p)
+	{
+		for (unsigned int i = 0; i < frame.activationRanges.size(); ++i)
+		{
+			unsigned int rangeEnd = a + frame.activationRanges[i].nodeCount;
+			for (; (a < rangeEnd) && (a < frame.activations.size()); ++a)
+				activationData.addFloat(frame.activations[a]);
+			activationData.addString(",");
+		}
+	}
+
+	shmea::GList argData;
+	argData.addString("ACTIVATIONS");
+	argData.addInt(frame.activationEpoch);
+	shmea::ServiceData* cData = new shmea::ServiceData(cConnection, "GUI_Callback");
+	cData->set(activationData);
+	cData->setArgList(argData);
+	serverInstance->send(cData);
+}
+
+uint64_t glades::TelemetryPublisher::getPublished()
+{
+	pthread_mutex_lock(&slotMutex);
+	uint64_t retCount = published;
+	pthread_mutex_unlock(&slotMutex);
+
+	return retCount;
+}
+
+uint64_t glades::TelemetryPublisher::getSent()
+{
+	pthread_mutex_lock(&slotMutex);
+	uint64_t retCount = sent;
+	pthread_mutex_unlock(&slotMutex);
+
+	return retCount;
+}
+
+uint64_t glades::TelemetryPublisher::getDropped()
+{
+	pthread_mutex_lock(&slotMutex);
+	uint64_t retCount = dropped;
+	pthread_mutex_unlock(&slotMutex);
+
+	return retCount;
+}
+
+/*!
+ * @brief get latency
+ * @return milliseconds from publish() to the end of each frame's send
+ */
+RunningStat glades::TelemetryPublisher::getLatency()
+{
+	pthread_mutex_lock(&slotMutex);
+	RunningStat retLatency(latency);
+	pthread_mutex_unlock(&slotMutex);
+
+	return retLatency;
+}
+
+void glades::TelemetryPublisher::print()
+{
+	RunningStat cLatency = getLatency();
+	printf("[TELEMETRY] %lu published, %lu sent, %lu dropped, latency %f ms (max %f ms)\n",
+		   (unsigned long)getPublished(), (unsigned long)getSent(), (unsigned long)getDropped(),
+		   cLatency.getMean(), cLatency.getMax());
+}
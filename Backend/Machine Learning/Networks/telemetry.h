@@ -0,0 +1,155 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GTELEMETRY
+#define _GTELEMETRY
+
+#include "../GMath/cmatrix.h"
+#include "../GMath/runningstat.h"
+#include "activationsubscription.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace GNet {
+class GServer;
+class Connection;
+};
+
+namespace glades {
+
+class WeightStream;
+
+/*!
+ * @brief telemetry frame
+ * @details one GUI update, captured by the training thread as plain numbers; every GList,
+ * GTable and ServiceData is built from it on the publisher thread
+ */
+class TelemetryFrame
+{
+public:
+	int64_t captureTime;
+	int epoch;
+	int outputType;
+
+	// learning curve point and weights (not on the first epoch)
+	bool hasProgress;
+	float plotLoss;
+	std::vector<float> weights;
+	std::vector<unsigned int> weightCounts; // per layer
+
+	// the subscribed activations (see ActivationSubscription), activationEpoch is -1 for none
+	int activationEpoch;
+	std::vector<float> activations;
+	std::vector<ActivationSubscription::Range> activationRanges;
+	std::vector<unsigned int> activationProbes;
+
+	float accuracy;
+
+	// classifiers
+	CMatrix confusionMatrix;
+	float falseAlarm;
+	float recall;
+	float auc;
+
+	// regression
+	float rmse;
+	float mae;
+	float r2;
+	float errorP50;
+	float errorP95;
+	float errorP99;
+
+	TelemetryFrame();
+	void swap(TelemetryFrame&);
+};
+
+/*!
+ * @brief telemetry publisher
+ * @details sends the training loop's GUI updates from its own thread, so a slow GUI or socket
+ * never stalls training. The trainer fills the staged frame and publishes it into a single
+ * slot; a frame still in the slot when the next one arrives is dropped, so the GUI always gets
+ * the newest state and the trainer never waits on the publisher (the slot lock only covers a
+ * swap). Weight frames are encoded on the publisher thread, only for frames actually sent.
+ */
+class TelemetryPublisher
+{
+private:
+	GNet::GServer* serverInstance;
+	GNet::Connection* cConnection;
+	WeightStream* weightStream;
+
+	TelemetryFrame staged; // filled by the trainer
+	TelemetryFrame slot; // newest published frame
+	TelemetryFrame sending; // owned by the publisher thread
+	std::vector<int> layerSizes;
+	bool slotFull;
+	bool layerSizesPending;
+	bool stopping;
+
+	// the GUI's activation subscription, until the trainer takes it
+	ActivationSubscription requestedSubscription;
+	bool subscriptionPending;
+
+	pthread_t* publisherThread;
+	pthread_mutex_t slotMutex;
+	pthread_cond_t slotCond;
+
+	// counters
+	uint64_t published;
+	uint64_t sent;
+	uint64_t dropped;
+	RunningStat latency;
+
+	// publisher thread scratch
+	std::vector<char> frameBytes;
+	std::vector<ActivationSubscription::Range> sentRanges;
+	std::vector<unsigned int> sentProbes;
+
+	static void* publisherWorker(void*);
+	void send(const TelemetryFrame&, bool, const std::vector<int>&);
+	void sendActivations(const TelemetryFrame&);
+
+public:
+	TelemetryPublisher();
+	~TelemetryPublisher();
+
+	bool start(GNet::GServer*, GNet::Connection*, WeightStream*);
+	void stop();
+	bool isRunning() const;
+
+	// trainer
+	TelemetryFrame& stage();
+	void publish();
+	bool take(TelemetryFrame&);
+	void setLayerSizes(const std::vector<int>&);
+	bool takeSubscription(ActivationSubscription&);
+
+	// GUI
+	void subscribe(const ActivationSubscription&);
+
+	// gets
+	uint64_t getPublished();
+	uint64_t getSent();
+	uint64_t getDropped();
+	RunningStat getLatency();
+	void print();
+};
+};
+
+#endif
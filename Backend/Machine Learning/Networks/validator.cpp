@@ -0,0 +1,355 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "validator.h"
+#include "../DataObjects/DataInput.h"
+#include "../GMath/gmath.h"
+
+using namespace glades;
+
+glades::ValidationResult::ValidationResult()
+{
+	epoch = 0;
+	loss = 0.0f;
+	accuracy = 0.0f;
+	classAccuracy = 0.0f;
+	classPrecision = 0.0f;
+	classRecall = 0.0f;
+	classSpecificity = 0.0f;
+	classF1 = 0.0f;
+	classAUC = 0.0f;
+	rmse = 0.0f;
+	mae = 0.0f;
+	r2 = 0.0f;
+	errorP95 = 0.0f;
+}
+
+glades::Validator::Validator()
+{
+	vdi = NULL;
+	interval = DEFAULT_INTERVAL;
+	workerThread = NULL;
+	pending = false;
+	busy = false;
+	stopping = false;
+	pthread_mutex_init(&resultMutex, NULL);
+	pthread_cond_init(&resultCond, NULL);
+}
+
+glades::Validator::~Validator()
+{
+	stop();
+	pthread_cond_destroy(&resultCond);
+	pthread_mutex_destroy(&resultMutex);
+	history.clear();
+}
+
+/*!
+ * @brief start
+ * @details start the worker thread. The validation data must outlive the run and not change
+ * while the worker reads it.
+ * @param newDataInput the validation rows (train rows are scored)
+ * @param newInterval epochs between snapshots
+ * @return whether the worker started
+ */
+bool glades::Validator::start(const DataInput* newDataInput, int newInterval)
+{
+	if ((!newDataInput) || (newDataInput->getTrainSize() <= 0) || (workerThread))
+		return false;
+
+	vdi = newDataInput;
+	setInterval(newInterval);
+	pending = false;
+	busy = false;
+	stopping = false;
+	workerThread = (pthread_t*)malloc(sizeof(pthread_t));
+	if (pthread_create(workerThread, NULL, validationWorker, this) != 0)
+	{
+		free(workerThread);
+		workerThread = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/*!
+ * @brief stop
+ * @details finish the snapshot being scored and any submitted one, then join the worker
+ */
+void glades::Validator::stop()
+{
+	if (!workerThread)
+		return;
+
+	pthread_mutex_lock(&resultMutex);
+	stopping = true;
+	pthread_cond_broadcast(&resultCond);
+	pthread_mutex_unlock(&resultMutex);
+
+	pthread_join(*workerThread, NULL);
+	free(workerThread);
+	workerThread = NULL;
+	staged.clear();
+	active.clear();
+}
+
+/*!
+ * @brief due
+ * @param epoch the epoch that just finished
+ * @return whether this epoch's weights should be snapshotted
+ */
+bool glades::Validator::due(int epoch) const
+{
+	return (workerThread) && (epoch > 0) && ((epoch % interval) == 0);
+}
+
+/*!
+ * @brief stage
+ * @details the model the trainer captures the next snapshot into. Never blocks: the worker only
+ * swaps the staged model out, under the lock, once submit() has flagged it.
+ * @return the staged model, or NULL while the previous snapshot has not been picked up
+ */
+InferenceModel* glades::Validator::stage()
+{
+	if (!workerThread)
+		return NULL;
+
+	pthread_mutex_lock(&resultMutex);
+	bool open = !pending;
+	pthread_mutex_unlock(&resultMutex);
+
+	return open ? &staged : NULL;
+}
+
+/*!
+ * @brief submit
+ * @details hand the staged snapshot to the worker
+ */
+void glades::Validator::submit()
+{
+	if ((!workerThread) || (staged.empty()))
+		return;
+
+	pthread_mutex_lock(&resultMutex);
+	pending = true;
+	pthread_cond_broadcast(&resultCond);
+	pthread_mutex_unlock(&resultMutex);
+}
+
+/*!
+ * @brief wait
+ * @details block until every submitted snapshot has been scored
+ */
+void glades::Validator::wait()
+{
+	if (!workerThread)
+		return;
+
+	pthread_mutex_lock(&resultMutex);
+	while (pending || busy)
+		pthread_cond_wait(&resultCond, &resultMutex);
+	pthread_mutex_unlock(&resultMutex);
+}
+
+void* glades::Validator::validationWorker(void* y)
+{
+	Validator* validator = (Validator*)y;
+	pthread_mutex_lock(&validator->resultMutex);
+	while (true)
+	{
+		while ((!validator->pending) && (!validator->stopping))
+			pthread_cond_wait(&validator->resultCond, &validator->resultMutex);
+
+		if (!validator->pending)
+			break;
+
+		// Take the snapshot; the trainer may stage the next one meanwhile
+		validator->active.swap(validator->staged);
+		validator->pending = false;
+		validator->busy = true;
+		pthread_mutex_unlock(&validator->resultMutex);
+
+		ValidationResult result = validator->evaluate();
+
+		pthread_mutex_lock(&validator->resultMutex);
+		validator->history.push_back(result);
+		validator->busy = false;
+		pthread_cond_broadcast(&validator->resultCond);
+	}
+	pthread_mutex_unlock(&validator->resultMutex);
+
+	return NULL;
+}
+
+/*!
+ * @brief evaluate
+ * @details score the active snapshot on every validation row, batch by batch
+ * @return the snapshot's loss, accuracy and class metrics
+ */
+ValidationResult glades::Validator::evaluate()
+{
+	ValidationResult result;
+	result.epoch = active.getEpoch();
+
+	int outputType = active.getOutputType();
+	bool isClassifier = (outputType == GMath::CLASSIFICATION) || (outputType == GMath::KL) ||
+						(outputType == GMath::SOFTMAX);
+	unsigned int rowCount = vdi->getTrainSize();
+	unsigned int outputSize = active.getOutputSize();
+	if ((rowCount == 0) || (outputSize == 0))
+		return result;
+
+	if (isClassifier)
+	{
+		float minScore = 0.0f;
+		if ((outputType != GMath::SOFTMAX) && (active.getOutputActivation() == GMath::TANH))
+			minScore = -1.0f;
+
+		confusionMatrix.build(outputSize);
+		rocCurve.build(outputSize, ROCCurve::DEFAULT_BINS, minScore, 1.0f);
+	}
+	else if (outputType == GMath::REGRESSION)
+		regressionMetrics.build(outputSize);
+
+	float dataSize = (float)(rowCount * outputSize);
+	for (unsigned int batchStart = 0; batchStart < rowCount;
+		 batchStart += InferenceModel::BATCH_SIZE)
+	{
+		unsigned int batchRows = active.predict(vdi, batchStart);
+		const GMatrix& P = active.getOutput();
+		for (unsigned int b = 0; b < batchRows; ++b)
+		{
+			const float* pRow = P.row(b);
+			const float* eRow = active.getExpected(b);
+			for (unsigned int i = 0; i < outputSize; ++i)
+			{
+				float cOutputCost = GMath::outputNodeCost(eRow[i], pRow[i], dataSize, outputType);
+				result.loss += cOutputCost;
+
+				float percentError = GMath::PercentError(pRow[i], eRow[i], cOutputCost);
+				float accuracy = (1.0f - percentError) * 100.0f;
+				if (accuracy > 0.0f)
+					result.accuracy += accuracy;
+			}
+
+			if (isClassifier)
+			{
+				confusionMatrix.addResults(pRow, eRow, 1);
+				rocCurve.addResults(pRow, eRow, 1);
+			}
+			else if (regressionMetrics.size() == outputSize)
+				regressionMetrics.addResults(pRow, eRow, 1);
+		}
+	}
+
+	result.accuracy /= dataSize;
+	if (isClassifier)
+	{
+		confusionMatrix.updateResultParams();
+		result.classAccuracy = confusionMatrix.getOverallAccuracy() * 100.0f;
+		result.classPrecision = confusionMatrix.getOverallPrecision() * 100.0f;
+		result.classRecall = confusionMatrix.getOverallRecall() * 100.0f;
+		result.classSpecificity = confusionMatrix.getOverallSpecificity() * 100.0f;
+		result.classF1 = confusionMatrix.getOverallF1Score() * 100.0f;
+		result.classAUC = rocCurve.getOverallAUC();
+	}
+	else if (regressionMetrics.size() == outputSize)
+	{
+		result.rmse = regressionMetrics.getOverallRMSE();
+		result.mae = regressionMetrics.getOverallMAE();
+		result.r2 = regressionMetrics.getOverallR2();
+		result.errorP95 = regressionMetrics.getErrorQuantile(0.95f);
+	}
+
+	return result;
+}
+
+bool glades::Validator::isRunning() const
+{
+	return (workerThread != NULL);
+}
+
+int glades::Validator::getInterval() const
+{
+	return interval;
+}
+
+void glades::Validator::setInterval(int newInterval)
+{
+	interval = (newInterval > 0) ? newInterval : DEFAULT_INTERVAL;
+}
+
+const DataInput* glades::Validator::getDataInput() const
+{
+	return vdi;
+}
+
+/*!
+ * @brief get history
+ * @return every scored snapshot so far, oldest first
+ */
+std::vector<ValidationResult> glades::Validator::getHistory()
+{
+	pthread_mutex_lock(&resultMutex);
+	std::vector<ValidationResult> retHistory = history;
+	pthread_mutex_unlock(&resultMutex);
+
+	return retHistory;
+}
+
+/*!
+ * @brief get last
+ * @param result filled with the newest scored snapshot
+ * @return whether any snapshot has been scored
+ */
+bool glades::Validator::getLast(ValidationResult& result)
+{
+	pthread_mutex_lock(&resultMutex);
+	bool found = !history.empty();
+	if (found)
+		result = history[history.size() - 1];
+	pthread_mutex_unlock(&resultMutex);
+
+	return found;
+}
+
+/*!
+ * @brief get validation curve
+ * @details the validation loss per scored epoch, laid out like the PROGRESSIVE learning curve
+ * updates: epoch (int), loss (float), ...
+ * @return the curve
+ */
+shmea::GList glades::Validator::getValidationCurve()
+{
+	shmea::GList curve;
+	pthread_mutex_lock(&resultMutex);
+	for (unsigned int i = 0; i < history.size(); ++i)
+	{
+		curve.addInt(history[i].epoch);
+		curve.addFloat(history[i].loss);
+	}
+	pthread_mutex_unlock(&resultMutex);
+
+	return curve;
+}
+
+void glades::Validator::clear()
+{
+	pthread_mutex_lock(&resultMutex);
+	history.clear();
+	pthread_mutex_unlock(&resultMutex);
+}
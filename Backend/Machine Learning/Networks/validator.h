@@ -0,0 +1,116 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GVALIDATOR
+#define _GVALIDATOR
+
+#include "Backend/Database/GList.h"
+#include "inference.h"
+#include "../GMath/cmatrix.h"
+#include "../GMath/regressionmetrics.h"
+#include "../GMath/roccurve.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace glades {
+
+class DataInput;
+
+/*!
+ * @brief validation result
+ * @details the metrics of one weight snapshot on the validation set; the class metrics stay zero
+ * for regression outputs and the regression ones for classifiers
+ */
+class ValidationResult
+{
+public:
+	int epoch;
+	float loss;
+	float accuracy;
+	float classAccuracy;
+	float classPrecision;
+	float classRecall;
+	float classSpecificity;
+	float classF1;
+	float classAUC;
+	float rmse;
+	float mae;
+	float r2;
+	float errorP95;
+
+	ValidationResult();
+};
+
+/*!
+ * @brief concurrent validator
+ * @details scores weight snapshots on a validation data set on its own thread while training
+ * continues. The trainer captures a snapshot into the staged model every interval epochs and
+ * submits it; the worker swaps it into the active model and scores it. Staging never waits: while
+ * a submitted snapshot has not been picked up yet, later ones are skipped. The validation data
+ * is only read by the worker, so it must not be the data set being trained on.
+ */
+class Validator
+{
+private:
+	const DataInput* vdi;
+	int interval;
+
+	InferenceModel staged; // written by the trainer
+	InferenceModel active; // read by the worker
+	CMatrix confusionMatrix;
+	ROCCurve rocCurve;
+	RegressionMetrics regressionMetrics;
+	std::vector<ValidationResult> history;
+
+	pthread_t* workerThread;
+	pthread_mutex_t resultMutex;
+	pthread_cond_t resultCond;
+	bool pending;
+	bool busy;
+	bool stopping;
+
+	static void* validationWorker(void*);
+	ValidationResult evaluate();
+
+public:
+	static const int DEFAULT_INTERVAL = 1;
+
+	Validator();
+	~Validator();
+
+	// trainer
+	bool start(const DataInput*, int = DEFAULT_INTERVAL);
+	void stop();
+	bool due(int) const;
+	InferenceModel* stage();
+	void submit();
+	void wait();
+
+	// gets
+	bool isRunning() const;
+	int getInterval() const;
+	void setInterval(int);
+	const DataInput* getDataInput() const;
+	std::vector<ValidationResult> getHistory();
+	bool getLast(ValidationResult&);
+	shmea::GList getValidationCurve();
+	void clear();
+};
+};
+
+#endif
@@ -0,0 +1,290 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "weightstream.h"
+#include "../GMath/gmath.h"
+#include <math.h>
+
+using namespace glades;
+
+glades::WeightStream::WeightStream(int newFormat)
+{
+	setFormat(newFormat);
+	nextFrameId = 0;
+	baseId = -1;
+	pthread_mutex_init(&ackMutex, NULL);
+}
+
+glades::WeightStream::~WeightStream()
+{
+	reset();
+	pthread_mutex_destroy(&ackMutex);
+}
+
+/*!
+ * @brief set format
+ * @details takes effect with the next frame
+ * @param newFormat FORMAT_FP16 or FORMAT_INT8
+ */
+void glades::WeightStream::setFormat(int newFormat)
+{
+	format = (newFormat == FORMAT_INT8) ? FORMAT_INT8 : FORMAT_FP16;
+}
+
+int glades::WeightStream::getFormat() const
+{
+	return format;
+}
+
+/*!
+ * @brief encode
+ * @details quantize the weights into a frame: a delta against the last acknowledged frame when
+ * there is one with the same shape, otherwise a keyframe. O(weights), no per weight allocations.
+ * @param weights every weight, layer after layer (see LayerBuilder::getWeights)
+ * @param layerSizes the number of weights per layer
+ * @param frame filled with the binary frame
+ * @return the frame id, or -1 when the sizes do not add up
+ */
+int64_t glades::WeightStream::encode(const std::vector<float>& weights,
+									 const std::vector<unsigned int>& layerSizes,
+									 std::vector<char>& frame)
+{
+	unsigned int total = 0;
+	for (unsigned int l = 0; l < layerSizes.size(); ++l)
+		total += layerSizes[l];
+	if ((total != weights.size()) || (layerSizes.size() > 0xFFFF))
+		return -1;
+
+	pthread_mutex_lock(&ackMutex);
+
+	bool keyframe = (baseId < 0) || (baseWeights.size() != weights.size());
+	int64_t frameId = nextFrameId++;
+	int64_t frameBase = keyframe ? -1 : baseId;
+	unsigned int valueSize = (format == FORMAT_INT8) ? sizeof(int8_t) : sizeof(uint16_t);
+
+	frame.resize(HEADER_SIZE + (layerSizes.size() * 8) + (total * valueSize));
+	char* cursor = &frame[0];
+	uint32_t magic = MAGIC;
+	uint8_t cFormat = format;
+	uint8_t cKeyframe = keyframe ? 1 : 0;
+	uint16_t layerCount = layerSizes.size();
+	memcpy(cursor, &magic, 4);
+	memcpy(cursor + 4, &cFormat, 1);
+	memcpy(cursor + 5, &cKeyframe, 1);
+	memcpy(cursor + 6, &layerCount, 2);
+	memcpy(cursor + 8, &frameId, 8);
+	memcpy(cursor + 16, &frameBase, 8);
+	cursor += HEADER_SIZE;
+
+	// What the receiver will hold after decoding this frame
+	std::vector<float> decoded(total);
+	delta.resize(total);
+	unsigned int layerStart = 0;
+	for (unsigned int l = 0; l < layerSizes.size(); ++l)
+	{
+		unsigned int layerEnd = layerStart + layerSizes[l];
+		float maxAbs = 0.0f;
+		for (unsigned int i = layerStart; i < layerEnd; ++i)
+		{
+			delta[i] = keyframe ? weights[i] : weights[i] - baseWeights[i];
+			if (fabs(delta[i]) > maxAbs)
+				maxAbs = fabs(delta[i]);
+		}
+
+		float scale = (maxAbs > 0.0f) ? maxAbs : 1.0f;
+		uint32_t count = layerSizes[l];
+		memcpy(cursor, &count, 4);
+		memcpy(cursor + 4, &scale, 4);
+		cursor += 8;
+
+		for (unsigned int i = layerStart; i < layerEnd; ++i)
+		{
+			float cBase = keyframe ? 0.0f : baseWeights[i];
+			if (format == FORMAT_INT8)
+			{
+				float q = floor((delta[i] / scale) * 127.0f + 0.5f);
+				if (!(q > -127.0f))
+					q = (delta[i] != delta[i]) ? 0.0f : -127.0f;
+				if (q > 127.0f)
+					q = 127.0f;
+
+				int8_t cValue = (int8_t)q;
+				*cursor = (char)cValue;
+				decoded[i] = cBase + ((cValue * scale) / 127.0f);
+			}
+			else
+			{
+				uint16_t cValue = GMath::floatToHalf(delta[i] / scale);
+				memcpy(cursor, &cValue, 2);
+				decoded[i] = cBase + (GMath::halfToFloat(cValue) * scale);
+			}
+			cursor += valueSize;
+		}
+
+		layerStart = layerEnd;
+	}
+
+	// Remember it until it is acknowledged or too old
+	pendingIds.push_back(frameId);
+	pendingWeights.push_back(std::vector<float>());
+	pendingWeights.back().swap(decoded);
+	if (pendingIds.size() > MAX_PENDING)
+	{
+		pendingIds.erase(pendingIds.begin());
+		pendingWeights.erase(pendingWeights.begin());
+	}
+
+	pthread_mutex_unlock(&ackMutex);
+
+	return frameId;
+}
+
+/*!
+ * @brief ack
+ * @details the receiver has decoded frameId; later frames are deltas against it. Safe to call
+ * from the thread that handles the GUI's replies.
+ * @param frameId the decoded frame
+ * @return whether the frame was still pending
+ */
+bool glades::WeightStream::ack(int64_t frameId)
+{
+	pthread_mutex_lock(&ackMutex);
+	bool found = false;
+	for (unsigned int i = 0; i < pendingIds.size(); ++i)
+	{
+		if (pendingIds[i] != frameId)
+			continue;
+
+		// Older frames can no longer become the base
+		baseId = frameId;
+		baseWeights.swap(pendingWeights[i]);
+		pendingIds.erase(pendingIds.begin(), pendingIds.begin() + i + 1);
+		pendingWeights.erase(pendingWeights.begin(), pendingWeights.begin() + i + 1);
+		found = true;
+		break;
+	}
+	pthread_mutex_unlock(&ackMutex);
+
+	return found;
+}
+
+/*!
+ * @brief reset
+ * @details forget the acknowledged and pending frames (e.g. for a new receiver); the next frame
+ * is a keyframe
+ */
+void glades::WeightStream::reset()
+{
+	pthread_mutex_lock(&ackMutex);
+	baseId = -1;
+	baseWeights.clear();
+	pendingIds.clear();
+	pendingWeights.clear();
+	delta.clear();
+	pthread_mutex_unlock(&ackMutex);
+}
+
+int64_t glades::WeightStream::getBaseId()
+{
+	pthread_mutex_lock(&ackMutex);
+	int64_t retId = baseId;
+	pthread_mutex_unlock(&ackMutex);
+
+	return retId;
+}
+
+/*!
+ * @brief decode
+ * @details the receiving side of encode()
+ * @param frame the frame's bytes
+ * @param frameSize the frame's length
+ * @param weights in: the weights of the frame's base (ignored for a keyframe), out: the frame's
+ * weights
+ * @param frameId filled with the frame's id
+ * @param frameBase filled with the base frame's id, -1 for a keyframe
+ * @return false for a malformed frame or a delta whose base does not fit weights
+ */
+bool glades::WeightStream::decode(const char* frame, unsigned int frameSize,
+								  std::vector<float>& weights, int64_t& frameId,
+								  int64_t& frameBase)
+{
+	if ((!frame) || (frameSize < HEADER_SIZE))
+		return false;
+
+	uint32_t magic = 0;
+	uint8_t cFormat = 0;
+	uint8_t cKeyframe = 0;
+	uint16_t layerCount = 0;
+	memcpy(&magic, frame, 4);
+	memcpy(&cFormat, frame + 4, 1);
+	memcpy(&cKeyframe, frame + 5, 1);
+	memcpy(&layerCount, frame + 6, 2);
+	memcpy(&frameId, frame + 8, 8);
+	memcpy(&frameBase, frame + 16, 8);
+	if ((magic != MAGIC) || (cFormat > FORMAT_INT8))
+		return false;
+
+	unsigned int valueSize = (cFormat == FORMAT_INT8) ? sizeof(int8_t) : sizeof(uint16_t);
+	const char* cursor = frame + HEADER_SIZE;
+	const char* end = frame + frameSize;
+
+	// Sizes first, so a bad frame leaves weights alone
+	unsigned int total = 0;
+	for (unsigned int l = 0; l < layerCount; ++l)
+	{
+		if (end - cursor < 8)
+			return false;
+
+		uint32_t count = 0;
+		memcpy(&count, cursor, 4);
+		if ((unsigned int)(end - cursor - 8) / valueSize < count)
+			return false;
+
+		total += count;
+		cursor += 8 + (count * valueSize);
+	}
+
+	if ((!cKeyframe) && (weights.size() != total))
+		return false;
+	if (cKeyframe)
+		weights.assign(total, 0.0f);
+
+	cursor = frame + HEADER_SIZE;
+	unsigned int w = 0;
+	for (unsigned int l = 0; l < layerCount; ++l)
+	{
+		uint32_t count = 0;
+		float scale = 0.0f;
+		memcpy(&count, cursor, 4);
+		memcpy(&scale, cursor + 4, 4);
+		cursor += 8;
+
+		for (unsigned int i = 0; i < count; ++i, ++w)
+		{
+			if (cFormat == FORMAT_INT8)
+				weights[w] += ((int8_t)cursor[0] * scale) / 127.0f;
+			else
+			{
+				uint16_t cValue = 0;
+				memcpy(&cValue, cursor, 2);
+				weights[w] += GMath::halfToFloat(cValue) * scale;
+			}
+			cursor += valueSize;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,82 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GWEIGHTSTREAM
+#define _GWEIGHTSTREAM
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace glades {
+
+/*!
+ * @brief binary weight frames
+ * @details encodes the network's weights for the GUI as compact binary frames instead of a GList
+ * with a GType per weight. Each layer is quantized to fp16 or int8 with its own scale. Once the
+ * GUI acknowledges a frame, later frames carry only the difference from it, quantized the same
+ * way; until then every frame is a keyframe. The encoder tracks what the receiver decodes, so
+ * quantization error does not build up across deltas. The receiver keeps the weights of the last
+ * frame it acknowledged and decodes with decode().
+ *
+ * Frame layout (host byte order): magic (uint32), format (uint8), keyframe (uint8), layer count
+ * (uint16), frame id (int64), base frame id (int64, -1 for a keyframe), then per layer the
+ * weight count (uint32), the scale (float) and the values (int8 or fp16).
+ */
+class WeightStream
+{
+private:
+	int format;
+	int64_t nextFrameId;
+
+	// the last frame the receiver acknowledged, decoded
+	int64_t baseId;
+	std::vector<float> baseWeights;
+
+	// sent frames waiting for an acknowledgement, decoded
+	std::vector<int64_t> pendingIds;
+	std::vector<std::vector<float> > pendingWeights;
+
+	std::vector<float> delta;
+	pthread_mutex_t ackMutex;
+
+public:
+	static const uint32_t MAGIC = 0x31465747; // "GWF1"
+	static const unsigned int HEADER_SIZE = 24;
+	static const unsigned int MAX_PENDING = 8;
+
+	// format flags
+	static const int FORMAT_FP16 = 0;
+	static const int FORMAT_INT8 = 1;
+
+	WeightStream(int = FORMAT_FP16);
+	~WeightStream();
+
+	void setFormat(int);
+	int getFormat() const;
+
+	int64_t encode(const std::vector<float>&, const std::vector<unsigned int>&, std::vector<char>&);
+	bool ack(int64_t);
+	void reset();
+	int64_t getBaseId();
+
+	static bool decode(const char*, unsigned int, std::vector<float>&, int64_t&, int64_t&);
+};
+};
+
+#endif
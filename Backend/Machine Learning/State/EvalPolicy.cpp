@@ -0,0 +1,136 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include "EvalPolicy.h"
+#include "../GMath/grandom.h"
+
+glades::EvalPolicy::EvalPolicy()
+{
+	metricEpochs = 1l;
+	metricInterval = 0l;
+	sampleRate = 1.0f;
+	sampleThreshold = 0;
+	sampleSeed = 0;
+	lastMetricTime = 0l;
+}
+
+glades::EvalPolicy::~EvalPolicy()
+{
+	metricEpochs = 1l;
+	metricInterval = 0l;
+	sampleRate = 1.0f;
+}
+
+int64_t glades::EvalPolicy::getMetricEpochs() const
+{
+	return metricEpochs;
+}
+
+int64_t glades::EvalPolicy::getMetricInterval() const
+{
+	return metricInterval;
+}
+
+float glades::EvalPolicy::getSampleRate() const
+{
+	return sampleRate;
+}
+
+/*!
+ * @brief set metric epochs
+ * @param newMetricEpochs full metrics every this many epochs; 0 leaves it to the interval
+ */
+void glades::EvalPolicy::setMetricEpochs(int64_t newMetricEpochs)
+{
+	metricEpochs = (newMetricEpochs > 0l) ? newMetricEpochs : 0l;
+}
+
+/*!
+ * @brief set metric interval
+ * @param newMetricInterval full metrics once this many milliseconds have passed since the last
+ * metrics epoch; 0 leaves it to the epoch count
+ */
+void glades::EvalPolicy::setMetricInterval(int64_t newMetricInterval)
+{
+	metricInterval = (newMetricInterval > 0l) ? newMetricInterval : 0l;
+}
+
+/*!
+ * @brief set sample rate
+ * @details rows are picked by a hash of their index, so every metrics epoch sees the same subset
+ * @param newSampleRate the fraction of rows counted, clamped to (0, 1]
+ * @param newSeed picks a different subset
+ */
+void glades::EvalPolicy::setSampleRate(float newSampleRate, uint64_t newSeed)
+{
+	if (!(newSampleRate > 0.0f))
+		return;
+
+	sampleRate = (newSampleRate < 1.0f) ? newSampleRate : 1.0f;
+	sampleSeed = newSeed;
+
+	// compare against the top 53 bits of the hash
+	sampleThreshold = (uint64_t)(((double)sampleRate) * 9007199254740992.0);
+}
+
+/*!
+ * @brief due
+ * @param cEpoch the epoch about to run (1 based)
+ * @param cTime the current time in milliseconds
+ * @return true when the epoch should build the full metrics
+ */
+bool glades::EvalPolicy::due(int64_t cEpoch, int64_t cTime) const
+{
+	// the first epoch always reports
+	if (cEpoch <= 1l)
+		return true;
+
+	if ((metricEpochs > 0l) && (cEpoch % metricEpochs == 0))
+		return true;
+
+	if ((metricInterval > 0l) && (cTime - lastMetricTime >= metricInterval))
+		return true;
+
+	return false;
+}
+
+/*!
+ * @brief sampled
+ * @param row the row index
+ * @return true when the row counts toward the metrics
+ */
+bool glades::EvalPolicy::sampled(uint64_t row) const
+{
+	if (sampleRate >= 1.0f)
+		return true;
+
+	uint64_t state = sampleSeed ^ row;
+	return (GRandom::splitmix64(state) >> 11) < sampleThreshold;
+}
+
+/*!
+ * @brief mark
+ * @param cTime the time in milliseconds the last metrics epoch finished
+ */
+void glades::EvalPolicy::mark(int64_t cTime)
+{
+	lastMetricTime = cTime;
+}
+
+void glades::EvalPolicy::reset()
+{
+	lastMetricTime = 0l;
+}
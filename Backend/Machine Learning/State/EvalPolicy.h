@@ -0,0 +1,67 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+// associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#ifndef _GQL_EvalPolicy
+#define _GQL_EvalPolicy
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace glades {
+
+/*!
+ * @brief evaluation policy
+ * @details how often a training run pays for its full metrics. The loss and accuracy totals are
+ * kept every epoch (the terminator reads them); the confusion matrix, ROC histograms, derived
+ * class metrics and the progress line are only built on epochs the policy marks as due: every
+ * N epochs and/or once T milliseconds have passed since the last metrics epoch. A sample rate
+ * below 1 counts a fixed, hash selected subset of the rows on those epochs.
+ * The defaults (every epoch, every row) match the old behaviour.
+ */
+class EvalPolicy
+{
+private:
+	int64_t metricEpochs;
+	int64_t metricInterval;
+	float sampleRate;
+	uint64_t sampleThreshold;
+	uint64_t sampleSeed;
+	int64_t lastMetricTime;
+
+public:
+	EvalPolicy();
+	~EvalPolicy();
+
+	// gets
+	int64_t getMetricEpochs() const;
+	int64_t getMetricInterval() const;
+	float getSampleRate() const;
+
+	// sets
+	void setMetricEpochs(int64_t);
+	void setMetricInterval(int64_t);
+	void setSampleRate(float, uint64_t = 0);
+
+	// Condition checks
+	bool due(int64_t, int64_t) const;
+	bool sampled(uint64_t) const;
+	void mark(int64_t);
+	void reset();
+};
+};
+
+#endif
@@ -39,11 +39,13 @@ using namespace glades;
 glades::LayerBuilder::LayerBuilder()
 {
 	netType = NNetwork::TYPE_DFF;
+	dropoutSeed = 0;
 }
 
 glades::LayerBuilder::LayerBuilder(int newNetType)
 {
 	netType = newNetType;
+	dropoutSeed = 0;
 }
 
 glades::LayerBuilder::~LayerBuilder()
@@ -132,37 +134,20 @@ void glades::LayerBuilder::buildInputLayers(const NNInfo* skeleton, const DataIn
 		// 	shmea::GType cCell = di->getTrainRow(r)[c];
 		// }
 
+		// Fetch the row once; wide rows (images, hashed text) are expensive to build
+		const shmea::GList cRow = di->getTrainRow(r);
 		for (unsigned int c = 0; c < featureCount; ++c)
 		{
 			// We can probably get rid of most of these conditions becuase Gtype auto types
-			float newWeight = 0.0f;
-			shmea::GType cCell = di->getTrainRow(r)[c];
-
-			shmea::GType::Type cellType = cCell.getType(); 
-			// printf("Cell type %s",cellType);
-
-			switch (cellType)
+			shmea::GType cCell = cRow[c];
+			if ((cCell.getType() == shmea::GType::STRING_TYPE) && (!di->featureIsCategorical[c]))
 			{
-				case shmea::GType::STRING_TYPE:
-					if (!di->featureIsCategorical[c])
-					{
-						inputLayers.clear();
-						return;
-					}
-					break;
-				case shmea::GType::CHAR_TYPE:   newWeight = cCell.getChar();   break;
-				case shmea::GType::SHORT_TYPE:  newWeight = cCell.getShort();  break;
-				case shmea::GType::INT_TYPE:    newWeight = cCell.getInt();    break;
-				case shmea::GType::LONG_TYPE:   newWeight = cCell.getLong();   break;
-				case shmea::GType::FLOAT_TYPE:  newWeight = cCell.getFloat();  break;
-				case shmea::GType::DOUBLE_TYPE: newWeight = cCell.getDouble(); break;
-				case shmea::GType::BOOLEAN_TYPE:
-					newWeight = cCell.getBoolean() ? 1.0f : 0.0f;
-					break;
-				default:
-					break;  // Skip unsupported types
+				inputLayers.clear();
+				return;
 			}
-			
+
+			float newWeight = cellWeight(cCell);
+
 			// Error
 			Node* node = new Node();
 			if (!node)
@@ -189,6 +174,73 @@ void glades::LayerBuilder::buildInputLayers(const NNInfo* skeleton, const DataIn
 	}
 }
 
+/*!
+ * @brief cell weight
+ * @details the input node weight for one cell of a data row; strings (categorical features) and
+ * unsupported types read as 0
+ * @param cCell the cell
+ * @return the cell as a float
+ */
+float glades::LayerBuilder::cellWeight(const shmea::GType& cCell)
+{
+	switch (cCell.getType())
+	{
+		case shmea::GType::CHAR_TYPE:   return cCell.getChar();
+		case shmea::GType::SHORT_TYPE:  return cCell.getShort();
+		case shmea::GType::INT_TYPE:    return cCell.getInt();
+		case shmea::GType::LONG_TYPE:   return cCell.getLong();
+		case shmea::GType::FLOAT_TYPE:  return cCell.getFloat();
+		case shmea::GType::DOUBLE_TYPE: return cCell.getDouble();
+		case shmea::GType::BOOLEAN_TYPE:
+			return cCell.getBoolean() ? 1.0f : 0.0f;
+		default:
+			break;  // Skip unsupported types
+	}
+
+	return 0.0f;
+}
+
+/*!
+ * @brief set input layer
+ * @details overwrites the node weights of one input layer, or appends a layer when index is one
+ * past the end. Used by online training, where a fixed set of input layers is reused as rows
+ * stream through.
+ * @param index the input layer (train row) index
+ * @param row the standardized input row; must have as many cols as the existing input layers
+ * @return whether the layer was set
+ */
+bool glades::LayerBuilder::setInputLayer(unsigned int index, const shmea::GList& row)
+{
+	if (index > inputLayers.size())
+		return false;
+
+	if ((inputLayers.size() > 0) && (row.size() != inputLayers[0]->size()))
+	{
+		printf("[GQL] Input row has %u cols, expected %u\n", row.size(), inputLayers[0]->size());
+		return false;
+	}
+
+	if (index == inputLayers.size())
+	{
+		Layer* cLayer = new Layer(Layer::INPUT_TYPE, false);
+		for (unsigned int c = 0; c < row.size(); ++c)
+		{
+			Node* node = new Node();
+			node->setWeight(row.getFloat(c));
+			cLayer->addNode(node);
+		}
+
+		inputLayers.push_back(cLayer);
+		return true;
+	}
+
+	Layer* cLayer = inputLayers[index];
+	for (unsigned int c = 0; c < row.size(); ++c)
+		cLayer->getNode(c)->setWeight(row.getFloat(c));
+
+	return true;
+}
+
 void glades::LayerBuilder::buildHiddenLayers(const NNInfo* skeleton)
 {
 	int inputLayerSize = inputLayers[0]->size();
@@ -209,7 +261,8 @@ void glades::LayerBuilder::buildHiddenLayers(const NNInfo* skeleton)
 		if (isPositive)
 		{
 			// Create the hidden layer
-			cLayer->initWeights(prevLayerSize, cLayerSize, Node::INIT_POSXAVIER, activationType);
+			cLayer->initWeights(prevLayerSize, cLayerSize, Node::INIT_POSXAVIER, activationType,
+								 rng);
 		}
 		else
 		{
@@ -225,7 +278,7 @@ void glades::LayerBuilder::buildHiddenLayers(const NNInfo* skeleton)
 				continue;
 			}
 
-			cLayer->initWeights(prevLayerSize, cLayerSize, Node::INIT_XAVIER, activationType);
+			cLayer->initWeights(prevLayerSize, cLayerSize, Node::INIT_XAVIER, activationType, rng);
 		}
 
 		layers.push_back(cLayer);
@@ -260,9 +313,10 @@ void glades::LayerBuilder::buildOutputLayer(const NNInfo* skeleton)
 	// Create the output layer
 	Layer* cLayer = new Layer(Layer::OUTPUT_TYPE);
 	if (isPositive)
-		cLayer->initWeights(prevLayerSize, outputLayerSize, Node::INIT_POSXAVIER, activationType);
+		cLayer->initWeights(prevLayerSize, outputLayerSize, Node::INIT_POSXAVIER, activationType,
+							 rng);
 	else
-		cLayer->initWeights(prevLayerSize, outputLayerSize, Node::INIT_XAVIER, activationType);
+		cLayer->initWeights(prevLayerSize, outputLayerSize, Node::INIT_XAVIER, activationType, rng);
 	layers.push_back(cLayer);
 }
 
@@ -360,6 +414,30 @@ unsigned int glades::LayerBuilder::getLayersSize() const
 	return layers.size();
 }
 
+/*!
+ * @brief get layer
+ * @details layer 0 is the row's input layer, then the hidden layers and the output layer
+ * @param inputRowCounter the current row
+ * @param cLayerCounter the layer index
+ * @return the layer, or NULL if out of range
+ */
+glades::Layer* glades::LayerBuilder::getLayer(unsigned int inputRowCounter,
+											  unsigned int cLayerCounter)
+{
+	if (cLayerCounter == 0)
+	{
+		if (inputRowCounter >= inputLayers.size())
+			return NULL;
+
+		return inputLayers[inputRowCounter];
+	}
+
+	if (cLayerCounter > layers.size())
+		return NULL;
+
+	return layers[cLayerCounter - 1];
+}
+
 unsigned int glades::LayerBuilder::getLayerSize(unsigned int index) const
 {
     if(index > layers.size()+1)
@@ -409,6 +487,31 @@ shmea::GList glades::LayerBuilder::getWeights()
     return weights;
 }
 
+/*!
+ * @brief get weights
+ * @details every edge weight, flat and in the order of getWeights(), without a GType per value
+ * @param weights filled with the weights
+ * @param layerSizes filled with the number of weights per layer
+ */
+void glades::LayerBuilder::getWeights(std::vector<float>& weights,
+									  std::vector<unsigned int>& layerSizes)
+{
+	weights.clear();
+	layerSizes.clear();
+	for (unsigned int i = 0; i < getLayersSize(); ++i)
+	{
+		unsigned int layerStart = weights.size();
+		std::vector<Node*> cChildren = layers[i]->getChildren();
+		for (unsigned int j = 0; j < cChildren.size(); ++j)
+		{
+			for (unsigned int k = 0; k < cChildren[j]->numEdges(); ++k)
+				weights.push_back(cChildren[j]->getEdgeWeight(k));
+		}
+
+		layerSizes.push_back(weights.size() - layerStart);
+	}
+}
+
 void glades::LayerBuilder::standardizeWeights(const NNInfo* skeleton)
 {
 	// Structure required!
@@ -494,8 +597,29 @@ float glades::LayerBuilder::unstandardize(float value)
 	return ((value + 0.5f) * xRange) + xMin;
 }
 
-void glades::LayerBuilder::scrambleDropout(unsigned int inputRowCounter, float pInput,
-										   const std::vector<float>& pHidden)
+/*!
+ * @brief set seed
+ * @details reseed the stream used for weight init and the one dropout masks are derived from
+ * @param newSeed the seed
+ */
+void glades::LayerBuilder::setSeed(uint64_t newSeed)
+{
+	rng.seed(newSeed);
+	dropoutSeed = newSeed;
+}
+
+/*!
+ * @brief scramble dropout
+ * @details draw new dropout masks for one row. The masks come from that sample's own stream
+ * (GRandom::forSample), so they depend on the seed and the sample index only, not on the order
+ * the rows are trained in or the thread that trains them.
+ * @param inputRowCounter the input row
+ * @param sampleIndex the training step, unique per row and epoch
+ * @param pInput the input layer's dropout probability
+ * @param pHidden each hidden layer's dropout probability
+ */
+void glades::LayerBuilder::scrambleDropout(unsigned int inputRowCounter, uint64_t sampleIndex,
+										   float pInput, const std::vector<float>& pHidden)
 {
 	// Invalid arg
 	if (layers.size() - 1 != pHidden.size())
@@ -509,7 +633,8 @@ void glades::LayerBuilder::scrambleDropout(unsigned int inputRowCounter, float p
 		return;
 
 	// Input layer
-	cInputLayer->generateDropout(pInput);
+	GRandom sampleRng = GRandom::forSample(dropoutSeed, sampleIndex);
+	cInputLayer->generateDropout(pInput, sampleRng);
 
 	// Hidden layers dropout
 	for (unsigned int i = 0; i < layers.size(); ++i)
@@ -518,7 +643,7 @@ void glades::LayerBuilder::scrambleDropout(unsigned int inputRowCounter, float p
 			continue;
 
 		// Hidden layer 'i'
-		layers[i]->generateDropout(pHidden[i]);
+		layers[i]->generateDropout(pHidden[i], sampleRng);
 	}
 }
 
@@ -18,6 +18,7 @@
 #define _GQL_LAYERBUILDER
 
 #include "Backend/Database/GTable.h"
+#include "../GMath/grandom.h"
 #include <map>
 #include <math.h>
 #include <stdio.h>
@@ -45,6 +46,8 @@ private:
 	float xMax;
 	float xRange;
 	std::vector<std::vector<std::vector<float> > > timeState;
+	GRandom rng;
+	uint64_t dropoutSeed; // dropout masks come from GRandom::forSample(dropoutSeed, sample)
 
 	void seperateTables(const shmea::GTable&);
 	void buildInputLayers(const NNInfo*, const DataInput*);
@@ -59,21 +62,26 @@ public:
 	~LayerBuilder();
 
 	bool build(const NNInfo*, const DataInput*, bool = false);
+	bool setInputLayer(unsigned int, const shmea::GList&);
+	static float cellWeight(const shmea::GType&);
 	NetworkState* getNetworkStateFromLoc(unsigned int, unsigned int, unsigned int, unsigned int,
 										 unsigned int);
 	void setTimeState(unsigned int, unsigned int, unsigned int, float);
 	unsigned int getInputLayersSize() const;
 	unsigned int getLayersSize() const;
+	Layer* getLayer(unsigned int, unsigned int);
 	unsigned int getLayerSize(unsigned int) const;
 	unsigned int sizeOfLayer(unsigned int) const;
 	float getTimeState(unsigned int, unsigned int, unsigned int) const;
-	void scrambleDropout(unsigned int, float, const std::vector<float>&);
+	void setSeed(uint64_t);
+	void scrambleDropout(unsigned int, uint64_t, float, const std::vector<float>&);
 	void clearDropout();
 	void print(const NNInfo*, bool = false) const;
 	void clean();
 
 	// Getters
 	shmea::GList getWeights();
+	void getWeights(std::vector<float>&, std::vector<unsigned int>&);
 	shmea::GList getActivations();
 
 	// Database
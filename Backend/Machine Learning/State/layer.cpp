@@ -16,6 +16,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "layer.h"
 #include "../GMath/gmath.h"
+#include "../GMath/grandom.h"
 #include "node.h"
 
 using namespace glades;
@@ -41,6 +42,8 @@ glades::Layer::~Layer()
 	type = 0;
 	children.clear();
 	dropoutFlag.clear();
+	activeNodes.clear();
+	allNodes.clear();
 }
 
 int64_t glades::Layer::getID() const
@@ -99,38 +102,52 @@ void glades::Layer::setupDropout()
 	}
 }
 
-void glades::Layer::generateDropout(float p)
+void glades::Layer::generateDropout(float p, GRandom& rng)
 {
 	if (dropoutFlag.size() < size())
 	    setupDropout();
 	
-	int cDropoutRate = p * 100.0f;
-	if (cDropoutRate < 0)
+	if (p < 0.0f)
 		return;
 
-	if (cDropoutRate >= 100)
+	if (p >= 1.0f)
 		return;
 
-	bool fullLayerDropped = true;
-	do
+	if (size() == 0)
+		return;
+
+	// generate the dropout flags in bulk; never drop the whole layer
+	unsigned int kept = rng.fillBernoulli(dropoutFlag, size(), p);
+	if (kept == 0)
+		dropoutFlag[rng.nextBelow(size())] = false;
+
+	// The passes only visit these
+	activeNodes.clear();
+	for (unsigned int i = 0; i < size(); ++i)
 	{
-		fullLayerDropped = true;
+		if (!dropoutFlag[i])
+			activeNodes.push_back(i);
+	}
+}
 
-		// generate the dropout probabilities
-		for (unsigned int i = 0; i < size(); ++i)
-		{
-			bool cDropped = false;
-			int dart = (rand() % 100) + 1; // 1-100 (100 possibilities)
-			if (dart <= cDropoutRate)
-				cDropped = true;
-			else
-				fullLayerDropped = false;
-
-			// Populate the dropout vector
-			dropoutFlag[i] = cDropped;
-		}
+/*!
+ * @brief get active nodes
+ * @details the indices of the nodes that survived the current dropout draw, in order (every
+ * node when no dropout is in effect)
+ * @return the active node indices
+ */
+const std::vector<unsigned int>& glades::Layer::getActiveNodes()
+{
+	if ((type == OUTPUT_TYPE) || (dropoutFlag.size() < size()) ||
+		(activeNodes.empty() && (size() > 0)))
+	{
+		while (allNodes.size() < size())
+			allNodes.push_back(allNodes.size());
+		allNodes.resize(size());
+		return allNodes;
+	}
 
-	} while (fullLayerDropped);
+	return activeNodes;
 }
 
 bool glades::Layer::possiblePath(unsigned int index) const
@@ -185,6 +202,7 @@ unsigned int glades::Layer::lastValidPath() const
 void glades::Layer::clearDropout()
 {
 	dropoutFlag.clear();
+	activeNodes.clear();
 }
 
 void glades::Layer::addNode(Node* child)
@@ -194,24 +212,14 @@ void glades::Layer::addNode(Node* child)
 }
 
 void glades::Layer::initWeights(int prevLayerSize, unsigned int cLayerSize, int initType,
-								int activationType)
+								int activationType, GRandom& rng)
 {
 	if (initType == Node::INIT_XAVIER || initType == Node::INIT_POSXAVIER)
 	{
-		unsigned int num_layers = 2048;
-		float zigg_layers[num_layers + 1]; // array of pre-calculated x values
-		float normal_CDF = 1.0;
-		for (unsigned int i = 1; i < num_layers; i++) // assigning x values to layers
-		{
-			normal_CDF = normal_CDF - (1 / ((float)num_layers * 2));
-			zigg_layers[i] = GMath::norm_inv_CDF(normal_CDF);
-		}
-		zigg_layers[0] = zigg_layers[1];
-		zigg_layers[num_layers] = 0;
 		while (size() < cLayerSize)
 		{
 			Node* newNode = new Node();
-			newNode->initWeights(prevLayerSize, zigg_layers, num_layers, initType, activationType);
+			newNode->initWeights(prevLayerSize, initType, activationType, rng);
 			addNode(newNode);
 		}
 	}
@@ -220,7 +228,7 @@ void glades::Layer::initWeights(int prevLayerSize, unsigned int cLayerSize, int
 		while (size() < cLayerSize)
 		{
 			Node* newNode = new Node();
-			newNode->initWeights(prevLayerSize, initType);
+			newNode->initWeights(prevLayerSize, initType, rng);
 			addNode(newNode);
 		}
 	}
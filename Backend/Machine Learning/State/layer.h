@@ -25,12 +25,15 @@
 namespace glades {
 
 class Node;
+class GRandom;
 
 class Layer
 {
 private:
 	std::vector<Node*> children;
 	std::vector<bool> dropoutFlag;
+	std::vector<unsigned int> activeNodes;
+	std::vector<unsigned int> allNodes;
 	int64_t id;
 	float biasWeight;
 	int type;
@@ -51,6 +54,7 @@ public:
 	int getType() const;
 	unsigned int size() const;
 	bool possiblePath(unsigned int) const;
+	const std::vector<unsigned int>& getActiveNodes();
 	unsigned int firstValidPath() const;
 	unsigned int lastValidPath() const;
 
@@ -63,10 +67,10 @@ public:
 	const std::vector<glades::Node*>& getChildren() const;
 	Node* getNode(unsigned int);
 	void setupDropout();
-	void generateDropout(float);
+	void generateDropout(float, GRandom&);
 	void clearDropout();
 	void addNode(Node*);
-	void initWeights(int, unsigned int, int, int);
+	void initWeights(int, unsigned int, int, int, GRandom&);
 	std::vector<Node*>::iterator removeNode(Node*);
 	void clean();
 	void print() const;
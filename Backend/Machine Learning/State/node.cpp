@@ -16,6 +16,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "node.h"
 #include "../GMath/gmath.h"
+#include "../GMath/grandom.h"
 #include "edge.h"
 
 using namespace glades;
@@ -217,19 +218,19 @@ void glades::Node::print() const
 	printf("]");
 }
 
-void glades::Node::initWeights(unsigned int newNumEdges, int initType)
+void glades::Node::initWeights(unsigned int newNumEdges, int initType, GRandom& rng)
 {
 	while (numEdges() < newNumEdges)
 	{
 		if (initType == INIT_RANDOM)
 		{
-			int randomNum = rand() % 100 + 1; //+1 so we dont divide by zero
+			int randomNum = rng.nextBelow(100) + 1; //+1 so we dont divide by zero
 			float randomFloat = ((float)(randomNum)) / (((float)100));
 			edges.push_back(new glades::Edge(numEdges(), randomFloat));
 		}
 		else if (initType == INIT_POSRAND)
 		{
-			int randomNum = rand() % 100 + 1; //+1 so we dont divide by zero
+			int randomNum = rng.nextBelow(100) + 1; //+1 so we dont divide by zero
 			float randomFloat = ((float)(randomNum)) / (((float)100));
 			edges.push_back(new glades::Edge(numEdges(), randomFloat));
 		}
@@ -238,8 +239,8 @@ void glades::Node::initWeights(unsigned int newNumEdges, int initType)
 	}
 }
 
-void glades::Node::initWeights(unsigned int newNumEdges, float zigg_layers[],
-							   unsigned int num_layers, int initType, int activationType)
+void glades::Node::initWeights(unsigned int newNumEdges, int initType, int activationType,
+							   GRandom& rng)
 {
 	float std_dev;
 	if (activationType != GMath::RELU)
@@ -248,28 +249,9 @@ void glades::Node::initWeights(unsigned int newNumEdges, float zigg_layers[],
 		std_dev = sqrt(2 / (float)newNumEdges);
 	while (numEdges() < newNumEdges)
 	{
-		bool accepted = false;
-		float candidate_x;
-		while (!accepted)
-		{
-			int layer = rand() % 2048;
-			candidate_x = rand() / (RAND_MAX / zigg_layers[layer]);
-			if (layer == 0) // tail; possibly not worth calculating values past 3 std devs, maybe
-							// revisit another day
-				continue;
-			else if (candidate_x < zigg_layers[layer + 1])
-				accepted = true;
-			else if (candidate_x > zigg_layers[layer + 1])
-			{
-				float randU = rand() / RAND_MAX;
-				float candidate_y =
-					GMath::normal_pdf(zigg_layers[layer]) +
-					randU * (GMath::normal_pdf(zigg_layers[layer - 1] -
-											   GMath::normal_pdf(zigg_layers[layer])));
-				if (candidate_y < GMath::normal_pdf(candidate_x))
-					accepted = true;
-			}
-		}
+		float candidate_x = rng.nextNormal();
+		if (initType == INIT_POSXAVIER)
+			candidate_x = fabs(candidate_x);
 		candidate_x = candidate_x * std_dev;
 		edges.push_back(new glades::Edge(numEdges(), candidate_x));
 	}
@@ -291,17 +273,23 @@ void glades::Node::getDelta(unsigned int index, float baseError, float cInputNod
 	addPrevDelta(index, deltaW);
 }
 
-void glades::Node::applyDeltas(unsigned int index, int minibatchSize)
+float glades::Node::getBatchDelta(unsigned int index, int minibatchSize) const
 {
 	if (index >= edges.size())
-		return;
+		return 0.0f;
 
 	float deltaW = 0.0f;
 	for (int i = 0; i < minibatchSize; ++i)
 		deltaW += edges[index]->getPrevDelta(i);
 
-	deltaW /= minibatchSize;
+	return deltaW / minibatchSize;
+}
+
+void glades::Node::applyDeltas(unsigned int index, int minibatchSize)
+{
+	if (index >= edges.size())
+		return;
 
 	// Set the new weight
-	setEdgeWeight(index, getEdgeWeight(index) - deltaW);
+	setEdgeWeight(index, getEdgeWeight(index) - getBatchDelta(index, minibatchSize));
 }
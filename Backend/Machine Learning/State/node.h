@@ -31,6 +31,7 @@ class GType;
 namespace glades {
 
 class Edge;
+class GRandom;
 
 // Makes up the graph
 class Node
@@ -87,9 +88,10 @@ public:
 	void print() const;
 
 	// weights functions
-	void initWeights(unsigned int, int);
-	void initWeights(unsigned int, float[], unsigned int, int, int);
+	void initWeights(unsigned int, int, GRandom&);
+	void initWeights(unsigned int, int, int, GRandom&);
 	void getDelta(unsigned int, float, float, float, float, float, float);
+	float getBatchDelta(unsigned int, int) const;
 	void applyDeltas(unsigned int, int);
 };
 };
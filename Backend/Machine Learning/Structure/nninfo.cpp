@@ -25,6 +25,7 @@
 #include "inputlayerinfo.h"
 #include "layerinfo.h"
 #include "outputlayerinfo.h"
+#include "../GMath/gmath.h"
 
 using namespace glades;
 
@@ -38,6 +39,8 @@ glades::NNInfo::NNInfo(const shmea::GString& newName)
 	name = newName;
 	inputType = 0;
 	hiddenLayerCount = 0;
+	precision = GMath::PRECISION_EXACT;
+	weightStorage = GMath::STORAGE_FP32;
 }
 
 /*!
@@ -54,6 +57,8 @@ glades::NNInfo::NNInfo(const shmea::GString& newName, InputLayerInfo* newInputLa
 	name = newName;
 	inputType = 0;
 	hiddenLayerCount = hidden.size();
+	precision = GMath::PRECISION_EXACT;
+	weightStorage = GMath::STORAGE_FP32;
 	inputLayer = newInputLayer;
 	outputLayer = newOutputLayer;
 
@@ -78,6 +83,8 @@ glades::NNInfo::NNInfo(const shmea::GString& newName, const shmea::GTable& newTa
 	hiddenLayerCount = rows - 2;
 	layers.reserve(hiddenLayerCount);
 	name = newName;
+	precision = GMath::PRECISION_EXACT;
+	weightStorage = GMath::STORAGE_FP32;
 	fromGTable(newName, newTable);
 }
 
@@ -159,6 +166,26 @@ int glades::NNInfo::getBatchSize() const
 	return inputLayer->getBatchSize();
 }
 
+/*!
+ * @brief get transcendental precision
+ * @details get the GMath precision flag the network uses for tanh/sigmoid activations
+ * @return GMath::PRECISION_EXACT (default) or GMath::PRECISION_FAST
+ */
+int glades::NNInfo::getPrecision() const
+{
+	return precision;
+}
+
+/*!
+ * @brief get weight storage
+ * @details get the GMath storage flag for the copy of the weights the forward pass reads
+ * @return GMath::STORAGE_FP32 (default), GMath::STORAGE_BF16 or GMath::STORAGE_FP16
+ */
+int glades::NNInfo::getWeightStorage() const
+{
+	return weightStorage;
+}
+
 /*!
  * @brief get input layer
  * @details get NNInfo's input layer
@@ -472,6 +499,35 @@ void glades::NNInfo::setBatchSize(int newBatchSize)
 	inputLayer->setBatchSize(newBatchSize);
 }
 
+/*!
+ * @brief set transcendental precision
+ * @details select exact libm or the fast polynomial tanh/sigmoid kernels for this network; the
+ * flag is not part of the saved GTable
+ * @param newPrecision GMath::PRECISION_EXACT or GMath::PRECISION_FAST
+ */
+void glades::NNInfo::setPrecision(int newPrecision)
+{
+	if ((newPrecision != GMath::PRECISION_EXACT) && (newPrecision != GMath::PRECISION_FAST))
+		return;
+
+	precision = newPrecision;
+}
+
+/*!
+ * @brief set weight storage
+ * @details keep a bf16 or fp16 copy of the weights for the forward pass; training still updates
+ * fp32 master weights and refreshes the copy from them. The flag is not part of the saved GTable
+ * @param newStorage GMath::STORAGE_FP32, GMath::STORAGE_BF16 or GMath::STORAGE_FP16
+ */
+void glades::NNInfo::setWeightStorage(int newStorage)
+{
+	if ((newStorage != GMath::STORAGE_FP32) && (newStorage != GMath::STORAGE_BF16) &&
+		(newStorage != GMath::STORAGE_FP16))
+		return;
+
+	weightStorage = newStorage;
+}
+
 /*!
  * @brief set the output layer type
  * @details set the output layer type
@@ -50,6 +50,8 @@ private:
 	std::vector<HiddenLayerInfo*> layers;
 	int hiddenLayerCount;
 	int batchSize;
+	int precision; // GMath precision flag, runtime only (not saved)
+	int weightStorage; // GMath storage flag, runtime only (not saved)
 
 	//
 	shmea::GTable toGTable() const;
@@ -89,6 +91,8 @@ public:
 	int getOutputType() const;
 	float getPInput() const;
 	int getBatchSize() const;
+	int getPrecision() const;
+	int getWeightStorage() const;
 	InputLayerInfo* getInputLayer() const;
 	std::vector<HiddenLayerInfo*> getLayers() const;
 	int numHiddenLayers() const;
@@ -111,6 +115,8 @@ public:
 	void setOutputSize(int);
 	void setPInput(float);
 	void setBatchSize(int);
+	void setPrecision(int);
+	void setWeightStorage(int);
 	void setLayers(const std::vector<HiddenLayerInfo*>&);
 	void setLearningRate(unsigned int, float);
 	void setMomentumFactor(unsigned int, float);
@@ -0,0 +1,109 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "activations-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/activations.h"
+#include <math.h>
+#include <vector>
+
+void ActivationsUnitTest()
+{
+    // Every specialized kernel matches the runtime switch it replaces
+    float netInputs[9] = {-3.0f, -0.95f, -0.2f, 0.0f, 0.05f, 0.3f, 0.97f, 1.5f, 4.0f};
+    float fxParams[3] = {0.01f, 0.05f, 0.1f};
+    bool squashMatch = true;
+    bool errDerMatch = true;
+    for (int fx = glades::GMath::TANH; fx <= glades::GMath::STEP; ++fx)
+    {
+	for (unsigned int p = 0; p < 3; ++p)
+	{
+	    for (int precision = glades::GMath::PRECISION_EXACT; precision <= glades::GMath::PRECISION_FAST; ++precision)
+	    {
+		glades::ActivationPlan plan(fx, fxParams[p], glades::GMath::REGRESSION, precision);
+		float squashed[9];
+		float errDers[9];
+		memcpy(squashed, netInputs, sizeof(netInputs));
+		plan.squash(squashed, 9, plan.fxParam);
+		plan.errDer(squashed, errDers, 9, plan.fxParam);
+		for (unsigned int i = 0; i < 9; ++i)
+		{
+		    float expected = glades::GMath::squash(netInputs[i], fx, fxParams[p], precision);
+		    if (squashed[i] != expected)
+			squashMatch = false;
+		    if (errDers[i] != glades::GMath::activationErrDer(squashed[i], fx, fxParams[p]))
+			errDerMatch = false;
+		}
+	    }
+	}
+    }
+    G_assert(__FILE__, __LINE__, "Squash kernel mismatch", squashMatch);
+    G_assert(__FILE__, __LINE__, "Activation derivative kernel mismatch", errDerMatch);
+
+    // Cost derivative kernels
+    float expectations[3] = {0.0f, 1.0f, 0.0f};
+    float predictions[3] = {0.2f, 0.7f, 0.1f};
+    bool costMatch = true;
+    for (int costFx = glades::GMath::REGRESSION; costFx <= glades::GMath::SOFTMAX; ++costFx)
+    {
+	float errDers[3];
+	glades::ActivationPlan plan(glades::GMath::LINEAR, 1.0f, costFx);
+	plan.costErrDer(expectations, predictions, errDers, 3);
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+	    if (errDers[i] != glades::GMath::costErrDer(expectations[i], predictions[i], costFx))
+		costMatch = false;
+	}
+    }
+    G_assert(__FILE__, __LINE__, "Cost derivative kernel mismatch", costMatch);
+
+    // The fused softmax gradient matches a finite difference of the cost, with OHE targets that
+    // do not sum to 1
+    const unsigned int classes = 5;
+    float logits[classes] = {0.4f, -1.2f, 2.0f, 0.1f, -0.3f};
+    float targets[classes] = {0.01f, 0.01f, 0.99f, 0.01f, 0.01f};
+    std::vector<float> probs(logits, logits + classes);
+    glades::GMath::softmax(probs);
+    float softmaxDers[classes];
+    glades::ActivationPlan softmaxPlan(glades::GMath::LINEAR, 1.0f, glades::GMath::SOFTMAX);
+    softmaxPlan.costErrDer(targets, &probs[0], softmaxDers, classes);
+    float targetSum = 0.0f;
+    for (unsigned int i = 0; i < classes; ++i)
+	targetSum += targets[i];
+    bool gradientMatch = true;
+    bool scalarMatch = true;
+    const float h = 1.0e-2f;
+    for (unsigned int i = 0; i < classes; ++i)
+    {
+	double sideCost[2];
+	for (int side = 0; side < 2; ++side)
+	{
+	    std::vector<float> shifted(logits, logits + classes);
+	    shifted[i] += (side == 0) ? h : -h;
+	    glades::GMath::softmax(shifted);
+	    sideCost[side] = 0.0;
+	    for (unsigned int j = 0; j < classes; ++j)
+		sideCost[side] += glades::GMath::SoftmaxCrossEntropyCost(targets[j], shifted[j]);
+	}
+	double numeric = (sideCost[0] - sideCost[1]) / (2.0 * h);
+	if (fabs(numeric - softmaxDers[i]) > 1.0e-3)
+	    gradientMatch = false;
+	if (softmaxDers[i] != glades::GMath::costErrDer(targets[i], probs[i], glades::GMath::SOFTMAX, targetSum))
+	    scalarMatch = false;
+    }
+    G_assert(__FILE__, __LINE__, "Softmax gradient does not match the finite difference", gradientMatch);
+    G_assert(__FILE__, __LINE__, "Softmax kernel mismatch", scalarMatch);
+
+    // The default plan is the identity
+    glades::ActivationPlan identity;
+    float value = 0.42f;
+    identity.squash(&value, 1, identity.fxParam);
+    G_assert(__FILE__, __LINE__, "Identity plan mismatch", value == 0.42f);
+
+    printf("ActivationsUnitTest completed successfully.\n");
+}
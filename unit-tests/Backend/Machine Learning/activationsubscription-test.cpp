@@ -0,0 +1,91 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+
+#include "activationsubscription-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/Networks/activationsubscription.h"
+#include <vector>
+
+void ActivationSubscriptionUnitTest()
+{
+    // Input, two hidden layers and the output
+    std::vector<int> layerSizes;
+    layerSizes.push_back(4);
+    layerSizes.push_back(10);
+    layerSizes.push_back(6);
+    layerSizes.push_back(2);
+    std::vector<float> layerValues(10);
+    for (unsigned int i = 0; i < layerValues.size(); ++i)
+	layerValues[i] = (float)i;
+
+    // Default: every computed layer of the last row
+    glades::ActivationSubscription all;
+    G_assert(__FILE__, __LINE__, "Default bind failed", all.bind(layerSizes, 50));
+    G_assert(__FILE__, __LINE__, "Wrong default width", all.getWidth() == 18);
+    G_assert(__FILE__, __LINE__, "Wrong default ranges", all.getBoundRanges().size() == 3);
+    G_assert(__FILE__, __LINE__, "Input layer subscribed", !all.wantsLayer(0));
+    G_assert(__FILE__, __LINE__, "Wrong default probe", (all.getBoundProbes().size() == 1) && (all.getBoundProbes()[0] == 49));
+
+    // Nothing recorded before the epoch starts
+    G_assert(__FILE__, __LINE__, "Recording before the epoch", all.getProbe(49) == -1);
+    G_assert(__FILE__, __LINE__, "Epoch not recorded", all.beginEpoch(1));
+    G_assert(__FILE__, __LINE__, "Last row not probed", all.getProbe(49) == 0);
+    G_assert(__FILE__, __LINE__, "Other row probed", all.getProbe(48) == -1);
+    all.record(0, 2, &layerValues[0], 6);
+    G_assert(__FILE__, __LINE__, "Layer 2 in the wrong place", (all.getValues()[10] == 0.0f) && (all.getValues()[15] == 5.0f));
+    G_assert(__FILE__, __LINE__, "Wrong captured epoch", all.getCapturedEpoch() == 1);
+
+    // Neuron ranges, a stride, probe rows and an interval
+    glades::ActivationSubscription some;
+    some.clear();
+    some.addRange(glades::ActivationSubscription::Range(1, 2, 3));
+    some.addRange(glades::ActivationSubscription::Range(1, 1, glades::ActivationSubscription::ALL, 4));
+    some.addLayer(0);
+    some.addRange(glades::ActivationSubscription::Range(7)); // no such layer
+    some.addProbeRow(30);
+    some.addProbeRow(5);
+    some.addProbeRow(5);
+    some.addProbeRow(500); // past the data
+    some.setSampleInterval(3);
+    G_assert(__FILE__, __LINE__, "Subset bind failed", some.bind(layerSizes, 50));
+    G_assert(__FILE__, __LINE__, "Wrong subset ranges", some.getBoundRanges().size() == 3);
+    G_assert(__FILE__, __LINE__, "Wrong strided count", some.getBoundRanges()[1].nodeCount == 3);
+    G_assert(__FILE__, __LINE__, "Wrong subset width", some.getWidth() == 10);
+    G_assert(__FILE__, __LINE__, "Wrong probes", (some.getBoundProbes().size() == 2) && (some.getBoundProbes()[0] == 5) && (some.getBoundProbes()[1] == 30));
+    G_assert(__FILE__, __LINE__, "Unsubscribed layer wanted", !some.wantsLayer(2));
+
+    G_assert(__FILE__, __LINE__, "Off interval epoch recorded", !some.beginEpoch(4));
+    G_assert(__FILE__, __LINE__, "Probe outside the interval", some.getProbe(30) == -1);
+    G_assert(__FILE__, __LINE__, "Interval epoch not recorded", some.beginEpoch(6));
+    int probe = some.getProbe(30);
+    G_assert(__FILE__, __LINE__, "Second probe not found", probe == 1);
+    some.record(probe, 1, &layerValues[0], 10);
+    some.record(probe, 0, &layerValues[0], 4);
+    const std::vector<float>& values = some.getValues();
+    G_assert(__FILE__, __LINE__, "Wrong value count", values.size() == 20);
+    G_assert(__FILE__, __LINE__, "First probe written", values[0] == 0.0f && values[2] == 0.0f);
+    G_assert(__FILE__, __LINE__, "Wrong range values", (values[10] == 2.0f) && (values[12] == 4.0f));
+    G_assert(__FILE__, __LINE__, "Wrong strided values", (values[13] == 1.0f) && (values[14] == 5.0f) && (values[15] == 9.0f));
+    G_assert(__FILE__, __LINE__, "Wrong input values", (values[16] == 0.0f) && (values[19] == 3.0f));
+
+    // Nothing subscribed, or too much, records nothing
+    glades::ActivationSubscription none;
+    none.clear();
+    G_assert(__FILE__, __LINE__, "Empty subscription bound", !none.bind(layerSizes, 50));
+    G_assert(__FILE__, __LINE__, "Empty subscription records", !none.beginEpoch(1));
+
+    std::vector<int> wideSizes(2, 1 << 16);
+    glades::ActivationSubscription wide;
+    for (unsigned int i = 0; i < 32; ++i)
+	wide.addProbeRow(i);
+    G_assert(__FILE__, __LINE__, "Oversized subscription bound", !wide.bind(wideSizes, 64));
+    G_assert(__FILE__, __LINE__, "Oversized subscription records", wide.getProbe(0) == -1);
+
+    printf("ActivationSubscriptionUnitTest completed successfully.\n");
+}
@@ -0,0 +1,21 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#ifndef _UT_ACTIVATIONSUBSCRIPTION
+#define _UT_ACTIVATIONSUBSCRIPTION
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+
+void ActivationSubscriptionUnitTest();
+
+#endif
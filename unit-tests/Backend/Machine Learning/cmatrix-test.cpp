@@ -0,0 +1,84 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "cmatrix-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/cmatrix.h"
+#include <math.h>
+#include <vector>
+
+static bool nearlyEqual(float a, float b)
+{
+    return fabs(a - b) <= 1.0e-6f;
+}
+
+void CMatrixUnitTest()
+{
+    // argmax only votes for positive values
+    const float vote[4] = {0.1f, 0.7f, 0.2f, 0.7f};
+    const float none[3] = {0.0f, -1.0f, 0.0f};
+    G_assert(__FILE__, __LINE__, "argmax wrong", glades::CMatrix::argmax(vote, 4) == 1);
+    G_assert(__FILE__, __LINE__, "argmax voted without a positive value", glades::CMatrix::argmax(none, 3) == -1);
+
+    // Batch of 5 samples over 3 classes, one with no expected class
+    const float exp[15] = {1, 0, 0,  1, 0, 0,  0, 1, 0,  0, 0, 1,  0, 0, 0};
+    const float pred[15] = {0.8f, 0.1f, 0.1f,  0.2f, 0.7f, 0.1f,  0.1f, 0.8f, 0.1f,
+			    0.3f, 0.3f, 0.4f,  0.9f, 0.0f, 0.1f};
+    glades::CMatrix cm;
+    cm.build(3);
+    cm.addResults(pred, exp, 5);
+    G_assert(__FILE__, __LINE__, "Wrong size", cm.size() == 3);
+    G_assert(__FILE__, __LINE__, "Unlabelled sample counted", cm.getTotal() == 4);
+    G_assert(__FILE__, __LINE__, "Wrong cell", cm.getCount(0, 0) == 1);
+    G_assert(__FILE__, __LINE__, "Wrong cell", cm.getCount(0, 1) == 1);
+    G_assert(__FILE__, __LINE__, "Wrong cell", cm.getCount(1, 1) == 1);
+    G_assert(__FILE__, __LINE__, "Wrong cell", cm.getCount(2, 2) == 1);
+
+    // Per thread matrices merge into the epoch's
+    glades::CMatrix worker;
+    worker.build(3);
+    worker.addResult(2, 0);
+    worker.addResult(2, 2);
+    worker.addResult(7, 0);
+    cm.merge(worker);
+    G_assert(__FILE__, __LINE__, "Merge lost counts", cm.getTotal() == 6);
+    G_assert(__FILE__, __LINE__, "Merge wrong cell", cm.getCount(2, 2) == 2);
+    glades::CMatrix wrongSize;
+    wrongSize.build(2);
+    wrongSize.addResult(0, 0);
+    cm.merge(wrongSize);
+    G_assert(__FILE__, __LINE__, "Merged a mismatched matrix", cm.getTotal() == 6);
+
+    // rows: {1,1,0} {0,1,0} {1,0,2}
+    cm.updateResultParams();
+    G_assert(__FILE__, __LINE__, "Wrong precision", nearlyEqual(cm.getClassPrecision(0), 0.5f));
+    G_assert(__FILE__, __LINE__, "Wrong precision", nearlyEqual(cm.getClassPrecision(1), 0.5f));
+    G_assert(__FILE__, __LINE__, "Wrong precision", nearlyEqual(cm.getClassPrecision(2), 1.0f));
+    G_assert(__FILE__, __LINE__, "Wrong recall", nearlyEqual(cm.getClassRecall(0), 0.5f));
+    G_assert(__FILE__, __LINE__, "Wrong recall", nearlyEqual(cm.getClassRecall(2), 2.0f / 3.0f));
+    G_assert(__FILE__, __LINE__, "Wrong accuracy", nearlyEqual(cm.getClassAccuracy(1), 4.0f / 5.0f));
+
+    // Params are rebuilt, not accumulated, on every update
+    cm.updateResultParams();
+    G_assert(__FILE__, __LINE__, "Params accumulated", nearlyEqual(cm.getClassRecall(0), 0.5f));
+
+    // Copies take the counts and params, swaps trade them
+    glades::CMatrix copied;
+    copied.copy(cm);
+    G_assert(__FILE__, __LINE__, "Copy lost counts", (copied.size() == 3) && (copied.getTotal() == 6) && (copied.getCount(2, 0) == 1));
+    G_assert(__FILE__, __LINE__, "Copy lost params", nearlyEqual(copied.getClassRecall(2), 2.0f / 3.0f));
+    copied.swap(wrongSize);
+    G_assert(__FILE__, __LINE__, "Swap mismatch", (copied.size() == 2) && (copied.getTotal() == 1) && (wrongSize.size() == 3) && (wrongSize.getTotal() == 6));
+    copied.copy(cm);
+    G_assert(__FILE__, __LINE__, "Copy did not reshape", (copied.size() == 3) && (copied.getCount(2, 2) == 2));
+
+    cm.reset();
+    G_assert(__FILE__, __LINE__, "Reset kept counts", (cm.getTotal() == 0) && (cm.size() == 3));
+
+    printf("CMatrixUnitTest completed successfully.\n");
+}
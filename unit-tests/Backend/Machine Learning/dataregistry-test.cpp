@@ -0,0 +1,118 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "dataregistry-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/DataObjects/DataRegistry.h"
+#include "../../../Backend/Machine Learning/GMath/gmath.h"
+#include <pthread.h>
+#include <unistd.h>
+
+// Both threads acquire the same key once the gate opens
+struct RegistryRace
+{
+    pthread_mutex_t gateMutex;
+    pthread_cond_t gateCond;
+    bool open;
+    const char* path;
+    glades::DataHandle handles[2];
+    unsigned int nextHandle;
+};
+
+static void* raceAcquire(void* y)
+{
+    RegistryRace* race = (RegistryRace*)y;
+    pthread_mutex_lock(&race->gateMutex);
+    while (!race->open)
+	pthread_cond_wait(&race->gateCond, &race->gateMutex);
+    unsigned int slot = race->nextHandle++;
+    pthread_mutex_unlock(&race->gateMutex);
+
+    race->handles[slot] = glades::DataRegistry::acquire(race->path, glades::DataInput::CSV);
+    return NULL;
+}
+
+void DataRegistryUnitTest()
+{
+    unsigned int startSize = glades::DataRegistry::size();
+
+    // Same key, one import
+    glades::DataHandle h1 = glades::DataRegistry::acquire("datasets/xorgate.csv", glades::DataInput::CSV);
+    glades::DataHandle h2 = glades::DataRegistry::acquire("datasets/xorgate.csv", glades::DataInput::CSV);
+    G_assert(__FILE__, __LINE__, "Registry handle empty", !h1.empty());
+    G_assert(__FILE__, __LINE__, "Registry did not share the dataset", h1.get() == h2.get());
+    G_assert(__FILE__, __LINE__, "Registry size mismatch", glades::DataRegistry::size() == startSize + 1);
+    G_assert(__FILE__, __LINE__, "Registry ref count mismatch", glades::DataRegistry::useCount(h1) == 2);
+    G_assert(__FILE__, __LINE__, "Shared dataset not imported", h1->getTrainSize() > 0);
+
+    // Different standardization, different dataset
+    glades::DataHandle h3 = glades::DataRegistry::acquire("datasets/xorgate.csv", glades::DataInput::CSV, glades::GMath::ZSCORE);
+    G_assert(__FILE__, __LINE__, "Registry shared across options", h3.get() != h1.get());
+    G_assert(__FILE__, __LINE__, "Registry size mismatch", glades::DataRegistry::size() == startSize + 2);
+
+    // Copies hold a reference
+    {
+	glades::DataHandle h4 = h1;
+	G_assert(__FILE__, __LINE__, "Handle copy did not add a ref", glades::DataRegistry::useCount(h1) == 3);
+    }
+    G_assert(__FILE__, __LINE__, "Handle copy did not release", glades::DataRegistry::useCount(h1) == 2);
+
+    // Last handle frees the dataset
+    h1.reset();
+    h2.reset();
+    h3.reset();
+    G_assert(__FILE__, __LINE__, "Registry did not free released datasets", glades::DataRegistry::size() == startSize);
+
+    // A failed import is not cached; every try imports again
+    unsigned int startImports = glades::DataRegistry::getImports();
+    glades::DataHandle missing = glades::DataRegistry::acquire("datasets/missing.csv", glades::DataInput::CSV);
+    G_assert(__FILE__, __LINE__, "Missing dataset gave a handle", missing.empty());
+    G_assert(__FILE__, __LINE__, "Missing dataset cached", glades::DataRegistry::size() == startSize);
+    missing = glades::DataRegistry::acquire("datasets/missing.csv", glades::DataInput::CSV);
+    G_assert(__FILE__, __LINE__, "Missing dataset not retried", missing.empty() && (glades::DataRegistry::getImports() == startImports + 2));
+
+    // Two threads racing for one key share a single import
+    char racePath[] = "/tmp/glades-registry-XXXXXX";
+    int raceFd = mkstemp(racePath);
+    G_assert(__FILE__, __LINE__, "Temp file failed", raceFd >= 0);
+    FILE* raceFile = fdopen(raceFd, "w");
+    fprintf(raceFile, "x,y,z\n");
+    for (unsigned int i = 0; i < 20000; ++i)
+	fprintf(raceFile, "%u,%u,%u\n", i % 7, i % 13, i % 2);
+    fclose(raceFile);
+
+    RegistryRace race;
+    pthread_mutex_init(&race.gateMutex, NULL);
+    pthread_cond_init(&race.gateCond, NULL);
+    race.open = false;
+    race.path = racePath;
+    race.nextHandle = 0;
+    startImports = glades::DataRegistry::getImports();
+    pthread_t racers[2];
+    for (unsigned int t = 0; t < 2; ++t)
+	pthread_create(&racers[t], NULL, raceAcquire, &race);
+    pthread_mutex_lock(&race.gateMutex);
+    race.open = true;
+    pthread_cond_broadcast(&race.gateCond);
+    pthread_mutex_unlock(&race.gateMutex);
+    for (unsigned int t = 0; t < 2; ++t)
+	pthread_join(racers[t], NULL);
+
+    G_assert(__FILE__, __LINE__, "Racing acquires imported twice", glades::DataRegistry::getImports() == startImports + 1);
+    G_assert(__FILE__, __LINE__, "Racing acquires got different datasets", (!race.handles[0].empty()) && (race.handles[0].get() == race.handles[1].get()));
+    G_assert(__FILE__, __LINE__, "Raced dataset rows", race.handles[0]->getTrainSize() == 20000);
+    G_assert(__FILE__, __LINE__, "Raced ref count", glades::DataRegistry::useCount(race.handles[0]) == 2);
+    race.handles[0].reset();
+    race.handles[1].reset();
+    G_assert(__FILE__, __LINE__, "Raced dataset not freed", glades::DataRegistry::size() == startSize);
+    pthread_cond_destroy(&race.gateCond);
+    pthread_mutex_destroy(&race.gateMutex);
+    unlink(racePath);
+
+    printf("DataRegistryUnitTest completed successfully.\n");
+}
@@ -0,0 +1,53 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "evalpolicy-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/State/EvalPolicy.h"
+
+void EvalPolicyUnitTest()
+{
+    // Defaults: every epoch, every row
+    glades::EvalPolicy policy;
+    G_assert(__FILE__, __LINE__, "Default not every epoch", policy.due(1, 0) && policy.due(2, 0) && policy.due(3, 0));
+    G_assert(__FILE__, __LINE__, "Default skipped a row", policy.sampled(0) && policy.sampled(12345));
+
+    // Every N epochs; the first epoch always reports
+    policy.setMetricEpochs(5);
+    G_assert(__FILE__, __LINE__, "First epoch not due", policy.due(1, 0));
+    G_assert(__FILE__, __LINE__, "Epoch 3 due", !policy.due(3, 0));
+    G_assert(__FILE__, __LINE__, "Epoch 10 not due", policy.due(10, 0));
+
+    // Every T milliseconds since the last metrics epoch
+    policy.setMetricEpochs(0);
+    policy.setMetricInterval(1000);
+    policy.mark(5000);
+    G_assert(__FILE__, __LINE__, "Due before the interval", !policy.due(7, 5999));
+    G_assert(__FILE__, __LINE__, "Not due after the interval", policy.due(7, 6000));
+    policy.reset();
+    G_assert(__FILE__, __LINE__, "Reset kept the last time", policy.due(7, 1000));
+
+    // Sampling keeps about the requested fraction, the same rows every time
+    policy.setSampleRate(0.25f, 7);
+    unsigned int kept = 0;
+    for (unsigned int r = 0; r < 10000; ++r)
+	if (policy.sampled(r))
+	    ++kept;
+    G_assert(__FILE__, __LINE__, "Sample rate off", (kept > 2300) && (kept < 2700));
+    bool stable = true;
+    for (unsigned int r = 0; r < 100; ++r)
+	stable = stable && (policy.sampled(r) == policy.sampled(r));
+    G_assert(__FILE__, __LINE__, "Sampling not deterministic", stable);
+
+    policy.setSampleRate(0.0f);
+    G_assert(__FILE__, __LINE__, "Zero sample rate accepted", policy.getSampleRate() == 0.25f);
+    policy.setSampleRate(3.0f);
+    G_assert(__FILE__, __LINE__, "Sample rate not clamped", policy.getSampleRate() == 1.0f);
+
+    printf("EvalPolicyUnitTest completed successfully.\n");
+}
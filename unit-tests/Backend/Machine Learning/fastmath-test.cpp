@@ -0,0 +1,74 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "fastmath-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/gmath.h"
+
+void FastMathUnitTest()
+{
+    // Sweep the error bounds documented in gmath.cpp; keep the two in step
+    double maxExpErr = 0.0;
+    for (float x = -87.0f; x < 88.0f; x += 0.01f)
+    {
+	double expected = exp((double)x);
+	double err = fabs(glades::GMath::fastExp(x) - expected) / expected;
+	if (err > maxExpErr)
+	    maxExpErr = err;
+    }
+    G_assert(__FILE__, __LINE__, "fastExp relative error too large", maxExpErr < 8.4e-8);
+
+    double maxTanhErr = 0.0;
+    double maxSigmoidErr = 0.0;
+    for (float x = -20.0f; x < 20.0f; x += 0.001f)
+    {
+	double tanhErr = fabs(glades::GMath::fastTanh(x) - tanh((double)x));
+	if (tanhErr > maxTanhErr)
+	    maxTanhErr = tanhErr;
+
+	double sigmoid = 1.0 / (1.0 + exp(-(double)x));
+	double sigmoidErr = fabs(glades::GMath::fastSigmoid(x) - sigmoid);
+	if (sigmoidErr > maxSigmoidErr)
+	    maxSigmoidErr = sigmoidErr;
+    }
+    G_assert(__FILE__, __LINE__, "fastTanh absolute error too large", maxTanhErr < 4.1e-7);
+    G_assert(__FILE__, __LINE__, "fastSigmoid absolute error too large", maxSigmoidErr < 2.3e-7);
+
+    // Saturation and symmetry
+    G_assert(__FILE__, __LINE__, "fastTanh(0) mismatch", glades::GMath::fastTanh(0.0f) == 0.0f);
+    G_assert(__FILE__, __LINE__, "fastTanh saturation mismatch", glades::GMath::fastTanh(100.0f) <= 1.0f);
+    G_assert(__FILE__, __LINE__, "fastTanh odd symmetry mismatch",
+	     glades::GMath::fastTanh(-1.5f) == -glades::GMath::fastTanh(1.5f));
+    G_assert(__FILE__, __LINE__, "fastExp(0) mismatch", glades::GMath::fastExp(0.0f) == 1.0f);
+
+    // squash honors the precision flag; exact stays the default
+    float exact = glades::GMath::squash(0.7f, glades::GMath::TANH);
+    float fast = glades::GMath::squash(0.7f, glades::GMath::TANH, 0.1f, glades::GMath::PRECISION_FAST);
+    G_assert(__FILE__, __LINE__, "Default squash is not exact", fabs(exact - tanh(0.7)) < 1.0e-7);
+    G_assert(__FILE__, __LINE__, "Fast squash mismatch", fast == glades::GMath::fastTanh(0.7f));
+    G_assert(__FILE__, __LINE__, "Fast squash out of bounds", fabs(fast - exact) < 5.0e-7);
+
+    // Softmax stays finite on large net inputs and sums to 1
+    std::vector<float> netInputs;
+    netInputs.push_back(1000.0f);
+    netInputs.push_back(999.0f);
+    netInputs.push_back(-1000.0f);
+    glades::GMath::softmax(netInputs);
+    float probSum = netInputs[0] + netInputs[1] + netInputs[2];
+    G_assert(__FILE__, __LINE__, "Softmax does not sum to 1", fabs(probSum - 1.0f) < 1.0e-6);
+    G_assert(__FILE__, __LINE__, "Softmax ratio mismatch", fabs((netInputs[0] / netInputs[1]) - exp(1.0)) < 1.0e-4);
+    G_assert(__FILE__, __LINE__, "Softmax underflow mismatch", netInputs[2] == 0.0f);
+
+    // Fused softmax cross entropy gradient is p - y for a one hot target
+    float errDer = glades::GMath::costErrDer(1.0f, 0.25f, glades::GMath::SOFTMAX);
+    G_assert(__FILE__, __LINE__, "Softmax gradient mismatch", errDer == -0.75f);
+    float cost = glades::GMath::outputNodeCost(1.0f, 0.0f, 1.0f, glades::GMath::SOFTMAX);
+    G_assert(__FILE__, __LINE__, "Softmax cost is not finite", cost == cost && cost < FLT_MAX);
+
+    printf("FastMathUnitTest completed successfully.\n");
+}
@@ -0,0 +1,48 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "featurehasher-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/featurehasher.h"
+
+void FeatureHasherUnitTest()
+{
+    // Fixed memory regardless of cardinality
+    glades::FeatureHasher hasher(64, true);
+    G_assert(__FILE__, __LINE__, "Hasher bucket count mismatch", hasher.size() == 64);
+
+    // Same string, same bucket and sign every time
+    unsigned int catIndex = hasher.indexAt("cat");
+    float catSign = hasher.signAt("cat");
+    G_assert(__FILE__, __LINE__, "Hasher bucket not stable", catIndex == hasher.indexAt(std::string("cat")));
+    G_assert(__FILE__, __LINE__, "Hasher bucket out of range", catIndex < hasher.size());
+    G_assert(__FILE__, __LINE__, "Hasher sign not +/-1", (catSign == 1.0f) || (catSign == -1.0f));
+
+    // Encoding has exactly one non-zero entry
+    std::vector<float> catEncoding = hasher["cat"];
+    G_assert(__FILE__, __LINE__, "Hashed encoding size mismatch", catEncoding.size() == 64);
+    unsigned int nonZero = 0;
+    for (unsigned int i = 0; i < catEncoding.size(); ++i)
+	if (catEncoding[i] != 0.0f)
+	    ++nonZero;
+    G_assert(__FILE__, __LINE__, "Hashed encoding should be one-hot", nonZero == 1);
+    G_assert(__FILE__, __LINE__, "Hashed encoding value mismatch", catEncoding[catIndex] == catSign);
+
+    // Unsigned hashing is always positive
+    glades::FeatureHasher unsignedHasher(64, false);
+    G_assert(__FILE__, __LINE__, "Unsigned hasher produced a negative sign", unsignedHasher.signAt("dog") == 1.0f);
+
+    // Accumulate a small bag of words
+    std::vector<float> bag;
+    hasher.accumulate("the", bag);
+    hasher.accumulate("the", bag);
+    G_assert(__FILE__, __LINE__, "Accumulated row size mismatch", bag.size() == 64);
+    G_assert(__FILE__, __LINE__, "Accumulated count mismatch", bag[hasher.indexAt("the")] == 2.0f * hasher.signAt("the"));
+
+    printf("FeatureHasherUnitTest completed successfully.\n");
+}
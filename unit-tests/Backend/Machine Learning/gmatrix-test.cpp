@@ -0,0 +1,114 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "gmatrix-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/gmatrix.h"
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+static bool nearlyEqual(float a, float b)
+{
+    return fabs(a - b) <= 1.0e-4f * (1.0f + fabs(b));
+}
+
+static void fillMatrix(glades::GMatrix& m, unsigned int seed)
+{
+    for (unsigned int r = 0; r < m.numberOfRows(); ++r)
+	for (unsigned int c = 0; c < m.numberOfCols(); ++c)
+	    m(r, c) = (float)(((r * 31 + c * 7 + seed) % 29)) / 14.0f - 1.0f;
+}
+
+static bool matchesNaive(const glades::GMatrix& A, const glades::GMatrix& B,
+			 const glades::GMatrix& C, float base)
+{
+    for (unsigned int i = 0; i < A.numberOfRows(); ++i)
+    {
+	for (unsigned int j = 0; j < B.numberOfCols(); ++j)
+	{
+	    float expected = base;
+	    for (unsigned int k = 0; k < A.numberOfCols(); ++k)
+		expected += A(i, k) * B(k, j);
+	    if (!nearlyEqual(C(i, j), expected))
+		return false;
+	}
+    }
+
+    return true;
+}
+
+void GMatrixUnitTest()
+{
+    // Layout
+    glades::GMatrix A(13, 300);
+    G_assert(__FILE__, __LINE__, "Wrong shape", (A.numberOfRows() == 13) && (A.numberOfCols() == 300));
+    G_assert(__FILE__, __LINE__, "Stride not padded", (A.stride() % glades::GMatrix::ROW_PAD) == 0);
+    G_assert(__FILE__, __LINE__, "Rows not aligned", ((uintptr_t)A.row(5) % glades::GMatrix::ALIGNMENT) == 0);
+    G_assert(__FILE__, __LINE__, "Default matrix not empty", glades::GMatrix().empty());
+
+    // Odd sizes cross the K block and leave row and column tails
+    glades::GMatrix B(300, 37);
+    fillMatrix(A, 1);
+    fillMatrix(B, 2);
+    glades::GMatrix C;
+    glades::GMatrix::multiply(A, B, C);
+    G_assert(__FILE__, __LINE__, "Product shape", (C.numberOfRows() == 13) && (C.numberOfCols() == 37));
+    G_assert(__FILE__, __LINE__, "Product mismatch", matchesNaive(A, B, C, 0.0f));
+
+    glades::GMatrix D(13, 37, 0.5f);
+    glades::GMatrix::multiply(A, B, D, true);
+    G_assert(__FILE__, __LINE__, "Accumulate mismatch", matchesNaive(A, B, D, 0.5f));
+
+    // Transpose and the vector products
+    glades::GMatrix At = A.transpose();
+    G_assert(__FILE__, __LINE__, "Transpose shape", (At.numberOfRows() == 300) && (At.numberOfCols() == 13));
+    G_assert(__FILE__, __LINE__, "Transpose value", At(299, 12) == A(12, 299));
+
+    std::vector<float> x(300);
+    std::vector<float> xM(13);
+    for (unsigned int i = 0; i < x.size(); ++i)
+	x[i] = (float)(i % 11) / 5.0f - 1.0f;
+    for (unsigned int i = 0; i < xM.size(); ++i)
+	xM[i] = (float)i / 6.0f - 1.0f;
+
+    std::vector<float> y(13);
+    std::vector<float> yT(300, 9.0f);
+    glades::GMatrix::multiplyVector(A, &x[0], &y[0]);
+    glades::GMatrix::multiplyTransposeVector(A, &xM[0], &yT[0]);
+    bool vectorMatch = true;
+    for (unsigned int i = 0; i < 13; ++i)
+	vectorMatch = vectorMatch && nearlyEqual(y[i], glades::GMatrix::dot(A.row(i), &x[0], 300));
+    for (unsigned int j = 0; j < 300; ++j)
+	vectorMatch = vectorMatch && nearlyEqual(yT[j], glades::GMatrix::dot(At.row(j), &xM[0], 13));
+    G_assert(__FILE__, __LINE__, "Vector product mismatch", vectorMatch);
+
+    // Threaded rows give the same bits as one thread
+    glades::GMatrix big(130, 200);
+    glades::GMatrix bigB(200, 90);
+    fillMatrix(big, 3);
+    fillMatrix(bigB, 4);
+    glades::GMatrix single;
+    glades::GMatrix threaded;
+    glades::GMatrix::multiply(big, bigB, single);
+    glades::GMatrix::setThreads(4);
+    glades::GMatrix::multiply(big, bigB, threaded);
+    glades::GMatrix::setThreads(1);
+    bool threadMatch = true;
+    for (unsigned int i = 0; i < single.numberOfRows(); ++i)
+	for (unsigned int j = 0; j < single.numberOfCols(); ++j)
+	    threadMatch = threadMatch && (single(i, j) == threaded(i, j));
+    G_assert(__FILE__, __LINE__, "Threaded product differs", threadMatch);
+
+    // Copies are deep
+    glades::GMatrix copy = C;
+    copy(0, 0) += 1.0f;
+    G_assert(__FILE__, __LINE__, "Copy shares storage", copy(0, 0) != C(0, 0));
+
+    printf("GMatrixUnitTest completed successfully.\n");
+}
@@ -0,0 +1,79 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "grandom-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/grandom.h"
+#include <math.h>
+#include <pthread.h>
+#include <vector>
+
+static void* drawLocal(void* y)
+{
+    *((uint64_t*)y) = glades::GRandom::local().next();
+    return NULL;
+}
+
+void GRandomUnitTest()
+{
+    // Same seed, same stream
+    glades::GRandom a(1234);
+    glades::GRandom b(1234);
+    glades::GRandom c(1235);
+    bool sameStream = true;
+    for (unsigned int i = 0; i < 100; ++i)
+	sameStream = sameStream && (a.next() == b.next());
+    G_assert(__FILE__, __LINE__, "Seeded streams differ", sameStream);
+    G_assert(__FILE__, __LINE__, "Seed ignored", a.next() != c.next());
+
+    // Bulk dropout flags hit the requested rate and report what survived
+    const unsigned int n = 100001;
+    std::vector<bool> flags;
+    unsigned int kept = a.fillBernoulli(flags, n, 0.3f);
+    unsigned int counted = 0;
+    for (unsigned int i = 0; i < n; ++i)
+	counted += !flags[i];
+    G_assert(__FILE__, __LINE__, "Bernoulli size", flags.size() == n);
+    G_assert(__FILE__, __LINE__, "Bernoulli kept count", kept == counted);
+    G_assert(__FILE__, __LINE__, "Bernoulli rate", fabs(((float)kept) / n - 0.7f) < 0.01f);
+    G_assert(__FILE__, __LINE__, "Bernoulli p=0", a.fillBernoulli(flags, n, 0.0f) == n);
+    G_assert(__FILE__, __LINE__, "Bernoulli p=1", a.fillBernoulli(flags, n, 1.0f) == 0);
+
+    std::vector<float> u(1001);
+    a.fillUniform(&u[0], u.size());
+    bool inRange = true;
+    for (unsigned int i = 0; i < u.size(); ++i)
+	inRange = inRange && (u[i] >= 0.0f) && (u[i] < 1.0f);
+    G_assert(__FILE__, __LINE__, "Uniform out of range", inRange);
+
+    // Normal samples are centred, unit variance and take both signs
+    double sum = 0.0;
+    double sumSq = 0.0;
+    unsigned int negatives = 0;
+    for (unsigned int i = 0; i < n; ++i)
+    {
+	float z = a.nextNormal();
+	sum += z;
+	sumSq += z * z;
+	negatives += (z < 0.0f);
+    }
+    double mean = sum / n;
+    double variance = sumSq / n - mean * mean;
+    G_assert(__FILE__, __LINE__, "Normal mean", fabs(mean) < 0.02);
+    G_assert(__FILE__, __LINE__, "Normal variance", fabs(variance - 1.0) < 0.03);
+    G_assert(__FILE__, __LINE__, "Normal sign", fabs(((float)negatives) / n - 0.5f) < 0.01f);
+
+    // Every thread gets its own stream
+    uint64_t otherThread = 0;
+    pthread_t worker;
+    pthread_create(&worker, NULL, drawLocal, &otherThread);
+    pthread_join(worker, NULL);
+    G_assert(__FILE__, __LINE__, "Threads share a stream", otherThread != glades::GRandom::local().next());
+
+    printf("GRandomUnitTest completed successfully.\n");
+}
@@ -0,0 +1,157 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "halfmatrix-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/gmath.h"
+#include "../../../Backend/Machine Learning/GMath/gmatrix.h"
+#include "../../../Backend/Machine Learning/GMath/halfmatrix.h"
+#include "../../../Backend/Machine Learning/GMath/kernels.h"
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+static bool withinRelative(float a, float b, float tolerance)
+{
+    return fabs(a - b) <= tolerance * (1.0f + fabs(b));
+}
+
+void HalfMatrixUnitTest()
+{
+    // bfloat16 rounding: ties go to even, NaN stays NaN
+    G_assert(__FILE__, __LINE__, "bf16(1) wrong", glades::GMath::floatToBF16(1.0f) == 0x3F80);
+    G_assert(__FILE__, __LINE__, "bf16(-2) wrong", glades::GMath::floatToBF16(-2.0f) == 0xC000);
+    G_assert(__FILE__, __LINE__, "bf16 tie not even", glades::GMath::floatToBF16(1.00390625f) == 0x3F80);
+    G_assert(__FILE__, __LINE__, "bf16 tie not even", glades::GMath::floatToBF16(1.01171875f) == 0x3F82);
+    G_assert(__FILE__, __LINE__, "bf16 round trip", glades::GMath::bf16ToFloat(0x3FC0) == 1.5f);
+    G_assert(__FILE__, __LINE__, "bf16 lost infinity", glades::GMath::bf16ToFloat(glades::GMath::floatToBF16(HUGE_VALF)) == HUGE_VALF);
+    float nan = glades::GMath::bf16ToFloat(glades::GMath::floatToBF16(sqrtf(-1.0f)));
+    G_assert(__FILE__, __LINE__, "bf16 lost NaN", nan != nan);
+
+    // Every ISA converts bit for bit like the scalar path (odd length exercises the tails)
+    const unsigned int N = 45;
+    std::vector<float> x(N);
+    std::vector<float> y(N);
+    for (unsigned int i = 0; i < N; ++i)
+    {
+	x[i] = ((float)((i * 37) % 41) - 20.0f) * 0.173f;
+	y[i] = (float)((i * 5) % 11) / 5.0f - 1.0f;
+    }
+    x[3] = 70000.0f;   // overflows binary16
+    x[7] = 1.0e-6f;    // binary16 subnormal
+    x[11] = -0.0f;
+    x[13] = 3.0e38f;   // rounds to bf16 infinity
+
+    const glades::Kernels::Table* ref = glades::Kernels::getTable(glades::Kernels::ISA_SCALAR);
+    std::vector<uint16_t> refFP16(N);
+    std::vector<uint16_t> refBF16(N);
+    ref->packFP16(&x[0], &refFP16[0], N);
+    ref->packBF16(&x[0], &refBF16[0], N);
+    for (unsigned int i = 0; i < N; ++i)
+	G_assert(__FILE__, __LINE__, "Scalar bf16 pack wrong", refBF16[i] == glades::GMath::floatToBF16(x[i]));
+
+    // Dots run on finite weights
+    std::vector<uint16_t> wFP16(N);
+    std::vector<uint16_t> wBF16(N);
+    ref->packFP16(&y[0], &wFP16[0], N);
+    ref->packBF16(&y[0], &wBF16[0], N);
+    float refDotFP16 = ref->dotFP16(&wFP16[0], &y[0], N);
+    float refDotBF16 = ref->dotBF16(&wBF16[0], &y[0], N);
+    for (int isa = glades::Kernels::ISA_SSE2; isa <= glades::Kernels::ISA_AVX512; ++isa)
+    {
+	const glades::Kernels::Table* table = glades::Kernels::getTable(isa);
+	if (!table)
+	    continue;
+
+	printf("[MATH] Checking %s half conversions\n", table->name);
+	std::vector<uint16_t> h(N);
+	std::vector<float> back(N);
+	std::vector<float> refBack(N);
+	bool match = true;
+
+	table->packFP16(&x[0], &h[0], N);
+	for (unsigned int i = 0; i < N; ++i)
+	    match = match && (h[i] == refFP16[i]);
+	table->unpackFP16(&h[0], &back[0], N);
+	ref->unpackFP16(&h[0], &refBack[0], N);
+	for (unsigned int i = 0; i < N; ++i)
+	    match = match && (back[i] == refBack[i]);
+
+	table->packBF16(&x[0], &h[0], N);
+	for (unsigned int i = 0; i < N; ++i)
+	    match = match && (h[i] == refBF16[i]);
+	table->unpackBF16(&h[0], &back[0], N);
+	ref->unpackBF16(&h[0], &refBack[0], N);
+	for (unsigned int i = 0; i < N; ++i)
+	    match = match && (back[i] == refBack[i]);
+
+	match = match && withinRelative(table->dotFP16(&wFP16[0], &y[0], N), refDotFP16, 1.0e-4f);
+	match = match && withinRelative(table->dotBF16(&wBF16[0], &y[0], N), refDotBF16, 1.0e-4f);
+	G_assert(__FILE__, __LINE__, "SIMD half conversions disagree with scalar", match);
+    }
+
+    // Layout
+    glades::HalfMatrix H(5, 45, glades::GMath::STORAGE_FP16);
+    G_assert(__FILE__, __LINE__, "Wrong shape", (H.numberOfRows() == 5) && (H.numberOfCols() == 45));
+    G_assert(__FILE__, __LINE__, "Wrong format", H.getFormat() == glades::GMath::STORAGE_FP16);
+    G_assert(__FILE__, __LINE__, "Stride not padded", (H.stride() % glades::HalfMatrix::ROW_PAD) == 0);
+    G_assert(__FILE__, __LINE__, "Rows not aligned", ((uintptr_t)H.row(3) % glades::HalfMatrix::ALIGNMENT) == 0);
+    H.set(2, 9, 0.5f);
+    G_assert(__FILE__, __LINE__, "Set/get lost a value", H.get(2, 9) == 0.5f);
+    G_assert(__FILE__, __LINE__, "Default half matrix not empty", glades::HalfMatrix().empty());
+
+    // Round trip and products stay within each format's rounding error
+    glades::GMatrix W(7, 45);
+    for (unsigned int r = 0; r < W.numberOfRows(); ++r)
+	for (unsigned int c = 0; c < W.numberOfCols(); ++c)
+	    W(r, c) = (float)((r * 13 + c * 7) % 31) / 15.0f - 1.0f;
+
+    std::vector<float> expected(W.numberOfRows());
+    glades::GMatrix::multiplyVector(W, &y[0], &expected[0]);
+
+    const int formats[2] = {glades::GMath::STORAGE_BF16, glades::GMath::STORAGE_FP16};
+    const float tolerance[2] = {1.0f / 256.0f, 1.0f / 2048.0f};
+    for (unsigned int f = 0; f < 2; ++f)
+    {
+	glades::HalfMatrix packed;
+	packed.pack(W, formats[f]);
+	glades::GMatrix unpacked;
+	packed.unpack(unpacked);
+	bool close = (unpacked.numberOfRows() == W.numberOfRows()) &&
+		     (unpacked.numberOfCols() == W.numberOfCols());
+	for (unsigned int r = 0; close && (r < W.numberOfRows()); ++r)
+	    for (unsigned int c = 0; c < W.numberOfCols(); ++c)
+		close = close && withinRelative(unpacked(r, c), W(r, c), tolerance[f]);
+	G_assert(__FILE__, __LINE__, "Half round trip too lossy", close);
+
+	std::vector<float> product(W.numberOfRows());
+	packed.multiplyVector(&y[0], &product[0]);
+	for (unsigned int r = 0; r < W.numberOfRows(); ++r)
+	    close = close && withinRelative(product[r], expected[r], 45.0f * tolerance[f]);
+	G_assert(__FILE__, __LINE__, "Half product too far from fp32", close);
+
+	// The indexed dot over every other column matches the full dot with the rest zeroed
+	std::vector<unsigned int> cols;
+	std::vector<float> xCompact;
+	std::vector<float> xMasked(W.numberOfCols(), 0.0f);
+	for (unsigned int c = 0; c < W.numberOfCols(); c += 2)
+	{
+	    cols.push_back(c);
+	    xCompact.push_back(y[c]);
+	    xMasked[c] = y[c];
+	}
+	for (unsigned int r = 0; r < W.numberOfRows(); ++r)
+	{
+	    float indexed = packed.dotRowIndexed(r, &cols[0], cols.size(), &xCompact[0]);
+	    close = close && withinRelative(indexed, packed.dotRow(r, &xMasked[0]), 1.0e-5f);
+	}
+	G_assert(__FILE__, __LINE__, "Indexed dot disagrees with the masked dot", close);
+    }
+
+    printf("HalfMatrixUnitTest completed successfully.\n");
+}
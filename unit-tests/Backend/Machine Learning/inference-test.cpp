@@ -0,0 +1,200 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "inference-test.h"
+#include "../../unit-test.h"
+#include "Backend/Database/GList.h"
+#include "../../../Backend/Machine Learning/DataObjects/StreamInput.h"
+#include "../../../Backend/Machine Learning/GMath/activations.h"
+#include "../../../Backend/Machine Learning/GMath/gmath.h"
+#include "../../../Backend/Machine Learning/Networks/inference.h"
+#include "../../../Backend/Machine Learning/Networks/network.h"
+#include "../../../Backend/Machine Learning/State/LayerBuilder.h"
+#include "../../../Backend/Machine Learning/Structure/hiddenlayerinfo.h"
+#include "../../../Backend/Machine Learning/Structure/inputlayerinfo.h"
+#include "../../../Backend/Machine Learning/Structure/nninfo.h"
+#include "../../../Backend/Machine Learning/Structure/outputlayerinfo.h"
+#include <math.h>
+#include <vector>
+
+// A 3-4-3-1 regression net that cannot learn: no learning rate, momentum or dropout, so its
+// weights stay the ones the seed gave them
+static glades::NNInfo* buildFixedInfo()
+{
+    std::vector<glades::HiddenLayerInfo*> hidden;
+    hidden.push_back(new glades::HiddenLayerInfo(4, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, glades::GMath::TANH, 0.0f));
+    hidden.push_back(new glades::HiddenLayerInfo(3, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, glades::GMath::LINEAR, 1.0f));
+    glades::InputLayerInfo* input = new glades::InputLayerInfo(glades::NNInfo::BATCH_STOCHASTIC, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, glades::GMath::SIGMOID, 0.0f);
+    glades::OutputLayerInfo* output = new glades::OutputLayerInfo(1, glades::GMath::REGRESSION);
+    return new glades::NNInfo("inferencenet", input, hidden, output);
+}
+
+// A 3-8-8-1 linear net with dropout and no learning. SGDHelper draws the input layer's mask
+// and the first hidden layer's with the input rate, the second hidden layer's with the first
+// hidden layer's rate.
+static glades::NNInfo* buildDropoutInfo(float pInput, float pHidden)
+{
+    std::vector<glades::HiddenLayerInfo*> hidden;
+    hidden.push_back(new glades::HiddenLayerInfo(8, 0.0f, 0.0f, 0.0f, 0.0f, pHidden, glades::GMath::LINEAR, 1.0f));
+    hidden.push_back(new glades::HiddenLayerInfo(8, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, glades::GMath::LINEAR, 1.0f));
+    glades::InputLayerInfo* input = new glades::InputLayerInfo(glades::NNInfo::BATCH_STOCHASTIC, 0.0f, 0.0f, 0.0f, 0.0f, pInput, glades::GMath::LINEAR, 1.0f);
+    glades::OutputLayerInfo* output = new glades::OutputLayerInfo(1, glades::GMath::REGRESSION);
+    return new glades::NNInfo("dropoutnet", input, hidden, output);
+}
+
+// The first batch row an InferenceModel of info's net built from seed predicts for line
+static float captureOutput(glades::NNInfo* info, uint64_t seed, const char* line)
+{
+    glades::StreamInput batch(1, 1);
+    batch.pushLine(line);
+    shmea::GList inputRow;
+    shmea::GList expectedRow;
+    while (batch.pop(inputRow, expectedRow, 1))
+    {
+	batch.stage(inputRow, expectedRow);
+	batch.admit();
+    }
+
+    glades::LayerBuilder meat;
+    meat.setSeed(seed);
+    G_assert(__FILE__, __LINE__, "Layer build failed", meat.build(info, &batch, false));
+
+    std::vector<glades::ActivationPlan> plan;
+    int layerCount = info->numHiddenLayers() + 1;
+    for (int l = 0; l < layerCount; ++l)
+    {
+	int costFx = (l == layerCount - 1) ? info->getOutputType() : glades::GMath::REGRESSION;
+	plan.push_back(glades::ActivationPlan(info->getActivationType(l), info->getActivationParam(l), costFx, info->getPrecision()));
+    }
+
+    glades::InferenceModel model;
+    G_assert(__FILE__, __LINE__, "Capture failed", model.capture(meat, info, plan, 0));
+    G_assert(__FILE__, __LINE__, "Wrong batch row count", model.predict(&batch, 0) > 0);
+    return model.getOutput()(0, 0);
+}
+
+// Training keeps the survivors' raw activations, so the captured model has to predict the mean
+// of the dropout passes rather than the pass with every node kept
+static void DropoutTest()
+{
+    const uint64_t seed = 77;
+    const unsigned int passCount = 400;
+    const char* line = "0.6,-0.4,0.9,1";
+
+    // Every pass draws new masks
+    glades::NNInfo* info = buildDropoutInfo(0.2f, 0.3f);
+    glades::NNetwork cNetwork(info);
+    cNetwork.setSeed(seed);
+    std::vector<float> passOutputs;
+    for (unsigned int k = 0; k < passCount; ++k)
+    {
+	glades::StreamInput rowStream(1, 1);
+	rowStream.pushLine(line);
+	rowStream.close();
+	cNetwork.trainStream(&rowStream, 0);
+
+	shmea::GList results = cNetwork.getResults();
+	G_assert(__FILE__, __LINE__, "ForwardPass left no result", results.size() == 2);
+	passOutputs.push_back(results.getFloat(1));
+    }
+
+    double mean = 0.0;
+    for (unsigned int k = 0; k < passCount; ++k)
+	mean += passOutputs[k];
+    mean /= passCount;
+
+    double variance = 0.0;
+    for (unsigned int k = 0; k < passCount; ++k)
+	variance += (passOutputs[k] - mean) * (passOutputs[k] - mean);
+    double meanError = sqrt(variance / (passCount - 1) / passCount);
+
+    // Within four standard errors of the mean pass
+    float captured = captureOutput(info, seed, line);
+    G_assert(__FILE__, __LINE__, "Captured model is not the mean dropout pass", fabs(captured - mean) <= 4.0 * meanError);
+
+    // The same weights unscaled are far off it
+    glades::NNInfo* keepAllInfo = buildDropoutInfo(0.0f, 0.0f);
+    float unscaled = captureOutput(keepAllInfo, seed, line);
+    G_assert(__FILE__, __LINE__, "Dropout case cannot tell the scaling apart", fabs(unscaled - mean) > 8.0 * meanError);
+
+    delete keepAllInfo;
+    delete info;
+}
+
+void InferenceUnitTest()
+{
+    const uint64_t seed = 1234;
+    const unsigned int rowCount = 6;
+    const char* lines[rowCount] = {"0.1,0.9,-0.4,1", "0.5,-0.2,0.3,0", "-0.7,0.6,0.8,1",
+				   "0.0,0.0,0.0,0", "0.9,0.9,-0.9,1", "-0.3,-0.8,0.2,0"};
+
+    // Per row: ForwardPass through a one row stream; the last step's (expected, predicted)
+    // pair is left in getResults()
+    glades::NNInfo* info = buildFixedInfo();
+    glades::NNetwork cNetwork(info);
+    cNetwork.setSeed(seed);
+    std::vector<float> forwardOutputs;
+    for (unsigned int k = 0; k < rowCount; ++k)
+    {
+	glades::StreamInput rowStream(1, 1);
+	rowStream.pushLine(lines[k]);
+	rowStream.close();
+	cNetwork.trainStream(&rowStream, 0);
+
+	shmea::GList results = cNetwork.getResults();
+	G_assert(__FILE__, __LINE__, "ForwardPass left no result", results.size() == 2);
+	forwardOutputs.push_back(results.getFloat(1));
+    }
+
+    // Batched: the same rows through an InferenceModel of a network built from the same seed.
+    // Train row 0 is the last staged line and the replay slots hold the lines in order.
+    glades::StreamInput batch(rowCount, 1);
+    for (unsigned int k = 0; k < rowCount; ++k)
+	batch.pushLine(lines[k]);
+    shmea::GList inputRow;
+    shmea::GList expectedRow;
+    while (batch.pop(inputRow, expectedRow, 1))
+    {
+	batch.stage(inputRow, expectedRow);
+	batch.admit();
+    }
+    G_assert(__FILE__, __LINE__, "Batch stream size mismatch", batch.getTrainSize() == rowCount + 1);
+
+    glades::LayerBuilder meat;
+    meat.setSeed(seed);
+    G_assert(__FILE__, __LINE__, "Layer build failed", meat.build(info, &batch, false));
+
+    std::vector<glades::ActivationPlan> plan;
+    int layerCount = info->numHiddenLayers() + 1;
+    for (int l = 0; l < layerCount; ++l)
+    {
+	int costFx = (l == layerCount - 1) ? info->getOutputType() : glades::GMath::REGRESSION;
+	plan.push_back(glades::ActivationPlan(info->getActivationType(l), info->getActivationParam(l), costFx, info->getPrecision()));
+    }
+
+    glades::InferenceModel model;
+    G_assert(__FILE__, __LINE__, "Capture failed", model.capture(meat, info, plan, 0));
+    G_assert(__FILE__, __LINE__, "Wrong model shape", (model.getInputSize() == 3) && (model.getOutputSize() == 1));
+    unsigned int batchRows = model.predict(&batch, 0);
+    G_assert(__FILE__, __LINE__, "Wrong batch row count", batchRows == rowCount + 1);
+
+    const glades::GMatrix& P = model.getOutput();
+    bool match = true;
+    for (unsigned int b = 0; b < batchRows; ++b)
+    {
+	float forward = forwardOutputs[(b + rowCount - 1) % rowCount];
+	float batched = P(b, 0);
+	match = match && (fabs(batched - forward) <= 1.0e-5f * (1.0f + fabs(forward)));
+    }
+    G_assert(__FILE__, __LINE__, "InferenceModel disagrees with ForwardPass", match);
+
+    delete info;
+
+    DropoutTest();
+    printf("InferenceUnitTest completed successfully.\n");
+}
@@ -0,0 +1,105 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "kernels-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/gmath.h"
+#include "../../../Backend/Machine Learning/GMath/kernels.h"
+
+static bool nearlyEqual(float a, float b)
+{
+    return fabs(a - b) <= 1.0e-4f * (1.0f + fabs(b));
+}
+
+void KernelsUnitTest()
+{
+    printf("[MATH] Active kernels: %s\n", glades::Kernels::getISAName());
+    G_assert(__FILE__, __LINE__, "Scalar kernels missing", glades::Kernels::getTable(glades::Kernels::ISA_SCALAR) != NULL);
+    G_assert(__FILE__, __LINE__, "Active ISA beyond the CPU", glades::Kernels::getISA() <= glades::Kernels::detectISA());
+
+    // Odd sizes exercise the vector bodies and the tails
+    const unsigned int M = 7;
+    const unsigned int K = 37;
+    const unsigned int N = 19;
+    std::vector<float> A(M * K);
+    std::vector<float> B(K * N);
+    std::vector<float> x(K);
+    std::vector<float> xM(M);
+    for (unsigned int i = 0; i < A.size(); ++i)
+	A[i] = (float)((i * 7) % 23) / 11.0f - 1.0f;
+    for (unsigned int i = 0; i < B.size(); ++i)
+	B[i] = (float)((i * 5) % 17) / 8.0f - 1.0f;
+    for (unsigned int i = 0; i < x.size(); ++i)
+	x[i] = (float)((i * 3) % 13) / 6.0f - 1.0f;
+    for (unsigned int i = 0; i < xM.size(); ++i)
+	xM[i] = (float)i / 3.0f - 1.0f;
+
+    const glades::Kernels::Table* ref = glades::Kernels::getTable(glades::Kernels::ISA_SCALAR);
+    for (int isa = glades::Kernels::ISA_SSE2; isa <= glades::Kernels::ISA_AVX512; ++isa)
+    {
+	const glades::Kernels::Table* table = glades::Kernels::getTable(isa);
+	if (!table)
+	    continue;
+
+	printf("[MATH] Checking %s kernels\n", table->name);
+	bool match = true;
+
+	match = match && nearlyEqual(table->dot(&A[0], &x[0], K), ref->dot(&A[0], &x[0], K));
+	match = match && nearlyEqual(table->sum(&B[0], B.size()), ref->sum(&B[0], B.size()));
+	match = match && (table->dot(&x[0], &x[0], 0) == 0.0f);
+
+	std::vector<float> y1(K, 0.5f);
+	std::vector<float> y2(K, 0.5f);
+	table->axpy(0.25f, &x[0], &y1[0], K);
+	ref->axpy(0.25f, &x[0], &y2[0], K);
+	for (unsigned int i = 0; i < K; ++i)
+	    match = match && nearlyEqual(y1[i], y2[i]);
+
+	std::vector<float> gv1(M);
+	std::vector<float> gv2(M);
+	table->gemv(&A[0], &x[0], &gv1[0], M, K, K);
+	ref->gemv(&A[0], &x[0], &gv2[0], M, K, K);
+	for (unsigned int i = 0; i < M; ++i)
+	    match = match && nearlyEqual(gv1[i], gv2[i]);
+
+	std::vector<float> gt1(K, 0.0f);
+	std::vector<float> gt2(K, 0.0f);
+	table->gemvT(&A[0], &xM[0], &gt1[0], M, K, K);
+	ref->gemvT(&A[0], &xM[0], &gt2[0], M, K, K);
+	for (unsigned int i = 0; i < K; ++i)
+	    match = match && nearlyEqual(gt1[i], gt2[i]);
+
+	std::vector<float> C1(M * N, 1.0f);
+	std::vector<float> C2(M * N, 1.0f);
+	table->gemm(&A[0], &B[0], &C1[0], M, N, K, K, N, N);
+	ref->gemm(&A[0], &B[0], &C2[0], M, N, K, K, N, N);
+	for (unsigned int i = 0; i < M * N; ++i)
+	    match = match && nearlyEqual(C1[i], C2[i]);
+
+	G_assert(__FILE__, __LINE__, "SIMD kernel disagrees with scalar", match);
+
+	// The vector fast tanh is bit identical to GMath::fastTanh
+	std::vector<float> t(K);
+	for (unsigned int i = 0; i < K; ++i)
+	    t[i] = (x[i] * 9.0f);
+	table->fastTanh(&t[0], K);
+	bool tanhMatch = true;
+	for (unsigned int i = 0; i < K; ++i)
+	    tanhMatch = tanhMatch && (t[i] == glades::GMath::fastTanh(x[i] * 9.0f));
+	G_assert(__FILE__, __LINE__, "SIMD fastTanh mismatch", tanhMatch);
+    }
+
+    // Forcing a path and restoring the detected one
+    int detected = glades::Kernels::getISA();
+    G_assert(__FILE__, __LINE__, "Scalar override failed", glades::Kernels::setISA(glades::Kernels::ISA_SCALAR));
+    G_assert(__FILE__, __LINE__, "Scalar override not active", glades::Kernels::getISA() == glades::Kernels::ISA_SCALAR);
+    G_assert(__FILE__, __LINE__, "Bad ISA accepted", !glades::Kernels::setISA(42));
+    glades::Kernels::setISA(detected);
+
+    printf("KernelsUnitTest completed successfully.\n");
+}
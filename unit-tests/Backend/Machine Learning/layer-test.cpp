@@ -0,0 +1,77 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "layer-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/gmath.h"
+#include "../../../Backend/Machine Learning/GMath/grandom.h"
+#include "../../../Backend/Machine Learning/State/layer.h"
+#include "../../../Backend/Machine Learning/State/node.h"
+#include <vector>
+
+static void deleteNodes(glades::Layer& layer)
+{
+    for (unsigned int i = 0; i < layer.size(); ++i)
+	delete layer[i];
+}
+
+void LayerUnitTest()
+{
+    glades::GRandom rng(99);
+    glades::Layer hidden(glades::Layer::HIDDEN_TYPE);
+    hidden.initWeights(3, 200, glades::Node::INIT_XAVIER, glades::GMath::TANH, rng);
+    G_assert(__FILE__, __LINE__, "Layer size", hidden.size() == 200);
+
+    // Before any draw every node is active
+    G_assert(__FILE__, __LINE__, "Undropped layer not dense", hidden.getActiveNodes().size() == 200);
+
+    // The active list is exactly the surviving nodes, in order
+    hidden.generateDropout(0.5f, rng);
+    const std::vector<unsigned int>& active = hidden.getActiveNodes();
+    bool listMatches = true;
+    unsigned int survivors = 0;
+    for (unsigned int i = 0; i < hidden.size(); ++i)
+    {
+	if (!hidden.possiblePath(i))
+	    continue;
+
+	listMatches = listMatches && (survivors < active.size()) && (active[survivors] == i);
+	++survivors;
+    }
+    G_assert(__FILE__, __LINE__, "Active list differs from the flags", listMatches && (survivors == active.size()));
+    G_assert(__FILE__, __LINE__, "Dropout rate", (survivors > 60) && (survivors < 140));
+
+    // A layer is never fully dropped, and an empty one does not hang
+    glades::Layer single(glades::Layer::HIDDEN_TYPE);
+    single.initWeights(3, 1, glades::Node::INIT_XAVIER, glades::GMath::TANH, rng);
+    bool alwaysOne = true;
+    for (unsigned int i = 0; i < 100; ++i)
+    {
+	single.generateDropout(0.99f, rng);
+	alwaysOne = alwaysOne && (single.getActiveNodes().size() == 1);
+    }
+    G_assert(__FILE__, __LINE__, "Whole layer dropped", alwaysOne);
+
+    glades::Layer empty(glades::Layer::HIDDEN_TYPE);
+    empty.generateDropout(0.5f, rng);
+    G_assert(__FILE__, __LINE__, "Empty layer has active nodes", empty.getActiveNodes().empty());
+
+    // Clearing restores the dense list; output layers never drop
+    hidden.clearDropout();
+    G_assert(__FILE__, __LINE__, "Cleared layer not dense", hidden.getActiveNodes().size() == 200);
+    glades::Layer output(glades::Layer::OUTPUT_TYPE);
+    output.initWeights(3, 4, glades::Node::INIT_XAVIER, glades::GMath::TANH, rng);
+    output.generateDropout(0.5f, rng);
+    G_assert(__FILE__, __LINE__, "Output layer dropped", output.getActiveNodes().size() == 4);
+
+    // Layers do not own their nodes
+    deleteNodes(hidden);
+    deleteNodes(single);
+    deleteNodes(output);
+    printf("LayerUnitTest completed successfully.\n");
+}
@@ -0,0 +1,90 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "learningcurve-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/learningcurve.h"
+#include <math.h>
+#include <vector>
+
+void LearningCurveUnitTest()
+{
+    // Two series: the epoch itself and a metric only measured on even epochs
+    glades::LearningCurve curve;
+    curve.build(2, 8);
+    for (int64_t e = 0; e < 6; ++e)
+    {
+	float values[2] = {(float)e, ((e % 2) == 0) ? (float)(10 * e) : NAN};
+	curve.add(e, values);
+    }
+
+    // Few points: every epoch at full resolution, NaNs skipped
+    std::vector<glades::LearningCurve::Bucket> points;
+    G_assert(__FILE__, __LINE__, "Wrong point count", curve.getCurve(0, 100, points) == 6);
+    G_assert(__FILE__, __LINE__, "Wrong first point", (points[0].firstEpoch == 0) && (points[0].getMean() == 0.0f));
+    G_assert(__FILE__, __LINE__, "Wrong last point", (points[5].lastEpoch == 5) && (points[5].getMean() == 5.0f));
+    G_assert(__FILE__, __LINE__, "NaN epochs kept", curve.getCurve(1, 100, points) == 3);
+    G_assert(__FILE__, __LINE__, "Wrong metric", points[2].getMean() == 40.0f);
+
+    glades::LearningCurve::Bucket last;
+    G_assert(__FILE__, __LINE__, "No last point", curve.getLast(0, last) && (last.lastEpoch == 5));
+
+    // Many points: the levels stay logarithmic and the whole history is still there
+    glades::LearningCurve longRun;
+    longRun.build(1, 64);
+    const int64_t epochs = 1000000;
+    double total = 0.0;
+    for (int64_t e = 0; e < epochs; ++e)
+    {
+	float value = (float)(e % 1000);
+	longRun.add(e, &value);
+	total += value;
+    }
+
+    G_assert(__FILE__, __LINE__, "Wrong point count", longRun.getPointCount() == epochs);
+    G_assert(__FILE__, __LINE__, "Too many levels", longRun.getLevelCount() <= 16);
+
+    unsigned int n = longRun.getCurve(0, 100, points);
+    G_assert(__FILE__, __LINE__, "Too many points", (n > 0) && (n <= 100));
+    G_assert(__FILE__, __LINE__, "Curve does not start at 0", points[0].firstEpoch == 0);
+    G_assert(__FILE__, __LINE__, "Curve does not reach the end", points[n - 1].lastEpoch == epochs - 1);
+
+    // Buckets are contiguous and account for every epoch exactly once
+    uint64_t counted = 0;
+    double sum = 0.0;
+    bool contiguous = true;
+    float lo = 1000.0f;
+    float hi = -1.0f;
+    for (unsigned int i = 0; i < n; ++i)
+    {
+	counted += points[i].count;
+	sum += points[i].sum;
+	if ((i > 0) && (points[i].firstEpoch != points[i - 1].lastEpoch + 1))
+	    contiguous = false;
+	lo = (points[i].fMin < lo) ? points[i].fMin : lo;
+	hi = (points[i].fMax > hi) ? points[i].fMax : hi;
+    }
+    G_assert(__FILE__, __LINE__, "Curve not contiguous", contiguous);
+    G_assert(__FILE__, __LINE__, "Epochs lost", counted == (uint64_t)epochs);
+    G_assert(__FILE__, __LINE__, "Sum lost", fabs(sum - total) < 1.0);
+    G_assert(__FILE__, __LINE__, "Wrong min/max", (lo == 0.0f) && (hi == 999.0f));
+
+    // A recent window comes from a finer level
+    n = longRun.getCurve(0, 1000, points, epochs - 10);
+    G_assert(__FILE__, __LINE__, "Recent window too coarse", (n >= 10) && (points[n - 1].lastEpoch == epochs - 1));
+    G_assert(__FILE__, __LINE__, "Recent window too long", points[0].firstEpoch >= epochs - 20);
+
+    // The GUI list has four values per point
+    shmea::GList flat = longRun.getGList(0, 50);
+    G_assert(__FILE__, __LINE__, "Wrong GList size", (flat.size() > 0) && ((flat.size() % 4) == 0) && (flat.size() <= 200));
+
+    longRun.reset();
+    G_assert(__FILE__, __LINE__, "Reset kept points", (longRun.getPointCount() == 0) && (longRun.getCurve(0, 10, points) == 0));
+
+    printf("LearningCurveUnitTest completed successfully.\n");
+}
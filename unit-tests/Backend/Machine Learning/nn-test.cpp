@@ -12,6 +12,7 @@
 #include "../../../Backend/Machine Learning/Networks/network.h"
 #include "../../../Backend/Machine Learning/DataObjects/ImageInput.h"
 #include "../../../Backend/Machine Learning/DataObjects/NumberInput.h"
+#include "../../../Backend/Machine Learning/DataObjects/TextInput.h"
 #include "../../../Backend/Machine Learning/State/Terminator.h"
 
 // === This is the primary unit testing function:
@@ -45,8 +46,8 @@ void NNUnitTest()
     }
     else if (inputType == glades::DataInput::TEXT)
     {
-    	// TODO
-    	return;
+    	inputFName = "datasets/" + inputFName;
+    	di = new glades::TextInput();
     }
     else
     	return;
@@ -100,8 +101,8 @@ void NNUnitTest()
     }
     else if (inputType == glades::DataInput::TEXT)
     {
-    	// TODO
-    	return;
+    	inputFName = "datasets/" + inputFName;
+    	di2 = new glades::TextInput();
     }
     else
     	return;
@@ -151,8 +152,8 @@ void NNUnitTest()
     }
     else if (inputType == glades::DataInput::TEXT)
     {
-    	// TODO
-    	return;
+    	inputFName = "datasets/" + inputFName;
+    	di3 = new glades::TextInput();
     }
     else
     	return;
@@ -0,0 +1,207 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+
+#include "numberinput-test.h"
+#include "../../unit-test.h"
+#include "Backend/Database/GList.h"
+#include "../../../Backend/Machine Learning/DataObjects/NumberInput.h"
+#include "../../../Backend/Machine Learning/GMath/featurehasher.h"
+#include <math.h>
+#include <unistd.h>
+
+// Write a small CSV to a temp file; path must hold "/tmp/glades-numberinput-XXXXXX"
+static void writeCSV(char* path, const char* text)
+{
+    int fd = mkstemp(path);
+    G_assert(__FILE__, __LINE__, "Temp file failed", fd >= 0);
+    FILE* csv = fdopen(fd, "w");
+    fputs(text, csv);
+    fclose(csv);
+}
+
+static void FeatureHashingTest()
+{
+    char path[] = "/tmp/glades-numberinput-XXXXXX";
+    writeCSV(path, "color,size,label\nred,1,yes\ngreen,2,no\nblue,3,yes\nred,4,no\n");
+
+    const unsigned int buckets = 8;
+    glades::NumberInput ni;
+    ni.setFeatureHashing(buckets);
+    ni.import(path);
+    unlink(path);
+    G_assert(__FILE__, __LINE__, "Hashed import rows", ni.getTrainSize() == 4);
+
+    // The hashed col is exactly bucket-count wide, followed by the numeric col
+    G_assert(__FILE__, __LINE__, "Hashed col width", ni.getFeatureCount() == buckets + 1);
+
+    // One +-1 cell per row, in the hasher's bucket with the hasher's sign
+    glades::FeatureHasher hasher(buckets, true);
+    const char* colors[4] = {"red", "green", "blue", "red"};
+    for (unsigned int r = 0; r < 4; ++r)
+    {
+	shmea::GList row = ni.getTrainRow(r);
+	unsigned int hot = 0;
+	for (unsigned int i = 0; i < buckets; ++i)
+	{
+	    float cell = row.getFloat(i);
+	    if (cell != 0.0f)
+	    {
+		++hot;
+		G_assert(__FILE__, __LINE__, "Hashed cell not +-1", fabs(cell) == 1.0f);
+		G_assert(__FILE__, __LINE__, "Hashed bucket mismatch", i == hasher.indexAt(colors[r]));
+		G_assert(__FILE__, __LINE__, "Hashed sign mismatch", cell == hasher.signAt(colors[r]));
+	    }
+	}
+	G_assert(__FILE__, __LINE__, "Row should have exactly one hashed cell", hot == 1);
+    }
+
+    // Output cols still use OHE
+    shmea::GList yes = ni.getTrainExpectedRow(0);
+    shmea::GList no = ni.getTrainExpectedRow(1);
+    G_assert(__FILE__, __LINE__, "Output col not OHE", (yes.size() == 2) && (no.size() == 2));
+    G_assert(__FILE__, __LINE__, "Output OHE values", (fabs(yes.getFloat(0) + yes.getFloat(1) - 1.0f) < 1.0e-6) && (yes.getFloat(0) != no.getFloat(0)));
+    G_assert(__FILE__, __LINE__, "Output OHE mismatch", ni.getTrainExpectedRow(2).getFloat(0) == yes.getFloat(0));
+
+    // Copies keep their own hasher
+    {
+	glades::NumberInput copied = ni;
+	G_assert(__FILE__, __LINE__, "Copied hashed width", copied.getFeatureCount() == buckets + 1);
+    }
+    G_assert(__FILE__, __LINE__, "Original hasher lost with the copy", ni.featureHasher.size() == buckets);
+
+    // Too late once imported
+    ni.setFeatureHashing(0);
+    G_assert(__FILE__, __LINE__, "Hashing changed after import", ni.useFeatureHashing);
+}
+
+// Raw row of three numbers
+static shmea::GList rawRow(int a, int b, int y)
+{
+    shmea::GList row;
+    row.addInt(a);
+    row.addInt(b);
+    row.addInt(y);
+    return row;
+}
+
+static bool rowsMatch(const shmea::GList& a, const shmea::GList& b)
+{
+    if (a.size() != b.size())
+	return false;
+
+    for (unsigned int i = 0; i < a.size(); ++i)
+    {
+	if (fabs(a.getFloat(i) - b.getFloat(i)) > 1.0e-5)
+	    return false;
+    }
+
+    return true;
+}
+
+static void AppendTest()
+{
+    char path[] = "/tmp/glades-numberinput-XXXXXX";
+    writeCSV(path, "a,b,y\n0,10,1\n5,20,2\n10,30,3\n");
+    char fullPath[] = "/tmp/glades-numberinput-XXXXXX";
+    writeCSV(fullPath, "a,b,y\n0,10,1\n5,20,2\n10,30,3\n20,0,5\n");
+
+    glades::NumberInput ni;
+    ni.import(path);
+    unlink(path);
+    G_assert(__FILE__, __LINE__, "Import rows", ni.getTrainSize() == 3);
+    G_assert(__FILE__, __LINE__, "Import encoding", fabs(ni.getTrainRow(1).getFloat(0) - 0.5f) < 1.0e-6);
+
+    // A row that moves every min/max: old rows read with the new encoding
+    shmea::GTable rows(',');
+    rows.addRow(rawRow(20, 0, 5));
+    G_assert(__FILE__, __LINE__, "Append failed", ni.append(rows));
+    G_assert(__FILE__, __LINE__, "Append rows", ni.getTrainSize() == 4);
+    shmea::GList oldRow = ni.getTrainRow(1);
+    G_assert(__FILE__, __LINE__, "Old row not re-encoded", (fabs(oldRow.getFloat(0) - 0.25f) < 1.0e-6) && (fabs(oldRow.getFloat(1) - (20.0f / 30.0f)) < 1.0e-6));
+    G_assert(__FILE__, __LINE__, "Old expected row not re-encoded", fabs(ni.getTrainExpectedRow(1).getFloat(0) - 0.25f) < 1.0e-6);
+
+    // encodeRow matches the stored rows
+    const int raw[4][3] = {{0, 10, 1}, {5, 20, 2}, {10, 30, 3}, {20, 0, 5}};
+    bool encodedMatch = true;
+    for (unsigned int r = 0; r < 4; ++r)
+    {
+	shmea::GList inputRow;
+	shmea::GList expectedRow;
+	encodedMatch = encodedMatch && ni.encodeRow(rawRow(raw[r][0], raw[r][1], raw[r][2]), inputRow, expectedRow);
+	encodedMatch = encodedMatch && rowsMatch(inputRow, ni.getTrainRow(r)) && rowsMatch(expectedRow, ni.getTrainExpectedRow(r));
+    }
+    G_assert(__FILE__, __LINE__, "encodeRow does not match the stored rows", encodedMatch);
+
+    // rescale() leaves the tables a fresh import of all the rows would build
+    ni.rescale();
+    glades::NumberInput fresh;
+    fresh.import(fullPath);
+    unlink(fullPath);
+    bool freshMatch = (fresh.getTrainSize() == 4);
+    for (unsigned int r = 0; (freshMatch) && (r < 4); ++r)
+    {
+	freshMatch = rowsMatch(ni.trainTable.getRow(r), fresh.trainTable.getRow(r));
+	freshMatch = freshMatch && rowsMatch(ni.trainExpectedTable.getRow(r), fresh.trainExpectedTable.getRow(r));
+    }
+    G_assert(__FILE__, __LINE__, "Rescaled tables differ from a fresh import", freshMatch);
+    G_assert(__FILE__, __LINE__, "Rescale left corrections pending", ni.rescaleCols.empty());
+
+    // A bad row after a good one: the good one stays and the reads follow its stats
+    shmea::GTable badRows(',');
+    badRows.addRow(rawRow(40, 0, 5));
+    shmea::GList badRow;
+    badRow.addString("x");
+    badRow.addInt(0);
+    badRow.addInt(1);
+    badRows.addRow(badRow);
+    G_assert(__FILE__, __LINE__, "Bad row appended", !ni.append(badRows));
+    G_assert(__FILE__, __LINE__, "Good row before the bad one lost", ni.getTrainSize() == 5);
+    shmea::GList inputRow;
+    shmea::GList expectedRow;
+    ni.encodeRow(rawRow(10, 30, 3), inputRow, expectedRow);
+    G_assert(__FILE__, __LINE__, "Reads disagree with the stats after a failed append", rowsMatch(inputRow, ni.getTrainRow(2)) && (fabs(inputRow.getFloat(0) - 0.25f) < 1.0e-6));
+}
+
+static void GrowCategoryTest()
+{
+    char path[] = "/tmp/glades-numberinput-XXXXXX";
+    writeCSV(path, "color,x,label\nred,1,a\nblue,2,b\n");
+
+    glades::NumberInput ni;
+    ni.import(path);
+    unlink(path);
+    G_assert(__FILE__, __LINE__, "Categorical import width", ni.getFeatureCount() == 3);
+
+    // An unseen category adds a col, cold for the stored rows and hot for the new one
+    shmea::GList row;
+    row.addString("green");
+    row.addInt(3);
+    row.addString("a");
+    G_assert(__FILE__, __LINE__, "Append with a new category failed", ni.append(row));
+    G_assert(__FILE__, __LINE__, "Category col not added", ni.getFeatureCount() == 4);
+    G_assert(__FILE__, __LINE__, "New category col not cold", (fabs(ni.getTrainRow(0).getFloat(2) - 0.01f) < 1.0e-6) && (fabs(ni.getTrainRow(1).getFloat(2) - 0.01f) < 1.0e-6));
+    G_assert(__FILE__, __LINE__, "New category not hot", fabs(ni.getTrainRow(2).getFloat(2) - 0.99f) < 1.0e-6);
+    G_assert(__FILE__, __LINE__, "Old categories moved", (fabs(ni.getTrainRow(2).getFloat(0) - 0.01f) < 1.0e-6) && (fabs(ni.getTrainRow(2).getFloat(1) - 0.01f) < 1.0e-6));
+
+    // The numeric col shifted over with its new stats
+    shmea::GList inputRow;
+    shmea::GList expectedRow;
+    G_assert(__FILE__, __LINE__, "encodeRow failed", ni.encodeRow(row, inputRow, expectedRow));
+    G_assert(__FILE__, __LINE__, "encodeRow after a new category", rowsMatch(inputRow, ni.getTrainRow(2)) && rowsMatch(expectedRow, ni.getTrainExpectedRow(2)));
+    G_assert(__FILE__, __LINE__, "Numeric col after the new category", fabs(ni.getTrainRow(0).getFloat(3) - 0.01f) < 1.0e-6);
+}
+
+void NumberInputUnitTest()
+{
+    FeatureHashingTest();
+    AppendTest();
+    GrowCategoryTest();
+
+    printf("NumberInputUnitTest completed successfully.\n");
+}
@@ -9,12 +9,87 @@
 #include "../../unit-test.h"
 #include "Backend/Database/GList.h"
 #include "../../../Backend/Machine Learning/GMath/pca.h"
+#include <math.h>
 
 // === This is the primary unit testing function:
 // void G_assert(const char* fileName, int lineNo, const char* failureMsg, bool expr)
 
+// Sample covariance of the 2D points, in double
+static void covariance2D(const std::vector<std::vector<double> >& data, double cov[2][2])
+{
+    double mean[2] = {0.0, 0.0};
+    for (unsigned int k = 0; k < data.size(); ++k)
+    {
+	mean[0] += data[k][0] / data.size();
+	mean[1] += data[k][1] / data.size();
+    }
+
+    cov[0][0] = cov[0][1] = cov[1][0] = cov[1][1] = 0.0;
+    for (unsigned int k = 0; k < data.size(); ++k)
+    {
+	for (int i = 0; i < 2; ++i)
+	    for (int j = 0; j < 2; ++j)
+		cov[i][j] += (data[k][i] - mean[i]) * (data[k][j] - mean[j]) / (data.size() - 1);
+    }
+}
+
+// Variance of one column of the transformed data (the eigenvalue of that component)
+static double columnVariance(const std::vector<std::vector<double> >& data, unsigned int col)
+{
+    double mean = 0.0;
+    for (unsigned int k = 0; k < data.size(); ++k)
+	mean += data[k][col] / data.size();
+
+    double variance = 0.0;
+    for (unsigned int k = 0; k < data.size(); ++k)
+	variance += (data[k][col] - mean) * (data[k][col] - mean) / (data.size() - 1);
+    return variance;
+}
+
+// Every eigenvector is unit length, orthogonal to the others and satisfies C v = lambda v
+static void checkEigenvectors(const std::vector<std::vector<double> >& data,
+			      const std::vector<std::vector<double> >& eigVecs,
+			      const std::vector<std::vector<double> >& transformed)
+{
+    double cov[2][2];
+    covariance2D(data, cov);
+
+    G_assert(__FILE__, __LINE__, "Wrong eigenvector count", eigVecs.size() == 2);
+    G_assert(__FILE__, __LINE__, "Eigenvectors not orthogonal", fabs((eigVecs[0][0] * eigVecs[1][0]) + (eigVecs[0][1] * eigVecs[1][1])) < 1e-9);
+    for (unsigned int e = 0; e < 2; ++e)
+    {
+	const std::vector<double>& v = eigVecs[e];
+	G_assert(__FILE__, __LINE__, "Eigenvector not unit length", fabs((v[0] * v[0]) + (v[1] * v[1]) - 1.0) < 1e-9);
+
+	double lambda = columnVariance(transformed, e);
+	double cv0 = (cov[0][0] * v[0]) + (cov[0][1] * v[1]);
+	double cv1 = (cov[1][0] * v[0]) + (cov[1][1] * v[1]);
+	G_assert(__FILE__, __LINE__, "C v != lambda v", (fabs(cv0 - (lambda * v[0])) < 1e-3) && (fabs(cv1 - (lambda * v[1])) < 1e-3));
+    }
+
+    // Sorted by eigenvalue, and the eigenvalues add up to the total variance
+    double lambda0 = columnVariance(transformed, 0);
+    double lambda1 = columnVariance(transformed, 1);
+    G_assert(__FILE__, __LINE__, "Eigenvalues not sorted", lambda0 >= lambda1);
+    G_assert(__FILE__, __LINE__, "Eigenvalues do not sum to the trace", fabs(lambda0 + lambda1 - cov[0][0] - cov[1][1]) < 1e-3);
+}
+
 void PCAUnitTest()
 {
+    // matrixMultiply keeps double precision: 1 + 1e-10 does not survive a float
+    std::vector<std::vector<double> > A(2, std::vector<double>(2, 0.0));
+    std::vector<std::vector<double> > B(2, std::vector<double>(1, 0.0));
+    A[0][0] = 1.0 + 1e-10;
+    A[0][1] = 2.0;
+    A[1][0] = 3.0;
+    A[1][1] = 4.0;
+    B[0][0] = 1.0;
+    B[1][0] = 1e-10;
+    std::vector<std::vector<double> > C = matrixMultiply(A, B);
+    G_assert(__FILE__, __LINE__, "matrixMultiply shape", (C.size() == 2) && (C[0].size() == 1));
+    G_assert(__FILE__, __LINE__, "matrixMultiply rounded through float", fabs(C[0][0] - (1.0 + 3e-10)) < 1e-15);
+    G_assert(__FILE__, __LINE__, "matrixMultiply value", fabs(C[1][0] - (3.0 + 4e-10)) < 1e-14);
+
     // Generate example data
     std::vector<std::vector<double> > example_data;
     int graphSize = 200; // pos and neg
@@ -33,8 +108,29 @@ void PCAUnitTest()
     std::vector<std::vector<double> > sorted_eig_vecs;
     compute_pca(example_data, transformed_data, sorted_eig_vecs);
 
+    // y = x: all of the variance lies along (1, 1)
+    double cov[2][2];
+    covariance2D(example_data, cov);
+    checkEigenvectors(example_data, sorted_eig_vecs, transformed_data);
+    G_assert(__FILE__, __LINE__, "y = x first eigenvalue", fabs(columnVariance(transformed_data, 0) - (2.0 * cov[0][0])) < 1e-3);
+    G_assert(__FILE__, __LINE__, "y = x second eigenvalue", columnVariance(transformed_data, 1) < 1e-6);
+    G_assert(__FILE__, __LINE__, "y = x first eigenvector", (fabs(fabs(sorted_eig_vecs[0][0]) - M_SQRT1_2) < 1e-6) && (sorted_eig_vecs[0][0] * sorted_eig_vecs[0][1] > 0.0));
+
+    // Reconstruction through both components gives the data back
+    double worst = 0.0;
+    for (unsigned int k = 0; k < example_data.size(); ++k)
+    {
+	for (unsigned int j = 0; j < 2; ++j)
+	{
+	    double value = (transformed_data[k][0] * sorted_eig_vecs[0][j]) + (transformed_data[k][1] * sorted_eig_vecs[1][j]);
+	    if (fabs(value - example_data[k][j]) > worst)
+		worst = fabs(value - example_data[k][j]);
+	}
+    }
+    G_assert(__FILE__, __LINE__, "y = x reconstruction", worst < 1e-4);
+
     /* Expected Output:
-     * ----------
+     *  ----------
      *  Computing the mean of the data...
      *  ----------
      *  Computing the covariance matrix...
@@ -42,21 +138,21 @@ void PCAUnitTest()
      *  Covariance Matrix Row 1: [33.4167, 33.4167]
      *  ----------
      *  Computing the eigenvectors and eigenvalues of the covariance matrix...
-     *  Eigenvalues: [-7.64242e-15, -5.56129e-15]
+     *  Eigenvalues: [66.8333, 3.9443e-31]
      *  ----------
      *  Sorting eigenvectors based on eigenvalues...
      *  Running Gram-Schmidt orthogonalization on the eigenvectors...
      *  ----------
-     *  Eigenvector 0: [-0.707107, 0.707107]
-     *  Eigenvector 1: [0.707107, 0.707107]
+     *  Eigenvector 0: [0.707107, 0.707107]
+     *  Eigenvector 1: [-0.707107, 0.707107]
      *  ----------
      *  Transforming the data using the eigenvectors...
      *  Computing the percentage of variance explained by each principal component...
      *  Variance explained by each principal component: 
-     *  Principal Component 0: 57.8809%
-     *  Principal Component 1: 42.1191%
+     *  Principal Component 0: 100%
+     *  Principal Component 1: 5.9017e-31%
      *
-     *  Reconstruction error: 4.6284e-28
+     *  Reconstruction error: 7.68761e-11 (float GEMM projection)
      */
 
     printf("============================================================\n");
@@ -79,29 +175,33 @@ void PCAUnitTest()
     sorted_eig_vecs.clear();
     compute_pca(example_data, transformed_data, sorted_eig_vecs);
 
+    // A noisy line: the first component follows its slope
+    checkEigenvectors(example_data, sorted_eig_vecs, transformed_data);
+    G_assert(__FILE__, __LINE__, "Noisy line first eigenvector", fabs(sorted_eig_vecs[0][1] / sorted_eig_vecs[0][0]) < 1.0);
+
     /* Expected Output:
-     * ----------
-     * Computing the mean of the data...
-     * ----------
+     *  ----------
+     *  Computing the mean of the data...
+     *  ----------
      *  Computing the covariance matrix...
      *  Covariance Matrix Row 0: [33.4167, 16.568]
      *  Covariance Matrix Row 1: [16.568, 8.73592]
      *  ----------
      *  Computing the eigenvectors and eigenvalues of the covariance matrix...
-     *  Eigenvalues: [-0.687157, -25.3679]
+     *  Eigenvalues: [41.7351, 0.417531]
      *  ----------
      *  Sorting eigenvectors based on eigenvalues...
      *  Running Gram-Schmidt orthogonalization on the eigenvectors...
      *  ----------
-     *  Eigenvector 0: [-0.436971, 0.899476]
-     *  Eigenvector 1: [-0.899476, -0.436971]
+     *  Eigenvector 0: [0.893684, 0.448696]
+     *  Eigenvector 1: [-0.448696, 0.893684]
      *  ----------
      *  Transforming the data using the eigenvectors...
      *  Computing the percentage of variance explained by each principal component...
      *  Variance explained by each principal component: 
-     *  Principal Component 0: 2.63732%
-     *  Principal Component 1: 97.3627%
+     *  Principal Component 0: 99.0095%
+     *  Principal Component 1: 0.990522%
      *
-     *  Reconstruction error: 54430.9
+     *  Reconstruction error: 5.85323e-11 (float GEMM projection)
      */
 }
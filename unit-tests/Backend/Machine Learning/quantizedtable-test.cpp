@@ -0,0 +1,72 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "quantizedtable-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/DataObjects/QuantizedTable.h"
+#include "../../../Backend/Machine Learning/GMath/gmath.h"
+
+void QuantizedTableUnitTest()
+{
+    // fp16 round trips
+    G_assert(__FILE__, __LINE__, "Half of 1.0 mismatch", glades::GMath::floatToHalf(1.0f) == 0x3C00);
+    G_assert(__FILE__, __LINE__, "Half of -2.0 mismatch", glades::GMath::floatToHalf(-2.0f) == 0xC000);
+    G_assert(__FILE__, __LINE__, "Half overflow should be inf", glades::GMath::floatToHalf(70000.0f) == 0x7C00);
+    G_assert(__FILE__, __LINE__, "Half 0.01 round trip", fabs(glades::GMath::halfToFloat(glades::GMath::floatToHalf(0.01f)) - 0.01f) < 1e-5f);
+    G_assert(__FILE__, __LINE__, "Smallest subnormal half mismatch", glades::GMath::halfToFloat(0x0001) == ldexpf(1.0f, -24));
+
+    // Standardized table with a constant col and an OHE col
+    shmea::GTable src(',');
+    for (unsigned int r = 0; r < 16; ++r)
+    {
+	shmea::GList row;
+	row.addFloat(r / 15.0f);
+	row.addFloat(0.5f);
+	row.addFloat((r % 2) ? 0.99f : 0.01f);
+	src.addRow(row);
+    }
+
+    // uint8 codes, per col scale/offset
+    glades::QuantizedTable byteTable(glades::DataInput::STORE_UINT8);
+    byteTable.fromTable(src);
+    G_assert(__FILE__, __LINE__, "uint8 row count mismatch", byteTable.numberOfRows() == 16);
+    G_assert(__FILE__, __LINE__, "uint8 col count mismatch", byteTable.numberOfCols() == 3);
+    for (unsigned int r = 0; r < 16; ++r)
+    {
+	G_assert(__FILE__, __LINE__, "uint8 range col error too large", fabs(byteTable.getCell(r, 0) - (r / 15.0f)) <= (0.5f / 255.0f) + 1e-6f);
+	G_assert(__FILE__, __LINE__, "uint8 constant col mismatch", byteTable.getCell(r, 1) == 0.5f);
+	G_assert(__FILE__, __LINE__, "uint8 OHE col not exact", fabs(byteTable.getCell(r, 2) - ((r % 2) ? 0.99f : 0.01f)) < 1e-6f);
+    }
+
+    shmea::GList byteRow = byteTable.getRow(3);
+    G_assert(__FILE__, __LINE__, "uint8 row size mismatch", byteRow.size() == 3);
+    G_assert(__FILE__, __LINE__, "uint8 row decode mismatch", byteRow.getFloat(2) == byteTable.getCell(3, 2));
+    G_assert(__FILE__, __LINE__, "uint8 storage too large", byteTable.byteSize() == (16 * 3) + (2 * 3 * sizeof(float)));
+
+    // fp16 halves
+    glades::QuantizedTable halfTable(glades::DataInput::STORE_FP16);
+    halfTable.fromTable(src);
+    for (unsigned int r = 0; r < 16; ++r)
+	G_assert(__FILE__, __LINE__, "fp16 error too large", fabs(halfTable.getCell(r, 0) - (r / 15.0f)) < 1e-3f);
+
+    // streamed rows get their own scale/offset
+    glades::QuantizedTable pixelTable(glades::DataInput::STORE_UINT8);
+    shmea::GList pixels;
+    for (unsigned int i = 0; i < 256; ++i)
+	pixels.addFloat(i / 255.0f);
+    pixelTable.addRow(pixels);
+    float decoded[256];
+    pixelTable.getRow(0, decoded);
+    bool pixelsExact = true;
+    for (unsigned int i = 0; i < 256; ++i)
+	if (fabs(decoded[i] - (i / 255.0f)) > 1e-6f)
+	    pixelsExact = false;
+    G_assert(__FILE__, __LINE__, "8-bit pixels should decode exactly", pixelsExact);
+
+    printf("QuantizedTableUnitTest completed successfully.\n");
+}
@@ -0,0 +1,94 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "reduction-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/gmatrix.h"
+#include "../../../Backend/Machine Learning/GMath/grandom.h"
+#include "../../../Backend/Machine Learning/GMath/reduction.h"
+#include <math.h>
+#include <vector>
+
+void ReductionUnitTest()
+{
+    // Enough values for several leaves and for threads to kick in, with a ragged last leaf
+    const unsigned int n = 100003;
+    std::vector<float> x(n);
+    std::vector<float> y(n);
+    glades::GRandom fill(7);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+	x[i] = fill.nextFloat() * 2.0f - 1.0f;
+	y[i] = fill.nextFloat();
+    }
+
+    double exactSum = 0.0;
+    for (unsigned int i = 0; i < n; ++i)
+	exactSum += x[i];
+
+    int savedMode = glades::Reduction::getMode();
+
+    // Deterministic: same bits for every thread count
+    glades::Reduction::setMode(glades::Reduction::MODE_DETERMINISTIC);
+    float sum1 = glades::Reduction::sum(&x[0], n, 1);
+    float dot1 = glades::Reduction::dot(&x[0], &y[0], n, 1);
+    bool identical = true;
+    for (unsigned int threads = 2; threads <= 8; ++threads)
+    {
+	identical = identical && (glades::Reduction::sum(&x[0], n, threads) == sum1);
+	identical = identical && (glades::Reduction::dot(&x[0], &y[0], n, threads) == dot1);
+    }
+    G_assert(__FILE__, __LINE__, "Deterministic reduction depends on threads", identical);
+    G_assert(__FILE__, __LINE__, "Deterministic sum is off", fabs(sum1 - exactSum) < 1.0e-2);
+
+    // Below the threading cutoff the leaves go through the same tree
+    const unsigned int small = 5 * glades::Reduction::LEAF_SIZE + 7;
+    float leafTotals[6];
+    for (unsigned int leaf = 0; leaf < 6; ++leaf)
+    {
+	float leafSum = 0.0f;
+	for (unsigned int i = leaf * glades::Reduction::LEAF_SIZE; (i < (leaf + 1) * glades::Reduction::LEAF_SIZE) && (i < small); ++i)
+	    leafSum += x[i];
+	leafTotals[leaf] = leafSum;
+    }
+    G_assert(__FILE__, __LINE__, "Small deterministic sum is off", fabs(glades::Reduction::sum(&x[0], small, 4) - glades::Reduction::treeSum(leafTotals, 6)) < 1.0e-3);
+
+    // Fast: may round differently but stays close
+    glades::Reduction::setMode(glades::Reduction::MODE_FAST);
+    G_assert(__FILE__, __LINE__, "Fast sum is off", fabs(glades::Reduction::sum(&x[0], n, 3) - exactSum) < 1.0e-2);
+    G_assert(__FILE__, __LINE__, "Empty sum", glades::Reduction::sum(&x[0], 0, 4) == 0.0f);
+
+    // GMatrix::dot stays on the calling thread whatever the GEMM thread count
+    glades::GMatrix::setThreads(4);
+    G_assert(__FILE__, __LINE__, "GMatrix::dot split across threads", glades::GMatrix::dot(&x[0], &y[0], n) == glades::Reduction::dot(&x[0], &y[0], n, 1));
+    glades::GMatrix::setThreads(1);
+    glades::Reduction::setMode(savedMode);
+
+    // Tree shape
+    float partials[5] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+    G_assert(__FILE__, __LINE__, "Tree sum", glades::Reduction::treeSum(partials, 5) == 15.0f);
+
+    // Per-sample streams do not depend on who asks first
+    glades::GRandom a = glades::GRandom::forSample(42, 10);
+    glades::GRandom b = glades::GRandom::forSample(42, 11);
+    glades::GRandom a2 = glades::GRandom::forSample(42, 10);
+    uint64_t firstA = a.next();
+    G_assert(__FILE__, __LINE__, "Sample stream not reproducible", firstA == a2.next());
+    G_assert(__FILE__, __LINE__, "Neighbouring samples share a stream", firstA != b.next());
+    G_assert(__FILE__, __LINE__, "Seed ignored", firstA != glades::GRandom::forSample(43, 10).next());
+
+    bool inRange = true;
+    for (unsigned int i = 0; i < 1000; ++i)
+    {
+	float u = a.nextFloat();
+	inRange = inRange && (u >= 0.0f) && (u < 1.0f) && (a.nextBelow(7) < 7);
+    }
+    G_assert(__FILE__, __LINE__, "Random value out of range", inRange);
+
+    printf("ReductionUnitTest completed successfully.\n");
+}
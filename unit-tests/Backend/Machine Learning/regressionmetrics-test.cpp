@@ -0,0 +1,96 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "regressionmetrics-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/regressionmetrics.h"
+#include <math.h>
+#include <vector>
+
+static bool nearlyEqual(float a, float b, float tol)
+{
+    return fabs(a - b) <= tol;
+}
+
+void RegressionMetricsUnitTest()
+{
+    // Hand worked: targets 1..4, predictions off by 0.5, -0.5, 1, -1
+    glades::RegressionMetrics metrics;
+    metrics.build(1);
+    const float expected[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    const float predicted[4] = {1.5f, 1.5f, 4.0f, 3.0f};
+    metrics.addResults(predicted, expected, 4);
+
+    // SSE = 2.5, SST = 5
+    G_assert(__FILE__, __LINE__, "Wrong count", metrics.getCount() == 4);
+    G_assert(__FILE__, __LINE__, "Wrong MSE", nearlyEqual(metrics.getMSE(0), 0.625f, 1.0e-6f));
+    G_assert(__FILE__, __LINE__, "Wrong RMSE", nearlyEqual(metrics.getRMSE(0), sqrt(0.625f), 1.0e-6f));
+    G_assert(__FILE__, __LINE__, "Wrong MAE", nearlyEqual(metrics.getMAE(0), 0.75f, 1.0e-6f));
+    G_assert(__FILE__, __LINE__, "Wrong R2", nearlyEqual(metrics.getR2(0), 0.5f, 1.0e-6f));
+    G_assert(__FILE__, __LINE__, "Wrong overall R2", nearlyEqual(metrics.getOverallR2(), 0.5f, 1.0e-6f));
+
+    // A perfect model and a constant target
+    glades::RegressionMetrics perfect;
+    perfect.build(1);
+    perfect.addResults(expected, expected, 4);
+    G_assert(__FILE__, __LINE__, "Perfect R2 not 1", nearlyEqual(perfect.getR2(0), 1.0f, 1.0e-6f));
+    G_assert(__FILE__, __LINE__, "Perfect P99 not 0", perfect.getErrorQuantile(0.99f) == 0.0f);
+
+    // Quantiles of the errors 1..1000 within the sketch's accuracy
+    glades::RegressionMetrics sketch;
+    sketch.build(1);
+    for (unsigned int i = 1; i <= 1000; ++i)
+	sketch.addResult(0, 0.0f, (float)i);
+    float p50 = sketch.getErrorQuantile(0.5f);
+    float p95 = sketch.getErrorQuantile(0.95f);
+    float p99 = sketch.getErrorQuantile(0.99f);
+    G_assert(__FILE__, __LINE__, "P50 off", nearlyEqual(p50, 500.0f, 500.0f * 0.011f));
+    G_assert(__FILE__, __LINE__, "P95 off", nearlyEqual(p95, 950.0f, 950.0f * 0.011f));
+    G_assert(__FILE__, __LINE__, "P99 off", nearlyEqual(p99, 990.0f, 990.0f * 0.011f));
+
+    // Two halves merged give the same metrics as one pass, per output node
+    const unsigned int outputs = 2;
+    const unsigned int rows = 200;
+    std::vector<float> pred(rows * outputs);
+    std::vector<float> exp(rows * outputs);
+    for (unsigned int r = 0; r < rows; ++r)
+    {
+	exp[r * outputs] = (float)r * 0.1f;
+	pred[r * outputs] = exp[r * outputs] + (((r % 3) == 0) ? 0.2f : -0.1f);
+	exp[(r * outputs) + 1] = (float)(r % 7);
+	pred[(r * outputs) + 1] = (float)(r % 5);
+    }
+
+    glades::RegressionMetrics whole;
+    whole.build(outputs);
+    whole.addResults(&pred[0], &exp[0], rows);
+
+    glades::RegressionMetrics first;
+    glades::RegressionMetrics second;
+    first.build(outputs);
+    second.build(outputs);
+    first.addResults(&pred[0], &exp[0], rows / 2);
+    second.addResults(&pred[(rows / 2) * outputs], &exp[(rows / 2) * outputs], rows / 2);
+    first.merge(second);
+
+    G_assert(__FILE__, __LINE__, "Merged count", first.getCount() == whole.getCount());
+    for (unsigned int o = 0; o < outputs; ++o)
+    {
+	G_assert(__FILE__, __LINE__, "Merged MSE", nearlyEqual(first.getMSE(o), whole.getMSE(o), 1.0e-5f));
+	G_assert(__FILE__, __LINE__, "Merged MAE", nearlyEqual(first.getMAE(o), whole.getMAE(o), 1.0e-5f));
+	G_assert(__FILE__, __LINE__, "Merged R2", nearlyEqual(first.getR2(o), whole.getR2(o), 1.0e-5f));
+    }
+    G_assert(__FILE__, __LINE__, "Merged P95", first.getErrorQuantile(0.95f) == whole.getErrorQuantile(0.95f));
+
+    // Reset keeps the size
+    whole.reset();
+    G_assert(__FILE__, __LINE__, "Reset kept results", (whole.getCount() == 0) && (whole.size() == outputs));
+    G_assert(__FILE__, __LINE__, "Reset MSE not 0", whole.getOverallMSE() == 0.0f);
+
+    printf("RegressionMetricsUnitTest completed successfully.\n");
+}
@@ -0,0 +1,108 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "roccurve-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/roccurve.h"
+#include <math.h>
+#include <vector>
+
+static bool nearlyEqual(float a, float b)
+{
+    return fabs(a - b) <= 1.0e-5f;
+}
+
+void ROCCurveUnitTest()
+{
+    // Perfectly separated, perfectly inverted and uninformative scores
+    glades::ROCCurve roc;
+    roc.build(3, 100);
+    for (unsigned int i = 0; i < 50; ++i)
+    {
+	float low = 0.1f + 0.003f * (float)i;
+	float high = 0.6f + 0.003f * (float)i;
+	roc.addResult(0, high, true);
+	roc.addResult(0, low, false);
+	roc.addResult(1, low, true);
+	roc.addResult(1, high, false);
+	roc.addResult(2, 0.5f, (i % 2) == 0);
+    }
+    G_assert(__FILE__, __LINE__, "Separated AUC not 1", nearlyEqual(roc.getAUC(0), 1.0f));
+    G_assert(__FILE__, __LINE__, "Inverted AUC not 0", nearlyEqual(roc.getAUC(1), 0.0f));
+    G_assert(__FILE__, __LINE__, "Tied AUC not 0.5", nearlyEqual(roc.getAUC(2), 0.5f));
+    G_assert(__FILE__, __LINE__, "Separated AP not 1", nearlyEqual(roc.getAveragePrecision(0), 1.0f));
+    G_assert(__FILE__, __LINE__, "Wrong counts", (roc.getPositives(0) == 50) && (roc.getNegatives(0) == 50));
+
+    std::vector<float> fpr;
+    std::vector<float> tpr;
+    roc.getROC(0, fpr, tpr);
+    G_assert(__FILE__, __LINE__, "ROC does not start at (0, 0)", (fpr.front() == 0.0f) && (tpr.front() == 0.0f));
+    G_assert(__FILE__, __LINE__, "ROC does not end at (1, 1)", nearlyEqual(fpr.back(), 1.0f) && nearlyEqual(tpr.back(), 1.0f));
+    std::vector<float> recall;
+    std::vector<float> precision;
+    roc.getPR(0, recall, precision);
+    G_assert(__FILE__, __LINE__, "PR does not reach full recall", nearlyEqual(recall.back(), 1.0f));
+    G_assert(__FILE__, __LINE__, "PR ends above the base rate", nearlyEqual(precision.back(), 0.5f));
+
+    // Batch rows against the pairwise definition; scores sit on distinct bins so it is exact
+    const unsigned int N = 400;
+    std::vector<float> pred(N);
+    std::vector<float> exp(N);
+    for (unsigned int i = 0; i < N; ++i)
+    {
+	unsigned int h = (i * 2654435761u) >> 7;
+	pred[i] = ((float)(h % 1000) + 0.5f) / 1000.0f;
+	exp[i] = (((h >> 11) % 1000) < (h % 1000)) ? 1.0f : 0.0f;
+    }
+
+    glades::ROCCurve batch;
+    batch.build(1, 1000);
+    batch.addResults(&pred[0], &exp[0], N);
+
+    double wins = 0.0;
+    double pairs = 0.0;
+    for (unsigned int i = 0; i < N; ++i)
+    {
+	if (exp[i] == 0.0f)
+	    continue;
+	for (unsigned int j = 0; j < N; ++j)
+	{
+	    if (exp[j] != 0.0f)
+		continue;
+	    pairs += 1.0;
+	    if (pred[i] > pred[j])
+		wins += 1.0;
+	    else if (pred[i] == pred[j])
+		wins += 0.5;
+	}
+    }
+    G_assert(__FILE__, __LINE__, "Histogram AUC disagrees with pairwise AUC", nearlyEqual(batch.getAUC(0), (float)(wins / pairs)));
+
+    // Worker histograms merge into the epoch's
+    glades::ROCCurve half1;
+    glades::ROCCurve half2;
+    half1.build(1, 1000);
+    half2.build(1, 1000);
+    half1.addResults(&pred[0], &exp[0], N / 2);
+    half2.addResults(&pred[N / 2], &exp[N / 2], N - (N / 2));
+    half1.merge(half2);
+    G_assert(__FILE__, __LINE__, "Merged AUC differs", nearlyEqual(half1.getAUC(0), batch.getAUC(0)));
+
+    // Out of range scores clamp to the end bins
+    glades::ROCCurve clamped;
+    clamped.build(1, 10);
+    clamped.addResult(0, 5.0f, true);
+    clamped.addResult(0, -5.0f, false);
+    G_assert(__FILE__, __LINE__, "Clamped AUC not 1", nearlyEqual(clamped.getAUC(0), 1.0f));
+
+    roc.reset();
+    G_assert(__FILE__, __LINE__, "Reset kept counts", roc.getPositives(0) == 0);
+    G_assert(__FILE__, __LINE__, "Empty class AUC not 0.5", nearlyEqual(roc.getOverallAUC(), 0.5f));
+
+    printf("ROCCurveUnitTest completed successfully.\n");
+}
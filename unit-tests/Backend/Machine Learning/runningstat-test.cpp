@@ -0,0 +1,51 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "runningstat-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/runningstat.h"
+
+void RunningStatUnitTest()
+{
+    // 2, 4, 4, 4, 5, 5, 7, 9
+    float values[8] = {2.0f, 4.0f, 4.0f, 4.0f, 5.0f, 5.0f, 7.0f, 9.0f};
+    glades::RunningStat all;
+    glades::RunningStat firstHalf;
+    glades::RunningStat secondHalf;
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+	all.add(values[i]);
+	if (i < 3)
+	    firstHalf.add(values[i]);
+	else
+	    secondHalf.add(values[i]);
+    }
+
+    G_assert(__FILE__, __LINE__, "RunningStat count mismatch", all.size() == 8);
+    G_assert(__FILE__, __LINE__, "RunningStat min mismatch", all.getMin() == 2.0f);
+    G_assert(__FILE__, __LINE__, "RunningStat max mismatch", all.getMax() == 9.0f);
+    G_assert(__FILE__, __LINE__, "RunningStat mean mismatch", fabs(all.getMean() - 5.0) < 1e-9);
+    G_assert(__FILE__, __LINE__, "RunningStat variance mismatch", fabs(all.getVariance() - (32.0 / 7.0)) < 1e-9);
+
+    // Merged batches match a single pass
+    firstHalf.merge(secondHalf);
+    G_assert(__FILE__, __LINE__, "Merged count mismatch", firstHalf.size() == all.size());
+    G_assert(__FILE__, __LINE__, "Merged min mismatch", firstHalf.getMin() == all.getMin());
+    G_assert(__FILE__, __LINE__, "Merged max mismatch", firstHalf.getMax() == all.getMax());
+    G_assert(__FILE__, __LINE__, "Merged mean mismatch", fabs(firstHalf.getMean() - all.getMean()) < 1e-9);
+    G_assert(__FILE__, __LINE__, "Merged variance mismatch", fabs(firstHalf.getVariance() - all.getVariance()) < 1e-9);
+
+    // Empty and single value edge cases
+    glades::RunningStat single;
+    G_assert(__FILE__, __LINE__, "Empty variance should be 0", single.getVariance() == 0.0);
+    single.add(-3.0f);
+    G_assert(__FILE__, __LINE__, "Single value min mismatch", single.getMin() == -3.0f);
+    G_assert(__FILE__, __LINE__, "Single value range mismatch", single.getRange() == 0.0f);
+
+    printf("RunningStatUnitTest completed successfully.\n");
+}
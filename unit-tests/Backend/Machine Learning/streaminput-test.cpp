@@ -0,0 +1,74 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "streaminput-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/DataObjects/StreamInput.h"
+#include <string.h>
+#include <unistd.h>
+
+void StreamInputUnitTest()
+{
+    // 2 replay slots, last col is the label
+    glades::StreamInput stream(2, 1, glades::StreamInput::REPLAY_RECENT);
+    G_assert(__FILE__, __LINE__, "Stream should start empty", stream.getTrainSize() == 0);
+
+    G_assert(__FILE__, __LINE__, "Stream rejected a numeric line", stream.pushLine("0.1, 0.2, 1\n"));
+    G_assert(__FILE__, __LINE__, "Stream accepted a string without a schema", !stream.pushLine("a,b,1"));
+    G_assert(__FILE__, __LINE__, "Stream accepted a narrower row", !stream.pushLine("0.5,1"));
+    stream.pushLine("0.3,0.4,0");
+    stream.pushLine("0.5,0.6,1");
+
+    // Rows come out in order, split into features and label
+    shmea::GList inputRow;
+    shmea::GList expectedRow;
+    G_assert(__FILE__, __LINE__, "Stream pop failed", stream.pop(inputRow, expectedRow, 10));
+    G_assert(__FILE__, __LINE__, "Stream feature count mismatch", inputRow.size() == 2);
+    G_assert(__FILE__, __LINE__, "Stream expected count mismatch", expectedRow.size() == 1);
+    G_assert(__FILE__, __LINE__, "Stream feature value mismatch", inputRow.getFloat(1) == 0.2f);
+    G_assert(__FILE__, __LINE__, "Stream label mismatch", expectedRow.getFloat(0) == 1.0f);
+
+    // Newest row is train row 0, replay fills rows 1..capacity
+    stream.stage(inputRow, expectedRow);
+    G_assert(__FILE__, __LINE__, "Staged row not at 0", stream.getTrainRow(0).getFloat(0) == 0.1f);
+    G_assert(__FILE__, __LINE__, "First admit slot mismatch", stream.admit() == 1);
+    stream.pop(inputRow, expectedRow, 10);
+    stream.stage(inputRow, expectedRow);
+    G_assert(__FILE__, __LINE__, "Second admit slot mismatch", stream.admit() == 2);
+    stream.pop(inputRow, expectedRow, 10);
+    stream.stage(inputRow, expectedRow);
+    G_assert(__FILE__, __LINE__, "Recent replay should overwrite the oldest slot", stream.admit() == 1);
+    G_assert(__FILE__, __LINE__, "Replay slot content mismatch", stream.getTrainRow(1).getFloat(0) == 0.5f);
+    G_assert(__FILE__, __LINE__, "Replay size mismatch", stream.getReplaySize() == 2);
+    G_assert(__FILE__, __LINE__, "Train size mismatch", stream.getTrainSize() == 3);
+    G_assert(__FILE__, __LINE__, "Rows seen mismatch", stream.getRowsSeen() == 3);
+
+    unsigned int sampled = stream.sampleSlot();
+    G_assert(__FILE__, __LINE__, "Sampled slot out of range", (sampled >= 1) && (sampled <= 2));
+
+    // Closed and drained
+    G_assert(__FILE__, __LINE__, "Pop should time out on an empty stream", !stream.pop(inputRow, expectedRow, 1));
+    stream.close();
+    G_assert(__FILE__, __LINE__, "Stream should report closed", stream.isClosed());
+    G_assert(__FILE__, __LINE__, "Closed stream accepted a row", !stream.pushLine("0.1,0.2,1"));
+
+    // The reader splits a pipe into lines and stops while the pipe is still open and silent
+    int pipeEnds[2];
+    G_assert(__FILE__, __LINE__, "Pipe failed", pipe(pipeEnds) == 0);
+    glades::StreamInput piped(2, 1);
+    G_assert(__FILE__, __LINE__, "Reader did not start", piped.startReader(fdopen(pipeEnds[0], "r")));
+    const char* pipedLines = "0.7,0.8,1\n0.9,";
+    G_assert(__FILE__, __LINE__, "Pipe write failed", write(pipeEnds[1], pipedLines, strlen(pipedLines)) == (ssize_t)strlen(pipedLines));
+    G_assert(__FILE__, __LINE__, "Piped row not read", piped.pop(inputRow, expectedRow, 2000));
+    G_assert(__FILE__, __LINE__, "Piped row mismatch", (inputRow.getFloat(0) == 0.7f) && (expectedRow.getFloat(0) == 1.0f));
+    G_assert(__FILE__, __LINE__, "Partial line pushed", !piped.pop(inputRow, expectedRow, 2 * glades::StreamInput::READER_POLL_MS));
+    piped.stopReader();
+    close(pipeEnds[1]);
+
+    printf("StreamInputUnitTest completed successfully.\n");
+}
@@ -0,0 +1,49 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+
+#include "telemetry-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/GMath/gmath.h"
+#include "../../../Backend/Machine Learning/Networks/telemetry.h"
+
+void TelemetryUnitTest()
+{
+    // No publisher thread drains the slot, so every publish lands on top of the last one
+    glades::TelemetryPublisher telemetry;
+    for (int i = 1; i <= 5; ++i)
+    {
+	glades::TelemetryFrame& frame = telemetry.stage();
+	frame.epoch = i;
+	frame.outputType = glades::GMath::CLASSIFICATION;
+	frame.accuracy = 0.1f * i;
+	frame.confusionMatrix.build(2);
+	frame.confusionMatrix.addResult(1, 1);
+	for (int j = 0; j < i; ++j)
+	    frame.confusionMatrix.addResult(0, 0);
+	telemetry.publish();
+    }
+    G_assert(__FILE__, __LINE__, "Published count mismatch", telemetry.getPublished() == 5);
+    G_assert(__FILE__, __LINE__, "Older frames not dropped", telemetry.getDropped() == 4);
+    G_assert(__FILE__, __LINE__, "Frame sent without a publisher", telemetry.getSent() == 0);
+
+    // Only the newest frame survives, whole
+    glades::TelemetryFrame newest;
+    G_assert(__FILE__, __LINE__, "Slot empty", telemetry.take(newest));
+    G_assert(__FILE__, __LINE__, "Slot held an older frame", (newest.epoch == 5) && (newest.accuracy == 0.5f));
+    G_assert(__FILE__, __LINE__, "Confusion matrix mismatch", (newest.confusionMatrix.size() == 2) && (newest.confusionMatrix.getCount(0, 0) == 5) && (newest.confusionMatrix.getTotal() == 6));
+    G_assert(__FILE__, __LINE__, "Slot not emptied", !telemetry.take(newest));
+
+    // A taken slot is refilled without a drop
+    telemetry.stage().epoch = 6;
+    telemetry.publish();
+    G_assert(__FILE__, __LINE__, "Drop on an empty slot", telemetry.getDropped() == 4);
+    G_assert(__FILE__, __LINE__, "Refilled slot mismatch", telemetry.take(newest) && (newest.epoch == 6));
+
+    printf("TelemetryUnitTest completed successfully.\n");
+}
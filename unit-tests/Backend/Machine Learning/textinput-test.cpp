@@ -0,0 +1,122 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+
+#include "textinput-test.h"
+#include "../../unit-test.h"
+#include "Backend/Database/GList.h"
+#include "../../../Backend/Machine Learning/DataObjects/TextInput.h"
+#include "../../../Backend/Machine Learning/GMath/featurehasher.h"
+#include <map>
+#include <math.h>
+#include <unistd.h>
+
+static const unsigned int TEXT_BUCKETS = 64;
+
+// Line i of the test corpus: "c<i%3>,Alpha w<i%97> beta, gamma!"
+static std::string corpusLine(unsigned int i)
+{
+    char buffer[64];
+    sprintf(buffer, "c%u,Alpha w%u beta, gamma!", i % 3, i % 97);
+    return buffer;
+}
+
+// The row TextInput should build for line i: unigrams and bigrams, signed, L2 normalized
+static std::vector<float> expectedFeatures(unsigned int i)
+{
+    char word[16];
+    sprintf(word, "w%u", i % 97);
+    const char* tokens[4] = {"alpha", word, "beta", "gamma"};
+
+    glades::FeatureHasher hasher(TEXT_BUCKETS, true);
+    std::map<unsigned int, float> counts;
+    for (unsigned int t = 0; t < 4; ++t)
+	counts[hasher.indexAt(tokens[t])] += hasher.signAt(tokens[t]);
+    for (unsigned int t = 0; t < 3; ++t)
+    {
+	std::string gram = std::string(tokens[t]) + " " + tokens[t + 1];
+	counts[hasher.indexAt(gram)] += hasher.signAt(gram);
+    }
+
+    float norm = 0.0f;
+    std::map<unsigned int, float>::const_iterator itr = counts.begin();
+    for (; itr != counts.end(); ++itr)
+	norm += itr->second * itr->second;
+    norm = sqrt(norm);
+
+    std::vector<float> dense(TEXT_BUCKETS, 0.0f);
+    for (itr = counts.begin(); itr != counts.end(); ++itr)
+	dense[itr->first] = itr->second / norm;
+    return dense;
+}
+
+void TextInputUnitTest()
+{
+    // More lines than one chunk, so rows cross a chunk boundary
+    const unsigned int lineCount = glades::TextInput::CHUNK_SIZE + 904;
+    char path[] = "/tmp/glades-textinput-XXXXXX";
+    int fd = mkstemp(path);
+    G_assert(__FILE__, __LINE__, "Temp file failed", fd >= 0);
+    FILE* corpus = fdopen(fd, "w");
+    for (unsigned int i = 0; i < lineCount; ++i)
+	fprintf(corpus, "%s\n", corpusLine(i).c_str());
+    fclose(corpus);
+
+    // 3 tokenizer threads
+    glades::TextInput ti(TEXT_BUCKETS, 2, 3);
+    ti.import(path);
+    G_assert(__FILE__, __LINE__, "Row count mismatch", ti.getTrainSize() == lineCount);
+    G_assert(__FILE__, __LINE__, "Feature count mismatch", ti.getFeatureCount() == TEXT_BUCKETS);
+
+    bool orderMatch = true;
+    bool unitNorm = true;
+    bool labelMatch = true;
+    for (unsigned int i = 0; i < lineCount; ++i)
+    {
+	// Rows in file order, each n-gram in its bucket with its sign
+	shmea::GList row = ti.getTrainRow(i);
+	std::vector<float> expected = expectedFeatures(i);
+	float norm = 0.0f;
+	for (unsigned int b = 0; b < TEXT_BUCKETS; ++b)
+	{
+	    if (fabs(row.getFloat(b) - expected[b]) > 1.0e-6)
+		orderMatch = false;
+	    norm += row.getFloat(b) * row.getFloat(b);
+	}
+	if (fabs(norm - 1.0f) > 1.0e-5)
+	    unitNorm = false;
+
+	// Labels one hot in the order they were first seen
+	shmea::GList label = ti.getTrainExpectedRow(i);
+	if (label.size() != 3)
+	    labelMatch = false;
+	for (unsigned int c = 0; (labelMatch) && (c < 3); ++c)
+	{
+	    float hot = (c == i % 3) ? 0.99f : 0.01f;
+	    if (fabs(label.getFloat(c) - hot) > 1.0e-6)
+		labelMatch = false;
+	}
+    }
+    G_assert(__FILE__, __LINE__, "Rows out of order or hashed wrong", orderMatch);
+    G_assert(__FILE__, __LINE__, "Rows not L2 normalized", unitNorm);
+    G_assert(__FILE__, __LINE__, "Label OHE mismatch", labelMatch);
+
+    // A test label training never saw does not widen the expected rows
+    corpus = fopen(path, "w");
+    fprintf(corpus, "c1,alpha beta\nunseen,gamma\n");
+    fclose(corpus);
+    ti.importTest(path);
+    unlink(path);
+    G_assert(__FILE__, __LINE__, "Test row count mismatch", ti.getTestSize() == 2);
+    G_assert(__FILE__, __LINE__, "Test label widened the OHE", ti.getTrainExpectedRow(0).size() == 3);
+    G_assert(__FILE__, __LINE__, "Known test label mismatch", fabs(ti.getTestExpectedRow(0).getFloat(1) - 0.99f) < 1.0e-6);
+    shmea::GList unseen = ti.getTestExpectedRow(1);
+    G_assert(__FILE__, __LINE__, "Unseen test label not cold", (unseen.size() == 3) && (unseen.getFloat(0) < 0.5f) && (unseen.getFloat(1) < 0.5f) && (unseen.getFloat(2) < 0.5f));
+
+    printf("TextInputUnitTest completed successfully.\n");
+}
@@ -0,0 +1,239 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "validator-test.h"
+#include "../../unit-test.h"
+#include "Backend/Database/GList.h"
+#include "../../../Backend/Machine Learning/DataObjects/DataInput.h"
+#include "../../../Backend/Machine Learning/GMath/activations.h"
+#include "../../../Backend/Machine Learning/GMath/gmath.h"
+#include "../../../Backend/Machine Learning/Networks/inference.h"
+#include "../../../Backend/Machine Learning/Networks/validator.h"
+#include "../../../Backend/Machine Learning/State/LayerBuilder.h"
+#include "../../../Backend/Machine Learning/State/layer.h"
+#include "../../../Backend/Machine Learning/State/node.h"
+#include "../../../Backend/Machine Learning/Structure/hiddenlayerinfo.h"
+#include "../../../Backend/Machine Learning/Structure/inputlayerinfo.h"
+#include "../../../Backend/Machine Learning/Structure/nninfo.h"
+#include "../../../Backend/Machine Learning/Structure/outputlayerinfo.h"
+#include <math.h>
+#include <pthread.h>
+#include <vector>
+
+// Validation rows whose reads block while the gate is shut, so the test knows exactly when the
+// worker is busy scoring a snapshot
+class GatedInput : public glades::DataInput
+{
+private:
+    std::vector<shmea::GList> rows;
+    std::vector<shmea::GList> expectedRows;
+    mutable pthread_mutex_t gateMutex;
+    mutable pthread_cond_t gateCond;
+    mutable bool entered;
+    bool gateOpen;
+
+public:
+    GatedInput()
+    {
+	entered = false;
+	gateOpen = true;
+	pthread_mutex_init(&gateMutex, NULL);
+	pthread_cond_init(&gateCond, NULL);
+    }
+
+    virtual ~GatedInput()
+    {
+	pthread_cond_destroy(&gateCond);
+	pthread_mutex_destroy(&gateMutex);
+    }
+
+    void addRow(float x0, float x1, float y)
+    {
+	shmea::GList row;
+	row.addFloat(x0);
+	row.addFloat(x1);
+	rows.push_back(row);
+
+	shmea::GList expectedRow;
+	expectedRow.addFloat(y);
+	expectedRows.push_back(expectedRow);
+    }
+
+    void setGate(bool newGateOpen)
+    {
+	pthread_mutex_lock(&gateMutex);
+	gateOpen = newGateOpen;
+	entered = false;
+	pthread_cond_broadcast(&gateCond);
+	pthread_mutex_unlock(&gateMutex);
+    }
+
+    // Block until a reader is held at the shut gate
+    void waitEntered()
+    {
+	pthread_mutex_lock(&gateMutex);
+	while (!entered)
+	    pthread_cond_wait(&gateCond, &gateMutex);
+	pthread_mutex_unlock(&gateMutex);
+    }
+
+    virtual void import(shmea::GString) {}
+
+    virtual shmea::GList getTrainRow(unsigned int index) const
+    {
+	pthread_mutex_lock(&gateMutex);
+	entered = true;
+	pthread_cond_broadcast(&gateCond);
+	while (!gateOpen)
+	    pthread_cond_wait(&gateCond, &gateMutex);
+	pthread_mutex_unlock(&gateMutex);
+
+	return rows[index];
+    }
+
+    virtual shmea::GList getTrainExpectedRow(unsigned int index) const
+    {
+	return expectedRows[index];
+    }
+
+    virtual shmea::GList getTestRow(unsigned int) const { return shmea::GList(); }
+    virtual shmea::GList getTestExpectedRow(unsigned int) const { return shmea::GList(); }
+    virtual unsigned int getTrainSize() const { return rows.size(); }
+    virtual unsigned int getTestSize() const { return 0; }
+    virtual unsigned int getFeatureCount() const { return rows.empty() ? 0 : rows[0].size(); }
+    virtual int getType() const { return glades::DataInput::CSV; }
+};
+
+void ValidatorUnitTest()
+{
+    GatedInput data;
+    data.addRow(0.2f, 0.8f, 1.0f);
+    data.addRow(-0.5f, 0.1f, 0.0f);
+    data.addRow(0.9f, -0.3f, 1.0f);
+
+    // A 2-3-1 regression net to snapshot
+    std::vector<glades::HiddenLayerInfo*> hidden;
+    hidden.push_back(new glades::HiddenLayerInfo(3, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, glades::GMath::SIGMOID, 0.0f));
+    glades::InputLayerInfo* input = new glades::InputLayerInfo(glades::NNInfo::BATCH_STOCHASTIC, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, glades::GMath::TANH, 0.0f);
+    glades::OutputLayerInfo* output = new glades::OutputLayerInfo(1, glades::GMath::REGRESSION);
+    glades::NNInfo info("validatornet", input, hidden, output);
+
+    glades::LayerBuilder meat;
+    meat.setSeed(99);
+    G_assert(__FILE__, __LINE__, "Layer build failed", meat.build(&info, &data, false));
+
+    std::vector<glades::ActivationPlan> plan;
+    for (int l = 0; l <= info.numHiddenLayers(); ++l)
+    {
+	int costFx = (l == info.numHiddenLayers()) ? info.getOutputType() : glades::GMath::REGRESSION;
+	plan.push_back(glades::ActivationPlan(info.getActivationType(l), info.getActivationParam(l), costFx));
+    }
+
+    // Capturing the same shape again reuses the model's buffers
+    glades::InferenceModel reused;
+    G_assert(__FILE__, __LINE__, "Capture failed", reused.capture(meat, &info, plan, 1));
+    const float* outputBlock = reused.getOutput().row(0);
+    G_assert(__FILE__, __LINE__, "Capture failed", reused.capture(meat, &info, plan, 2));
+    G_assert(__FILE__, __LINE__, "Recapture reallocated", (reused.getOutput().row(0) == outputBlock) && (reused.getEpoch() == 2));
+
+    glades::Validator validator;
+    G_assert(__FILE__, __LINE__, "Validator ran before start", (!validator.isRunning()) && (validator.stage() == NULL));
+    G_assert(__FILE__, __LINE__, "Validator did not start", validator.start(&data, 2));
+    G_assert(__FILE__, __LINE__, "Odd epoch due at interval 2", (!validator.due(3)) && (validator.due(4)));
+
+    // Snapshot 2 is taken by the worker, which then blocks reading the shut gate
+    data.setGate(false);
+    glades::InferenceModel* snapshot = validator.stage();
+    G_assert(__FILE__, __LINE__, "Idle validator refused a snapshot", snapshot != NULL);
+    G_assert(__FILE__, __LINE__, "Capture failed", snapshot->capture(meat, &info, plan, 2));
+    validator.submit();
+    data.waitEntered();
+
+    // While it is busy one more snapshot can queue...
+    snapshot = validator.stage();
+    G_assert(__FILE__, __LINE__, "Busy validator refused to queue a snapshot", snapshot != NULL);
+    G_assert(__FILE__, __LINE__, "Capture failed", snapshot->capture(meat, &info, plan, 4));
+    validator.submit();
+
+    // ...and later ones are skipped until the worker picks it up
+    G_assert(__FILE__, __LINE__, "Queued snapshot was not kept", validator.stage() == NULL);
+
+    data.setGate(true);
+    validator.wait();
+
+    // Both scored, in order; the skipped one never was
+    std::vector<glades::ValidationResult> history = validator.getHistory();
+    G_assert(__FILE__, __LINE__, "Wrong history size", history.size() == 2);
+    G_assert(__FILE__, __LINE__, "Wrong history epochs", (history[0].epoch == 2) && (history[1].epoch == 4));
+    G_assert(__FILE__, __LINE__, "Same weights scored differently", history[0].loss == history[1].loss);
+    G_assert(__FILE__, __LINE__, "Loss not finite", (history[0].loss >= 0.0f) && (history[0].loss == history[0].loss));
+
+    // Idle again
+    G_assert(__FILE__, __LINE__, "Idle validator refused a snapshot", validator.stage() != NULL);
+    validator.stop();
+    G_assert(__FILE__, __LINE__, "Validator still running", !validator.isRunning());
+
+    // The same net trained with dropout: the input and hidden masks are drawn at the input rate
+    std::vector<glades::HiddenLayerInfo*> dropoutHidden;
+    dropoutHidden.push_back(new glades::HiddenLayerInfo(3, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, glades::GMath::SIGMOID, 0.0f));
+    glades::InputLayerInfo* dropoutInput = new glades::InputLayerInfo(glades::NNInfo::BATCH_STOCHASTIC, 0.0f, 0.0f, 0.0f, 0.0f, 0.25f, glades::GMath::TANH, 0.0f);
+    glades::OutputLayerInfo* dropoutOutput = new glades::OutputLayerInfo(1, glades::GMath::REGRESSION);
+    glades::NNInfo dropoutInfo("dropoutnet", dropoutInput, dropoutHidden, dropoutOutput);
+
+    // The trainer snapshots from its fp32 masters (rows are output nodes), not the edges
+    std::vector<glades::GMatrix> masters;
+    for (int l = 0; l <= dropoutInfo.numHiddenLayers(); ++l)
+    {
+	glades::Layer* cInputLayer = meat.getLayer(0, l);
+	glades::Layer* cOutputLayer = meat.getLayer(0, l + 1);
+	masters.push_back(glades::GMatrix(cOutputLayer->size(), cInputLayer->size()));
+	for (unsigned int j = 0; j < cOutputLayer->size(); ++j)
+	{
+	    for (unsigned int i = 0; i < cInputLayer->size(); ++i)
+		masters[l](j, i) = (*cOutputLayer)[j]->getEdgeWeight(i);
+	}
+    }
+
+    // Both capture paths scale the weights for dropout
+    glades::InferenceModel fromEdges;
+    G_assert(__FILE__, __LINE__, "Capture failed", fromEdges.capture(meat, &dropoutInfo, plan, 6));
+    glades::InferenceModel fromMasters;
+    G_assert(__FILE__, __LINE__, "Capture failed", fromMasters.capture(meat, &dropoutInfo, plan, 6, &masters));
+    glades::InferenceModel keepAll;
+    G_assert(__FILE__, __LINE__, "Capture failed", keepAll.capture(meat, &info, plan, 6));
+    unsigned int rowCount = fromEdges.predict(&data, 0);
+    G_assert(__FILE__, __LINE__, "Wrong batch row count", (rowCount == 3) && (fromMasters.predict(&data, 0) == 3) && (keepAll.predict(&data, 0) == 3));
+
+    float dropoutLoss = 0.0f;
+    bool pathsMatch = true;
+    bool scaled = true;
+    for (unsigned int b = 0; b < rowCount; ++b)
+    {
+	float prediction = fromEdges.getOutput()(b, 0);
+	pathsMatch = pathsMatch && (prediction == fromMasters.getOutput()(b, 0));
+	scaled = scaled && (fabs(prediction - keepAll.getOutput()(b, 0)) > 1.0e-4f);
+	dropoutLoss += glades::GMath::outputNodeCost(fromEdges.getExpected(b)[0], prediction, (float)rowCount, glades::GMath::REGRESSION);
+    }
+    G_assert(__FILE__, __LINE__, "Master and edge captures disagree", pathsMatch);
+    G_assert(__FILE__, __LINE__, "Dropout snapshot was not scaled", scaled);
+
+    // The validator scores the scaled snapshot
+    glades::Validator dropoutValidator;
+    G_assert(__FILE__, __LINE__, "Validator did not start", dropoutValidator.start(&data, 1));
+    snapshot = dropoutValidator.stage();
+    G_assert(__FILE__, __LINE__, "Idle validator refused a snapshot", snapshot != NULL);
+    G_assert(__FILE__, __LINE__, "Capture failed", snapshot->capture(meat, &dropoutInfo, plan, 6, &masters));
+    dropoutValidator.submit();
+    dropoutValidator.wait();
+    history = dropoutValidator.getHistory();
+    G_assert(__FILE__, __LINE__, "Wrong history size", history.size() == 1);
+    G_assert(__FILE__, __LINE__, "Dropout snapshot scored wrong", fabs(history[0].loss - dropoutLoss) <= 1.0e-6f * (1.0f + dropoutLoss));
+    dropoutValidator.stop();
+
+    printf("ValidatorUnitTest completed successfully.\n");
+}
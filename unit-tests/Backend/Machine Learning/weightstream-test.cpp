@@ -0,0 +1,95 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+
+#include "weightstream-test.h"
+#include "../../unit-test.h"
+#include "../../../Backend/Machine Learning/Networks/weightstream.h"
+#include <math.h>
+#include <vector>
+
+static float maxError(const std::vector<float>& a, const std::vector<float>& b)
+{
+    float worst = 0.0f;
+    for (unsigned int i = 0; i < a.size(); ++i)
+	worst = (fabs(a[i] - b[i]) > worst) ? fabs(a[i] - b[i]) : worst;
+    return worst;
+}
+
+static void testFormat(int format, float tolerance)
+{
+    // Two layers with very different ranges, so each needs its own scale
+    std::vector<unsigned int> layerSizes;
+    layerSizes.push_back(300);
+    layerSizes.push_back(40);
+    std::vector<float> weights(340);
+    for (unsigned int i = 0; i < 300; ++i)
+	weights[i] = sin(0.1f * i) * 0.05f;
+    for (unsigned int i = 300; i < 340; ++i)
+	weights[i] = cos(0.3f * i) * 4.0f;
+
+    glades::WeightStream stream(format);
+    std::vector<char> frame;
+    std::vector<float> received;
+    int64_t frameId = -1;
+    int64_t frameBase = 0;
+
+    // No acknowledgement yet: a keyframe
+    int64_t sentId = stream.encode(weights, layerSizes, frame);
+    G_assert(__FILE__, __LINE__, "Encode failed", sentId == 0);
+    unsigned int valueSize = (format == glades::WeightStream::FORMAT_INT8) ? 1 : 2;
+    G_assert(__FILE__, __LINE__, "Wrong frame size", frame.size() == glades::WeightStream::HEADER_SIZE + (2 * 8) + (340 * valueSize));
+    G_assert(__FILE__, __LINE__, "Keyframe not decoded", glades::WeightStream::decode(&frame[0], frame.size(), received, frameId, frameBase));
+    G_assert(__FILE__, __LINE__, "Wrong keyframe ids", (frameId == 0) && (frameBase == -1));
+    G_assert(__FILE__, __LINE__, "Keyframe too coarse", maxError(received, weights) <= 4.0f * tolerance);
+
+    // Small layer keeps its own precision
+    std::vector<float> small(received.begin(), received.begin() + 300);
+    std::vector<float> smallExp(weights.begin(), weights.begin() + 300);
+    G_assert(__FILE__, __LINE__, "Small layer not scaled", maxError(small, smallExp) <= 0.05f * tolerance);
+
+    // Acknowledged: the next frames are deltas and close in on the weights
+    G_assert(__FILE__, __LINE__, "Ack failed", stream.ack(frameId));
+    G_assert(__FILE__, __LINE__, "Wrong base", stream.getBaseId() == 0);
+    for (unsigned int i = 0; i < 340; ++i)
+	weights[i] += 0.001f * (float)((int)(i % 7) - 3);
+
+    stream.encode(weights, layerSizes, frame);
+    std::vector<float> beforeDelta = received;
+    G_assert(__FILE__, __LINE__, "Delta not decoded", glades::WeightStream::decode(&frame[0], frame.size(), received, frameId, frameBase));
+    G_assert(__FILE__, __LINE__, "Wrong delta ids", (frameId == 1) && (frameBase == 0));
+    G_assert(__FILE__, __LINE__, "Delta too coarse", maxError(received, weights) <= 0.003f * tolerance);
+    G_assert(__FILE__, __LINE__, "Delta lost the keyframe error", maxError(received, weights) < maxError(beforeDelta, weights));
+
+    // A delta without the right base is refused
+    std::vector<float> wrongBase(10, 0.0f);
+    G_assert(__FILE__, __LINE__, "Bad base accepted", !glades::WeightStream::decode(&frame[0], frame.size(), wrongBase, frameId, frameBase));
+
+    // Unknown and stale acknowledgements are ignored
+    G_assert(__FILE__, __LINE__, "Unknown ack accepted", !stream.ack(42));
+    G_assert(__FILE__, __LINE__, "Ack failed", stream.ack(1));
+    G_assert(__FILE__, __LINE__, "Stale ack accepted", !stream.ack(0));
+
+    // A new shape goes back to a keyframe
+    layerSizes.push_back(5);
+    weights.resize(345, 1.0f);
+    stream.encode(weights, layerSizes, frame);
+    G_assert(__FILE__, __LINE__, "Reshape not decoded", glades::WeightStream::decode(&frame[0], frame.size(), received, frameId, frameBase));
+    G_assert(__FILE__, __LINE__, "Reshape not a keyframe", (frameBase == -1) && (received.size() == 345));
+
+    // Truncated frames are rejected
+    G_assert(__FILE__, __LINE__, "Short frame accepted", !glades::WeightStream::decode(&frame[0], frame.size() - 1, received, frameId, frameBase));
+    G_assert(__FILE__, __LINE__, "Mismatched sizes accepted", stream.encode(weights, std::vector<unsigned int>(1, 3), frame) == -1);
+}
+
+void WeightStreamUnitTest()
+{
+    testFormat(glades::WeightStream::FORMAT_FP16, 0.01f);
+    testFormat(glades::WeightStream::FORMAT_INT8, 1.0f);
+
+    printf("WeightStreamUnitTest completed successfully.\n");
+}
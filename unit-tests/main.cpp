@@ -11,6 +11,31 @@
 #include "Backend/Machine Learning/bayes-test.h"
 #include "Backend/Machine Learning/bayes-optimizer-test.h"
 #include "Backend/Machine Learning/ohe-test.h"
+#include "Backend/Machine Learning/featurehasher-test.h"
+#include "Backend/Machine Learning/quantizedtable-test.h"
+#include "Backend/Machine Learning/dataregistry-test.h"
+#include "Backend/Machine Learning/runningstat-test.h"
+#include "Backend/Machine Learning/streaminput-test.h"
+#include "Backend/Machine Learning/fastmath-test.h"
+#include "Backend/Machine Learning/activations-test.h"
+#include "Backend/Machine Learning/kernels-test.h"
+#include "Backend/Machine Learning/gmatrix-test.h"
+#include "Backend/Machine Learning/reduction-test.h"
+#include "Backend/Machine Learning/grandom-test.h"
+#include "Backend/Machine Learning/layer-test.h"
+#include "Backend/Machine Learning/halfmatrix-test.h"
+#include "Backend/Machine Learning/cmatrix-test.h"
+#include "Backend/Machine Learning/roccurve-test.h"
+#include "Backend/Machine Learning/evalpolicy-test.h"
+#include "Backend/Machine Learning/regressionmetrics-test.h"
+#include "Backend/Machine Learning/learningcurve-test.h"
+#include "Backend/Machine Learning/weightstream-test.h"
+#include "Backend/Machine Learning/activationsubscription-test.h"
+#include "Backend/Machine Learning/inference-test.h"
+#include "Backend/Machine Learning/validator-test.h"
+#include "Backend/Machine Learning/telemetry-test.h"
+#include "Backend/Machine Learning/numberinput-test.h"
+#include "Backend/Machine Learning/textinput-test.h"
 
 int main(int argc, char* argv[])
 {
@@ -22,6 +47,31 @@ int main(int argc, char* argv[])
 	BayesUnitTest();
 	BayesOptimizerUnitTest();
 	OHEUnitTest();
+	FeatureHasherUnitTest();
+	QuantizedTableUnitTest();
+	DataRegistryUnitTest();
+	RunningStatUnitTest();
+	StreamInputUnitTest();
+	FastMathUnitTest();
+	ActivationsUnitTest();
+	KernelsUnitTest();
+	GMatrixUnitTest();
+	ReductionUnitTest();
+	GRandomUnitTest();
+	LayerUnitTest();
+	HalfMatrixUnitTest();
+	CMatrixUnitTest();
+	ROCCurveUnitTest();
+	EvalPolicyUnitTest();
+	RegressionMetricsUnitTest();
+	LearningCurveUnitTest();
+	WeightStreamUnitTest();
+	ActivationSubscriptionUnitTest();
+	InferenceUnitTest();
+	ValidatorUnitTest();
+	TelemetryUnitTest();
+	NumberInputUnitTest();
+	TextInputUnitTest();
 
 	printf("========================\n");
 	printf("| Unit Tests Completed |\n");